@@ -0,0 +1,199 @@
+#ifndef TRAYZY_BENCH_BENCH_H
+#define TRAYZY_BENCH_BENCH_H
+
+#include <chrono>
+#include <cstddef>
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace trayzy
+{
+	namespace bench
+	{
+		/// A wall-clock stopwatch that starts on construction
+		class Stopwatch
+		{
+		public:
+			Stopwatch() :
+				mStart(std::chrono::steady_clock::now())
+			{
+				// Do nothing more
+			}
+
+			/// Restarts the measurement from the current time
+			void restart()
+			{
+				mStart = std::chrono::steady_clock::now();
+			}
+
+			/// Returns the seconds elapsed since construction or the last restart
+			double seconds() const
+			{
+				return std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count();
+			}
+
+		private:
+			std::chrono::steady_clock::time_point mStart;
+		};
+
+		/// Command-line options of the form --name value or --flag
+		class Options
+		{
+		public:
+			Options(int argc, char **argv) :
+				mArgc(argc),
+				mArgv(argv)
+			{
+				// Do nothing more
+			}
+
+			/// Returns whether a flag is present
+			bool flag(const char *name) const
+			{
+				return find(name) >= 0;
+			}
+
+			/// Returns the value following an option, or the fallback if it is absent
+			std::string string(const char *name, const std::string &fallback) const
+			{
+				int i = find(name);
+				return i >= 0 && i + 1 < mArgc ? std::string(mArgv[i + 1]) : fallback;
+			}
+
+			/// Returns the numeric value following an option, or the fallback if it is absent
+			double number(const char *name, double fallback) const
+			{
+				int i = find(name);
+				return i >= 0 && i + 1 < mArgc ? std::atof(mArgv[i + 1]) : fallback;
+			}
+
+		private:
+			int find(const char *name) const
+			{
+				for (int i = 0; i < mArgc; ++i)
+				{
+					if (mArgv[i][0] == '-' && mArgv[i][1] == '-' && std::strcmp(mArgv[i] + 2, name) == 0)
+					{
+						return i;
+					}
+				}
+
+				return -1;
+			}
+
+		private:
+			int mArgc;
+			char **mArgv;
+		};
+
+		/// Returns the peak resident memory of the process in bytes
+		inline std::size_t peakMemoryBytes()
+		{
+#if defined(_WIN32)
+			PROCESS_MEMORY_COUNTERS counters;
+			GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+			return counters.PeakWorkingSetSize;
+#else
+			struct rusage usage;
+			getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+			return std::size_t(usage.ru_maxrss);
+#else
+			return std::size_t(usage.ru_maxrss) * 1024;
+#endif
+#endif
+		}
+
+		/// Prevents the compiler from discarding the computation of a value
+		template<typename T>
+		inline void doNotOptimize(const T &value)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			asm volatile("" : : "r,m"(value) : "memory");
+#else
+			static volatile const T *sink;
+			sink = &value;
+#endif
+		}
+
+		// Benchmark entry points, each taking the arguments that follow its name
+
+		/// Measures the cost of participating media queries as their density grows
+		int media(int argc, char **argv);
+
+		/// Compares one-at-a-time and batched camera ray generation
+		int camera(int argc, char **argv);
+
+		/// Measures the attribute evaluations saved by two-phase intersection
+		int intersection(int argc, char **argv);
+
+		/// Compares virtual and static dispatch when rendering the same scene
+		int dispatch(int argc, char **argv);
+
+		/// Compares per-object heap allocation with a scene arena
+		int arena(int argc, char **argv);
+
+		/// Renders procedural scenes of growing size and checks a golden image
+		int scaling(int argc, char **argv);
+
+		/// Measures the image quality reached by time-budgeted renders
+		int progressive(int argc, char **argv);
+
+		/// Compares uniform light selection with the light hierarchy as the light count grows
+		int lights(int argc, char **argv);
+
+		/// Compares closest-hit and any-hit queries for shadow rays
+		int occlusion(int argc, char **argv);
+
+		/// Compares the cost of the path tracer with the preview integrators
+		int integrators(int argc, char **argv);
+
+		/// Compares pointer-based spheres with quantized sphere storage
+		int compact(int argc, char **argv);
+
+		/// Renders a sphere field paged in from a memory-mapped file under a residency budget
+		int outOfCore(int argc, char **argv);
+
+		/// Measures the overhead of per-pixel render statistics and reports the costliest tiles
+		int cost(int argc, char **argv);
+
+		/// Compares scalar and 8-wide Perlin noise and renders a marble scene
+		int noise(int argc, char **argv);
+
+		/// Compares rendering several views of one scene together against one at a time
+		int multiview(int argc, char **argv);
+
+		/// Compares the radiance cache against the uncached path tracer in speed and error
+		int radianceCache(int argc, char **argv);
+
+		/// Compares the convergence of photon-mapped caustics against path tracing them
+		int caustics(int argc, char **argv);
+
+		/// Measures the latency of inserting, removing and moving items of a dynamic hierarchy
+		int edits(int argc, char **argv);
+
+		/// Measures the samples that reprojecting history saves over a camera fly-through
+		int temporal(int argc, char **argv);
+
+		/// Measures the error and speed of the fast math kernels and their effect on a render
+		int fastMath(int argc, char **argv);
+
+		/// Compares rasterized primary visibility against tracing camera rays and checks the images match
+		int hybrid(int argc, char **argv);
+
+		/// Compares environment map sampling with MIS against finding the map by scattering alone
+		int environment(int argc, char **argv);
+	}
+}
+
+#endif
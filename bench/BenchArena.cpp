@@ -0,0 +1,144 @@
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <trayzy/Dielectric.h>
+#include <trayzy/HittableList.h>
+#include <trayzy/Lambertian.h>
+#include <trayzy/Metal.h>
+#include <trayzy/Random.h>
+#include <trayzy/SceneArena.h>
+#include <trayzy/Sphere.h>
+
+#include "Bench.h"
+
+using Dielectricf = trayzy::Dielectric<float>;
+using HittableListf = trayzy::HittableList<float>;
+using Intersectionf = trayzy::Intersection<float>;
+using Lambertianf = trayzy::Lambertian<float>;
+using Metalf = trayzy::Metal<float>;
+using Rayf = trayzy::Ray<float>;
+using Spheref = trayzy::Sphere<float>;
+using Vec3f = trayzy::Vec3<float>;
+
+namespace
+{
+	/// Fills a list with random spheres of mixed materials using the provided factory
+	template<typename Factory>
+	void build(HittableListf &world, int nSpheres, Factory make)
+	{
+		trayzy::seedRandomEngine(7);
+
+		for (int i = 0; i < nSpheres; ++i)
+		{
+			float choice = trayzy::randomUniform<float>();
+			Vec3f center(100.0f * trayzy::randomUniform<float>(), 100.0f * trayzy::randomUniform<float>(),
+				100.0f * trayzy::randomUniform<float>());
+			std::shared_ptr<trayzy::Material<float>> material;
+
+			if (choice < 0.8f)
+			{
+				material = make(trayzy::Lambertian<float>(Vec3f(choice, choice, choice)));
+			}
+			else if (choice < 0.95f)
+			{
+				material = make(Metalf(Vec3f(0.5f, 0.6f, 0.7f), choice - 0.8f));
+			}
+			else
+			{
+				material = make(Dielectricf(1.5f));
+			}
+
+			world.insert(make(Spheref(center, 0.1f, material)));
+		}
+	}
+
+	/// Returns the seconds spent intersecting a few rays with every object in the list
+	double traverse(const HittableListf &world, int nRays)
+	{
+		Intersectionf intersection;
+		trayzy::bench::Stopwatch stopwatch;
+
+		for (int i = 0; i < nRays; ++i)
+		{
+			Rayf ray(Vec3f(-1.0f, 50.0f, 50.0f), Vec3f(1.0f, 0.001f * i, 0.0f));
+			world.hit(ray, 0.001f, 1e30f, intersection);
+			trayzy::bench::doNotOptimize(intersection.t);
+		}
+
+		return stopwatch.seconds();
+	}
+}
+
+namespace trayzy
+{
+	namespace bench
+	{
+		int arena(int argc, char **argv)
+		{
+			int nSpheres = argc > 0 ? std::atoi(argv[0]) : 1000000;
+			int nRays = 20;
+
+			std::cout << "Scene construction with " << nSpheres << " spheres and materials" << std::endl << std::endl;
+			std::cout << std::setw(14) << "allocator" << std::setw(12) << "build s" << std::setw(14) << "traverse s"
+				<< std::setw(12) << "free s" << std::endl;
+
+			{
+				Stopwatch stopwatch;
+				auto world = std::make_unique<HittableListf>();
+				build(*world, nSpheres, [](auto object)
+				{
+					return std::make_shared<decltype(object)>(object);
+				});
+				double buildSeconds = stopwatch.seconds();
+				double traverseSeconds = traverse(*world, nRays);
+
+				stopwatch.restart();
+				world.reset();
+				double freeSeconds = stopwatch.seconds();
+
+				std::cout << std::fixed << std::setprecision(4) << std::setw(14) << "make_shared"
+					<< std::setw(12) << buildSeconds << std::setw(14) << traverseSeconds
+					<< std::setw(12) << freeSeconds << std::endl;
+			}
+
+			std::vector<SceneArena::Footprint> footprint;
+
+			{
+				Stopwatch stopwatch;
+				auto sceneArena = std::make_unique<SceneArena>();
+				auto world = std::make_unique<HittableListf>();
+				build(*world, nSpheres, [&](auto object)
+				{
+					return unowned(sceneArena->make<decltype(object)>(object));
+				});
+				double buildSeconds = stopwatch.seconds();
+				double traverseSeconds = traverse(*world, nRays);
+				footprint = sceneArena->footprint();
+
+				stopwatch.restart();
+				world.reset();
+				sceneArena.reset();
+				double freeSeconds = stopwatch.seconds();
+
+				std::cout << std::fixed << std::setprecision(4) << std::setw(14) << "arena"
+					<< std::setw(12) << buildSeconds << std::setw(14) << traverseSeconds
+					<< std::setw(12) << freeSeconds << std::endl << std::endl;
+			}
+
+			std::cout << std::left << std::setw(40) << "arena type" << std::right << std::setw(12) << "count"
+				<< std::setw(12) << "bytes/obj" << std::setw(14) << "used KiB" << std::setw(14) << "reserved KiB" << std::endl;
+
+			for (const SceneArena::Footprint &entry : footprint)
+			{
+				std::cout << std::left << std::setw(40) << entry.type << std::right << std::setw(12) << entry.count
+					<< std::setw(12) << entry.objectBytes << std::setw(14) << entry.usedBytes / 1024
+					<< std::setw(14) << entry.reservedBytes / 1024 << std::endl;
+			}
+
+			return 0;
+		}
+	}
+}
@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+#include <trayzy/Camera.h>
+#include <trayzy/Random.h>
+#include <trayzy/RayBatch.h>
+
+#include "Bench.h"
+
+using Cameraf = trayzy::Camera<float>;
+using Rayf = trayzy::Ray<float>;
+using RayBatchf = trayzy::RayBatch<float>;
+using Vec3f = trayzy::Vec3<float>;
+
+namespace
+{
+	/// Returns the rays per second of generating one ray at a time
+	double measureScalar(const Cameraf &camera, int nCols, int nRows, int nSamples)
+	{
+		trayzy::bench::Stopwatch stopwatch;
+
+		for (int j = 0; j < nRows; ++j)
+		{
+			for (int i = 0; i < nCols; ++i)
+			{
+				for (int s = 0; s < nSamples; ++s)
+				{
+					float u = (i + trayzy::randomUniform<float>()) / nCols;
+					float v = (j + trayzy::randomUniform<float>()) / nRows;
+					Rayf ray = camera.getRay(u, v);
+					trayzy::bench::doNotOptimize(ray);
+				}
+			}
+		}
+
+		return double(nCols) * nRows * nSamples / stopwatch.seconds();
+	}
+
+	/// Returns the rays per second of generating a tile of rays at a time
+	double measureBatch(const Cameraf &camera, int nCols, int nRows, int nSamples, int tileSize)
+	{
+		RayBatchf rays;
+		trayzy::bench::Stopwatch stopwatch;
+
+		for (int y0 = 0; y0 < nRows; y0 += tileSize)
+		{
+			for (int x0 = 0; x0 < nCols; x0 += tileSize)
+			{
+				int width = std::min(tileSize, nCols - x0);
+				int height = std::min(tileSize, nRows - y0);
+				camera.getRays(x0, y0, width, height, nCols, nRows, nSamples, rays);
+				trayzy::bench::doNotOptimize(rays.directionZ.back());
+			}
+		}
+
+		return double(nCols) * nRows * nSamples / stopwatch.seconds();
+	}
+}
+
+namespace trayzy
+{
+	namespace bench
+	{
+		int camera(int argc, char **argv)
+		{
+			int nCols = argc > 0 ? std::atoi(argv[0]) : 1920;
+			int nRows = argc > 1 ? std::atoi(argv[1]) : 1080;
+			int nSamples = argc > 2 ? std::atoi(argv[2]) : 4;
+			float aspectRatio = float(nCols) / nRows;
+
+			Vec3f lookFrom(3, 3, 2);
+			Vec3f lookAt(0, 0, -1);
+			Cameraf pinhole(lookFrom, lookAt, Vec3f(0, 1, 0), 20, aspectRatio);
+			Cameraf thinLens(lookFrom, lookAt, Vec3f(0, 1, 0), 20, aspectRatio, 2.0f, (lookFrom - lookAt).magnitude());
+
+			std::cout << "Camera ray generation, " << nCols << "x" << nRows << " at " << nSamples
+				<< " samples per pixel, millions of rays per second" << std::endl << std::endl;
+			std::cout << std::setw(12) << "camera" << std::setw(12) << "scalar"
+				<< std::setw(12) << "tile 8" << std::setw(12) << "tile 16" << std::setw(12) << "tile 64" << std::endl;
+
+			for (const Cameraf *camera : { &pinhole, &thinLens })
+			{
+				std::cout << std::fixed << std::setprecision(1)
+					<< std::setw(12) << (camera == &pinhole ? "pinhole" : "thin lens")
+					<< std::setw(12) << measureScalar(*camera, nCols, nRows, nSamples) * 1e-6
+					<< std::setw(12) << measureBatch(*camera, nCols, nRows, nSamples, 8) * 1e-6
+					<< std::setw(12) << measureBatch(*camera, nCols, nRows, nSamples, 16) * 1e-6
+					<< std::setw(12) << measureBatch(*camera, nCols, nRows, nSamples, 64) * 1e-6 << std::endl;
+			}
+
+			return 0;
+		}
+	}
+}
@@ -0,0 +1,169 @@
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <trayzy/Camera.h>
+#include <trayzy/Dielectric.h>
+#include <trayzy/DiffuseLight.h>
+#include <trayzy/HittableList.h>
+#include <trayzy/Image.h>
+#include <trayzy/Lambertian.h>
+#include <trayzy/LightSampler.h>
+#include <trayzy/PathIntegrator.h>
+#include <trayzy/PhotonMap.h>
+#include <trayzy/PhotonMapIntegrator.h>
+#include <trayzy/Renderer.h>
+#include <trayzy/SceneArena.h>
+#include <trayzy/Sphere.h>
+#include <trayzy/UniformLightSampler.h>
+
+#include "Bench.h"
+
+using Cameraf = trayzy::Camera<float>;
+using Dielectricf = trayzy::Dielectric<float>;
+using DiffuseLightf = trayzy::DiffuseLight<float>;
+using HittableListf = trayzy::HittableList<float>;
+using Imagef = trayzy::Image<float>;
+using Integratorf = trayzy::Integrator<float>;
+using Lambertianf = trayzy::Lambertian<float>;
+using Lightf = trayzy::Light<float>;
+using PathIntegratorf = trayzy::PathIntegrator<float>;
+using PhotonMapf = trayzy::PhotonMap<float>;
+using PhotonMapIntegratorf = trayzy::PhotonMapIntegrator<float>;
+using Rendererf = trayzy::Renderer<float>;
+using Spheref = trayzy::Sphere<float>;
+using UniformLightSamplerf = trayzy::UniformLightSampler<float>;
+using Vec3f = trayzy::Vec3<float>;
+
+namespace
+{
+	/// Returns the mean of every pixel's components, which noise leaves alone but bias shifts
+	double meanBrightness(const Imagef &image)
+	{
+		double sum = 0;
+
+		for (int row = 0; row < image.height(); ++row)
+		{
+			for (int col = 0; col < image.width(); ++col)
+			{
+				const Vec3f &c = image.at(col, row);
+				sum += c[trayzy::R] + c[trayzy::G] + c[trayzy::B];
+			}
+		}
+
+		return sum / (3.0 * image.width() * image.height());
+	}
+}
+
+namespace trayzy
+{
+	namespace bench
+	{
+		int caustics(int argc, char **argv)
+		{
+			Options options(argc, argv);
+
+			RenderSettings settings;
+			settings.width = int(options.number("width", 128));
+			settings.height = int(options.number("height", 72));
+			settings.threads = int(options.number("threads", 0));
+			std::size_t nEmitted = std::size_t(options.number("photons", 1e7));
+			float radius = float(options.number("radius", 0.05));
+
+			// Glass spheres over a matte floor under one small light; the large one hovers so that it focuses on the floor, with a dark dome instead of the sky
+			SceneArena arena;
+			HittableListf world;
+			Lightf light = { Vec3f(-1.0f, 7.0f, -0.5f), 0.25f, Vec3f(400.0f, 380.0f, 340.0f) };
+			world.insert(unowned(arena.make<Spheref>(Vec3f(0.0f, 0.0f, 0.0f), 50.0f,
+				unowned(arena.make<DiffuseLightf>(Vec3f(0, 0, 0))))));
+			world.insert(unowned(arena.make<Spheref>(Vec3f(0.0f, -1000.0f, 0.0f), 1000.0f,
+				unowned(arena.make<Lambertianf>(Vec3f(0.8f, 0.8f, 0.8f))))));
+			world.insert(unowned(arena.make<Spheref>(Vec3f(0.0f, 1.5f, 0.0f), 1.0f,
+				unowned(arena.make<Dielectricf>(1.5f)))));
+			world.insert(unowned(arena.make<Spheref>(Vec3f(2.2f, 0.6f, 0.6f), 0.6f,
+				unowned(arena.make<Dielectricf>(1.5f)))));
+			world.insert(unowned(arena.make<Spheref>(Vec3f(-1.8f, 0.5f, 1.2f), 0.5f,
+				unowned(arena.make<Lambertianf>(Vec3f(0.7f, 0.3f, 0.2f))))));
+			world.insert(unowned(arena.make<Spheref>(light.center, light.radius,
+				unowned(arena.make<DiffuseLightf>(light.emission)))));
+
+			auto lights = std::make_shared<UniformLightSamplerf>(std::vector<Lightf>{ light });
+			Cameraf camera(Vec3f(0.5f, 4.0f, 6.5f), Vec3f(0.5f, 0.3f, 0.0f), Vec3f(0.0f, 1.0f, 0.0f), 40.0f,
+				float(settings.width) / settings.height);
+
+			Stopwatch stopwatch;
+			auto photons = std::make_shared<PhotonMapf>(world, lights->lights(), nEmitted, radius, settings.threads);
+			double buildSeconds = stopwatch.seconds();
+			auto otherPhotons = std::make_shared<PhotonMapf>(world, lights->lights(), nEmitted, radius, settings.threads, 1);
+
+			std::cout << "Caustics through glass spheres, " << settings.width << "x" << settings.height << " on "
+				<< Rendererf(settings).threadCount() << " threads" << std::endl << "Photon map: " << nEmitted
+				<< " emitted, " << photons->size() << " caustic photons stored, " << std::fixed << std::setprecision(1)
+				<< photons->memoryBytes() / 1048576.0 << " MiB, built in " << std::setprecision(3) << buildSeconds
+				<< " s" << std::endl << std::endl
+				<< "Noise is the RMSE between renders and photon maps with two seeds over the square root of two;" << std::endl
+				<< "the mean is relative to the path tracer at the most samples, which no bias shifts" << std::endl << std::endl;
+			std::cout << std::setw(10) << "renderer" << std::setw(8) << "spp" << std::setw(12) << "total s"
+				<< std::setw(10) << "noise" << std::setw(10) << "mean %" << std::endl;
+
+			struct Row
+			{
+				bool mapped;
+				int samples;
+				double seconds;
+				float noise;
+				double mean;
+			};
+
+			std::vector<Row> rows;
+			double referenceMean = 0;
+
+			for (int samples = 4; samples <= int(options.number("max-samples", 256)); samples *= 4)
+			{
+				for (bool mapped : { false, true })
+				{
+					RenderSettings rowSettings = settings;
+					rowSettings.samples = samples;
+					std::shared_ptr<const Integratorf> integrator = std::make_shared<PathIntegratorf>(lights);
+					std::shared_ptr<const Integratorf> otherIntegrator = integrator;
+
+					if (mapped)
+					{
+						integrator = std::make_shared<PhotonMapIntegratorf>(photons, lights);
+						otherIntegrator = std::make_shared<PhotonMapIntegratorf>(otherPhotons, lights);
+					}
+
+					stopwatch.restart();
+					Imagef image = Rendererf(rowSettings, integrator).render(world, camera);
+					double seconds = stopwatch.seconds() + (mapped ? buildSeconds : 0);
+
+					rowSettings.seed = settings.seed + 1;
+					Imagef other = Rendererf(rowSettings, otherIntegrator).render(world, camera);
+					double mean = meanBrightness(image);
+					referenceMean = mapped ? referenceMean : mean;
+					rows.push_back({ mapped, samples, seconds, rmse(image, other) / std::sqrt(2.0f), mean });
+
+					if (options.flag("write-images"))
+					{
+						std::ofstream out(std::string("caustics-") + (mapped ? "photons-" : "path-")
+							+ std::to_string(samples) + ".ppm", std::ios::binary);
+						image.writePpm(out, true);
+					}
+				}
+			}
+
+			for (const Row &row : rows)
+			{
+				std::cout << std::setw(10) << (row.mapped ? "photons" : "path") << std::setw(8) << row.samples
+					<< std::setw(12) << std::setprecision(3) << row.seconds << std::setw(10) << row.noise
+					<< std::setw(10) << std::setprecision(2) << 100 * (row.mean / referenceMean - 1) << std::endl;
+			}
+
+			return 0;
+		}
+	}
+}
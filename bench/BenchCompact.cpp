@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <trayzy/Bvh.h>
+#include <trayzy/Camera.h>
+#include <trayzy/CompactSphereBvh.h>
+#include <trayzy/Image.h>
+#include <trayzy/NormalIntegrator.h>
+#include <trayzy/Renderer.h>
+#include <trayzy/SceneArena.h>
+#include <trayzy/SceneGenerator.h>
+#include <trayzy/Sphere.h>
+
+#include "Bench.h"
+
+using Bvhf = trayzy::Bvh<float>;
+using Cameraf = trayzy::Camera<float>;
+using CompactSphereBvhf = trayzy::CompactSphereBvh<float>;
+using HitRecordf = trayzy::HitRecord<float>;
+using Hittablef = trayzy::Hittable<float>;
+using Imagef = trayzy::Image<float>;
+using Materialf = trayzy::Material<float>;
+using NormalIntegratorf = trayzy::NormalIntegrator<float>;
+using Rayf = trayzy::Ray<float>;
+using Rendererf = trayzy::Renderer<float>;
+using Spheref = trayzy::Sphere<float>;
+using Vec3f = trayzy::Vec3<float>;
+
+namespace
+{
+	/// Returns the nanoseconds per closest-hit query over the rays
+	double closestHitNanoseconds(const Hittablef &world, const std::vector<Rayf> &rays)
+	{
+		std::size_t nHits = 0;
+		trayzy::bench::Stopwatch stopwatch;
+
+		for (const Rayf &ray : rays)
+		{
+			HitRecordf record;
+			nHits += world.closestHit(ray, 0.001f, 1e30f, record);
+		}
+
+		trayzy::bench::doNotOptimize(nHits);
+		return stopwatch.seconds() * 1e9 / rays.size();
+	}
+
+	/// Returns the fraction of rays that hit in only one world or at distances more than 0.1% apart
+	double mismatchFraction(const Hittablef &a, const Hittablef &b, const std::vector<Rayf> &rays)
+	{
+		std::size_t nMismatches = 0;
+
+		for (const Rayf &ray : rays)
+		{
+			HitRecordf recordA;
+			HitRecordf recordB;
+			bool hitA = a.closestHit(ray, 0.001f, 1e30f, recordA);
+			bool hitB = b.closestHit(ray, 0.001f, 1e30f, recordB);
+			nMismatches += hitA != hitB || (hitA && std::abs(recordA.t - recordB.t) > 1e-3f * recordA.t);
+		}
+
+		return double(nMismatches) / rays.size();
+	}
+}
+
+namespace trayzy
+{
+	namespace bench
+	{
+		int compact(int argc, char **argv)
+		{
+			Options options(argc, argv);
+			double maxCount = options.number("max", 1e6);
+			int nRays = int(options.number("rays", 200000));
+
+			RenderSettings settings;
+			settings.width = 160;
+			settings.height = 90;
+			settings.samples = int(options.number("samples", 4));
+			settings.threads = int(options.number("threads", 0));
+
+			Cameraf camera(Vec3f(13.0f, 2.0f, 3.0f), Vec3f(0.0f, 0.0f, 0.0f), Vec3f(0.0f, 1.0f, 0.0f), 20.0f,
+				float(settings.width) / settings.height, 0.1f, 10.0f);
+
+			std::cout << "Pointer-based versus quantized sphere storage, " << nRays
+				<< " camera rays per scene" << std::endl << std::endl;
+			std::cout << std::setw(10) << "spheres" << std::setw(14) << "sphere B/prim" << std::setw(15)
+				<< "compact B/prim" << std::setw(12) << "sphere ns" << std::setw(13) << "compact ns"
+				<< std::setw(12) << "decode cost" << std::setw(12) << "mismatch %" << std::setw(14)
+				<< "normals RMSE" << std::endl;
+
+			for (double count = 10000; count <= maxCount; count *= 10)
+			{
+				SceneArena fieldArena;
+				auto field = generateSphereField<float>(fieldArena, std::size_t(count));
+
+				// The field has a material per sphere, so share a table of at most 32768 among them,
+				// keeping the ground and feature spheres' own materials
+				std::vector<std::shared_ptr<Materialf>> materials;
+				std::map<const Materialf *, std::uint16_t> ids;
+				std::vector<CompactSphereBvhf::Primitive> primitives(field.size());
+				std::vector<std::size_t> order(field.size());
+
+				for (std::size_t i = 0; i < field.size(); ++i)
+				{
+					order[i] = i == 0 || i + 3 >= field.size() ? i : field.size();
+				}
+
+				for (std::size_t pass = 0; pass < 2; ++pass)
+				{
+					for (std::size_t i = 0; i < field.size(); ++i)
+					{
+						if ((order[i] == i) != (pass == 0))
+						{
+							continue;
+						}
+
+						auto sphere = static_cast<const Spheref *>(field[i].get());
+						const Materialf *material = sphere->material().get();
+
+						if (ids.count(material) == 0)
+						{
+							if (materials.size() < CompactSphereBvhf::maxMaterials)
+							{
+								ids[material] = std::uint16_t(materials.size());
+								materials.push_back(sphere->material());
+							}
+							else
+							{
+								ids[material] = std::uint16_t(4 + i % (CompactSphereBvhf::maxMaterials - 4));
+							}
+						}
+
+						primitives[i] = { sphere->center(), sphere->radius(), ids[material] };
+					}
+				}
+
+				// Rebuild the pointer-based scene from the same spheres and table
+				SceneArena arena;
+				std::vector<std::shared_ptr<Hittablef>> spheres;
+
+				for (const CompactSphereBvhf::Primitive &primitive : primitives)
+				{
+					spheres.push_back(unowned(arena.make<Spheref>(primitive.center, primitive.radius,
+						materials[primitive.material])));
+				}
+
+				// The arena keeps owning the shared materials, so only the field's spheres can go
+				field.clear();
+
+				std::size_t nSpheres = spheres.size();
+				Bvhf world(std::move(spheres), 8);
+				CompactSphereBvhf compactWorld(std::move(primitives), materials);
+
+				std::size_t sphereBytes = world.memoryBytes() + nSpheres * sizeof(Spheref);
+				std::size_t compactBytes = compactWorld.memoryBytes();
+
+				std::mt19937 engine(1);
+				std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+				std::vector<Rayf> rays;
+
+				for (int i = 0; i < nRays; ++i)
+				{
+					float u = uniform(engine);
+					float v = uniform(engine);
+					rays.push_back(camera.getRay(u, v));
+				}
+
+				double sphereNanoseconds = closestHitNanoseconds(world, rays);
+				double compactNanoseconds = closestHitNanoseconds(compactWorld, rays);
+
+				double mismatches = mismatchFraction(world, compactWorld, rays);
+
+				// Normals show geometric error directly, without the noise of diverging light paths
+				auto normals = std::make_shared<NormalIntegratorf>();
+				Imagef image = Rendererf(settings, normals).render(world, camera);
+				Imagef compactImage = Rendererf(settings, normals).render(compactWorld, camera);
+
+				std::cout << std::fixed << std::setprecision(1) << std::setw(10) << nSpheres
+					<< std::setw(14) << double(sphereBytes) / nSpheres << std::setw(15)
+					<< double(compactBytes) / nSpheres << std::setw(12) << sphereNanoseconds << std::setw(13)
+					<< compactNanoseconds << std::setw(11) << std::setprecision(2)
+					<< compactNanoseconds / sphereNanoseconds << "x" << std::setw(12) << std::setprecision(3)
+					<< 100 * mismatches << std::setw(14) << rmse(image, compactImage) << std::endl;
+			}
+
+			return 0;
+		}
+	}
+}
@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <trayzy/Bvh.h>
+#include <trayzy/Camera.h>
+#include <trayzy/Renderer.h>
+#include <trayzy/RenderStats.h>
+#include <trayzy/SceneArena.h>
+#include <trayzy/SceneGenerator.h>
+
+#include "Bench.h"
+
+using Bvhf = trayzy::Bvh<float>;
+using Cameraf = trayzy::Camera<float>;
+using Rendererf = trayzy::Renderer<float>;
+using Vec3f = trayzy::Vec3<float>;
+
+namespace trayzy
+{
+	namespace bench
+	{
+		int cost(int argc, char **argv)
+		{
+			Options options(argc, argv);
+			std::size_t count = std::size_t(options.number("count", 10000));
+			std::string prefix = options.string("out", "");
+
+			RenderSettings settings;
+			settings.width = int(options.number("width", 320));
+			settings.height = int(options.number("height", 180));
+			settings.samples = int(options.number("samples", 8));
+			settings.threads = int(options.number("threads", 0));
+
+			SceneArena arena;
+			Bvhf world(generateSphereField<float>(arena, count));
+			Cameraf camera(Vec3f(13.0f, 2.0f, 3.0f), Vec3f(0.0f, 0.0f, 0.0f), Vec3f(0.0f, 1.0f, 0.0f), 20.0f,
+				float(settings.width) / settings.height, 0.1f, 10.0f);
+			Rendererf renderer(settings);
+
+			std::cout << "Render cost statistics on a field of " << count << " spheres, " << settings.width << "x"
+				<< settings.height << " at " << settings.samples << " samples per pixel; intersection tests are "
+				<< (RenderStats::countsTests() ? "" : "not ") << "counted in this build" << std::endl << std::endl;
+
+			// Keep the fastest of a few renders with and without statistics, which is the least disturbed
+			RenderStats stats;
+			double plainSeconds = 1e30;
+			double statsSeconds = 1e30;
+
+			for (int i = 0; i < 3; ++i)
+			{
+				Stopwatch stopwatch;
+				renderer.render(world, camera);
+				plainSeconds = std::min(plainSeconds, stopwatch.seconds());
+
+				stopwatch.restart();
+				renderer.render(world, camera, &stats);
+				statsSeconds = std::min(statsSeconds, stopwatch.seconds());
+			}
+
+			using Metric = RenderStats::Metric;
+			std::cout << std::fixed << std::setprecision(3) << "without statistics " << plainSeconds << " s, with "
+				<< statsSeconds << " s (" << std::setprecision(1) << 100 * (statsSeconds / plainSeconds - 1)
+				<< "% overhead)" << std::endl;
+			std::cout << std::uint64_t(stats.total(Metric::Rays)) << " rays, "
+				<< std::uint64_t(stats.total(Metric::Tests)) << " intersection tests" << std::endl << std::endl;
+
+			std::vector<TileCost> tiles = stats.tiles();
+			double meanSeconds = 0;
+
+			for (const TileCost &tile : tiles)
+			{
+				meanSeconds += tile.seconds / tiles.size();
+			}
+
+			std::sort(tiles.begin(), tiles.end(), [](const TileCost &a, const TileCost &b) { return a.seconds > b.seconds; });
+
+			std::cout << "Costliest tiles, against a mean of " << std::setprecision(3) << 1e3 * meanSeconds << " ms"
+				<< std::endl << std::endl;
+			std::cout << std::setw(8) << "tile" << std::setw(8) << "x0" << std::setw(8) << "y0" << std::setw(10) << "ms"
+				<< std::setw(10) << "x mean" << std::setw(12) << "rays" << std::setw(14) << "tests" << std::endl;
+
+			for (std::size_t i = 0; i < std::min<std::size_t>(5, tiles.size()); ++i)
+			{
+				const TileCost &tile = tiles[i];
+				std::cout << std::setw(8) << tile.tile.index << std::setw(8) << tile.tile.x0 << std::setw(8)
+					<< tile.tile.y0 << std::setw(10) << std::setprecision(3) << 1e3 * tile.seconds << std::setw(10)
+					<< std::setprecision(2) << tile.seconds / meanSeconds << std::setw(12) << tile.rays
+					<< std::setw(14) << tile.tests << std::endl;
+			}
+
+			if (!prefix.empty())
+			{
+				std::ofstream timeOut(prefix + "-time.ppm", std::ios::binary);
+				stats.writeHeatmap(timeOut, Metric::Time);
+				std::ofstream raysOut(prefix + "-rays.ppm", std::ios::binary);
+				stats.writeHeatmap(raysOut, Metric::Rays);
+				std::ofstream testsOut(prefix + "-tests.ppm", std::ios::binary);
+				stats.writeHeatmap(testsOut, Metric::Tests);
+				std::ofstream tilesOut(prefix + "-tiles.csv");
+				stats.writeTileCsv(tilesOut);
+			}
+
+			return 0;
+		}
+	}
+}
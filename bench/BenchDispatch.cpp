@@ -0,0 +1,152 @@
+#include <cstdlib>
+#include <type_traits>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <trayzy/Camera.h>
+#include <trayzy/HittableList.h>
+#include <trayzy/PathTracer.h>
+#include <trayzy/Random.h>
+#include <trayzy/RayBatch.h>
+#include <trayzy/Sphere.h>
+#include <trayzy/StaticScene.h>
+
+#include "Bench.h"
+
+using Cameraf = trayzy::Camera<float>;
+using Dielectricf = trayzy::Dielectric<float>;
+using HittableListf = trayzy::HittableList<float>;
+using Lambertianf = trayzy::Lambertian<float>;
+using Metalf = trayzy::Metal<float>;
+using RayBatchf = trayzy::RayBatch<float>;
+using Spheref = trayzy::Sphere<float>;
+using StaticScenef = trayzy::StaticScene<float>;
+using Vec3f = trayzy::Vec3<float>;
+
+namespace
+{
+	/// Builds the same field of small random spheres in both scene representations
+	void buildScenes(int gridSize, HittableListf &open, StaticScenef &closed)
+	{
+		trayzy::seedRandomEngine(42);
+
+		auto add = [&](const Vec3f &center, float radius, const StaticScenef::MaterialVariant &material)
+		{
+			std::shared_ptr<trayzy::Material<float>> pointer = std::visit([](const auto &m)
+			{
+				return std::shared_ptr<trayzy::Material<float>>(std::make_shared<std::decay_t<decltype(m)>>(m));
+			}, material);
+
+			open.insert(std::make_shared<Spheref>(center, radius, pointer));
+			closed.addSphere(center, radius, closed.addMaterial(material));
+		};
+
+		add(Vec3f(0.0f, -1000.0f, 0.0f), 1000.0f, Lambertianf(Vec3f(0.5f, 0.5f, 0.5f)));
+
+		for (int a = -gridSize; a < gridSize; ++a)
+		{
+			for (int b = -gridSize; b < gridSize; ++b)
+			{
+				float choice = trayzy::randomUniform<float>();
+				Vec3f center(a + 0.9f * trayzy::randomUniform<float>(), 0.2f, b + 0.9f * trayzy::randomUniform<float>());
+
+				if (choice < 0.8f)
+				{
+					add(center, 0.2f, Lambertianf(Vec3f(trayzy::randomUniform<float>(), trayzy::randomUniform<float>(),
+						trayzy::randomUniform<float>())));
+				}
+				else if (choice < 0.95f)
+				{
+					add(center, 0.2f, Metalf(Vec3f(0.5f, 0.6f, 0.7f), 0.5f * trayzy::randomUniform<float>()));
+				}
+				else
+				{
+					add(center, 0.2f, Dielectricf(1.5f));
+				}
+			}
+		}
+
+		add(Vec3f(0.0f, 1.0f, 0.0f), 1.0f, Dielectricf(1.5f));
+		add(Vec3f(-4.0f, 1.0f, 0.0f), 1.0f, Lambertianf(Vec3f(0.4f, 0.2f, 0.1f)));
+		add(Vec3f(4.0f, 1.0f, 0.0f), 1.0f, Metalf(Vec3f(0.7f, 0.6f, 0.5f), 0.0f));
+	}
+
+	/// Renders the scene with per-pixel seeds so both representations draw identical samples
+	template<typename World>
+	std::vector<Vec3f> render(const World &world, const Cameraf &camera, int nCols, int nRows, int nSamples)
+	{
+		std::vector<Vec3f> image;
+		RayBatchf rays;
+
+		for (int j = 0; j < nRows; ++j)
+		{
+			for (int i = 0; i < nCols; ++i)
+			{
+				trayzy::seedRandomEngine(unsigned(j * nCols + i + 1));
+				camera.getRays(i, j, 1, 1, nCols, nRows, nSamples, rays);
+				Vec3f c;
+
+				for (int s = 0; s < nSamples; ++s)
+				{
+					c += trayzy::color(rays.ray(s), world, 0);
+				}
+
+				image.push_back(c / float(nSamples));
+			}
+		}
+
+		return image;
+	}
+}
+
+namespace trayzy
+{
+	namespace bench
+	{
+		int dispatch(int argc, char **argv)
+		{
+			int nCols = argc > 0 ? std::atoi(argv[0]) : 160;
+			int nRows = argc > 1 ? std::atoi(argv[1]) : 90;
+			int nSamples = argc > 2 ? std::atoi(argv[2]) : 8;
+
+			Cameraf camera(Vec3f(13.0f, 2.0f, 3.0f), Vec3f(0.0f, 0.0f, 0.0f), Vec3f(0.0f, 1.0f, 0.0f),
+				20.0f, float(nCols) / nRows);
+
+			std::cout << "Virtual versus static dispatch, " << nCols << "x" << nRows << " at "
+				<< nSamples << " samples per pixel" << std::endl << std::endl;
+			std::cout << std::setw(10) << "spheres" << std::setw(14) << "virtual s" << std::setw(14) << "static s"
+				<< std::setw(12) << "speedup" << std::setw(18) << "identical px" << std::endl;
+
+			for (int gridSize : { 2, 5, 11 })
+			{
+				HittableListf open;
+				StaticScenef closed;
+				buildScenes(gridSize, open, closed);
+
+				Stopwatch stopwatch;
+				std::vector<Vec3f> openImage = render(open, camera, nCols, nRows, nSamples);
+				double openSeconds = stopwatch.seconds();
+
+				stopwatch.restart();
+				std::vector<Vec3f> closedImage = render(closed, camera, nCols, nRows, nSamples);
+				double closedSeconds = stopwatch.seconds();
+
+				std::size_t nIdentical = 0;
+
+				for (std::size_t i = 0; i < openImage.size(); ++i)
+				{
+					nIdentical += (openImage[i] == closedImage[i]);
+				}
+
+				std::cout << std::fixed << std::setprecision(3) << std::setw(10) << closed.size()
+					<< std::setw(14) << openSeconds << std::setw(14) << closedSeconds
+					<< std::setw(12) << openSeconds / closedSeconds
+					<< std::setw(17) << std::setprecision(1) << 100.0 * nIdentical / openImage.size() << "%" << std::endl;
+			}
+
+			return 0;
+		}
+	}
+}
@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <trayzy/Bvh.h>
+#include <trayzy/Camera.h>
+#include <trayzy/DynamicBvh.h>
+#include <trayzy/HitRecord.h>
+#include <trayzy/HittableList.h>
+#include <trayzy/Renderer.h>
+#include <trayzy/SceneArena.h>
+#include <trayzy/SceneGenerator.h>
+#include <trayzy/Sphere.h>
+
+#include "Bench.h"
+
+using Bvhf = trayzy::Bvh<float>;
+using Cameraf = trayzy::Camera<float>;
+using DynamicBvhf = trayzy::DynamicBvh<float>;
+using Hittablef = trayzy::Hittable<float>;
+using HitRecordf = trayzy::HitRecord<float>;
+using HittableListf = trayzy::HittableList<float>;
+using Rendererf = trayzy::Renderer<float>;
+using Spheref = trayzy::Sphere<float>;
+using Vec3f = trayzy::Vec3<float>;
+
+namespace
+{
+	/// The latencies of one kind of edit, in seconds
+	struct Latencies
+	{
+		std::string name;
+		std::vector<double> seconds;
+	};
+
+	/// Returns the mean seconds it takes to render a small view of a world
+	double renderSeconds(const Hittablef &world, const trayzy::RenderSettings &settings)
+	{
+		Cameraf camera(Vec3f(13.0f, 2.0f, 3.0f), Vec3f(0.0f, 0.0f, 0.0f), Vec3f(0.0f, 1.0f, 0.0f), 20.0f,
+			float(settings.width) / settings.height, 0.1f, 10.0f);
+		trayzy::bench::Stopwatch stopwatch;
+		Rendererf(settings).render(world, camera);
+		return stopwatch.seconds();
+	}
+
+	/**
+	 * Returns the number of camera rays whose closest hit or occlusion differs between a tree
+	 * whose items are two interleaved trees and a list of the same spheres.
+	 *
+	 * The inner trees overlap everywhere, so traversing one often happens while the outer tree
+	 * has nodes deferred, which catches traversals that share their stacks. Leaves get at least a
+	 * small margin because an unpadded slab test can round away a grazing hit that the list finds,
+	 * in flat trees as much as in nested ones.
+	 */
+	std::size_t nestedMismatches(const std::vector<std::shared_ptr<Hittablef>> &spheres, int nRays, float margin)
+	{
+		std::vector<std::shared_ptr<Hittablef>> halves[2];
+		margin = std::max(margin, 0.01f);
+
+		for (std::size_t i = 0; i < spheres.size(); ++i)
+		{
+			halves[i % 2].push_back(spheres[i]);
+		}
+
+		DynamicBvhf nested({ std::make_shared<DynamicBvhf>(halves[0], margin),
+			std::make_shared<DynamicBvhf>(halves[1], margin) }, margin);
+		HittableListf flat(spheres);
+
+		Cameraf camera(Vec3f(13.0f, 2.0f, 3.0f), Vec3f(0.0f, 0.0f, 0.0f), Vec3f(0.0f, 1.0f, 0.0f), 20.0f, 16.0f / 9.0f);
+		std::mt19937 engine(5);
+		std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+		std::size_t nMismatches = 0;
+
+		for (int i = 0; i < nRays; ++i)
+		{
+			float u = uniform(engine);
+			float v = uniform(engine);
+			trayzy::Ray<float> ray = camera.getRay(u, v);
+			HitRecordf a;
+			HitRecordf b;
+			float tMax = std::numeric_limits<float>::max();
+			bool hitA = nested.closestHit(ray, 0.001f, tMax, a);
+			bool hitB = flat.closestHit(ray, 0.001f, tMax, b);
+
+			nMismatches += hitA != hitB || (hitA && (a.primitive != b.primitive || a.t != b.t))
+				|| nested.occluded(ray, 0.001f, tMax) != hitB ? 1 : 0;
+		}
+
+		return nMismatches;
+	}
+}
+
+namespace trayzy
+{
+	namespace bench
+	{
+		int edits(int argc, char **argv)
+		{
+			Options options(argc, argv);
+			std::size_t count = std::size_t(options.number("count", 1e6));
+			std::size_t nEdits = std::size_t(options.number("edits", 100000));
+			std::size_t nestedCount = std::size_t(options.number("nested-count", 20000));
+			int nestedRays = int(options.number("nested-rays", 2000));
+			float margin = float(options.number("margin", 0));
+
+			RenderSettings settings;
+			settings.width = int(options.number("width", 160));
+			settings.height = int(options.number("height", 90));
+			settings.samples = int(options.number("samples", 2));
+			settings.threads = int(options.number("threads", 0));
+
+			SceneArena arena;
+			std::vector<std::shared_ptr<Hittablef>> hittables = generateSphereField<float>(arena, count);
+			float halfSide = 0.5f * float(std::ceil(std::sqrt(double(count))));
+
+			Stopwatch stopwatch;
+			Bvhf rebuilt(hittables);
+			double rebuildSeconds = stopwatch.seconds();
+
+			stopwatch.restart();
+			DynamicBvhf world(hittables, margin);
+			double buildSeconds = stopwatch.seconds();
+
+			std::cout << "Incremental edits of a field of " << hittables.size() << " spheres with a leaf margin of "
+				<< margin << std::endl << std::endl << std::fixed << std::setprecision(3)
+				<< "Full rebuild of a static hierarchy: " << rebuildSeconds << " s; initial dynamic build: "
+				<< buildSeconds << " s" << std::endl << std::endl;
+
+			// Edit the small spheres, whose handles follow the ground's
+			std::mt19937 engine(11);
+			std::uniform_int_distribution<DynamicBvhf::Handle> pick(1, DynamicBvhf::Handle(count));
+			std::uniform_real_distribution<float> nudge(-0.1f, 0.1f);
+			std::uniform_real_distribution<float> anywhere(-halfSide, halfSide);
+
+			auto moved = [&](DynamicBvhf::Handle handle, const Vec3f &center)
+			{
+				auto sphere = std::static_pointer_cast<Spheref>(world.item(handle));
+				return unowned(arena.make<Spheref>(center, sphere->radius(), sphere->material()));
+			};
+
+			std::vector<Latencies> latencies = { { "nudge", {} }, { "teleport", {} }, { "insert", {} },
+				{ "remove", {} } };
+			std::vector<DynamicBvhf::Handle> inserted;
+
+			for (std::size_t i = 0; i < nEdits; ++i)
+			{
+				DynamicBvhf::Handle handle = pick(engine);
+				auto sphere = std::static_pointer_cast<Spheref>(world.item(handle));
+				Vec3f offset(nudge(engine), 0.0f, nudge(engine));
+				auto replacement = moved(handle, sphere->center() + offset);
+				stopwatch.restart();
+				world.replace(handle, replacement);
+				latencies[0].seconds.push_back(stopwatch.seconds());
+
+				handle = pick(engine);
+				replacement = moved(handle, Vec3f(anywhere(engine), 0.2f, anywhere(engine)));
+				stopwatch.restart();
+				world.replace(handle, replacement);
+				latencies[1].seconds.push_back(stopwatch.seconds());
+
+				replacement = moved(handle, Vec3f(anywhere(engine), 0.2f, anywhere(engine)));
+				stopwatch.restart();
+				inserted.push_back(world.insert(replacement));
+				latencies[2].seconds.push_back(stopwatch.seconds());
+			}
+
+			// Removing what was inserted restores the original count
+			std::shuffle(inserted.begin(), inserted.end(), engine);
+
+			for (DynamicBvhf::Handle handle : inserted)
+			{
+				stopwatch.restart();
+				world.remove(handle);
+				latencies[3].seconds.push_back(stopwatch.seconds());
+			}
+
+			std::cout << std::setw(10) << "edit" << std::setw(10) << "count" << std::setw(12) << "mean us"
+				<< std::setw(12) << "p99 us" << std::setw(12) << "max us" << std::setw(16) << "vs rebuild" << std::endl;
+
+			for (Latencies &entry : latencies)
+			{
+				std::vector<double> &seconds = entry.seconds;
+				double sum = 0;
+
+				for (double s : seconds)
+				{
+					sum += s;
+				}
+
+				double mean = sum / seconds.size();
+				std::sort(seconds.begin(), seconds.end());
+
+				std::cout << std::setw(10) << entry.name << std::setw(10) << seconds.size() << std::setprecision(2)
+					<< std::setw(12) << mean * 1e6 << std::setw(12) << seconds[seconds.size() * 99 / 100] * 1e6
+					<< std::setw(12) << seconds.back() * 1e6 << std::setw(15) << std::setprecision(0)
+					<< rebuildSeconds / mean << "x" << std::endl;
+			}
+
+			// Compare the edited tree against a fresh build over the same items
+			std::vector<std::shared_ptr<Hittablef>> current;
+
+			for (DynamicBvhf::Handle handle = 0; handle < DynamicBvhf::Handle(hittables.size()); ++handle)
+			{
+				current.push_back(world.item(handle));
+			}
+
+			DynamicBvhf fresh(current, margin);
+			Bvhf freshStatic(current);
+
+			std::cout << std::endl << std::setw(22) << "hierarchy" << std::setw(10) << "depth" << std::setw(12) << "render s" << std::endl << std::setprecision(3);
+			std::cout << std::setw(22) << "static, rebuilt" << std::setw(10) << "-"
+				<< std::setw(12) << renderSeconds(freshStatic, settings) << std::endl;
+			std::cout << std::setw(22) << "dynamic, rebuilt" << std::setw(10) << fresh.depth() << std::setw(12) << renderSeconds(fresh, settings) << std::endl;
+			std::cout << std::setw(22) << "dynamic, edited" << std::setw(10) << world.depth() << std::setw(12) << renderSeconds(world, settings) << std::endl;
+
+			// A tree of trees must find the same hits as a flat list of their spheres
+			current.resize(std::min(current.size(), nestedCount));
+			std::size_t nMismatches = nestedMismatches(current, nestedRays, margin);
+			bool passed = nMismatches == 0;
+
+			std::cout << std::endl << "Two nested trees of " << current.size() << " spheres against a list: "
+				<< nMismatches << " of " << nestedRays << " rays differ: " << (passed ? "PASS" : "FAIL") << std::endl;
+
+			return passed ? 0 : 1;
+		}
+	}
+}
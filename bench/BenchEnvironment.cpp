@@ -0,0 +1,316 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <trayzy/Bvh.h>
+#include <trayzy/Camera.h>
+#include <trayzy/EnvironmentLight.h>
+#include <trayzy/Image.h>
+#include <trayzy/Integrator.h>
+#include <trayzy/PathIntegrator.h>
+#include <trayzy/PathTracer.h>
+#include <trayzy/Renderer.h>
+#include <trayzy/SceneArena.h>
+#include <trayzy/SceneGenerator.h>
+
+#include "Bench.h"
+
+using Bvhf = trayzy::Bvh<float>;
+using Cameraf = trayzy::Camera<float>;
+using EnvironmentLightf = trayzy::EnvironmentLight<float>;
+using Imagef = trayzy::Image<float>;
+using Integratorf = trayzy::Integrator<float>;
+using PathIntegratorf = trayzy::PathIntegrator<float>;
+using Rendererf = trayzy::Renderer<float>;
+using Vec3f = trayzy::Vec3<float>;
+
+namespace
+{
+	/// Finds the environment only by scattering, as the sky gradient is found
+	class EscapeIntegrator : public Integratorf
+	{
+	public:
+		explicit EscapeIntegrator(std::shared_ptr<const EnvironmentLightf> environment) :
+			mEnvironment(std::move(environment))
+		{
+			// Do nothing more
+		}
+
+		// Integrator::radiance
+		virtual Vec3f radiance(const trayzy::Ray<float> &ray, const trayzy::Hittable<float> &world) const override
+		{
+			return trace(ray, world, 0);
+		}
+
+	private:
+		Vec3f trace(const trayzy::Ray<float> &ray, const trayzy::Hittable<float> &world, int depth) const
+		{
+			trayzy::Intersection<float> intersection;
+
+			if (!world.hit(ray, 0.001f, std::numeric_limits<float>::max(), intersection))
+			{
+				return mEnvironment->radiance(ray.direction());
+			}
+
+			trayzy::Ray<float> scattered;
+			Vec3f attenuation;
+			Vec3f c = trayzy::emitted(world, intersection);
+
+			if (depth < 50 && trayzy::scatter(world, ray, intersection, attenuation, scattered))
+			{
+				c += attenuation * trace(scattered, world, depth + 1);
+			}
+
+			return c;
+		}
+
+	private:
+		std::shared_ptr<const EnvironmentLightf> mEnvironment;
+	};
+
+	/// Returns a sky with a small sun, whose direct light outweighs the rest of the sky
+	Imagef makeSunnySky(int width, int height, float sunRadiance, float sunDegrees)
+	{
+		Imagef image(width, height);
+		Vec3f toSun = trayzy::unitVector(Vec3f(1.0f, 0.8f, 0.6f));
+		float cosSun = std::cos(sunDegrees * float(M_PI) / 180);
+
+		for (int row = 0; row < height; ++row)
+		{
+			for (int col = 0; col < width; ++col)
+			{
+				// The direction through the texel's center, laid out as EnvironmentLight expects
+				float phi = 2 * float(M_PI) * (col + 0.5f) / width - float(M_PI);
+				float theta = float(M_PI) * (row + 0.5f) / height;
+				Vec3f d(-std::sin(theta) * std::cos(phi), -std::cos(theta), -std::sin(theta) * std::sin(phi));
+
+				float up = std::max(0.0f, d[trayzy::Y]);
+				Vec3f c = d[trayzy::Y] < 0 ? Vec3f(0.15f, 0.13f, 0.1f)
+					: (1 - up) * Vec3f(0.8f, 0.85f, 0.9f) + up * Vec3f(0.25f, 0.4f, 0.8f);
+
+				image.at(col, row) = dot(d, toSun) > cosSun ? Vec3f(sunRadiance, sunRadiance * 0.9f, sunRadiance * 0.8f)
+					: c;
+			}
+		}
+
+		return image;
+	}
+
+	/// Returns the luminance integrated over the sphere of directions, summed texel by texel
+	double integrateLuminance(const Imagef &image)
+	{
+		double sum = 0;
+
+		for (int row = 0; row < image.height(); ++row)
+		{
+			// The solid angle of a texel in this row
+			double theta0 = M_PI * row / image.height();
+			double theta1 = M_PI * (row + 1) / image.height();
+			double solidAngle = 2 * M_PI / image.width() * (std::cos(theta0) - std::cos(theta1));
+
+			for (int col = 0; col < image.width(); ++col)
+			{
+				const Vec3f &c = image.at(col, row);
+				sum += (0.2126 * c[trayzy::R] + 0.7152 * c[trayzy::G] + 0.0722 * c[trayzy::B]) * solidAngle;
+			}
+		}
+
+		return sum;
+	}
+
+	/// Returns an image whose pixels average square blocks of another's
+	Imagef blockMeans(const Imagef &image, int blockSize)
+	{
+		Imagef means(image.width() / blockSize, image.height() / blockSize);
+
+		for (int row = 0; row < means.height() * blockSize; ++row)
+		{
+			for (int col = 0; col < means.width() * blockSize; ++col)
+			{
+				means.at(col / blockSize, row / blockSize) += image.at(col, row) / float(blockSize * blockSize);
+			}
+		}
+
+		return means;
+	}
+
+	/// Returns the mean of the components of an image's pixels
+	double meanBrightness(const Imagef &image)
+	{
+		double sum = 0;
+
+		for (int row = 0; row < image.height(); ++row)
+		{
+			for (int col = 0; col < image.width(); ++col)
+			{
+				const Vec3f &c = image.at(col, row);
+				sum += c[trayzy::R] + c[trayzy::G] + c[trayzy::B];
+			}
+		}
+
+		return sum / (3.0 * image.width() * image.height());
+	}
+}
+
+namespace trayzy
+{
+	namespace bench
+	{
+		int environment(int argc, char **argv)
+		{
+			Options options(argc, argv);
+			int mapWidth = int(options.number("map-width", 1024));
+			int mapHeight = mapWidth / 2;
+			std::size_t count = std::size_t(options.number("count", 200));
+			std::size_t nSamples = std::size_t(options.number("directions", 1 << 20));
+			int referenceSamples = int(options.number("reference", 256));
+			int blockSize = int(options.number("block", 10));
+			std::string environmentPath = options.string("environment", "");
+
+			RenderSettings settings;
+			settings.width = int(options.number("width", 160));
+			settings.height = int(options.number("height", 90));
+			settings.samples = int(options.number("samples", 16));
+			settings.threads = int(options.number("threads", 0));
+
+			// Read a map if provided, or else make a sunny sky and check it survives a round trip
+			Imagef image;
+			bool roundTrip = true;
+
+			if (!environmentPath.empty())
+			{
+				std::ifstream in(environmentPath, std::ios::binary);
+				image = Imagef::readPfm(in);
+			}
+			else
+			{
+				image = makeSunnySky(mapWidth, mapHeight, float(options.number("sun", 5000)), 1.0f);
+				std::stringstream stream;
+				image.writePfm(stream);
+				Imagef copy = Imagef::readPfm(stream);
+
+				for (std::size_t i = 0; i < image.pixels().size(); ++i)
+				{
+					for (int c = R; c <= B; ++c)
+					{
+						roundTrip = roundTrip && copy.pixels()[i][c] == image.pixels()[i][c];
+					}
+				}
+			}
+
+			if (options.flag("write-environment"))
+			{
+				std::ofstream out("environment.pfm", std::ios::binary);
+				image.writePfm(out);
+				std::cout << "Environment map written to environment.pfm" << std::endl;
+			}
+
+			Stopwatch stopwatch;
+			auto environment = std::make_shared<EnvironmentLightf>(image);
+			double buildSeconds = stopwatch.seconds();
+
+			// Time sampling alone, on random numbers drawn beforehand
+			std::mt19937 engine(1);
+			std::uniform_real_distribution<float> uniform(0.0f, std::nextafter(1.0f, 0.0f));
+			std::vector<float> uniforms(4 * nSamples);
+			std::vector<Vec3f> directions(nSamples);
+			std::vector<Vec3f> radiances(nSamples);
+			std::vector<float> pdfs(nSamples);
+
+			for (float &u : uniforms)
+			{
+				u = uniform(engine);
+			}
+
+			stopwatch.restart();
+
+			for (std::size_t i = 0; i < nSamples; ++i)
+			{
+				radiances[i] = environment->sample(uniforms[4 * i], uniforms[4 * i + 1], uniforms[4 * i + 2],
+					uniforms[4 * i + 3], directions[i], pdfs[i]);
+			}
+
+			doNotOptimize(radiances.data());
+			double sampleSeconds = stopwatch.seconds();
+
+			// Sampling in proportion to luminance makes luminance / pdf constant, and its mean must
+			// match the integral of the map whatever the distribution
+			double sum = 0;
+			std::size_t nMismatched = 0;
+
+			for (std::size_t i = 0; i < nSamples; ++i)
+			{
+				const Vec3f &c = radiances[i];
+
+				if (pdfs[i] > 0)
+				{
+					sum += (0.2126 * c[R] + 0.7152 * c[G] + 0.0722 * c[B]) / pdfs[i];
+					nMismatched += std::abs(environment->pdf(directions[i]) - pdfs[i]) > 1e-3f * pdfs[i] ? 1 : 0;
+				}
+			}
+
+			double expected = integrateLuminance(image);
+			double estimate = sum / double(nSamples);
+			double integralError = std::abs(estimate - expected) / expected;
+
+			// A direction within rounding of a texel's edge can map back to its neighbour
+			bool densityAgrees = nMismatched <= nSamples / 10000;
+
+			std::cout << "Environment map " << image.width() << "x" << image.height() << ": alias table built in "
+				<< std::fixed << std::setprecision(3) << buildSeconds * 1000 << " ms, "
+				<< 1e9 * sampleSeconds / double(nSamples) << " ns per sample" << std::endl
+				<< "Integrated luminance " << expected << ", estimated from " << nSamples << " samples " << estimate
+				<< " (" << std::setprecision(4) << 100 * integralError << "% off); " << nMismatched
+				<< " samples whose density disagrees with pdf()" << std::endl << std::endl;
+
+			SceneArena arena;
+			Bvhf world(generateSphereField<float>(arena, count));
+			Cameraf camera(Vec3f(13.0f, 2.0f, 3.0f), Vec3f(0.0f, 0.0f, 0.0f), Vec3f(0.0f, 1.0f, 0.0f), 20.0f,
+				float(settings.width) / settings.height);
+
+			auto mis = std::make_shared<PathIntegratorf>(nullptr, environment);
+			auto escape = std::make_shared<EscapeIntegrator>(environment);
+
+			// Render the reference by scattering alone, so that a bias in sampling the map cannot
+			// agree with itself. It finds the sun too rarely to converge pixel by pixel, so compare
+			// the means of blocks of pixels, and the mean of the whole image
+			RenderSettings referenceSettings = settings;
+			referenceSettings.samples = referenceSamples;
+			referenceSettings.seed = 1u << 20;
+			Imagef reference = Rendererf(referenceSettings, escape).render(world, camera);
+			Imagef referenceBlocks = blockMeans(reference, blockSize);
+
+			stopwatch.restart();
+			Imagef misImage = Rendererf(settings, mis).render(world, camera);
+			double misSeconds = stopwatch.seconds();
+
+			stopwatch.restart();
+			Imagef escapeImage = Rendererf(settings, escape).render(world, camera);
+			double escapeSeconds = stopwatch.seconds();
+
+			float misError = rmse(blockMeans(misImage, blockSize), referenceBlocks);
+			float escapeError = rmse(blockMeans(escapeImage, blockSize), referenceBlocks);
+			double meanError = std::abs(meanBrightness(misImage) / meanBrightness(reference) - 1);
+			bool passed = roundTrip && integralError < 0.01 && densityAgrees && misError < escapeError
+				&& meanError < 0.05;
+
+			std::cout << "At " << settings.samples << " samples per pixel against scattering only at "
+				<< referenceSamples << ", over blocks of " << blockSize << " pixels:" << std::endl << std::setw(26)
+				<< "scattering only: RMSE " << std::setprecision(3) << escapeError << " in " << escapeSeconds << " s"
+				<< std::endl << std::setw(26) << "MIS: RMSE " << misError << " in " << misSeconds << " s, mean "
+				<< std::setprecision(2) << 100 * meanError << "% off" << std::endl << "Float map round trip "
+				<< (roundTrip ? "exact" : "differs") << ": " << (passed ? "PASS" : "FAIL") << std::endl;
+
+			return passed ? 0 : 1;
+		}
+	}
+}
@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <trayzy/Bvh.h>
+#include <trayzy/Camera.h>
+#include <trayzy/FastMath.h>
+#include <trayzy/Image.h>
+#include <trayzy/Renderer.h>
+#include <trayzy/SceneArena.h>
+#include <trayzy/SceneGenerator.h>
+
+#include "Bench.h"
+
+using Bvhf = trayzy::Bvh<float>;
+using Cameraf = trayzy::Camera<float>;
+using Imagef = trayzy::Image<float>;
+using Rendererf = trayzy::Renderer<float>;
+using Vec3f = trayzy::Vec3<float>;
+
+namespace
+{
+	/// Returns the number of representable values between two finite values of the same sign
+	template<typename T>
+	std::uint64_t ulpDistance(T a, T b)
+	{
+		using Bits = typename std::conditional<sizeof(T) == 4, std::int32_t, std::int64_t>::type;
+		Bits x, y;
+		std::memcpy(&x, &a, sizeof(a));
+		std::memcpy(&y, &b, sizeof(b));
+
+		// Map the sign-magnitude layout onto a monotonic integer line
+		x = x < 0 ? std::numeric_limits<Bits>::min() - x : x;
+		y = y < 0 ? std::numeric_limits<Bits>::min() - y : y;
+		return x > y ? std::uint64_t(x) - std::uint64_t(y) : std::uint64_t(y) - std::uint64_t(x);
+	}
+
+	/**
+	 * Measures the error and speed of a fast kernel against its standard library counterpart.
+	 *
+	 * @return The largest error in units in the last place
+	 */
+	template<typename T, typename Exact, typename Fast>
+	std::uint64_t compareKernel(const char *type, const char *kernel, const std::vector<T> &inputs, Exact exact,
+		Fast fast, int repeats)
+	{
+		std::uint64_t maxUlps = 0;
+		double sumUlps = 0;
+
+		for (T x : inputs)
+		{
+			std::uint64_t ulps = ulpDistance(fast(x), exact(x));
+			maxUlps = std::max(maxUlps, ulps);
+			sumUlps += double(ulps);
+		}
+
+		std::vector<T> outputs(inputs.size());
+
+		auto time = [&](auto function)
+		{
+			trayzy::bench::Stopwatch stopwatch;
+
+			for (int r = 0; r < repeats; ++r)
+			{
+				for (std::size_t i = 0; i < inputs.size(); ++i)
+				{
+					outputs[i] = function(inputs[i]);
+				}
+
+				trayzy::bench::doNotOptimize(outputs.data());
+			}
+
+			return 1e9 * stopwatch.seconds() / (double(repeats) * inputs.size());
+		};
+
+		double exactNs = time(exact);
+		double fastNs = time(fast);
+
+		std::cout << std::fixed << std::setw(8) << type << std::setw(8) << kernel << std::setw(10) << maxUlps
+			<< std::setw(12) << std::setprecision(3) << sumUlps / inputs.size() << std::setw(12) << exactNs
+			<< std::setw(10) << fastNs << std::setw(10) << std::setprecision(2) << exactNs / fastNs << "x"
+			<< std::endl;
+
+		return maxUlps;
+	}
+
+	/**
+	 * Compares every fast kernel of a type on inputs from the ranges the renderer calls them with.
+	 *
+	 * @return Whether every kernel stays within the error FastMath documents for it
+	 */
+	template<typename T>
+	bool compareKernels(const char *type, std::size_t count, int repeats)
+	{
+		using Fast = trayzy::FastMath<T>;
+
+		std::mt19937 engine(1);
+		std::uniform_real_distribution<double> exponent(-20, 20);
+		std::uniform_real_distribution<double> unit(0, 1);
+		std::vector<T> wide(count);
+		std::vector<T> fractions(count);
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			wide[i] = T(std::exp2(exponent(engine)));
+			fractions[i] = std::max(T(unit(engine)), std::numeric_limits<T>::min());
+		}
+
+		// Only the float reciprocal square root is approximated; double falls back to the exact one
+		std::uint64_t rsqrtBound = std::is_same<T, float>::value ? 5 : 0;
+
+		bool sqrtPassed = compareKernel<T>(type, "sqrt", wide, [](T x) { return std::sqrt(x); },
+			[](T x) { return Fast::sqrt(x); }, repeats) == 0;
+		bool rsqrtPassed = compareKernel<T>(type, "rsqrt", wide, [](T x) { return 1 / std::sqrt(x); },
+			[](T x) { return Fast::rsqrt(x); }, repeats) <= rsqrtBound;
+		bool pow5Passed = compareKernel<T>(type, "pow5", fractions, [](T x) { return T(std::pow(x, 5)); },
+			[](T x) { return Fast::pow5(x); }, repeats) <= 3;
+
+		return sqrtPassed && rsqrtPassed && pow5Passed;
+	}
+}
+
+namespace trayzy
+{
+	namespace bench
+	{
+		int fastMath(int argc, char **argv)
+		{
+			Options options(argc, argv);
+			std::size_t count = std::size_t(options.number("count", 1 << 20));
+			int repeats = int(options.number("repeats", 20));
+			std::string referencePath = options.string("reference", TRAYZY_BENCH_GOLDEN_DIR "/sphere-field-64spp.ppm");
+
+			std::cout << "Fast math kernels against the standard library over " << count << " inputs" << std::endl
+				<< "float instantiations use " << (Math<float>::fast ? "FastMath" : "ExactMath")
+				<< " in this build (TRAYZY_FAST_MATH)" << std::endl << std::endl;
+			std::cout << std::setw(8) << "type" << std::setw(8) << "kernel" << std::setw(10) << "max ulp"
+				<< std::setw(12) << "mean ulp" << std::setw(12) << "std ns" << std::setw(10) << "fast ns"
+				<< std::setw(11) << "speedup" << std::endl;
+
+			bool floatPassed = compareKernels<float>("float", count, repeats);
+			bool doublePassed = compareKernels<double>("double", count, repeats);
+			bool kernelsPassed = floatPassed && doublePassed;
+
+			std::cout << std::endl << "Every kernel within its documented error: " << (kernelsPassed ? "PASS" : "FAIL")
+				<< std::endl;
+
+			// Noise hides any bias at 16 samples per pixel, so compare converged renders against
+			// one made with the exact kernels, next to the noise between two seeds
+			RenderSettings settings;
+			settings.width = 160;
+			settings.height = 90;
+			settings.samples = int(options.number("samples", 64));
+			settings.threads = int(options.number("threads", 0));
+
+			SceneArena arena;
+			Bvhf world(generateSphereField<float>(arena, 1000));
+			Cameraf camera(Vec3f(13.0f, 2.0f, 3.0f), Vec3f(0.0f, 0.0f, 0.0f), Vec3f(0.0f, 1.0f, 0.0f), 20.0f,
+				float(settings.width) / settings.height, 0.1f, 10.0f);
+
+			Stopwatch stopwatch;
+			Imagef image = Rendererf(settings).render(world, camera);
+			double seconds = stopwatch.seconds();
+
+			std::cout << std::endl << "Render of 1000 spheres at " << settings.samples << " samples per pixel: "
+				<< std::setprecision(3) << seconds << " s" << std::endl;
+
+			if (options.flag("write-reference"))
+			{
+				if (Math<float>::fast)
+				{
+					std::cout << "The reference must come from a build without TRAYZY_FAST_MATH" << std::endl;
+					return 1;
+				}
+
+				std::ofstream out(referencePath, std::ios::binary);
+				image.writePpm(out, true);
+				std::cout << "Reference image written to " << referencePath << std::endl;
+				return out ? 0 : 1;
+			}
+
+			std::ifstream in(referencePath, std::ios::binary);
+
+			if (!in)
+			{
+				std::cout << "Reference image " << referencePath << " is missing; create it with --write-reference"
+					<< std::endl;
+				return 1;
+			}
+
+			Imagef reference = Imagef::readPpm(in);
+			RenderSettings otherSeed = settings;
+			otherSeed.seed = settings.seed + 1;
+			float noise = rmse(Rendererf(otherSeed).render(world, camera), reference);
+			float error = rmse(image, reference);
+			bool renderPassed = error <= 1.25f * noise;
+
+			std::cout << "RMSE against the exact reference " << error << ", between seeds " << noise << ": "
+				<< (renderPassed ? "PASS" : "FAIL") << std::endl;
+
+			return kernelsPassed && renderPassed ? 0 : 1;
+		}
+	}
+}
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <trayzy/Bvh.h>
+#include <trayzy/Camera.h>
+#include <trayzy/HitRecord.h>
+#include <trayzy/HybridRenderer.h>
+#include <trayzy/Image.h>
+#include <trayzy/Random.h>
+#include <trayzy/RayBatch.h>
+#include <trayzy/Renderer.h>
+#include <trayzy/SceneArena.h>
+#include <trayzy/SceneGenerator.h>
+#include <trayzy/SphereRasterizer.h>
+#include <trayzy/ThreadPool.h>
+
+#include "Bench.h"
+
+using Bvhf = trayzy::Bvh<float>;
+using Cameraf = trayzy::Camera<float>;
+using HitRecordf = trayzy::HitRecord<float>;
+using HybridRendererf = trayzy::HybridRenderer<float>;
+using Imagef = trayzy::Image<float>;
+using RayBatchf = trayzy::RayBatch<float>;
+using Rendererf = trayzy::Renderer<float>;
+using SphereRasterizerf = trayzy::SphereRasterizer<float>;
+using Vec3f = trayzy::Vec3<float>;
+
+namespace
+{
+	/// Returns the largest difference between the components of two images within a tile
+	float maxDifference(const Imagef &a, const Imagef &b, const trayzy::Tile &tile)
+	{
+		float difference = 0;
+
+		for (int row = tile.y0; row < tile.y0 + tile.height; ++row)
+		{
+			for (int col = tile.x0; col < tile.x0 + tile.width; ++col)
+			{
+				for (int c : { trayzy::R, trayzy::G, trayzy::B })
+				{
+					difference = std::max(difference, std::abs(a.at(col, row)[c] - b.at(col, row)[c]));
+				}
+			}
+		}
+
+		return difference;
+	}
+}
+
+namespace trayzy
+{
+	namespace bench
+	{
+		int hybrid(int argc, char **argv)
+		{
+			Options options(argc, argv);
+			std::size_t count = std::size_t(options.number("count", 100000));
+			int repeats = int(options.number("repeats", 5));
+
+			RenderSettings settings;
+			settings.width = int(options.number("width", 320));
+			settings.height = int(options.number("height", 180));
+			settings.samples = int(options.number("samples", 8));
+			settings.threads = int(options.number("threads", 0));
+
+			SceneArena arena;
+			std::vector<std::shared_ptr<Hittable<float>>> hittables = generateSphereField<float>(arena, count);
+			Bvhf world(hittables);
+			SphereRasterizerf rasterizer(hittables);
+			Cameraf camera(Vec3f(13.0f, 2.0f, 3.0f), Vec3f(0.0f, 0.0f, 0.0f), Vec3f(0.0f, 1.0f, 0.0f), 20.0f,
+				float(settings.width) / settings.height);
+
+			Rendererf renderer(settings);
+			HybridRendererf hybridRenderer(settings);
+			ThreadPool pool(renderer.threadCount());
+			std::vector<Tile> tiles = renderer.tiles();
+			std::size_t nRays = std::size_t(settings.width) * settings.height * settings.samples;
+
+			std::cout << "Primary visibility of " << rasterizer.size() << " spheres, " << settings.width << "x"
+				<< settings.height << " at " << settings.samples << " samples per pixel on " << pool.size()
+				<< " threads" << std::endl << std::endl;
+
+			// Find the closest hit of every camera ray both ways, keeping the hits of the last repeat
+			std::vector<std::vector<HitRecordf>> traced(tiles.size());
+			std::vector<std::vector<HitRecordf>> rasterized(tiles.size());
+			double traceSeconds = std::numeric_limits<double>::max();
+			double rasterSeconds = std::numeric_limits<double>::max();
+
+			for (int r = 0; r < repeats; ++r)
+			{
+				Stopwatch stopwatch;
+
+				parallelFor(pool, tiles.size(), [&](std::size_t i)
+				{
+					RayBatchf rays;
+					seedRandomEngine(Rendererf::tileSeed(settings.seed, tiles[i].index));
+					camera.getRays(tiles[i].x0, tiles[i].y0, tiles[i].width, tiles[i].height, settings.width,
+						settings.height, settings.samples, rays);
+					traced[i].assign(rays.size(), HitRecordf());
+
+					for (std::size_t k = 0; k < rays.size(); ++k)
+					{
+						world.closestHit(rays.ray(k), 0.001f, std::numeric_limits<float>::max(), traced[i][k]);
+					}
+				});
+
+				traceSeconds = std::min(traceSeconds, stopwatch.seconds());
+				stopwatch.restart();
+
+				SphereRasterizerf::Bins bins = rasterizer.bin(pool, camera, settings);
+
+				parallelFor(pool, tiles.size(), [&](std::size_t i)
+				{
+					RayBatchf rays;
+					seedRandomEngine(Rendererf::tileSeed(settings.seed, tiles[i].index));
+					camera.getRays(tiles[i].x0, tiles[i].y0, tiles[i].width, tiles[i].height, settings.width,
+						settings.height, settings.samples, rays);
+					rasterizer.rasterize(bins, tiles[i], settings.samples, rays, rasterized[i]);
+				});
+
+				rasterSeconds = std::min(rasterSeconds, stopwatch.seconds());
+			}
+
+			// The hierarchy's box tests lose a few rays that graze far spheres, where the rasterizer
+			// finds the hit that testing every sphere does, so only nearer rasterized hits may differ
+			std::size_t nHits = 0;
+			std::size_t nNearer = 0;
+			std::size_t nMismatched = 0;
+			std::vector<bool> tileDiffers(tiles.size(), false);
+
+			for (std::size_t i = 0; i < tiles.size(); ++i)
+			{
+				for (std::size_t k = 0; k < traced[i].size(); ++k)
+				{
+					const HitRecordf &a = traced[i][k];
+					const HitRecordf &b = rasterized[i][k];
+					nHits += a.primitive ? 1 : 0;
+
+					if (a.primitive == b.primitive && (!a.primitive || a.t == b.t))
+					{
+						continue;
+					}
+
+					tileDiffers[i] = true;
+					bool nearer = b.primitive && (!a.primitive || b.t < a.t);
+					nNearer += nearer ? 1 : 0;
+					nMismatched += nearer ? 0 : 1;
+				}
+			}
+
+			std::cout << std::fixed << std::setprecision(3) << "Traced camera rays:     " << traceSeconds * 1000
+				<< " ms" << std::endl << "Rasterized G-buffer:    " << rasterSeconds * 1000 << " ms ("
+				<< std::setprecision(2) << traceSeconds / rasterSeconds << "x)" << std::endl
+				<< "Rays that hit the scene " << nHits << " of " << nRays << "; rasterized hits nearer than traced "
+				<< nNearer << ", otherwise differing " << nMismatched << std::endl << std::endl;
+
+			// Then render the frame both ways; a differing hit changes the random sequence of the
+			// rest of its tile, but every other tile must agree to the last bit
+			Stopwatch stopwatch;
+			Imagef tracedImage = renderer.render(world, camera);
+			double tracedFrame = stopwatch.seconds();
+
+			stopwatch.restart();
+			Imagef hybridImage = hybridRenderer.render(pool, world, rasterizer, camera);
+			double hybridFrame = stopwatch.seconds();
+
+			std::size_t nDifferingTiles = 0;
+			float difference = 0;
+
+			for (std::size_t i = 0; i < tiles.size(); ++i)
+			{
+				if (tileDiffers[i])
+				{
+					++nDifferingTiles;
+				}
+				else
+				{
+					difference = std::max(difference, maxDifference(tracedImage, hybridImage, tiles[i]));
+				}
+			}
+
+			bool passed = nMismatched == 0 && difference == 0;
+
+			std::cout << std::setprecision(3) << "Ray traced frame:       " << tracedFrame << " s" << std::endl
+				<< "Hybrid frame:           " << hybridFrame << " s (" << std::setprecision(2)
+				<< tracedFrame / hybridFrame << "x)" << std::endl << "RMSE " << std::setprecision(6)
+				<< rmse(tracedImage, hybridImage) << "; largest difference outside the " << nDifferingTiles
+				<< " tiles with differing hits " << difference << ": " << (passed ? "PASS" : "FAIL") << std::endl;
+
+			return passed ? 0 : 1;
+		}
+	}
+}
@@ -0,0 +1,104 @@
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <trayzy/AlbedoIntegrator.h>
+#include <trayzy/AmbientOcclusionIntegrator.h>
+#include <trayzy/Bvh.h>
+#include <trayzy/Camera.h>
+#include <trayzy/DepthIntegrator.h>
+#include <trayzy/DirectLightingIntegrator.h>
+#include <trayzy/Image.h>
+#include <trayzy/NormalIntegrator.h>
+#include <trayzy/PathIntegrator.h>
+#include <trayzy/Renderer.h>
+#include <trayzy/SceneArena.h>
+#include <trayzy/SceneGenerator.h>
+
+#include "Bench.h"
+
+using AlbedoIntegratorf = trayzy::AlbedoIntegrator<float>;
+using AmbientOcclusionIntegratorf = trayzy::AmbientOcclusionIntegrator<float>;
+using Bvhf = trayzy::Bvh<float>;
+using Cameraf = trayzy::Camera<float>;
+using DepthIntegratorf = trayzy::DepthIntegrator<float>;
+using DirectLightingIntegratorf = trayzy::DirectLightingIntegrator<float>;
+using Imagef = trayzy::Image<float>;
+using Integratorf = trayzy::Integrator<float>;
+using NormalIntegratorf = trayzy::NormalIntegrator<float>;
+using PathIntegratorf = trayzy::PathIntegrator<float>;
+using Rendererf = trayzy::Renderer<float>;
+using Vec3f = trayzy::Vec3<float>;
+
+namespace trayzy
+{
+	namespace bench
+	{
+		int integrators(int argc, char **argv)
+		{
+			Options options(argc, argv);
+
+			RenderSettings settings;
+			settings.width = int(options.number("width", 320));
+			settings.height = int(options.number("height", 180));
+			settings.samples = int(options.number("samples", 16));
+			settings.threads = int(options.number("threads", 0));
+
+			SceneArena arena;
+			Bvhf world(generateSphereField<float>(arena, std::size_t(options.number("count", 10000))));
+			Cameraf camera(Vec3f(13.0f, 2.0f, 3.0f), Vec3f(0.0f, 0.0f, 0.0f), Vec3f(0.0f, 1.0f, 0.0f), 20.0f,
+				float(settings.width) / settings.height, 0.1f, 10.0f);
+
+			struct Entry
+			{
+				std::string name;
+				std::shared_ptr<const Integratorf> integrator;
+				int samples;
+			};
+
+			// Previews need far fewer samples, so each runs at the count it would be used at
+			std::vector<Entry> entries = {
+				{ "path", std::make_shared<PathIntegratorf>(), settings.samples },
+				{ "direct", std::make_shared<DirectLightingIntegratorf>(), settings.samples },
+				{ "ao", std::make_shared<AmbientOcclusionIntegratorf>(4, 1.0f), 4 },
+				{ "albedo", std::make_shared<AlbedoIntegratorf>(), 1 },
+				{ "normals", std::make_shared<NormalIntegratorf>(), 1 },
+				{ "depth", std::make_shared<DepthIntegratorf>(30.0f), 1 },
+			};
+
+			std::cout << "Integrators on the same scene and renderer, " << settings.width << "x" << settings.height
+				<< " on " << Rendererf(settings).threadCount() << " threads" << std::endl << std::endl;
+			std::cout << std::setw(10) << "integrator" << std::setw(8) << "spp" << std::setw(12) << "render s"
+				<< std::setw(14) << "Msamples/s" << std::setw(14) << "vs path" << std::endl;
+
+			double pathSeconds = 0;
+
+			for (const Entry &entry : entries)
+			{
+				RenderSettings entrySettings = settings;
+				entrySettings.samples = entry.samples;
+
+				Stopwatch stopwatch;
+				Imagef image = Rendererf(entrySettings, entry.integrator).render(world, camera);
+				double seconds = stopwatch.seconds();
+				pathSeconds = pathSeconds > 0 ? pathSeconds : seconds;
+
+				std::cout << std::fixed << std::setprecision(3) << std::setw(10) << entry.name << std::setw(8)
+					<< entry.samples << std::setw(12) << seconds << std::setw(14)
+					<< double(settings.width) * settings.height * entry.samples / seconds * 1e-6
+					<< std::setw(13) << std::setprecision(1) << pathSeconds / seconds << "x" << std::endl;
+
+				if (options.flag("write-images"))
+				{
+					std::ofstream out("integrator-" + entry.name + ".ppm", std::ios::binary);
+					image.writePpm(out, true);
+				}
+			}
+
+			return 0;
+		}
+	}
+}
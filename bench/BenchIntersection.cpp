@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <trayzy/HittableList.h>
+#include <trayzy/Lambertian.h>
+#include <trayzy/Random.h>
+#include <trayzy/Sphere.h>
+
+#include "Bench.h"
+
+using HittableListf = trayzy::HittableList<float>;
+using Intersectionf = trayzy::Intersection<float>;
+using Lambertianf = trayzy::Lambertian<float>;
+using Rayf = trayzy::Ray<float>;
+using Spheref = trayzy::Sphere<float>;
+using Vec3f = trayzy::Vec3<float>;
+
+namespace
+{
+	/// Returns a uniformly distributed point in the cube of the provided half-width
+	Vec3f randomInCube(float halfWidth)
+	{
+		return halfWidth * (2.0f * Vec3f(trayzy::randomUniform<float>(), trayzy::randomUniform<float>(),
+			trayzy::randomUniform<float>()) - Vec3f(1.0f, 1.0f, 1.0f));
+	}
+}
+
+namespace trayzy
+{
+	namespace bench
+	{
+		int intersection(int argc, char **argv)
+		{
+			int nRays = argc > 0 ? std::atoi(argv[0]) : 20000;
+			float halfWidth = 10.0f;
+			auto material = std::make_shared<Lambertianf>(Vec3f(0.5f, 0.5f, 0.5f));
+
+			std::cout << "Eager versus deferred hit attributes, " << nRays
+				<< " rays through a cube of random spheres" << std::endl << std::endl;
+			std::cout << std::setw(10) << "spheres" << std::setw(14) << "eager ns" << std::setw(14) << "deferred ns"
+				<< std::setw(12) << "speedup" << std::setw(16) << "evals/ray" << std::setw(14) << "evals saved" << std::endl;
+
+			for (int nSpheres : { 10, 100, 1000, 10000 })
+			{
+				trayzy::seedRandomEngine(nSpheres);
+
+				// Keep the expected number of spheres along a ray roughly constant in density
+				float radius = halfWidth / std::cbrt(float(nSpheres));
+				std::vector<std::shared_ptr<Spheref>> spheres;
+				HittableListf world;
+
+				for (int i = 0; i < nSpheres; ++i)
+				{
+					spheres.push_back(std::make_shared<Spheref>(randomInCube(halfWidth), radius, material));
+					world.insert(spheres.back());
+				}
+
+				std::vector<Rayf> rays;
+
+				for (int i = 0; i < nRays; ++i)
+				{
+					Vec3f origin = 3.0f * halfWidth * trayzy::unitVector(randomInCube(1.0f));
+					rays.emplace_back(origin, randomInCube(halfWidth) - origin);
+				}
+
+				// Eager evaluation fills every candidate's attributes, as hit() per primitive does
+				Intersectionf intersection;
+				std::size_t nEvaluations = 0;
+				Stopwatch stopwatch;
+
+				for (const Rayf &ray : rays)
+				{
+					float tClosest = 1e30f;
+
+					for (const auto &sphere : spheres)
+					{
+						if (sphere->hit(ray, 0.001f, tClosest, intersection))
+						{
+							tClosest = intersection.t;
+							++nEvaluations;
+						}
+					}
+
+					doNotOptimize(intersection.normal);
+				}
+
+				double eagerNs = stopwatch.seconds() * 1e9 / nRays;
+				std::size_t nHits = 0;
+				stopwatch.restart();
+
+				for (const Rayf &ray : rays)
+				{
+					if (world.hit(ray, 0.001f, 1e30f, intersection))
+					{
+						++nHits;
+					}
+
+					doNotOptimize(intersection.normal);
+				}
+
+				double deferredNs = stopwatch.seconds() * 1e9 / nRays;
+
+				std::cout << std::fixed << std::setprecision(2) << std::setw(10) << nSpheres
+					<< std::setw(14) << eagerNs << std::setw(14) << deferredNs << std::setw(12) << eagerNs / deferredNs
+					<< std::setw(16) << double(nEvaluations) / nRays
+					<< std::setw(13) << 100.0 * (nEvaluations - nHits) / std::max<std::size_t>(nEvaluations, 1) << "%" << std::endl;
+			}
+
+			return 0;
+		}
+	}
+}
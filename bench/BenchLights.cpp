@@ -0,0 +1,127 @@
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <trayzy/Bvh.h>
+#include <trayzy/Camera.h>
+#include <trayzy/Image.h>
+#include <trayzy/LightBvh.h>
+#include <trayzy/PathIntegrator.h>
+#include <trayzy/Renderer.h>
+#include <trayzy/SceneArena.h>
+#include <trayzy/SceneGenerator.h>
+#include <trayzy/UniformLightSampler.h>
+
+#include "Bench.h"
+
+using Bvhf = trayzy::Bvh<float>;
+using Cameraf = trayzy::Camera<float>;
+using Imagef = trayzy::Image<float>;
+using LightBvhf = trayzy::LightBvh<float>;
+using Lightf = trayzy::Light<float>;
+using LightSamplerf = trayzy::LightSampler<float>;
+using PathIntegratorf = trayzy::PathIntegrator<float>;
+using Rendererf = trayzy::Renderer<float>;
+using UniformLightSamplerf = trayzy::UniformLightSampler<float>;
+using Vec3f = trayzy::Vec3<float>;
+
+namespace
+{
+	/// Returns the nanoseconds per light choice from random points on the ground
+	double sampleNanoseconds(const LightSamplerf &sampler)
+	{
+		std::mt19937 engine(7);
+		std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+		const int nSamples = 1000000;
+		float sum = 0;
+
+		trayzy::bench::Stopwatch stopwatch;
+
+		for (int i = 0; i < nSamples; ++i)
+		{
+			Vec3f p(20 * uniform(engine) - 10, 0, 20 * uniform(engine) - 10);
+			float probability = 0;
+			const Lightf *light = sampler.sample(p, Vec3f(0, 1, 0), uniform(engine), probability);
+			sum += light ? probability : 0;
+		}
+
+		trayzy::bench::doNotOptimize(sum);
+		return stopwatch.seconds() * 1e9 / nSamples;
+	}
+}
+
+namespace trayzy
+{
+	namespace bench
+	{
+		int lights(int argc, char **argv)
+		{
+			Options options(argc, argv);
+			double maxCount = options.number("max", 10000);
+
+			RenderSettings settings;
+			settings.width = int(options.number("width", 96));
+			settings.height = int(options.number("height", 54));
+			settings.samples = int(options.number("samples", 4));
+			settings.threads = int(options.number("threads", 0));
+
+			RenderSettings reference = settings;
+			reference.samples = int(options.number("reference-samples", 256));
+
+			Cameraf camera(Vec3f(0.0f, 9.0f, 16.0f), Vec3f(0.0f, 0.0f, 0.0f), Vec3f(0.0f, 1.0f, 0.0f), 50.0f,
+				float(settings.width) / settings.height);
+
+			std::cout << "Direct light sampling, " << settings.width << "x" << settings.height << " at "
+				<< settings.samples << " samples per pixel against " << reference.samples
+				<< " with the light hierarchy" << std::endl << std::endl;
+			std::cout << std::setw(10) << "lights" << std::setw(14) << "uniform ns" << std::setw(12) << "bvh ns"
+				<< std::setw(14) << "uniform s" << std::setw(12) << "bvh s" << std::setw(14) << "uniform RMSE"
+				<< std::setw(12) << "bvh RMSE" << std::endl;
+
+			for (double count = 10; count <= maxCount; count *= 10)
+			{
+				SceneArena arena;
+				auto hittables = generateLightField<float>(arena, std::size_t(count));
+				std::vector<Lightf> lights = findLights(hittables);
+				Bvhf world(std::move(hittables));
+
+				auto uniform = std::make_shared<UniformLightSamplerf>(lights);
+				auto hierarchy = std::make_shared<LightBvhf>(lights);
+
+				Imagef expected = Rendererf(reference, std::make_shared<PathIntegratorf>(hierarchy)).render(world, camera);
+
+				Stopwatch stopwatch;
+				Imagef uniformImage = Rendererf(settings, std::make_shared<PathIntegratorf>(uniform)).render(world, camera);
+				double uniformSeconds = stopwatch.seconds();
+
+				stopwatch.restart();
+				Imagef hierarchyImage = Rendererf(settings, std::make_shared<PathIntegratorf>(hierarchy)).render(world, camera);
+				double hierarchySeconds = stopwatch.seconds();
+
+				std::cout << std::fixed << std::setprecision(1) << std::setw(10) << lights.size()
+					<< std::setw(14) << sampleNanoseconds(*uniform) << std::setw(12) << sampleNanoseconds(*hierarchy)
+					<< std::setprecision(3) << std::setw(14) << uniformSeconds << std::setw(12) << hierarchySeconds
+					<< std::setw(14) << rmse(uniformImage, expected) << std::setw(12) << rmse(hierarchyImage, expected)
+					<< std::endl;
+
+				if (options.flag("write-images"))
+				{
+					std::string prefix = "lights-" + std::to_string(lights.size());
+					std::ofstream uniformOut(prefix + "-uniform.ppm", std::ios::binary);
+					uniformImage.writePpm(uniformOut, true);
+					std::ofstream hierarchyOut(prefix + "-bvh.ppm", std::ios::binary);
+					hierarchyImage.writePpm(hierarchyOut, true);
+					std::ofstream referenceOut(prefix + "-reference.ppm", std::ios::binary);
+					expected.writePpm(referenceOut, true);
+				}
+			}
+
+			return 0;
+		}
+	}
+}
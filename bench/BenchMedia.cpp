@@ -0,0 +1,145 @@
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <trayzy/Aabb.h>
+#include <trayzy/ConstantMedium.h>
+#include <trayzy/GridMedium.h>
+#include <trayzy/Isotropic.h>
+#include <trayzy/Random.h>
+#include <trayzy/Sphere.h>
+
+#include "Bench.h"
+
+using Aabbf = trayzy::Aabb<float>;
+using ConstantMediumf = trayzy::ConstantMedium<float>;
+using GridMediumf = trayzy::GridMedium<float>;
+using Intersectionf = trayzy::Intersection<float>;
+using Isotropicf = trayzy::Isotropic<float>;
+using Rayf = trayzy::Ray<float>;
+using Spheref = trayzy::Sphere<float>;
+using Vec3f = trayzy::Vec3<float>;
+using Vec3i = trayzy::Vec3<int>;
+
+namespace
+{
+	/// Generates rays from a surrounding shell toward the unit cube
+	std::vector<Rayf> makeRays(int nRays)
+	{
+		std::vector<Rayf> rays;
+		rays.reserve(nRays);
+		trayzy::seedRandomEngine(1);
+
+		for (int i = 0; i < nRays; ++i)
+		{
+			Vec3f origin;
+
+			do
+			{
+				origin = 2.0f * Vec3f(trayzy::randomUniform<float>(), trayzy::randomUniform<float>(),
+					trayzy::randomUniform<float>()) - Vec3f(1.0f, 1.0f, 1.0f);
+			} while (origin.magnitudeSquared() > 1.0f || origin.magnitudeSquared() < 0.01f);
+
+			origin = 3.0f * trayzy::unitVector(origin);
+			Vec3f target(trayzy::randomUniform<float>() - 0.5f, trayzy::randomUniform<float>() - 0.5f,
+				trayzy::randomUniform<float>() - 0.5f);
+			rays.emplace_back(origin, target - origin);
+		}
+
+		return rays;
+	}
+
+	/// Fills a voxel grid with a lumpy smoke ball of the provided peak density
+	std::vector<float> makeSmoke(int n, float peak)
+	{
+		std::vector<float> densities(std::size_t(n) * n * n);
+
+		for (int k = 0; k < n; ++k)
+		{
+			for (int j = 0; j < n; ++j)
+			{
+				for (int i = 0; i < n; ++i)
+				{
+					Vec3f p(2.0f * (i + 0.5f) / n - 1.0f, 2.0f * (j + 0.5f) / n - 1.0f, 2.0f * (k + 0.5f) / n - 1.0f);
+					float falloff = std::max(0.0f, 1.0f - p.magnitude());
+					float lumps = 0.5f + 0.5f * std::sin(9.0f * p[trayzy::X]) * std::sin(7.0f * p[trayzy::Y]) * std::sin(8.0f * p[trayzy::Z]);
+					densities[(std::size_t(k) * n + j) * n + i] = peak * falloff * lumps;
+				}
+			}
+		}
+
+		return densities;
+	}
+
+	/// Returns the mean nanoseconds per query and the fraction of rays that collided
+	template<typename Medium>
+	void measure(const Medium &medium, const std::vector<Rayf> &rays, double &nsPerQuery, double &hitFraction)
+	{
+		Intersectionf intersection;
+		std::size_t nHits = 0;
+		trayzy::bench::Stopwatch stopwatch;
+
+		for (const Rayf &ray : rays)
+		{
+			if (medium.hit(ray, 0.001f, 1e30f, intersection))
+			{
+				++nHits;
+				trayzy::bench::doNotOptimize(intersection.t);
+			}
+		}
+
+		nsPerQuery = stopwatch.seconds() * 1e9 / rays.size();
+		hitFraction = double(nHits) / rays.size();
+	}
+}
+
+namespace trayzy
+{
+	namespace bench
+	{
+		int media(int argc, char **argv)
+		{
+			int nRays = argc > 0 ? std::atoi(argv[0]) : 200000;
+			int resolution = 64;
+			std::vector<Rayf> rays = makeRays(nRays);
+
+			auto phase = std::make_shared<Isotropicf>(Vec3f(0.8f, 0.8f, 0.8f));
+			auto boundary = std::make_shared<Spheref>(Vec3f(0.0f, 0.0f, 0.0f), 1.0f);
+			Aabbf bounds(Vec3f(-1.0f, -1.0f, -1.0f), Vec3f(1.0f, 1.0f, 1.0f));
+
+			std::cout << "Participating media, " << nRays << " rays per measurement, "
+				<< resolution << "^3 voxel grid with 2^3, 8^3 and global majorant blocks" << std::endl << std::endl;
+			std::cout << std::setw(10) << "density"
+				<< std::setw(16) << "constant ns" << std::setw(10) << "hit %"
+				<< std::setw(16) << "grid/2 ns" << std::setw(10) << "hit %"
+				<< std::setw(16) << "grid/8 ns" << std::setw(10) << "hit %"
+				<< std::setw(16) << "global ns" << std::setw(10) << "hit %" << std::endl;
+
+			for (float density : { 0.01f, 0.1f, 1.0f, 10.0f, 100.0f, 1000.0f, 10000.0f })
+			{
+				ConstantMediumf constant(boundary, density, phase);
+				std::vector<float> smoke = makeSmoke(resolution, density);
+				GridMediumf fine(bounds, Vec3i(resolution, resolution, resolution), smoke, phase, 2);
+				GridMediumf coarse(bounds, Vec3i(resolution, resolution, resolution), smoke, phase, 8);
+				GridMediumf global(bounds, Vec3i(resolution, resolution, resolution), smoke, phase, resolution);
+
+				double constantNs, constantHits, fineNs, fineHits, coarseNs, coarseHits, globalNs, globalHits;
+				measure(constant, rays, constantNs, constantHits);
+				measure(fine, rays, fineNs, fineHits);
+				measure(coarse, rays, coarseNs, coarseHits);
+				measure(global, rays, globalNs, globalHits);
+
+				std::cout << std::fixed << std::setprecision(2) << std::setw(10) << density
+					<< std::setw(16) << constantNs << std::setw(10) << 100 * constantHits
+					<< std::setw(16) << fineNs << std::setw(10) << 100 * fineHits
+					<< std::setw(16) << coarseNs << std::setw(10) << 100 * coarseHits
+					<< std::setw(16) << globalNs << std::setw(10) << 100 * globalHits << std::endl;
+			}
+
+			return 0;
+		}
+	}
+}
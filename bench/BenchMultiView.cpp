@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <trayzy/Bvh.h>
+#include <trayzy/Camera.h>
+#include <trayzy/Image.h>
+#include <trayzy/Renderer.h>
+#include <trayzy/SceneArena.h>
+#include <trayzy/SceneGenerator.h>
+
+#include "Bench.h"
+
+using Bvhf = trayzy::Bvh<float>;
+using Cameraf = trayzy::Camera<float>;
+using Imagef = trayzy::Image<float>;
+using Rendererf = trayzy::Renderer<float>;
+using Vec3f = trayzy::Vec3<float>;
+
+namespace
+{
+	/// A named set of cameras rendered together
+	struct ViewSet
+	{
+		std::string name;
+		trayzy::RenderSettings settings;
+		std::vector<Cameraf> cameras;
+	};
+
+	/// Returns the cameras of a stereo pair looking at the feature spheres of a sphere field
+	std::vector<Cameraf> stereoCameras(const trayzy::RenderSettings &settings)
+	{
+		Vec3f lookFrom(13.0f, 2.0f, 3.0f);
+		Vec3f lookAt(0.0f, 0.0f, 0.0f);
+		Vec3f up(0.0f, 1.0f, 0.0f);
+		Vec3f right = unitVector(cross(lookAt - lookFrom, up));
+		float aspectRatio = float(settings.width) / settings.height;
+		std::vector<Cameraf> cameras;
+
+		for (float eye : { -0.5f, 0.5f })
+		{
+			Vec3f offset = 0.065f * eye * right;
+			cameras.emplace_back(lookFrom + offset, lookAt + offset, up, 20.0f, aspectRatio);
+		}
+
+		return cameras;
+	}
+
+	/// Returns cameras circling the center of a sphere field
+	std::vector<Cameraf> turntableCameras(const trayzy::RenderSettings &settings, int count)
+	{
+		float aspectRatio = float(settings.width) / settings.height;
+		std::vector<Cameraf> cameras;
+
+		for (int i = 0; i < count; ++i)
+		{
+			float angle = 2 * float(M_PI) * i / count;
+			Vec3f lookFrom(13.4f * std::cos(angle), 2.0f, 13.4f * std::sin(angle));
+			cameras.emplace_back(lookFrom, Vec3f(0.0f, 0.0f, 0.0f), Vec3f(0.0f, 1.0f, 0.0f), 20.0f, aspectRatio);
+		}
+
+		return cameras;
+	}
+
+	/// Returns the six faces of a cube map seen from within a sphere field
+	std::vector<Cameraf> cubeCameras()
+	{
+		Vec3f center(0.0f, 1.0f, 5.0f);
+		Vec3f directions[] = { Vec3f(1, 0, 0), Vec3f(-1, 0, 0), Vec3f(0, 1, 0), Vec3f(0, -1, 0), Vec3f(0, 0, 1),
+			Vec3f(0, 0, -1) };
+		Vec3f ups[] = { Vec3f(0, 1, 0), Vec3f(0, 1, 0), Vec3f(0, 0, -1), Vec3f(0, 0, 1), Vec3f(0, 1, 0),
+			Vec3f(0, 1, 0) };
+		std::vector<Cameraf> cameras;
+
+		for (int i = 0; i < 6; ++i)
+		{
+			cameras.emplace_back(center, center + directions[i], ups[i], 90.0f, 1.0f);
+		}
+
+		return cameras;
+	}
+}
+
+namespace trayzy
+{
+	namespace bench
+	{
+		int multiview(int argc, char **argv)
+		{
+			Options options(argc, argv);
+			std::size_t count = std::size_t(options.number("count", 100000));
+
+			RenderSettings settings;
+			settings.width = int(options.number("width", 160));
+			settings.height = int(options.number("height", 90));
+			settings.samples = int(options.number("samples", 4));
+			settings.threads = int(options.number("threads", 0));
+
+			RenderSettings cubeSettings = settings;
+			cubeSettings.width = settings.height;
+
+			std::vector<ViewSet> viewSets = {
+				{ "stereo", settings, stereoCameras(settings) },
+				{ "cube map", cubeSettings, cubeCameras() },
+				{ "turntable", settings, turntableCameras(settings, int(options.number("turntable", 12))) }
+			};
+
+			std::cout << "Multi-view rendering of " << count << " spheres, " << settings.samples
+				<< " samples per pixel on " << Rendererf(settings).threadCount() << " threads" << std::endl
+				<< "Separate runs rebuild the scene for every view; shared runs build it once" << std::endl << std::endl;
+			std::cout << std::setw(12) << "views" << std::setw(8) << "count" << std::setw(14) << "separate s"
+				<< std::setw(12) << "shared s" << std::setw(12) << "speedup" << std::setw(14) << "views/s"
+				<< std::setw(12) << "max RMSE" << std::endl;
+
+			bool passed = true;
+
+			for (const ViewSet &viewSet : viewSets)
+			{
+				Rendererf renderer(viewSet.settings);
+
+				// One run per view, each building its own scene and thread pool
+				std::vector<Imagef> separate;
+				Stopwatch stopwatch;
+
+				for (const Cameraf &camera : viewSet.cameras)
+				{
+					SceneArena arena;
+					Bvhf world(generateSphereField<float>(arena, count));
+					separate.push_back(renderer.render(world, camera));
+				}
+
+				double separateSeconds = stopwatch.seconds();
+
+				// One scene and one queue of tiles for every view
+				stopwatch.restart();
+				SceneArena arena;
+				Bvhf world(generateSphereField<float>(arena, count));
+				std::vector<Imagef> shared = renderer.renderViews(world, viewSet.cameras);
+				double sharedSeconds = stopwatch.seconds();
+
+				float maxError = 0;
+
+				for (std::size_t i = 0; i < shared.size(); ++i)
+				{
+					maxError = std::max(maxError, rmse(separate[i], shared[i]));
+				}
+
+				passed = passed && maxError == 0;
+
+				std::cout << std::fixed << std::setprecision(3) << std::setw(12) << viewSet.name << std::setw(8)
+					<< viewSet.cameras.size() << std::setw(14) << separateSeconds << std::setw(12) << sharedSeconds
+					<< std::setw(11) << std::setprecision(2) << separateSeconds / sharedSeconds << "x" << std::setw(14)
+					<< viewSet.cameras.size() / sharedSeconds << std::setw(12) << std::setprecision(3) << maxError
+					<< std::endl;
+			}
+
+			std::cout << std::endl << "Shared views " << (passed ? "match" : "DIFFER FROM") << " separate renders"
+				<< std::endl;
+
+			return passed ? 0 : 1;
+		}
+	}
+}
@@ -0,0 +1,199 @@
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <trayzy/Camera.h>
+#include <trayzy/HittableList.h>
+#include <trayzy/Image.h>
+#include <trayzy/Lambertian.h>
+#include <trayzy/Metal.h>
+#include <trayzy/NoiseTexture.h>
+#include <trayzy/Perlin.h>
+#include <trayzy/Renderer.h>
+#include <trayzy/SceneArena.h>
+#include <trayzy/Sphere.h>
+
+#include "Bench.h"
+
+using Cameraf = trayzy::Camera<float>;
+using HittableListf = trayzy::HittableList<float>;
+using Imagef = trayzy::Image<float>;
+using Lambertianf = trayzy::Lambertian<float>;
+using Metalf = trayzy::Metal<float>;
+using NoiseTexturef = trayzy::NoiseTexture<float>;
+using Perlinf = trayzy::Perlin<float>;
+using Rendererf = trayzy::Renderer<float>;
+using Spheref = trayzy::Sphere<float>;
+using Vec3f = trayzy::Vec3<float>;
+
+namespace
+{
+	/// Prints one row comparing a scalar reference with its 8-wide counterpart
+	void printRow(const std::string &name, std::size_t n, double scalarSeconds, double wideSeconds,
+		std::size_t nMismatches)
+	{
+		std::cout << std::fixed << std::setprecision(1) << std::setw(16) << name << std::setw(12)
+			<< scalarSeconds * 1e9 / n << std::setw(12) << wideSeconds * 1e9 / n << std::setw(10)
+			<< std::setprecision(2) << scalarSeconds / wideSeconds << "x" << std::setw(12) << nMismatches << std::endl;
+	}
+}
+
+namespace trayzy
+{
+	namespace bench
+	{
+		int noise(int argc, char **argv)
+		{
+			Options options(argc, argv);
+			std::size_t n = std::size_t(options.number("points", 1 << 20));
+			int octaves = int(options.number("octaves", 7));
+			std::string outPath = options.string("out", "");
+
+			std::mt19937 engine(3);
+			std::uniform_real_distribution<float> uniform(-50.0f, 50.0f);
+			std::vector<Vec3f> points(n);
+			std::vector<float> x(n), y(n), z(n);
+
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				x[i] = uniform(engine);
+				y[i] = uniform(engine);
+				z[i] = uniform(engine);
+				points[i] = Vec3f(x[i], y[i], z[i]);
+			}
+
+			Perlinf perlin;
+			NoiseTexturef marble(4.0f, Vec3f(1.0f, 1.0f, 1.0f), octaves);
+			std::vector<float> scalar(n), wide(n);
+			std::vector<Vec3f> scalarColors(n), wideColors(n);
+
+			std::cout << "Perlin noise at " << n << " points, scalar reference against 8 lanes" << std::endl << std::endl;
+			std::cout << std::setw(16) << "function" << std::setw(12) << "scalar ns" << std::setw(12) << "8-wide ns"
+				<< std::setw(11) << "speedup" << std::setw(12) << "mismatches" << std::endl;
+
+			// Noise at every point, one at a time and eight points at a time
+			{
+				Stopwatch stopwatch;
+
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					scalar[i] = perlin.noise(points[i]);
+				}
+
+				double scalarSeconds = stopwatch.seconds();
+				stopwatch.restart();
+				perlin.noise(x.data(), y.data(), z.data(), n, wide.data());
+				double wideSeconds = stopwatch.seconds();
+
+				std::size_t nMismatches = 0;
+
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					nMismatches += scalar[i] != wide[i];
+				}
+
+				printRow("noise", n, scalarSeconds, wideSeconds, nMismatches);
+			}
+
+			// Fractal sums at every point, with the octaves in the lanes
+			{
+				Stopwatch stopwatch;
+
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					scalar[i] = perlin.scalarFbm(points[i], octaves);
+				}
+
+				double scalarSeconds = stopwatch.seconds();
+				stopwatch.restart();
+
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					wide[i] = perlin.fbm(points[i], octaves);
+				}
+
+				double wideSeconds = stopwatch.seconds();
+				std::size_t nMismatches = 0;
+
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					nMismatches += scalar[i] != wide[i];
+				}
+
+				printRow("fbm", n, scalarSeconds, wideSeconds, nMismatches);
+			}
+
+			// The marble texture, per point as in shading and in a batch with the points in the lanes
+			{
+				Stopwatch stopwatch;
+
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					float turbulence = std::abs(perlin.scalarFbm(points[i], octaves));
+					scalarColors[i] = Vec3f(1.0f, 1.0f, 1.0f) * (0.5f * (1 + std::sin(4.0f * points[i][Z] + 10 * turbulence)));
+				}
+
+				double scalarSeconds = stopwatch.seconds();
+				stopwatch.restart();
+
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					wideColors[i] = marble.value(points[i]);
+				}
+
+				double valueSeconds = stopwatch.seconds();
+				stopwatch.restart();
+				marble.values(points.data(), n, wideColors.data());
+				double valuesSeconds = stopwatch.seconds();
+
+				std::size_t nValueMismatches = 0;
+				std::size_t nValuesMismatches = 0;
+
+				for (std::size_t i = 0; i < n; ++i)
+				{
+					nValueMismatches += !(marble.value(points[i]) == scalarColors[i]);
+					nValuesMismatches += !(wideColors[i] == scalarColors[i]);
+				}
+
+				printRow("marble value", n, scalarSeconds, valueSeconds, nValueMismatches);
+				printRow("marble values", n, scalarSeconds, valuesSeconds, nValuesMismatches);
+			}
+
+			// A render with marble on both a diffuse and a metal surface
+			RenderSettings settings;
+			settings.width = int(options.number("width", 320));
+			settings.height = int(options.number("height", 180));
+			settings.samples = int(options.number("samples", 16));
+			settings.threads = int(options.number("threads", 0));
+
+			SceneArena arena;
+			HittableListf world;
+			auto texture = unowned(arena.make<NoiseTexturef>(4.0f, Vec3f(0.9f, 0.85f, 0.8f), octaves));
+			world.insert(unowned(arena.make<Spheref>(Vec3f(0.0f, -1000.0f, 0.0f), 1000.0f,
+				unowned(arena.make<Lambertianf>(texture)))));
+			world.insert(unowned(arena.make<Spheref>(Vec3f(0.0f, 2.0f, 0.0f), 2.0f,
+				unowned(arena.make<Metalf>(texture, 0.1f)))));
+			Cameraf camera(Vec3f(13.0f, 2.0f, 3.0f), Vec3f(0.0f, 1.0f, 0.0f), Vec3f(0.0f, 1.0f, 0.0f), 30.0f,
+				float(settings.width) / settings.height);
+
+			Stopwatch stopwatch;
+			Imagef image = Rendererf(settings).render(world, camera);
+			std::cout << std::endl << "Marble scene " << settings.width << "x" << settings.height << " at "
+				<< settings.samples << " samples per pixel in " << std::setprecision(3) << stopwatch.seconds() << " s"
+				<< std::endl;
+
+			if (!outPath.empty())
+			{
+				std::ofstream out(outPath, std::ios::binary);
+				image.writePpm(out, true);
+			}
+
+			return 0;
+		}
+	}
+}
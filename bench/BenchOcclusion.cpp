@@ -0,0 +1,131 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <trayzy/Bvh.h>
+#include <trayzy/HittableList.h>
+#include <trayzy/SceneArena.h>
+#include <trayzy/SceneGenerator.h>
+
+#include "Bench.h"
+
+using Bvhf = trayzy::Bvh<float>;
+using HitRecordf = trayzy::HitRecord<float>;
+using Hittablef = trayzy::Hittable<float>;
+using HittableListf = trayzy::HittableList<float>;
+using Intersectionf = trayzy::Intersection<float>;
+using Rayf = trayzy::Ray<float>;
+using Vec3f = trayzy::Vec3<float>;
+
+namespace
+{
+	/// Returns shadow-like segments from just above the ground to points above the field
+	std::vector<Rayf> shadowRays(std::size_t count, float halfWidth, int nRays)
+	{
+		std::mt19937 engine(static_cast<std::uint32_t>(count));
+		std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+		std::vector<Rayf> rays;
+
+		for (int i = 0; i < nRays; ++i)
+		{
+			float x0 = halfWidth * (2 * uniform(engine) - 1);
+			float z0 = halfWidth * (2 * uniform(engine) - 1);
+			float x1 = x0 + 4 * (2 * uniform(engine) - 1);
+			float z1 = z0 + 4 * (2 * uniform(engine) - 1);
+			float y1 = 1 + 3 * uniform(engine);
+			Vec3f origin(x0, 0.01f, z0);
+
+			// The direction spans the whole segment, so it ends at t = 1
+			rays.emplace_back(origin, Vec3f(x1, y1, z1) - origin);
+		}
+
+		return rays;
+	}
+
+	/// Prints the cost of each query over the rays and checks that they agree
+	void measure(const std::string &name, std::size_t count, const Hittablef &world, const std::vector<Rayf> &rays)
+	{
+		const float tMin = 0.001f;
+		const float tMax = 1.0f;
+		std::vector<char> blocked(rays.size());
+		std::size_t nBlocked = 0;
+		std::size_t nDisagreements = 0;
+
+		trayzy::bench::Stopwatch stopwatch;
+
+		for (std::size_t i = 0; i < rays.size(); ++i)
+		{
+			Intersectionf intersection;
+			blocked[i] = world.hit(rays[i], tMin, tMax, intersection);
+		}
+
+		double hitSeconds = stopwatch.seconds();
+		stopwatch.restart();
+
+		for (std::size_t i = 0; i < rays.size(); ++i)
+		{
+			HitRecordf record;
+			nBlocked += world.closestHit(rays[i], tMin, tMax, record);
+		}
+
+		double closestSeconds = stopwatch.seconds();
+		stopwatch.restart();
+
+		for (std::size_t i = 0; i < rays.size(); ++i)
+		{
+			nDisagreements += world.occluded(rays[i], tMin, tMax) != bool(blocked[i]);
+		}
+
+		double occludedSeconds = stopwatch.seconds();
+		double scale = 1e9 / rays.size();
+
+		std::cout << std::fixed << std::setprecision(1) << std::setw(8) << name << std::setw(10) << count
+			<< std::setw(12) << 100.0 * nBlocked / rays.size() << "%" << std::setw(12) << hitSeconds * scale
+			<< std::setw(14) << closestSeconds * scale << std::setw(14) << occludedSeconds * scale
+			<< std::setw(10) << std::setprecision(2) << hitSeconds / occludedSeconds << std::setw(12)
+			<< nDisagreements << std::endl;
+	}
+}
+
+namespace trayzy
+{
+	namespace bench
+	{
+		int occlusion(int argc, char **argv)
+		{
+			Options options(argc, argv);
+			double maxCount = options.number("max", 1e6);
+			double maxListCount = options.number("max-list", 1e3);
+			int nRays = int(options.number("rays", 200000));
+
+			std::cout << "Closest-hit versus any-hit queries, " << nRays
+				<< " shadow segments per scene through sphere fields" << std::endl << std::endl;
+			std::cout << std::setw(8) << "world" << std::setw(10) << "spheres" << std::setw(13) << "blocked"
+				<< std::setw(12) << "hit ns" << std::setw(14) << "closest ns" << std::setw(14) << "occluded ns"
+				<< std::setw(10) << "speedup" << std::setw(12) << "mismatches" << std::endl;
+
+			for (double count = 100; count <= maxCount; count *= 10)
+			{
+				SceneArena arena;
+				auto hittables = generateSphereField<float>(arena, std::size_t(count));
+				float halfWidth = 0.5f * float(std::sqrt(count));
+				std::vector<Rayf> rays = shadowRays(std::size_t(count), halfWidth, nRays);
+
+				if (count <= maxListCount)
+				{
+					measure("list", std::size_t(count), HittableListf(hittables), rays);
+				}
+
+				measure("bvh", std::size_t(count), Bvhf(std::move(hittables)), rays);
+			}
+
+			return 0;
+		}
+	}
+}
@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <trayzy/Bvh.h>
+#include <trayzy/Camera.h>
+#include <trayzy/Image.h>
+#include <trayzy/OutOfCoreScene.h>
+#include <trayzy/Renderer.h>
+#include <trayzy/SceneArena.h>
+#include <trayzy/SceneGenerator.h>
+#include <trayzy/Sphere.h>
+
+#include "Bench.h"
+
+using Bvhf = trayzy::Bvh<float>;
+using Cameraf = trayzy::Camera<float>;
+using HitRecordf = trayzy::HitRecord<float>;
+using Hittablef = trayzy::Hittable<float>;
+using Imagef = trayzy::Image<float>;
+using Materialf = trayzy::Material<float>;
+using OutOfCoreScenef = trayzy::OutOfCoreScene<float>;
+using Rayf = trayzy::Ray<float>;
+using Rendererf = trayzy::Renderer<float>;
+using Spheref = trayzy::Sphere<float>;
+using Vec3f = trayzy::Vec3<float>;
+
+namespace
+{
+	/// Returns bounce-like rays leaving random points among the field's spheres at grazing angles
+	std::vector<Rayf> bounceRays(float halfWidth, int nRays)
+	{
+		std::mt19937 engine(7);
+		std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+		std::vector<Rayf> rays;
+
+		for (int i = 0; i < nRays; ++i)
+		{
+			float x = halfWidth * (2 * uniform(engine) - 1);
+			float z = halfWidth * (2 * uniform(engine) - 1);
+			float phi = 2 * 3.14159265f * uniform(engine);
+			float cosTheta = 0.25f * uniform(engine);
+			float sinTheta = std::sqrt(1 - cosTheta * cosTheta);
+			rays.emplace_back(Vec3f(x, 0.3f, z), Vec3f(sinTheta * std::cos(phi), cosTheta, sinTheta * std::sin(phi)));
+		}
+
+		return rays;
+	}
+
+	/// Prints one row of the residency table
+	void printRow(const std::string &name, double seconds, const trayzy::OutOfCoreStats &stats)
+	{
+		std::cout << std::fixed << std::setprecision(3) << std::setw(22) << name << std::setw(10) << seconds
+			<< std::setw(12) << stats.accesses << std::setw(10) << stats.loads << std::setw(12) << stats.evictions
+			<< std::setw(12) << std::setprecision(1) << stats.peakResidentBytes / 1048576.0 << std::endl;
+	}
+}
+
+namespace trayzy
+{
+	namespace bench
+	{
+		int outOfCore(int argc, char **argv)
+		{
+			Options options(argc, argv);
+			std::size_t count = std::size_t(options.number("count", 1e6));
+			double budgetFraction = options.number("budget", 0.25);
+			int chunkSize = int(options.number("chunk", 4096));
+			int nRays = int(options.number("rays", 200000));
+			std::size_t batchSize = std::size_t(options.number("batch", 65536));
+			std::string path = options.string("file", "trayzy-out-of-core.bin");
+
+			RenderSettings settings;
+			settings.width = 160;
+			settings.height = 90;
+			settings.samples = int(options.number("samples", 4));
+			settings.threads = int(options.number("threads", 0));
+
+			Cameraf camera(Vec3f(13.0f, 2.0f, 3.0f), Vec3f(0.0f, 0.0f, 0.0f), Vec3f(0.0f, 1.0f, 0.0f), 20.0f,
+				float(settings.width) / settings.height, 0.1f, 10.0f);
+
+			// The file indexes the field's own materials, one per sphere
+			SceneArena arena;
+			std::vector<std::shared_ptr<Hittablef>> field = generateSphereField<float>(arena, count);
+			std::vector<std::shared_ptr<Materialf>> materials;
+			std::vector<OutOfCoreScenef::Primitive> primitives;
+
+			for (const std::shared_ptr<Hittablef> &hittable : field)
+			{
+				auto sphere = static_cast<const Spheref *>(hittable.get());
+				primitives.push_back({ sphere->center(), sphere->radius(), std::uint32_t(materials.size()) });
+				materials.push_back(sphere->material());
+			}
+
+			Stopwatch stopwatch;
+			OutOfCoreScenef::write(path, primitives, chunkSize);
+			double writeSeconds = stopwatch.seconds();
+			std::vector<OutOfCoreScenef::Primitive>().swap(primitives);
+
+			Bvhf reference(std::move(field));
+
+			std::size_t budgetBytes;
+			std::size_t fileBytes;
+			double openSeconds;
+
+			{
+				stopwatch.restart();
+				OutOfCoreScenef probe(path, materials, 0);
+				openSeconds = stopwatch.seconds();
+				fileBytes = probe.fileBytes();
+				budgetBytes = std::size_t(budgetFraction * fileBytes);
+
+				std::cout << "Out-of-core sphere field of " << probe.size() << " spheres in " << probe.chunkCount()
+					<< " chunks" << std::endl << std::endl;
+			}
+
+			std::cout << std::fixed << std::setprecision(3) << "write " << writeSeconds << " s, open " << openSeconds
+				<< " s, file " << std::setprecision(1) << fileBytes / 1048576.0 << " MiB, residency budget "
+				<< budgetBytes / 1048576.0 << " MiB" << std::endl << std::endl;
+			std::cout << std::setw(22) << "workload" << std::setw(10) << "seconds" << std::setw(12) << "accesses"
+				<< std::setw(10) << "loads" << std::setw(12) << "evictions" << std::setw(12) << "peak MiB" << std::endl;
+
+			int exitCode = 0;
+
+			// A full render through the renderer, tracing one ray at a time
+			{
+				OutOfCoreScenef scene(path, materials, budgetBytes);
+				stopwatch.restart();
+				Imagef image = Rendererf(settings).render(scene, camera);
+				printRow("render", stopwatch.seconds(), scene.stats());
+
+				Imagef expected = Rendererf(settings).render(reference, camera);
+				float error = rmse(image, expected);
+				std::cout << std::setw(22) << "" << "  RMSE against in-memory " << std::setprecision(3) << error
+					<< std::endl;
+				exitCode = error > 1.0f ? 1 : exitCode;
+			}
+
+			// Incoherent rays, first in arrival order and then reordered by chunk
+			std::vector<Rayf> rays = bounceRays(0.5f * std::sqrt(float(count)), nRays);
+			std::vector<HitRecordf> single(rays.size());
+			std::vector<HitRecordf> batched;
+
+			{
+				OutOfCoreScenef scene(path, materials, budgetBytes);
+				stopwatch.restart();
+
+				for (std::size_t i = 0; i < rays.size(); ++i)
+				{
+					scene.closestHit(rays[i], 0.001f, 1e30f, single[i]);
+				}
+
+				printRow("bounce rays, in order", stopwatch.seconds(), scene.stats());
+			}
+
+			{
+				OutOfCoreScenef scene(path, materials, budgetBytes);
+				std::vector<HitRecordf> records;
+				stopwatch.restart();
+
+				for (std::size_t first = 0; first < rays.size(); first += batchSize)
+				{
+					std::vector<Rayf> batch(rays.begin() + first, rays.begin() + std::min(rays.size(), first + batchSize));
+					scene.closestHits(batch, 0.001f, 1e30f, records);
+					batched.insert(batched.end(), records.begin(), records.end());
+				}
+
+				printRow("bounce rays, reordered", stopwatch.seconds(), scene.stats());
+			}
+
+			std::size_t nMismatches = 0;
+
+			for (std::size_t i = 0; i < rays.size(); ++i)
+			{
+				bool hitSingle = single[i].primitive != nullptr;
+				bool hitBatched = batched[i].primitive != nullptr;
+				nMismatches += hitSingle != hitBatched || (hitSingle && single[i].t != batched[i].t);
+			}
+
+			std::cout << std::endl << nMismatches << " of " << rays.size()
+				<< " reordered hits differ from rays traced one at a time" << std::endl;
+
+			std::remove(path.c_str());
+			return nMismatches > 0 ? 1 : exitCode;
+		}
+	}
+}
@@ -0,0 +1,79 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+#include <trayzy/Bvh.h>
+#include <trayzy/Camera.h>
+#include <trayzy/Image.h>
+#include <trayzy/ProgressiveRenderer.h>
+#include <trayzy/Renderer.h>
+#include <trayzy/SceneArena.h>
+#include <trayzy/SceneGenerator.h>
+
+#include "Bench.h"
+
+using Bvhf = trayzy::Bvh<float>;
+using Cameraf = trayzy::Camera<float>;
+using Imagef = trayzy::Image<float>;
+using ProgressiveRendererf = trayzy::ProgressiveRenderer<float>;
+using Rendererf = trayzy::Renderer<float>;
+using Vec3f = trayzy::Vec3<float>;
+
+namespace trayzy
+{
+	namespace bench
+	{
+		int progressive(int argc, char **argv)
+		{
+			Options options(argc, argv);
+
+			RenderSettings settings;
+			settings.width = int(options.number("width", 160));
+			settings.height = int(options.number("height", 90));
+			settings.samples = int(options.number("samples", 1024));
+			settings.threads = int(options.number("threads", 0));
+
+			RenderSettings reference = settings;
+			reference.samples = int(options.number("reference-samples", 64));
+
+			SceneArena arena;
+			Bvhf world(generateSphereField<float>(arena, std::size_t(options.number("count", 1000))));
+			Cameraf camera(Vec3f(13.0f, 2.0f, 3.0f), Vec3f(0.0f, 0.0f, 0.0f), Vec3f(0.0f, 1.0f, 0.0f), 20.0f,
+				float(settings.width) / settings.height, 0.1f, 10.0f);
+
+			Stopwatch stopwatch;
+			Imagef expected = Rendererf(reference).render(world, camera);
+			double referenceSeconds = stopwatch.seconds();
+
+			std::cout << "Time-budgeted rendering, " << settings.width << "x" << settings.height << " on "
+				<< Rendererf(settings).threadCount() << " threads, compared with " << reference.samples
+				<< " samples per pixel rendered in " << std::fixed << std::setprecision(3) << referenceSeconds << " s"
+				<< std::endl << std::endl;
+			std::cout << std::setw(12) << "budget ms" << std::setw(12) << "first ms" << std::setw(12) << "total ms"
+				<< std::setw(12) << "passes" << std::setw(12) << "spp" << std::setw(12) << "RMSE" << std::endl;
+
+			double budgets[] = { 10, 50, 100, 200, 500, 1000 };
+			double single = options.number("budget", 0);
+
+			for (double budget : budgets)
+			{
+				budget = single > 0 ? single : budget;
+				auto duration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+					std::chrono::duration<double, std::milli>(budget));
+				ProgressiveResult<float> result = ProgressiveRendererf(settings).render(world, camera, duration);
+
+				std::cout << std::setprecision(1) << std::setw(12) << budget << std::setw(12)
+					<< 1000 * result.firstImageSeconds << std::setw(12) << 1000 * result.elapsedSeconds
+					<< std::setw(12) << result.passes << std::setw(12) << std::setprecision(2) << result.samplesPerPixel
+					<< std::setw(12) << std::setprecision(3) << rmse(result.image, expected) << std::endl;
+
+				if (single > 0)
+				{
+					break;
+				}
+			}
+
+			return 0;
+		}
+	}
+}
@@ -0,0 +1,186 @@
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <trayzy/Bvh.h>
+#include <trayzy/Camera.h>
+#include <trayzy/DiffuseLight.h>
+#include <trayzy/Image.h>
+#include <trayzy/Lambertian.h>
+#include <trayzy/LightSampler.h>
+#include <trayzy/PathIntegrator.h>
+#include <trayzy/RadianceCache.h>
+#include <trayzy/RadianceCacheIntegrator.h>
+#include <trayzy/Renderer.h>
+#include <trayzy/SceneArena.h>
+#include <trayzy/Sphere.h>
+#include <trayzy/UniformLightSampler.h>
+
+#include "Bench.h"
+
+using Bvhf = trayzy::Bvh<float>;
+using Cameraf = trayzy::Camera<float>;
+using DiffuseLightf = trayzy::DiffuseLight<float>;
+using Hittablef = trayzy::Hittable<float>;
+using Imagef = trayzy::Image<float>;
+using Lambertianf = trayzy::Lambertian<float>;
+using PathIntegratorf = trayzy::PathIntegrator<float>;
+using RadianceCachef = trayzy::RadianceCache<float>;
+using RadianceCacheIntegratorf = trayzy::RadianceCacheIntegrator<float>;
+using Rendererf = trayzy::Renderer<float>;
+using Spheref = trayzy::Sphere<float>;
+using UniformLightSamplerf = trayzy::UniformLightSampler<float>;
+using Vec3f = trayzy::Vec3<float>;
+
+namespace
+{
+	/// Returns a closed, all-matte room of spheres lit by one small light, where paths bounce many times
+	std::vector<std::shared_ptr<Hittablef>> matteRoom(trayzy::SceneArena &arena)
+	{
+		std::vector<std::shared_ptr<Hittablef>> hittables;
+		std::mt19937 engine(7);
+		std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+		// A negative radius points the normals inward, turning the sphere into the walls of the room
+		hittables.push_back(unowned(arena.make<Spheref>(Vec3f(0.0f, 0.0f, 0.0f), -12.0f,
+			unowned(arena.make<Lambertianf>(Vec3f(0.75f, 0.73f, 0.7f))))));
+		hittables.push_back(unowned(arena.make<Spheref>(Vec3f(0.0f, -1000.0f, 0.0f), 1000.0f,
+			unowned(arena.make<Lambertianf>(Vec3f(0.7f, 0.7f, 0.7f))))));
+
+		for (int i = 0; i < 40; ++i)
+		{
+			float radius = 0.3f + 0.9f * uniform(engine);
+			Vec3f center(14 * uniform(engine) - 7, radius, 14 * uniform(engine) - 7);
+			Vec3f albedo(0.3f + 0.6f * uniform(engine), 0.3f + 0.6f * uniform(engine), 0.3f + 0.6f * uniform(engine));
+			hittables.push_back(unowned(arena.make<Spheref>(center, radius, unowned(arena.make<Lambertianf>(albedo)))));
+		}
+
+		hittables.push_back(unowned(arena.make<Spheref>(Vec3f(2.0f, 8.0f, -2.0f), 0.8f,
+			unowned(arena.make<DiffuseLightf>(Vec3f(60.0f, 55.0f, 45.0f))))));
+
+		return hittables;
+	}
+
+	/// Returns the mean of every pixel's components, which noise leaves alone but bias shifts
+	double meanBrightness(const Imagef &image)
+	{
+		double sum = 0;
+
+		for (int row = 0; row < image.height(); ++row)
+		{
+			for (int col = 0; col < image.width(); ++col)
+			{
+				const Vec3f &c = image.at(col, row);
+				sum += c[trayzy::R] + c[trayzy::G] + c[trayzy::B];
+			}
+		}
+
+		return sum / (3.0 * image.width() * image.height());
+	}
+}
+
+namespace trayzy
+{
+	namespace bench
+	{
+		int radianceCache(int argc, char **argv)
+		{
+			Options options(argc, argv);
+
+			RenderSettings settings;
+			settings.width = int(options.number("width", 160));
+			settings.height = int(options.number("height", 90));
+			settings.samples = int(options.number("samples", 8));
+			settings.threads = int(options.number("threads", 0));
+			int referenceSamples = int(options.number("reference-samples", 128));
+
+			SceneArena arena;
+			auto hittables = matteRoom(arena);
+			auto lights = std::make_shared<UniformLightSamplerf>(findLights(hittables));
+			Bvhf world(hittables);
+			Cameraf camera(Vec3f(0.0f, 3.0f, 10.0f), Vec3f(0.0f, 1.0f, 0.0f), Vec3f(0.0f, 1.0f, 0.0f), 60.0f,
+				float(settings.width) / settings.height);
+
+			RenderSettings referenceSettings = settings;
+			referenceSettings.samples = referenceSamples;
+			Stopwatch stopwatch;
+			Imagef reference = Rendererf(referenceSettings, std::make_shared<PathIntegratorf>(lights)).render(world, camera);
+
+			std::cout << "Radiance cache on a closed matte room, " << settings.width << "x" << settings.height << " at "
+				<< settings.samples << " samples per pixel on " << Rendererf(settings).threadCount() << " threads"
+				<< std::endl << "Errors are against the uncached path tracer at " << referenceSamples
+				<< " samples per pixel (" << std::fixed << std::setprecision(1) << stopwatch.seconds() << " s)"
+				<< std::endl << std::endl;
+			std::cout << std::setw(10) << "cell" << std::setw(10) << "normals" << std::setw(10) << "min spp"
+				<< std::setw(12) << "render s" << std::setw(10) << "speedup" << std::setw(10) << "RMSE"
+				<< std::setw(10) << "bias %" << std::setw(12) << "entries" << std::endl;
+
+			struct Entry
+			{
+				float cellSize;
+				int normalBins;
+				int minSamples;
+			};
+
+			// A zero cell size stands for the uncached path tracer
+			std::vector<Entry> entries = {
+				{ 0.0f, 0, 0 },
+				{ 0.05f, 4, 16 },
+				{ 0.1f, 4, 16 },
+				{ 0.1f, 4, 64 },
+				{ 0.2f, 4, 16 },
+				{ 0.4f, 2, 16 }
+			};
+
+			double pathSeconds = 0;
+			double referenceMean = meanBrightness(reference);
+
+			for (const Entry &entry : entries)
+			{
+				std::shared_ptr<RadianceCachef> cache;
+				std::shared_ptr<const Integrator<float>> integrator = std::make_shared<PathIntegratorf>(lights);
+
+				if (entry.cellSize > 0)
+				{
+					cache = std::make_shared<RadianceCachef>(entry.cellSize, entry.normalBins, entry.minSamples);
+					integrator = std::make_shared<RadianceCacheIntegratorf>(cache, lights);
+				}
+
+				stopwatch.restart();
+				Imagef image = Rendererf(settings, integrator).render(world, camera);
+				double seconds = stopwatch.seconds();
+				pathSeconds = pathSeconds > 0 ? pathSeconds : seconds;
+
+				std::cout << std::fixed << std::setprecision(2);
+
+				if (cache)
+				{
+					std::cout << std::setw(10) << entry.cellSize << std::setw(10) << entry.normalBins << std::setw(10)
+						<< entry.minSamples;
+				}
+				else
+				{
+					std::cout << std::setw(30) << "uncached";
+				}
+
+				std::cout << std::setprecision(3) << std::setw(12) << seconds << std::setw(9) << std::setprecision(2)
+					<< pathSeconds / seconds << "x" << std::setw(10) << std::setprecision(3) << rmse(image, reference)
+					<< std::setw(10) << std::setprecision(2) << 100 * (meanBrightness(image) / referenceMean - 1)
+					<< std::setw(12) << (cache ? cache->size() : 0) << std::endl;
+
+				if (options.flag("write-images"))
+				{
+					std::ofstream out("radiance-cache-" + std::to_string(entry.cellSize) + "-"
+						+ std::to_string(entry.minSamples) + ".ppm", std::ios::binary);
+					image.writePpm(out, true);
+				}
+			}
+
+			return 0;
+		}
+	}
+}
@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <trayzy/Bvh.h>
+#include <trayzy/Camera.h>
+#include <trayzy/Image.h>
+#include <trayzy/Renderer.h>
+#include <trayzy/SceneArena.h>
+#include <trayzy/SceneGenerator.h>
+
+#include "Bench.h"
+
+using Bvhf = trayzy::Bvh<float>;
+using Cameraf = trayzy::Camera<float>;
+using Imagef = trayzy::Image<float>;
+using Rendererf = trayzy::Renderer<float>;
+using Vec3f = trayzy::Vec3<float>;
+
+namespace
+{
+	/// Forwards to another hittable while counting the rays traced against it
+	class CountingHittable : public trayzy::Hittable<float>
+	{
+	public:
+		explicit CountingHittable(const trayzy::Hittable<float> &world) :
+			mWorld(world),
+			mCount(0)
+		{
+			// Do nothing more
+		}
+
+		virtual bool closestHit(const trayzy::Ray<float> &ray, float tMin, float tMax,
+			trayzy::HitRecord<float> &record) const override
+		{
+			mCount.fetch_add(1, std::memory_order_relaxed);
+			return mWorld.closestHit(ray, tMin, tMax, record);
+		}
+
+		virtual void evaluate(const trayzy::Ray<float> &ray, const trayzy::HitRecord<float> &record,
+			trayzy::Intersection<float> &intersection) const override
+		{
+			mWorld.evaluate(ray, record, intersection);
+		}
+
+		virtual trayzy::Aabb<float> boundingBox() const override
+		{
+			return mWorld.boundingBox();
+		}
+
+		std::uint64_t count() const
+		{
+			return mCount.load();
+		}
+
+	private:
+		const trayzy::Hittable<float> &mWorld;
+		mutable std::atomic<std::uint64_t> mCount;
+	};
+
+	/// Returns the camera that frames the feature spheres of a sphere field
+	Cameraf fieldCamera(const trayzy::RenderSettings &settings)
+	{
+		Vec3f lookFrom(13.0f, 2.0f, 3.0f);
+		Vec3f lookAt(0.0f, 0.0f, 0.0f);
+		return Cameraf(lookFrom, lookAt, Vec3f(0.0f, 1.0f, 0.0f), 20.0f,
+			float(settings.width) / settings.height, 0.1f, 10.0f);
+	}
+}
+
+namespace trayzy
+{
+	namespace bench
+	{
+		int scaling(int argc, char **argv)
+		{
+			Options options(argc, argv);
+			double maxCount = options.number("max", 1e6);
+			std::string goldenPath = options.string("golden", TRAYZY_BENCH_GOLDEN_DIR "/sphere-field.ppm");
+			double tolerance = options.number("tolerance", 1.0);
+
+			RenderSettings settings;
+			settings.width = int(options.number("width", 160));
+			settings.height = int(options.number("height", 90));
+			settings.samples = int(options.number("samples", 8));
+			settings.threads = int(options.number("threads", 0));
+			Cameraf camera = fieldCamera(settings);
+
+			std::cout << "Sphere field scaling, " << settings.width << "x" << settings.height << " at "
+				<< settings.samples << " samples per pixel on " << Rendererf(settings).threadCount()
+				<< " threads" << std::endl << std::endl;
+			std::cout << std::setw(12) << "spheres" << std::setw(12) << "build s" << std::setw(12) << "bvh MiB"
+				<< std::setw(12) << "render s" << std::setw(12) << "Mrays/s" << std::setw(14) << "peak MiB" << std::endl;
+
+			for (double count = 10; count <= maxCount; count *= 10)
+			{
+				SceneArena arena;
+				Stopwatch stopwatch;
+				Bvhf world(generateSphereField<float>(arena, std::size_t(count)));
+				double buildSeconds = stopwatch.seconds();
+
+				CountingHittable counted(world);
+				stopwatch.restart();
+				Rendererf(settings).render(counted, camera);
+				double renderSeconds = stopwatch.seconds();
+
+				std::cout << std::fixed << std::setprecision(3) << std::setw(12) << std::size_t(count)
+					<< std::setw(12) << buildSeconds << std::setw(12) << world.memoryBytes() / 1048576.0
+					<< std::setw(12) << renderSeconds << std::setw(12) << counted.count() / renderSeconds * 1e-6
+					<< std::setw(14) << peakMemoryBytes() / 1048576.0 << std::endl;
+			}
+
+			// Thread scaling on a mid-sized scene
+			{
+				std::size_t count = std::size_t(std::min(maxCount, options.number("scaling-count", 100000)));
+				int maxThreads = int(std::max(1u, std::thread::hardware_concurrency()));
+				SceneArena arena;
+				Bvhf world(generateSphereField<float>(arena, count));
+				double baseSeconds = 0;
+
+				std::cout << std::endl << "Thread scaling with " << count << " spheres" << std::endl << std::endl;
+				std::cout << std::setw(12) << "threads" << std::setw(12) << "render s" << std::setw(12) << "speedup"
+					<< std::setw(14) << "efficiency" << std::endl;
+
+				for (int threads = 1; ; threads = std::min(threads * 2, maxThreads))
+				{
+					RenderSettings threaded = settings;
+					threaded.threads = threads;
+					Stopwatch stopwatch;
+					Rendererf(threaded).render(world, camera);
+					double seconds = stopwatch.seconds();
+					baseSeconds = threads == 1 ? seconds : baseSeconds;
+
+					std::cout << std::fixed << std::setprecision(3) << std::setw(12) << threads
+						<< std::setw(12) << seconds << std::setw(12) << baseSeconds / seconds
+						<< std::setw(13) << std::setprecision(1) << 100 * baseSeconds / seconds / threads << "%" << std::endl;
+
+					if (threads == maxThreads)
+					{
+						break;
+					}
+				}
+			}
+
+			// The golden image uses fixed settings so that it is comparable across runs
+			RenderSettings golden;
+			golden.width = 160;
+			golden.height = 90;
+			golden.samples = 16;
+			SceneArena arena;
+			Bvhf world(generateSphereField<float>(arena, 1000));
+			Imagef image = Rendererf(golden).render(world, fieldCamera(golden));
+
+			std::cout << std::endl;
+
+			if (options.flag("write-golden"))
+			{
+				std::ofstream out(goldenPath, std::ios::binary);
+				image.writePpm(out, true);
+				std::cout << "Golden image written to " << goldenPath << std::endl;
+				return out ? 0 : 1;
+			}
+
+			std::ifstream in(goldenPath, std::ios::binary);
+
+			if (!in)
+			{
+				std::cout << "Golden image " << goldenPath << " is missing; create it with --write-golden" << std::endl;
+				return 1;
+			}
+
+			float error = rmse(image, Imagef::readPpm(in));
+			bool passed = error <= tolerance;
+			std::cout << "Golden image RMSE " << std::setprecision(3) << error << " (tolerance " << tolerance << "): "
+				<< (passed ? "PASS" : "FAIL") << std::endl;
+
+			return passed ? 0 : 1;
+		}
+	}
+}
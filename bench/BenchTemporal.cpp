@@ -0,0 +1,117 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+
+#include <trayzy/Bvh.h>
+#include <trayzy/Camera.h>
+#include <trayzy/Image.h>
+#include <trayzy/Renderer.h>
+#include <trayzy/SceneArena.h>
+#include <trayzy/SceneGenerator.h>
+#include <trayzy/TemporalRenderer.h>
+
+#include "Bench.h"
+
+using Bvhf = trayzy::Bvh<float>;
+using Cameraf = trayzy::Camera<float>;
+using Imagef = trayzy::Image<float>;
+using Rendererf = trayzy::Renderer<float>;
+using TemporalFramef = trayzy::TemporalFrame<float>;
+using TemporalRendererf = trayzy::TemporalRenderer<float>;
+using Vec3f = trayzy::Vec3<float>;
+
+namespace
+{
+	/// Returns the camera of a frame of a slow orbit around the center of a sphere field
+	Cameraf orbitCamera(const trayzy::RenderSettings &settings, int frame, float degreesPerFrame)
+	{
+		float angle = std::atan2(3.0f, 13.0f) + frame * degreesPerFrame * float(M_PI) / 180;
+		Vec3f lookFrom(13.34f * std::cos(angle), 2.0f, 13.34f * std::sin(angle));
+		return Cameraf(lookFrom, Vec3f(0.0f, 0.0f, 0.0f), Vec3f(0.0f, 1.0f, 0.0f), 20.0f,
+			float(settings.width) / settings.height);
+	}
+}
+
+namespace trayzy
+{
+	namespace bench
+	{
+		int temporal(int argc, char **argv)
+		{
+			Options options(argc, argv);
+			std::size_t count = std::size_t(options.number("count", 100000));
+			int nFrames = int(options.number("frames", 16));
+			float degreesPerFrame = float(options.number("degrees", 0.25));
+			int referenceSamples = int(options.number("reference", 256));
+
+			RenderSettings settings;
+			settings.width = int(options.number("width", 160));
+			settings.height = int(options.number("height", 90));
+			settings.samples = int(options.number("samples", 16));
+			settings.threads = int(options.number("threads", 0));
+
+			TemporalSettings temporalSettings;
+			temporalSettings.maxHistory = int(options.number("max-history", 64));
+			temporalSettings.minSamples = int(options.number("min-samples", 1));
+			temporalSettings.noiseThreshold = options.number("noise", 0.05);
+
+			SceneArena arena;
+			Bvhf world(generateSphereField<float>(arena, count));
+			TemporalRendererf temporalRenderer(settings, temporalSettings);
+			std::size_t nPixels = std::size_t(settings.width) * settings.height;
+
+			std::cout << "Temporal reprojection over " << nFrames << " frames orbiting " << count << " spheres by "
+				<< degreesPerFrame << " degrees each, " << settings.width << "x" << settings.height << " at "
+				<< settings.samples << " samples per pixel on " << Rendererf(settings).threadCount() << " threads"
+				<< std::endl << std::endl;
+			std::cout << std::setw(8) << "frame" << std::setw(12) << "reused %" << std::setw(12) << "samples"
+				<< std::setw(12) << "saved" << std::setw(10) << "saved %" << std::setw(12) << "temporal s"
+				<< std::setw(10) << "fresh s" << std::endl;
+
+			double temporalSeconds = 0;
+			double freshSeconds = 0;
+			std::int64_t totalSaved = 0;
+			TemporalFramef frame;
+			Imagef fresh;
+
+			for (int i = 0; i < nFrames; ++i)
+			{
+				Cameraf camera = orbitCamera(settings, i, degreesPerFrame);
+				frame = temporalRenderer.render(world, camera);
+
+				RenderSettings freshSettings = settings;
+				freshSettings.seed = std::uint32_t(i);
+				Stopwatch stopwatch;
+				fresh = Rendererf(freshSettings).render(world, camera);
+				double seconds = stopwatch.seconds();
+
+				temporalSeconds += frame.elapsedSeconds;
+				freshSeconds += seconds;
+				totalSaved += frame.samplesSaved;
+
+				std::cout << std::fixed << std::setw(8) << i << std::setw(12) << std::setprecision(1)
+					<< 100.0 * frame.reusedPixels / nPixels << std::setw(12) << frame.samples << std::setw(12)
+					<< frame.samplesSaved << std::setw(10) << 100.0 * frame.samplesSaved / (nPixels * settings.samples)
+					<< std::setw(12) << std::setprecision(3) << frame.elapsedSeconds << std::setw(10) << seconds
+					<< std::endl;
+			}
+
+			// Compare the last frame of both against a converged render of its view
+			RenderSettings referenceSettings = settings;
+			referenceSettings.samples = referenceSamples;
+			referenceSettings.seed = 1u << 20;
+			Imagef reference = Rendererf(referenceSettings).render(world, orbitCamera(settings, nFrames - 1,
+				degreesPerFrame));
+
+			std::cout << std::endl << std::fixed << std::setprecision(1) << "Samples saved over the sequence: "
+				<< 100.0 * totalSaved / (double(nPixels) * settings.samples * nFrames) << "%, time "
+				<< std::setprecision(3) << temporalSeconds << " s against " << freshSeconds << " s" << std::endl
+				<< "RMSE of the last frame against " << referenceSamples << " samples per pixel: temporal "
+				<< rmse(frame.image, reference) << ", fresh " << rmse(fresh, reference) << std::endl;
+
+			return 0;
+		}
+	}
+}
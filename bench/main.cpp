@@ -0,0 +1,71 @@
+#include <cstring>
+#include <iostream>
+
+#include "Bench.h"
+
+namespace
+{
+	struct Benchmark
+	{
+		const char *name;
+		const char *description;
+		int (*run)(int argc, char **argv);
+	};
+
+	const Benchmark benchmarks[] = {
+		{ "media", "Participating media query cost versus density", trayzy::bench::media },
+		{ "camera", "Scalar versus batched camera ray generation", trayzy::bench::camera },
+		{ "intersection", "Eager versus deferred hit attribute evaluation", trayzy::bench::intersection },
+		{ "dispatch", "Virtual versus static scene and material dispatch", trayzy::bench::dispatch },
+		{ "arena", "Scene construction with make_shared versus an arena", trayzy::bench::arena },
+		{ "scaling", "End-to-end scaling on procedural sphere fields", trayzy::bench::scaling },
+		{ "progressive", "Image quality reached within wall-clock budgets", trayzy::bench::progressive },
+		{ "lights", "Noise of uniform versus hierarchical light selection", trayzy::bench::lights },
+		{ "occlusion", "Closest-hit versus any-hit queries for shadow rays", trayzy::bench::occlusion },
+		{ "integrators", "Path tracing versus fast preview integrators", trayzy::bench::integrators },
+		{ "compact", "Memory and traversal cost of quantized sphere storage", trayzy::bench::compact },
+		{ "out-of-core", "Chunk residency of a memory-mapped scene under a budget", trayzy::bench::outOfCore },
+		{ "cost", "Overhead of per-pixel render statistics and the costliest tiles", trayzy::bench::cost },
+		{ "noise", "Scalar against 8-wide Perlin noise and marble textures", trayzy::bench::noise },
+		{ "multiview", "Stereo, cube map and turntable views sharing one scene", trayzy::bench::multiview },
+		{ "radiance-cache", "Diffuse interreflection from a radiance cache against path tracing", trayzy::bench::radianceCache },
+		{ "caustics", "Photon-mapped caustics against path tracing through glass", trayzy::bench::caustics },
+		{ "edits", "Per-edit latency of a dynamic hierarchy against rebuilding", trayzy::bench::edits },
+		{ "temporal", "Samples saved by temporal reprojection over a camera orbit", trayzy::bench::temporal },
+		{ "fast-math", "ULP error and speed of fast math kernels, and a converged render check", trayzy::bench::fastMath },
+		{ "hybrid", "Rasterized primary visibility against traced camera rays", trayzy::bench::hybrid },
+		{ "environment", "HDR environment light sampled through an alias table with MIS", trayzy::bench::environment },
+	};
+
+	void usage(const char *program)
+	{
+		std::cerr << "Usage: " << program << " <benchmark> [options]" << std::endl << std::endl;
+		std::cerr << "Benchmarks:" << std::endl;
+
+		for (const Benchmark &benchmark : benchmarks)
+		{
+			std::cerr << "  " << benchmark.name << "\t" << benchmark.description << std::endl;
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		usage(argv[0]);
+		return 1;
+	}
+
+	for (const Benchmark &benchmark : benchmarks)
+	{
+		if (std::strcmp(argv[1], benchmark.name) == 0)
+		{
+			return benchmark.run(argc - 2, argv + 2);
+		}
+	}
+
+	std::cerr << "Unknown benchmark: " << argv[1] << std::endl << std::endl;
+	usage(argv[0]);
+	return 1;
+}
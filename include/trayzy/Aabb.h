@@ -0,0 +1,222 @@
+#ifndef TRAYZY_AABB_H
+#define TRAYZY_AABB_H
+
+#include "Forward.h"
+#include "Ray.h"
+#include "Vec3.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace trayzy
+{
+	/**
+	 * An axis-aligned bounding box.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class Aabb
+	{
+	public:
+		/// Creates an empty box that contains no points
+		Aabb() :
+			mLower(std::numeric_limits<T>::max(), std::numeric_limits<T>::max(), std::numeric_limits<T>::max()),
+			mUpper(std::numeric_limits<T>::lowest(), std::numeric_limits<T>::lowest(), std::numeric_limits<T>::lowest())
+		{
+			// Do nothing more
+		}
+
+		/**
+		 * Creates a box from its extreme corners.
+		 *
+		 * @param lower The corner with the smallest coordinates
+		 * @param upper The corner with the largest coordinates
+		 */
+		Aabb(const Vec3<T> &lower, const Vec3<T> &upper) :
+			mLower(lower),
+			mUpper(upper)
+		{
+			// Do nothing more
+		}
+
+		/// Returns the corner with the smallest coordinates
+		inline const Vec3<T> &lower() const;
+
+		/// Returns the corner with the largest coordinates
+		inline const Vec3<T> &upper() const;
+
+		/// Returns the dimensions of this box
+		inline Vec3<T> extent() const;
+
+		/// Returns the center of this box
+		inline Vec3<T> center() const;
+
+		/// Returns whether this box contains no points
+		inline bool isEmpty() const;
+
+		/// Grows this box to contain the provided point
+		inline Aabb<T> &expand(const Vec3<T> &p);
+
+		/// Grows this box to contain another box
+		inline Aabb<T> &expand(const Aabb<T> &box);
+
+		/**
+		 * Clips a ray's parametric range to this box using the slab method.
+		 *
+		 * @param ray The ray to clip
+		 * @param[in,out] tMin The minimum parametric coordinate, replaced with the entry coordinate
+		 * @param[in,out] tMax The maximum parametric coordinate, replaced with the exit coordinate
+		 * @return Whether any part of the range lies within this box
+		 */
+		inline bool clip(const Ray<T> &ray, T &tMin, T &tMax) const;
+
+		/**
+		 * Determines whether a ray overlaps this box within a parametric range, for traversals
+		 * that test many boxes against the same ray.
+		 *
+		 * @param origin The origin of the ray
+		 * @param inverseDirection The reciprocal of each component of the ray's direction
+		 * @param tMin The minimum parametric coordinate
+		 * @param tMax The maximum parametric coordinate
+		 * @return Whether any part of the range lies within this box
+		 */
+		inline bool overlaps(const Vec3<T> &origin, const Vec3<T> &inverseDirection, T tMin, T tMax) const;
+
+		/**
+		 * Determines whether a ray overlaps this box within a parametric range, and where it
+		 * enters, for traversals that visit the nearer of two boxes first.
+		 *
+		 * @param origin The origin of the ray
+		 * @param inverseDirection The reciprocal of each component of the ray's direction
+		 * @param tMin The minimum parametric coordinate
+		 * @param tMax The maximum parametric coordinate
+		 * @param[out] tEntry The parametric coordinate where the range enters this box
+		 * @return Whether any part of the range lies within this box
+		 */
+		inline bool overlaps(const Vec3<T> &origin, const Vec3<T> &inverseDirection, T tMin, T tMax, T &tEntry) const;
+
+		/// Returns whether this box contains every point of another box
+		inline bool contains(const Aabb<T> &box) const;
+
+	private:
+		Vec3<T> mLower;
+		Vec3<T> mUpper;
+	};
+}
+
+// Inline implementation
+namespace trayzy
+{
+	template<typename T>
+	const Vec3<T> &Aabb<T>::lower() const
+	{
+		return mLower;
+	}
+
+	template<typename T>
+	const Vec3<T> &Aabb<T>::upper() const
+	{
+		return mUpper;
+	}
+
+	template<typename T>
+	Vec3<T> Aabb<T>::extent() const
+	{
+		return mUpper - mLower;
+	}
+
+	template<typename T>
+	Vec3<T> Aabb<T>::center() const
+	{
+		return T(0.5) * (mLower + mUpper);
+	}
+
+	template<typename T>
+	bool Aabb<T>::isEmpty() const
+	{
+		return mLower[X] > mUpper[X] || mLower[Y] > mUpper[Y] || mLower[Z] > mUpper[Z];
+	}
+
+	template<typename T>
+	Aabb<T> &Aabb<T>::expand(const Vec3<T> &p)
+	{
+		mLower = minimum(mLower, p);
+		mUpper = maximum(mUpper, p);
+		return *this;
+	}
+
+	template<typename T>
+	Aabb<T> &Aabb<T>::expand(const Aabb<T> &box)
+	{
+		mLower = minimum(mLower, box.mLower);
+		mUpper = maximum(mUpper, box.mUpper);
+		return *this;
+	}
+
+	template<typename T>
+	bool Aabb<T>::clip(const Ray<T> &ray, T &tMin, T &tMax) const
+	{
+		for (int axis = X; axis <= Z; ++axis)
+		{
+			T inverseDirection = 1 / ray.direction()[axis];
+			T t0 = (mLower[axis] - ray.origin()[axis]) * inverseDirection;
+			T t1 = (mUpper[axis] - ray.origin()[axis]) * inverseDirection;
+
+			if (inverseDirection < 0)
+			{
+				std::swap(t0, t1);
+			}
+
+			// Written so that NaNs from zero direction components keep the current range
+			tMin = t0 > tMin ? t0 : tMin;
+			tMax = t1 < tMax ? t1 : tMax;
+
+			if (tMax <= tMin)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	template<typename T>
+	bool Aabb<T>::overlaps(const Vec3<T> &origin, const Vec3<T> &inverseDirection, T tMin, T tMax) const
+	{
+		for (int axis = X; axis <= Z; ++axis)
+		{
+			T t0 = (mLower[axis] - origin[axis]) * inverseDirection[axis];
+			T t1 = (mUpper[axis] - origin[axis]) * inverseDirection[axis];
+			tMin = std::max(tMin, std::min(t0, t1));
+			tMax = std::min(tMax, std::max(t0, t1));
+		}
+
+		return tMin <= tMax;
+	}
+
+	template<typename T>
+	bool Aabb<T>::overlaps(const Vec3<T> &origin, const Vec3<T> &inverseDirection, T tMin, T tMax, T &tEntry) const
+	{
+		for (int axis = X; axis <= Z; ++axis)
+		{
+			T t0 = (mLower[axis] - origin[axis]) * inverseDirection[axis];
+			T t1 = (mUpper[axis] - origin[axis]) * inverseDirection[axis];
+			tMin = std::max(tMin, std::min(t0, t1));
+			tMax = std::min(tMax, std::max(t0, t1));
+		}
+
+		tEntry = tMin;
+		return tMin <= tMax;
+	}
+
+	template<typename T>
+	bool Aabb<T>::contains(const Aabb<T> &box) const
+	{
+		return mLower[X] <= box.mLower[X] && mLower[Y] <= box.mLower[Y] && mLower[Z] <= box.mLower[Z]
+			&& box.mUpper[X] <= mUpper[X] && box.mUpper[Y] <= mUpper[Y] && box.mUpper[Z] <= mUpper[Z];
+	}
+}
+
+#endif
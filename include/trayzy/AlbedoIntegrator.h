@@ -0,0 +1,44 @@
+#ifndef TRAYZY_ALBEDOINTEGRATOR_H
+#define TRAYZY_ALBEDOINTEGRATOR_H
+
+#include "Integrator.h"
+#include "Intersection.h"
+#include "Material.h"
+#include "PathTracer.h"
+
+#include <limits>
+
+namespace trayzy
+{
+	/**
+	 * Shows the albedo of the material at the first hit, or the sky for rays that escape
+	 * the scene.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class AlbedoIntegrator : public Integrator<T>
+	{
+	public:
+		// Integrator::radiance
+		virtual Vec3<T> radiance(const Ray<T> &ray, const Hittable<T> &world) const override;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	Vec3<T> AlbedoIntegrator<T>::radiance(const Ray<T> &ray, const Hittable<T> &world) const
+	{
+		Intersection<T> intersection;
+
+		if (!world.hit(ray, T(0.001f), std::numeric_limits<T>::max(), intersection))
+		{
+			return background(ray);
+		}
+
+		return intersection.material ? intersection.material->albedo(intersection) : Vec3<T>(0, 0, 0);
+	}
+}
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef TRAYZY_ALIASTABLE_H
+#define TRAYZY_ALIASTABLE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace trayzy
+{
+	/**
+	 * Chooses an index in proportion to a weight in constant time.
+	 *
+	 * Vose's method splits the weights into as many bins as there are indices, each holding
+	 * an equal share of the total: a bin keeps its own index with some probability and
+	 * otherwise hands out one alias, an index whose weight overflowed into it. Sampling
+	 * picks a bin uniformly and then decides between the two, so it costs the same for any
+	 * distribution, however skewed.
+	 *
+	 * @tparam T The weight data type
+	 */
+	template<typename T>
+	class AliasTable
+	{
+	public:
+		/**
+		 * Builds the table over non-negative weights.
+		 *
+		 * @param weights The weight of each index; if they are all zero, every index is
+		 *        equally likely
+		 */
+		explicit AliasTable(const std::vector<T> &weights = std::vector<T>());
+
+		/// Returns the number of indices
+		inline std::size_t size() const;
+
+		/// Returns the sum of the weights the table was built over
+		inline T total() const;
+
+		/**
+		 * Chooses an index.
+		 *
+		 * @param u1 A uniform random number in [0, 1) that picks the bin
+		 * @param u2 A uniform random number in [0, 1) that decides between the bin's index and its alias
+		 * @param[out] probability The probability of choosing the returned index
+		 * @return The chosen index
+		 */
+		inline std::size_t sample(T u1, T u2, T &probability) const;
+
+		/// Returns the probability of choosing an index
+		inline T probability(std::size_t i) const;
+
+	private:
+		/// A bin of equal probability
+		struct Bin
+		{
+			/// The probability that the bin keeps its own index
+			T threshold;
+
+			/// The index the bin hands out otherwise
+			std::uint32_t alias;
+
+			/// The probabilities of choosing the bin's index and its alias, kept alongside so
+			/// that a sample touches a single bin
+			T probability;
+			T aliasProbability;
+		};
+
+	private:
+		std::vector<Bin> mBins;
+		std::vector<T> mProbabilities;
+		T mTotal = 0;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	AliasTable<T>::AliasTable(const std::vector<T> &weights) :
+		mBins(weights.size()),
+		mProbabilities(weights.size())
+	{
+		std::size_t n = weights.size();
+
+		// Sum in double precision, since tables over environment maps have millions of entries
+		double total = 0;
+
+		for (T weight : weights)
+		{
+			total += double(std::max(T(0), weight));
+		}
+
+		mTotal = T(total);
+
+		// Scale each weight to its share of a bin, where 1 fills a bin exactly
+		std::vector<double> scaled(n);
+		std::vector<std::uint32_t> small;
+		std::vector<std::uint32_t> large;
+
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			double probability = total > 0 ? double(std::max(T(0), weights[i])) / total : 1.0 / double(n);
+			mProbabilities[i] = T(probability);
+			scaled[i] = probability * double(n);
+			(scaled[i] < 1 ? small : large).push_back(std::uint32_t(i));
+		}
+
+		// Fill each underfull bin with the excess of an overfull index, which may then become underfull
+		while (!small.empty() && !large.empty())
+		{
+			std::uint32_t under = small.back();
+			std::uint32_t over = large.back();
+			small.pop_back();
+			large.pop_back();
+
+			mBins[under] = { T(scaled[under]), over, 0, 0 };
+			scaled[over] -= 1 - scaled[under];
+			(scaled[over] < 1 ? small : large).push_back(over);
+		}
+
+		// Whatever is left is full up to rounding
+		for (std::vector<std::uint32_t> *rest : { &small, &large })
+		{
+			for (std::uint32_t i : *rest)
+			{
+				mBins[i] = { T(1), i, 0, 0 };
+			}
+		}
+
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			mBins[i].probability = mProbabilities[i];
+			mBins[i].aliasProbability = mProbabilities[mBins[i].alias];
+		}
+	}
+
+	template<typename T>
+	std::size_t AliasTable<T>::size() const
+	{
+		return mBins.size();
+	}
+
+	template<typename T>
+	T AliasTable<T>::total() const
+	{
+		return mTotal;
+	}
+
+	template<typename T>
+	std::size_t AliasTable<T>::sample(T u1, T u2, T &probability) const
+	{
+		const Bin &bin = mBins[std::min(std::size_t(u1 * T(mBins.size())), mBins.size() - 1)];
+		bool own = u2 < bin.threshold;
+		probability = own ? bin.probability : bin.aliasProbability;
+		return own ? std::size_t(&bin - mBins.data()) : bin.alias;
+	}
+
+	template<typename T>
+	T AliasTable<T>::probability(std::size_t i) const
+	{
+		return mProbabilities[i];
+	}
+}
+
+#endif
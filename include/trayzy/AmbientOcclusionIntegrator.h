@@ -0,0 +1,72 @@
+#ifndef TRAYZY_AMBIENTOCCLUSIONINTEGRATOR_H
+#define TRAYZY_AMBIENTOCCLUSIONINTEGRATOR_H
+
+#include "Integrator.h"
+#include "Intersection.h"
+#include "Random.h"
+
+#include <limits>
+
+namespace trayzy
+{
+	/**
+	 * Shows the fraction of the hemisphere above the first hit that is open within a
+	 * radius, estimated with cosine-weighted occlusion rays. Rays that escape the scene are
+	 * white.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class AmbientOcclusionIntegrator : public Integrator<T>
+	{
+	public:
+		/**
+		 * Creates an ambient occlusion preview.
+		 *
+		 * @param nRays The number of occlusion rays per camera ray
+		 * @param radius The distance beyond which hits no longer occlude
+		 */
+		explicit AmbientOcclusionIntegrator(int nRays = 4, T radius = T(1)) :
+			mRayCount(nRays < 1 ? 1 : nRays),
+			mRadius(radius)
+		{
+			// Do nothing more
+		}
+
+		// Integrator::radiance
+		virtual Vec3<T> radiance(const Ray<T> &ray, const Hittable<T> &world) const override;
+
+	private:
+		int mRayCount;
+		T mRadius;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	Vec3<T> AmbientOcclusionIntegrator<T>::radiance(const Ray<T> &ray, const Hittable<T> &world) const
+	{
+		Intersection<T> intersection;
+
+		if (!world.hit(ray, T(0.001f), std::numeric_limits<T>::max(), intersection))
+		{
+			return Vec3<T>(1, 1, 1);
+		}
+
+		Vec3<T> n = unitVector(intersection.normal);
+		n = dot(n, ray.direction()) < 0 ? n : -n;
+		int nOpen = 0;
+
+		for (int i = 0; i < mRayCount; ++i)
+		{
+			Vec3<T> direction = unitVector(randomCosineDirection(n));
+			nOpen += !world.occluded(Ray<T>(intersection.p, direction), T(0.001f), mRadius);
+		}
+
+		T open = T(nOpen) / mRayCount;
+		return Vec3<T>(open, open, open);
+	}
+}
+
+#endif
@@ -0,0 +1,235 @@
+#ifndef TRAYZY_BVH_H
+#define TRAYZY_BVH_H
+
+#include "Aabb.h"
+#include "BvhBuilder.h"
+#include "Hittable.h"
+#include "HitRecord.h"
+#include "Intersection.h"
+#include "Ray.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace trayzy
+{
+	/**
+	 * A bounding volume hierarchy over hittable items.
+	 *
+	 * The tree is built by BvhBuilder, top-down with a binned surface area heuristic.
+	 * Traversal visits the child nearer to the ray origin first and prunes nodes beyond
+	 * the closest hit found so far.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class Bvh : public Hittable<T>
+	{
+	public:
+		/**
+		 * Builds a hierarchy over the provided items.
+		 *
+		 * @param hittables The items to organize, which the hierarchy takes ownership of
+		 * @param maxLeafSize The largest number of items kept in a single leaf
+		 */
+		explicit Bvh(std::vector<std::shared_ptr<Hittable<T>>> hittables, int maxLeafSize = 4);
+
+		// Hittable::closestHit
+		virtual bool closestHit(const Ray<T> &ray, T tMin, T tMax, HitRecord<T> &record) const override;
+
+		// Hittable::evaluate
+		virtual void evaluate(const Ray<T> &ray, const HitRecord<T> &record, Intersection<T> &intersection) const override;
+
+		/**
+		 * @copydoc Hittable::occluded
+		 * 
+		 * Traversal returns at the first item hit, without ordering the children.
+		 */
+		virtual bool occluded(const Ray<T> &ray, T tMin, T tMax) const override;
+
+		// Hittable::boundingBox
+		virtual Aabb<T> boundingBox() const override;
+
+		/// Returns the number of nodes in the hierarchy
+		inline std::size_t nodeCount() const;
+
+		/// Returns the number of items in the hierarchy
+		inline std::size_t size() const;
+
+		/// Returns the bytes used by the nodes and the item pointers, excluding the items themselves
+		inline std::size_t memoryBytes() const;
+
+	private:
+		std::vector<BvhNode<T>> mNodes;
+		std::vector<std::shared_ptr<Hittable<T>>> mHittables;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	Bvh<T>::Bvh(std::vector<std::shared_ptr<Hittable<T>>> hittables, int maxLeafSize)
+	{
+		std::vector<Aabb<T>> bounds(hittables.size());
+
+		for (std::size_t i = 0; i < hittables.size(); ++i)
+		{
+			bounds[i] = hittables[i]->boundingBox();
+		}
+
+		BvhBuilder<T> builder(bounds, maxLeafSize);
+		mNodes = std::move(builder.nodes());
+
+		// Store the items in leaf order so each leaf references a contiguous range
+		mHittables.reserve(hittables.size());
+
+		for (std::uint32_t index : builder.order())
+		{
+			mHittables.push_back(std::move(hittables[index]));
+		}
+	}
+
+	template<typename T>
+	bool Bvh<T>::closestHit(const Ray<T> &ray, T tMin, T tMax, HitRecord<T> &record) const
+	{
+		if (mNodes.empty() || mHittables.empty())
+		{
+			return false;
+		}
+
+		const Vec3<T> &origin = ray.origin();
+		Vec3<T> inverseDirection(1 / ray.direction()[X], 1 / ray.direction()[Y], 1 / ray.direction()[Z]);
+
+		std::uint32_t stack[128];
+		int stackSize = 0;
+		std::uint32_t node = 0;
+		bool hasHit = false;
+
+		while (true)
+		{
+			const BvhNode<T> &current = mNodes[node];
+
+			if (current.bounds.overlaps(origin, inverseDirection, tMin, tMax))
+			{
+				if (current.count > 0)
+				{
+					for (std::uint32_t i = current.offset; i < current.offset + current.count; ++i)
+					{
+						if (mHittables[i]->closestHit(ray, tMin, tMax, record))
+						{
+							tMax = record.t;
+							hasHit = true;
+						}
+					}
+				}
+				else
+				{
+					// Visit the child on the side the ray comes from first
+					if (ray.direction()[current.axis] < 0)
+					{
+						stack[stackSize++] = node + 1;
+						node = current.offset;
+					}
+					else
+					{
+						stack[stackSize++] = current.offset;
+						node = node + 1;
+					}
+
+					continue;
+				}
+			}
+
+			if (stackSize == 0)
+			{
+				break;
+			}
+
+			node = stack[--stackSize];
+		}
+
+		return hasHit;
+	}
+
+	template<typename T>
+	void Bvh<T>::evaluate(const Ray<T> &ray, const HitRecord<T> &record, Intersection<T> &intersection) const
+	{
+		record.primitive->evaluate(ray, record, intersection);
+	}
+
+	template<typename T>
+	bool Bvh<T>::occluded(const Ray<T> &ray, T tMin, T tMax) const
+	{
+		if (mNodes.empty() || mHittables.empty())
+		{
+			return false;
+		}
+
+		const Vec3<T> &origin = ray.origin();
+		Vec3<T> inverseDirection(1 / ray.direction()[X], 1 / ray.direction()[Y], 1 / ray.direction()[Z]);
+
+		std::uint32_t stack[128];
+		int stackSize = 0;
+		std::uint32_t node = 0;
+
+		while (true)
+		{
+			const BvhNode<T> &current = mNodes[node];
+
+			if (current.bounds.overlaps(origin, inverseDirection, tMin, tMax))
+			{
+				if (current.count == 0)
+				{
+					stack[stackSize++] = current.offset;
+					node = node + 1;
+					continue;
+				}
+
+				for (std::uint32_t i = current.offset; i < current.offset + current.count; ++i)
+				{
+					if (mHittables[i]->occluded(ray, tMin, tMax))
+					{
+						return true;
+					}
+				}
+			}
+
+			if (stackSize == 0)
+			{
+				return false;
+			}
+
+			node = stack[--stackSize];
+		}
+	}
+
+	template<typename T>
+	Aabb<T> Bvh<T>::boundingBox() const
+	{
+		return mNodes.empty() ? Aabb<T>() : mNodes.front().bounds;
+	}
+
+	template<typename T>
+	std::size_t Bvh<T>::nodeCount() const
+	{
+		return mNodes.size();
+	}
+
+	template<typename T>
+	std::size_t Bvh<T>::size() const
+	{
+		return mHittables.size();
+	}
+
+	template<typename T>
+	std::size_t Bvh<T>::memoryBytes() const
+	{
+		return mNodes.capacity() * sizeof(BvhNode<T>) + mHittables.capacity() * sizeof(std::shared_ptr<Hittable<T>>);
+	}
+}
+
+#endif
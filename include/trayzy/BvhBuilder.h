@@ -0,0 +1,246 @@
+#ifndef TRAYZY_BVHBUILDER_H
+#define TRAYZY_BVHBUILDER_H
+
+#include "Aabb.h"
+#include "Vec3.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace trayzy
+{
+	/**
+	 * A node of a flattened bounding volume hierarchy.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	struct BvhNode
+	{
+		/// The bounds of everything below this node
+		Aabb<T> bounds;
+
+		/// The first item index for leaves, or the right child index for interior nodes
+		std::uint32_t offset;
+
+		/// The number of items for leaves, or zero for interior nodes
+		std::uint16_t count;
+
+		/// The axis the children were split along
+		std::uint8_t axis;
+	};
+
+	/**
+	 * Builds the topology of a bounding volume hierarchy from the bounds of its items.
+	 *
+	 * The tree is built top-down with a binned surface area heuristic and stored as a flat
+	 * array in depth-first order, where an interior node's left child directly follows it.
+	 * The builder only orders item indices, so any structure that stores its items in
+	 * leaf order can share it.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class BvhBuilder
+	{
+	public:
+		/**
+		 * Builds a hierarchy over items with the provided bounds.
+		 *
+		 * @param bounds The bounds of every item
+		 * @param maxLeafSize The largest number of items kept in a single leaf
+		 */
+		BvhBuilder(const std::vector<Aabb<T>> &bounds, int maxLeafSize);
+
+		/// Returns the nodes, with the root first
+		inline std::vector<BvhNode<T>> &nodes();
+
+		/// Returns the item indices in leaf order, so each leaf references a contiguous range
+		inline const std::vector<std::uint32_t> &order() const;
+
+	private:
+		/// The bounds and centroid of one item, cached during the build
+		struct BuildItem
+		{
+			Aabb<T> bounds;
+			Vec3<T> centroid;
+		};
+
+		/// Builds the subtree over the items in [first, last) into the provided node
+		void build(std::uint32_t node, std::uint32_t first, std::uint32_t last, int depth);
+
+		/// Returns the surface area of a box, or zero for empty boxes
+		static T surfaceArea(const Aabb<T> &box);
+
+	private:
+		std::vector<BuildItem> mItems;
+		std::vector<BvhNode<T>> mNodes;
+		std::vector<std::uint32_t> mOrder;
+		int mMaxLeafSize;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	BvhBuilder<T>::BvhBuilder(const std::vector<Aabb<T>> &bounds, int maxLeafSize) :
+		mItems(bounds.size()),
+		mOrder(bounds.size()),
+		mMaxLeafSize(std::max(1, std::min(maxLeafSize, 0xFFFF)))
+	{
+		std::iota(mOrder.begin(), mOrder.end(), 0);
+
+		for (std::size_t i = 0; i < bounds.size(); ++i)
+		{
+			mItems[i].bounds = bounds[i];
+			mItems[i].centroid = bounds[i].center();
+		}
+
+		mNodes.reserve(2 * bounds.size() / mMaxLeafSize + 1);
+		mNodes.emplace_back();
+		build(0, 0, std::uint32_t(bounds.size()), 0);
+
+		// The cached items are only needed while building
+		std::vector<BuildItem>().swap(mItems);
+	}
+
+	template<typename T>
+	std::vector<BvhNode<T>> &BvhBuilder<T>::nodes()
+	{
+		return mNodes;
+	}
+
+	template<typename T>
+	const std::vector<std::uint32_t> &BvhBuilder<T>::order() const
+	{
+		return mOrder;
+	}
+
+	template<typename T>
+	void BvhBuilder<T>::build(std::uint32_t node, std::uint32_t first, std::uint32_t last, int depth)
+	{
+		constexpr int nBins = 16;
+
+		std::vector<BuildItem> &items = mItems;
+		std::vector<std::uint32_t> &order = mOrder;
+		Aabb<T> bounds;
+		Aabb<T> centroidBounds;
+
+		for (std::uint32_t i = first; i < last; ++i)
+		{
+			bounds.expand(items[order[i]].bounds);
+			centroidBounds.expand(items[order[i]].centroid);
+		}
+
+		std::uint32_t count = last - first;
+		mNodes[node].bounds = bounds;
+
+		if (count <= std::uint32_t(mMaxLeafSize))
+		{
+			mNodes[node].offset = first;
+			mNodes[node].count = std::uint16_t(count);
+			mNodes[node].axis = 0;
+			return;
+		}
+
+		Vec3<T> extent = centroidBounds.extent();
+		int axis = extent[X] > extent[Y] ? (extent[X] > extent[Z] ? X : Z) : (extent[Y] > extent[Z] ? Y : Z);
+		std::uint32_t middle = first;
+
+		// Past a generous depth, fall back to median splits to bound the traversal stack
+		if (extent[axis] > 0 && depth < 48)
+		{
+			std::array<Aabb<T>, nBins> binBounds;
+			std::array<std::uint32_t, nBins> binCounts{};
+			T scale = nBins / extent[axis];
+
+			auto binOf = [&](std::uint32_t item)
+			{
+				int bin = int((items[item].centroid[axis] - centroidBounds.lower()[axis]) * scale);
+				return std::min(bin, nBins - 1);
+			};
+
+			for (std::uint32_t i = first; i < last; ++i)
+			{
+				int bin = binOf(order[i]);
+				binBounds[bin].expand(items[order[i]].bounds);
+				++binCounts[bin];
+			}
+
+			// Sweep from the right to find the area of every suffix, then from the left to cost each split
+			std::array<T, nBins> rightCosts{};
+			Aabb<T> rightBounds;
+			std::uint32_t rightCount = 0;
+
+			for (int bin = nBins - 1; bin > 0; --bin)
+			{
+				rightBounds.expand(binBounds[bin]);
+				rightCount += binCounts[bin];
+				rightCosts[bin] = surfaceArea(rightBounds) * rightCount;
+			}
+
+			Aabb<T> leftBounds;
+			std::uint32_t leftCount = 0;
+			T bestCost = surfaceArea(bounds) * count;
+			int bestSplit = -1;
+
+			for (int bin = 1; bin < nBins; ++bin)
+			{
+				leftBounds.expand(binBounds[bin - 1]);
+				leftCount += binCounts[bin - 1];
+				T cost = surfaceArea(leftBounds) * leftCount + rightCosts[bin];
+
+				if (leftCount > 0 && leftCount < count && cost < bestCost)
+				{
+					bestCost = cost;
+					bestSplit = bin;
+				}
+			}
+
+			if (bestSplit > 0)
+			{
+				middle = std::uint32_t(std::partition(order.begin() + first, order.begin() + last,
+					[&](std::uint32_t item) { return binOf(item) < bestSplit; }) - order.begin());
+			}
+		}
+
+		if (middle == first || middle == last)
+		{
+			middle = first + count / 2;
+			std::nth_element(order.begin() + first, order.begin() + middle, order.begin() + last,
+				[&](std::uint32_t a, std::uint32_t b) { return items[a].centroid[axis] < items[b].centroid[axis]; });
+		}
+
+		std::uint32_t left = std::uint32_t(mNodes.size());
+		mNodes.emplace_back();
+		build(left, first, middle, depth + 1);
+
+		std::uint32_t right = std::uint32_t(mNodes.size());
+		mNodes.emplace_back();
+		build(right, middle, last, depth + 1);
+
+		mNodes[node].offset = right;
+		mNodes[node].count = 0;
+		mNodes[node].axis = std::uint8_t(axis);
+	}
+
+	/* static */
+	template<typename T>
+	T BvhBuilder<T>::surfaceArea(const Aabb<T> &box)
+	{
+		if (box.isEmpty())
+		{
+			return 0;
+		}
+
+		Vec3<T> e = box.extent();
+		return 2 * (e[X] * e[Y] + e[Y] * e[Z] + e[Z] * e[X]);
+	}
+}
+
+#endif
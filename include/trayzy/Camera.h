@@ -2,12 +2,20 @@
 #define TRAYZY_CAMERA_H
 
 #include "Forward.h"
+#include "Random.h"
 #include "Ray.h"
+#include "RayBatch.h"
+
+#include <cmath>
+#include <cstddef>
 
 namespace trayzy
 {
 	/**
-	 * A simple axis-aligned camera.
+	 * A camera with either a pinhole or a thin-lens aperture.
+	 *
+	 * Cameras are immutable once constructed, so a single instance can generate rays
+	 * from any number of threads at once.
 	 */
 	template<typename T>
 	class Camera
@@ -23,10 +31,13 @@ namespace trayzy
 		 */
 		Camera(const Vec3<T> &origin = Vec3<T>(0, 0, 0), const Vec3<T> &lowerLeft = Vec3<T>(-2, -1, -1),
 			const Vec3<T> &horizontal = Vec3<T>(4, 0, 0), const Vec3<T> &vertical = Vec3<T>(0, 2, 0)) :
-			mHorizontal(horizontal),
-			mLowerLeft(lowerLeft),
 			mOrigin(origin),
-			mVertical(vertical)
+			mLowerLeft(lowerLeft),
+			mHorizontal(horizontal),
+			mVertical(vertical),
+			mU(1, 0, 0),
+			mV(0, 1, 0),
+			mLensRadius(0)
 		{
 			// Do nothing more
 		}
@@ -39,10 +50,13 @@ namespace trayzy
 		 * @param up The upward direction
 		 * @param verticalFovDegrees The vertical field of view in degrees
 		 * @param aspectRatio The ratio between the horizontal and vertical draw plane axis lengths
+		 * @param aperture The diameter of the thin lens, or zero for a pinhole camera
+		 * @param focusDistance The distance from the camera to the plane in perfect focus
 		 */
 		Camera(const Vec3<T> &lookFrom, const Vec3<T> &lookAt, const Vec3<T> &up,
-			T verticalFovDegrees, T aspectRatio) :
-			mOrigin(lookFrom)
+			T verticalFovDegrees, T aspectRatio, T aperture = 0, T focusDistance = 1) :
+			mOrigin(lookFrom),
+			mLensRadius(aperture / 2)
 		 {
 		 	// Convert the vertical field of view to radians
 			T theta = verticalFovDegrees * T(M_PI) / 180;
@@ -51,42 +65,195 @@ namespace trayzy
 
 			// Compute the horizontal and vertical axes of the draw plane
 			Vec3<T> w = unitVector(lookFrom - lookAt);
-			Vec3<T> u = unitVector(cross(up, w));
-			Vec3<T> v = cross(w, u);
+			mU = unitVector(cross(up, w));
+			mV = cross(w, mU);
 
-			mLowerLeft = mOrigin - halfWidth * u - halfHeight * v - w;
-			mHorizontal = 2 * halfWidth * u;
-			mVertical = 2 * halfHeight * v;
+			// The draw plane doubles as the focus plane
+			mLowerLeft = mOrigin - focusDistance * (halfWidth * mU + halfHeight * mV + w);
+			mHorizontal = 2 * halfWidth * focusDistance * mU;
+			mVertical = 2 * halfHeight * focusDistance * mV;
 		 }
 
 		/**
 		 * Returns a ray from this camera's origin to the provided canvas coordinates
 		 * 
+		 * For thin-lens cameras the ray starts at a random point on the lens.
+		 * 
 		 * @param u The horizontal canvas coordinate
 		 * @param v The vertical canvas coordinate
 		 * @return The ray from the origin to the canvas coordinates
 		 */
-		Ray<T> getRay(T u, T v);
+		Ray<T> getRay(T u, T v) const;
+
+		/**
+		 * Generates jittered rays for every sample of every pixel in a rectangular tile.
+		 *
+		 * Random numbers are drawn in a first pass and the rays are then assembled in a
+		 * second, branch-free pass over the coordinate arrays that compilers vectorize.
+		 * Rays are ordered by row, then column, then sample, with row 0 at the bottom.
+		 *
+		 * @param x0 The column of the tile's lower-left pixel
+		 * @param y0 The row of the tile's lower-left pixel
+		 * @param width The number of columns in the tile
+		 * @param height The number of rows in the tile
+		 * @param nCols The number of columns in the whole image
+		 * @param nRows The number of rows in the whole image
+		 * @param nSamples The number of samples per pixel
+		 * @param[out] rays The generated rays
+		 */
+		void getRays(int x0, int y0, int width, int height, int nCols, int nRows, int nSamples,
+			RayBatch<T> &rays) const;
+
+		/**
+		 * Returns the canvas coordinates a point appears at, as the inverse of getRay().
+		 *
+		 * Points are projected through the center of the lens, where thin-lens cameras
+		 * render them sharply only on the focus plane.
+		 *
+		 * @param point The point to project
+		 * @param[out] u The horizontal canvas coordinate, in [0, 1) within the image
+		 * @param[out] v The vertical canvas coordinate, in [0, 1) within the image
+		 * @return Whether the point lies in front of the camera
+		 */
+		bool project(const Vec3<T> &point, T &u, T &v) const;
 
 		inline const Vec3<T> &origin() const;
 		inline const Vec3<T> &lowerLeft() const;
 		inline const Vec3<T> &horizontal() const;
 		inline const Vec3<T> &vertical() const;
+		inline T lensRadius() const;
+
+	private:
+		/// Returns a random point within the unit disk as its two coordinates
+		static void randomInUnitDisk(T &x, T &y);
 
 	private:
 		Vec3<T> mOrigin;
 		Vec3<T> mLowerLeft;
 		Vec3<T> mHorizontal;
 		Vec3<T> mVertical;
+		Vec3<T> mU;
+		Vec3<T> mV;
+		T mLensRadius;
 	};
 }
 
 namespace trayzy
 {
+	/* static */
+	template<typename T>
+	void Camera<T>::randomInUnitDisk(T &x, T &y)
+	{
+		do
+		{
+			x = 2 * randomUniform<T>() - 1;
+			y = 2 * randomUniform<T>() - 1;
+		} while (x * x + y * y >= 1);
+	}
+
+	template<typename T>
+	Ray<T> Camera<T>::getRay(T u, T v) const
+	{
+		if (mLensRadius <= 0)
+		{
+			return Ray<T>(mOrigin, mLowerLeft + u * mHorizontal + v * mVertical - mOrigin);
+		}
+
+		T x;
+		T y;
+		randomInUnitDisk(x, y);
+
+		Vec3<T> offset = mLensRadius * (x * mU + y * mV);
+		return Ray<T>(mOrigin + offset, mLowerLeft + u * mHorizontal + v * mVertical - mOrigin - offset);
+	}
+
 	template<typename T>
-	Ray<T> Camera<T>::getRay(T u, T v)
+	void Camera<T>::getRays(int x0, int y0, int width, int height, int nCols, int nRows, int nSamples,
+		RayBatch<T> &rays) const
 	{
-		return Ray<T>(mOrigin, mLowerLeft + u * mHorizontal + v * mVertical - mOrigin);
+		std::size_t n = std::size_t(width) * height * nSamples;
+		rays.resize(n);
+
+		// The direction arrays hold the canvas coordinates and the origin arrays hold
+		// the lens samples until the second pass replaces them in place
+		T *canvasU = rays.directionX.data();
+		T *canvasV = rays.directionY.data();
+		T *lensX = rays.originX.data();
+		T *lensY = rays.originY.data();
+		std::size_t i = 0;
+
+		for (int row = y0; row < y0 + height; ++row)
+		{
+			for (int col = x0; col < x0 + width; ++col)
+			{
+				for (int s = 0; s < nSamples; ++s, ++i)
+				{
+					canvasU[i] = (col + randomUniform<T>()) / nCols;
+					canvasV[i] = (row + randomUniform<T>()) / nRows;
+
+					if (mLensRadius > 0)
+					{
+						randomInUnitDisk(lensX[i], lensY[i]);
+					}
+					else
+					{
+						lensX[i] = 0;
+						lensY[i] = 0;
+					}
+				}
+			}
+		}
+
+		// Copy the camera frame into scalars so the loop below has no aliasing hazards
+		const T cornerX = mLowerLeft[X] - mOrigin[X], cornerY = mLowerLeft[Y] - mOrigin[Y], cornerZ = mLowerLeft[Z] - mOrigin[Z];
+		const T hX = mHorizontal[X], hY = mHorizontal[Y], hZ = mHorizontal[Z];
+		const T vX = mVertical[X], vY = mVertical[Y], vZ = mVertical[Z];
+		const T uX = mLensRadius * mU[X], uY = mLensRadius * mU[Y], uZ = mLensRadius * mU[Z];
+		const T wX = mLensRadius * mV[X], wY = mLensRadius * mV[Y], wZ = mLensRadius * mV[Z];
+		const T oX = mOrigin[X], oY = mOrigin[Y], oZ = mOrigin[Z];
+
+		T *originX = rays.originX.data();
+		T *originY = rays.originY.data();
+		T *originZ = rays.originZ.data();
+		T *directionX = rays.directionX.data();
+		T *directionY = rays.directionY.data();
+		T *directionZ = rays.directionZ.data();
+
+		for (std::size_t k = 0; k < n; ++k)
+		{
+			T s = directionX[k];
+			T t = directionY[k];
+			T offsetX = originX[k] * uX + originY[k] * wX;
+			T offsetY = originX[k] * uY + originY[k] * wY;
+			T offsetZ = originX[k] * uZ + originY[k] * wZ;
+
+			originX[k] = oX + offsetX;
+			originY[k] = oY + offsetY;
+			originZ[k] = oZ + offsetZ;
+			directionX[k] = cornerX + s * hX + t * vX - offsetX;
+			directionY[k] = cornerY + s * hY + t * vY - offsetY;
+			directionZ[k] = cornerZ + s * hZ + t * vZ - offsetZ;
+		}
+	}
+
+	template<typename T>
+	bool Camera<T>::project(const Vec3<T> &point, T &u, T &v) const
+	{
+		// Scale the direction to the point until it reaches the canvas plane
+		Vec3<T> normal = cross(mHorizontal, mVertical);
+		Vec3<T> direction = point - mOrigin;
+		T scale = dot(mLowerLeft - mOrigin, normal) / dot(direction, normal);
+
+		if (!(scale > 0))
+		{
+			return false;
+		}
+
+		// The canvas axes are perpendicular, so each coordinate is a projection onto its axis
+		Vec3<T> offset = mOrigin + scale * direction - mLowerLeft;
+		u = dot(offset, mHorizontal) / mHorizontal.magnitudeSquared();
+		v = dot(offset, mVertical) / mVertical.magnitudeSquared();
+		return true;
 	}
 
 	template<typename T>
@@ -112,6 +279,12 @@ namespace trayzy
 	{
 		return mVertical;
 	}
+
+	template<typename T>
+	T Camera<T>::lensRadius() const
+	{
+		return mLensRadius;
+	}
 }
 
 #endif
\ No newline at end of file
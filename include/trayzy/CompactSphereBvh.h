@@ -0,0 +1,450 @@
+#ifndef TRAYZY_COMPACTSPHEREBVH_H
+#define TRAYZY_COMPACTSPHEREBVH_H
+
+#include "Aabb.h"
+#include "BvhBuilder.h"
+#include "Hittable.h"
+#include "HitRecord.h"
+#include "Intersection.h"
+#include "Material.h"
+#include "Ray.h"
+#include "RenderStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace trayzy
+{
+	/**
+	 * A bounding volume hierarchy that stores spheres by value in 10 bytes each.
+	 *
+	 * Each sphere's center is quantized to 16 bits per axis within the bounds of its leaf,
+	 * its radius to 16 bits of half the leaf's smallest extent, and its material to a 15-bit
+	 * index into a shared table whose top bit holds the sign of the radius, so a negative
+	 * radius still turns the normals inward. Spheres are decoded on the fly while traversing,
+	 * so the precision is relative to the leaf, not to the whole scene, and a sphere alone in
+	 * its leaf, such as a huge ground sphere, decodes exactly. Centers and radii are rounded
+	 * to nearest, and a nonzero radius keeps at least one step; leaves of several spheres
+	 * are padded by 1/32767 of their largest extent beforehand, which covers the rounding and
+	 * keeps the hierarchy conservative.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class CompactSphereBvh : public Hittable<T>
+	{
+	public:
+		/// A sphere before quantization
+		struct Primitive
+		{
+			/// The center of the sphere
+			Vec3<T> center;
+
+			/// The radius of the sphere
+			T radius;
+
+			/// The index of the sphere's material in the material table
+			std::uint16_t material;
+		};
+
+		/// The largest number of materials in the table
+		static constexpr std::size_t maxMaterials = 0x8000;
+
+		/**
+		 * Builds a hierarchy over the provided spheres.
+		 *
+		 * @param spheres The spheres to store, which are released once quantized
+		 * @param materials The material table, with at most 32768 entries
+		 * @param maxLeafSize The largest number of spheres kept in a single leaf
+		 * @throws std::invalid_argument If the table is too large or a sphere's material is not in it
+		 */
+		CompactSphereBvh(std::vector<Primitive> spheres, std::vector<std::shared_ptr<Material<T>>> materials,
+			int maxLeafSize = 8);
+
+		// Hittable::closestHit
+		virtual bool closestHit(const Ray<T> &ray, T tMin, T tMax, HitRecord<T> &record) const override;
+
+		// Hittable::evaluate
+		virtual void evaluate(const Ray<T> &ray, const HitRecord<T> &record, Intersection<T> &intersection) const override;
+
+		// Hittable::occluded
+		virtual bool occluded(const Ray<T> &ray, T tMin, T tMax) const override;
+
+		// Hittable::boundingBox
+		virtual Aabb<T> boundingBox() const override;
+
+		/// Returns the number of nodes in the hierarchy
+		inline std::size_t nodeCount() const;
+
+		/// Returns the number of spheres in the hierarchy
+		inline std::size_t size() const;
+
+		/// Returns the bytes used by the nodes, the spheres and the leaf index, excluding the materials
+		inline std::size_t memoryBytes() const;
+
+	private:
+		/// A sphere quantized within the bounds of its leaf
+		struct QuantizedSphere
+		{
+			std::uint16_t center[3];
+			std::uint16_t radius;
+
+			/// The material index, with the sign of the radius in the top bit
+			std::uint16_t material;
+		};
+
+		/// The bit of the material word set for spheres of negative radius
+		static constexpr std::uint16_t negativeRadius = 0x8000;
+
+		/// The constants that decode the spheres of one leaf
+		struct Frame
+		{
+			Vec3<T> lower;
+			Vec3<T> step;
+			T radiusStep;
+		};
+
+		/// Returns the decoding constants of a leaf
+		static inline Frame frameOf(const Aabb<T> &bounds);
+
+		/// Decodes a sphere with the constants of its leaf
+		static inline void decode(const Frame &frame, const QuantizedSphere &sphere, Vec3<T> &center, T &radius);
+
+		/// Returns the smallest root within the range of a ray and a sphere, or tMax if there is none
+		static inline T intersect(const Ray<T> &ray, const Vec3<T> &center, T radius, T tMin, T tMax);
+
+		/// Returns the leaf node that holds a sphere
+		std::uint32_t leafOf(std::uint32_t sphere) const;
+
+	private:
+		std::vector<BvhNode<T>> mNodes;
+		std::vector<QuantizedSphere> mSpheres;
+		std::vector<std::shared_ptr<Material<T>>> mMaterials;
+
+		// The first sphere and node of every leaf, in sphere order, to find a hit's leaf
+		std::vector<std::uint32_t> mLeafFirsts;
+		std::vector<std::uint32_t> mLeafNodes;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	CompactSphereBvh<T>::CompactSphereBvh(std::vector<Primitive> spheres,
+		std::vector<std::shared_ptr<Material<T>>> materials, int maxLeafSize) :
+		mMaterials(std::move(materials))
+	{
+		if (mMaterials.size() > maxMaterials)
+		{
+			throw std::invalid_argument("CompactSphereBvh: more than 32768 materials");
+		}
+
+		std::vector<Aabb<T>> bounds(spheres.size());
+
+		for (std::size_t i = 0; i < spheres.size(); ++i)
+		{
+			if (spheres[i].material >= mMaterials.size())
+			{
+				throw std::invalid_argument("CompactSphereBvh: material index out of range");
+			}
+
+			T r = std::abs(spheres[i].radius);
+			bounds[i] = Aabb<T>(spheres[i].center - Vec3<T>(r, r, r), spheres[i].center + Vec3<T>(r, r, r));
+		}
+
+		BvhBuilder<T> builder(bounds, maxLeafSize);
+		std::vector<Aabb<T>>().swap(bounds);
+		mNodes = std::move(builder.nodes());
+		mNodes.shrink_to_fit();
+		mSpheres.resize(spheres.size());
+
+		// Pad every leaf of several spheres by more than half a center step plus half a radius step,
+		// the furthest a rounded sphere can reach past its original bounds, and refit the interior
+		// nodes, whose children always follow them
+		for (std::size_t node = mNodes.size(); node-- > 0;)
+		{
+			BvhNode<T> &current = mNodes[node];
+
+			if (current.count > 1)
+			{
+				Vec3<T> extent = current.bounds.extent();
+				T margin = std::max(extent[X], std::max(extent[Y], extent[Z])) / T(32767);
+				Vec3<T> padding(margin, margin, margin);
+				current.bounds = Aabb<T>(current.bounds.lower() - padding, current.bounds.upper() + padding);
+			}
+			else if (current.count == 0)
+			{
+				current.bounds = mNodes[node + 1].bounds;
+				current.bounds.expand(mNodes[current.offset].bounds);
+			}
+		}
+
+		for (std::uint32_t node = 0; node < mNodes.size(); ++node)
+		{
+			const BvhNode<T> &leaf = mNodes[node];
+
+			if (leaf.count == 0)
+			{
+				continue;
+			}
+
+			mLeafFirsts.push_back(leaf.offset);
+			mLeafNodes.push_back(node);
+
+			Frame frame = frameOf(leaf.bounds);
+
+			for (std::uint32_t i = leaf.offset; i < leaf.offset + leaf.count; ++i)
+			{
+				const Primitive &sphere = spheres[builder.order()[i]];
+				QuantizedSphere &quantized = mSpheres[i];
+
+				for (int axis = X; axis <= Z; ++axis)
+				{
+					T q = frame.step[axis] > 0 ? (sphere.center[axis] - frame.lower[axis]) / frame.step[axis] : 0;
+					quantized.center[axis] = std::uint16_t(std::min(T(65534), std::max(T(0), std::round(q))));
+				}
+
+				// Keep small spheres from vanishing in large leaves
+				T r = std::abs(sphere.radius);
+				T q = frame.radiusStep > 0 ? std::round(r / frame.radiusStep) : 0;
+				q = r > 0 ? std::max(T(1), q) : T(0);
+				quantized.radius = std::uint16_t(std::min(T(65535), q));
+				quantized.material = std::uint16_t(sphere.material | (sphere.radius < 0 ? negativeRadius : 0));
+			}
+		}
+	}
+
+	/* static */
+	template<typename T>
+	typename CompactSphereBvh<T>::Frame CompactSphereBvh<T>::frameOf(const Aabb<T> &bounds)
+	{
+		Vec3<T> extent = bounds.extent();
+		T smallest = std::min(extent[X], std::min(extent[Y], extent[Z]));
+		// An even number of center steps puts code 32767 at the middle, so a leaf of one sphere
+		// decodes it exactly however large it is
+		return { bounds.lower(), extent / T(65534), T(0.5) * smallest / T(65535) };
+	}
+
+	/* static */
+	template<typename T>
+	void CompactSphereBvh<T>::decode(const Frame &frame, const QuantizedSphere &sphere, Vec3<T> &center, T &radius)
+	{
+		center = Vec3<T>(frame.lower[X] + sphere.center[X] * frame.step[X],
+			frame.lower[Y] + sphere.center[Y] * frame.step[Y],
+			frame.lower[Z] + sphere.center[Z] * frame.step[Z]);
+		radius = (sphere.material & negativeRadius ? -T(sphere.radius) : T(sphere.radius)) * frame.radiusStep;
+	}
+
+	/* static */
+	template<typename T>
+	T CompactSphereBvh<T>::intersect(const Ray<T> &ray, const Vec3<T> &center, T radius, T tMin, T tMax)
+	{
+		countIntersectionTests();
+		Vec3<T> oc = ray.origin() - center;
+
+		T a = ray.direction().magnitudeSquared();
+		T b = 2 * dot(oc, ray.direction());
+		T c = oc.magnitudeSquared() - radius * radius;
+
+		T discriminant = b * b - 4 * a * c;
+
+		if (discriminant <= 0)
+		{
+			return tMax;
+		}
+
+		T sqrtDiscriminant = std::sqrt(discriminant);
+
+		for (T sign : {T(-1), T(1)})
+		{
+			T root = (-b + sign * sqrtDiscriminant) / (2 * a);
+
+			if (root < tMax && root > tMin)
+			{
+				return root;
+			}
+		}
+
+		return tMax;
+	}
+
+	template<typename T>
+	bool CompactSphereBvh<T>::closestHit(const Ray<T> &ray, T tMin, T tMax, HitRecord<T> &record) const
+	{
+		if (mSpheres.empty())
+		{
+			return false;
+		}
+
+		const Vec3<T> &origin = ray.origin();
+		Vec3<T> inverseDirection(1 / ray.direction()[X], 1 / ray.direction()[Y], 1 / ray.direction()[Z]);
+
+		std::uint32_t stack[128];
+		int stackSize = 0;
+		std::uint32_t node = 0;
+		bool hasHit = false;
+
+		while (true)
+		{
+			const BvhNode<T> &current = mNodes[node];
+
+			if (current.bounds.overlaps(origin, inverseDirection, tMin, tMax))
+			{
+				if (current.count > 0)
+				{
+					Frame frame = frameOf(current.bounds);
+
+					for (std::uint32_t i = current.offset; i < current.offset + current.count; ++i)
+					{
+						Vec3<T> center;
+						T radius;
+						decode(frame, mSpheres[i], center, radius);
+						T t = intersect(ray, center, radius, tMin, tMax);
+
+						if (t < tMax)
+						{
+							tMax = t;
+							record.t = t;
+							record.primitive = this;
+							record.index = i;
+							hasHit = true;
+						}
+					}
+				}
+				else
+				{
+					// Visit the child on the side the ray comes from first
+					if (ray.direction()[current.axis] < 0)
+					{
+						stack[stackSize++] = node + 1;
+						node = current.offset;
+					}
+					else
+					{
+						stack[stackSize++] = current.offset;
+						node = node + 1;
+					}
+
+					continue;
+				}
+			}
+
+			if (stackSize == 0)
+			{
+				break;
+			}
+
+			node = stack[--stackSize];
+		}
+
+		return hasHit;
+	}
+
+	template<typename T>
+	std::uint32_t CompactSphereBvh<T>::leafOf(std::uint32_t sphere) const
+	{
+		auto next = std::upper_bound(mLeafFirsts.begin(), mLeafFirsts.end(), sphere);
+		return mLeafNodes[std::size_t(next - mLeafFirsts.begin()) - 1];
+	}
+
+	template<typename T>
+	void CompactSphereBvh<T>::evaluate(const Ray<T> &ray, const HitRecord<T> &record, Intersection<T> &intersection) const
+	{
+		Vec3<T> center;
+		T radius;
+		const QuantizedSphere &sphere = mSpheres[record.index];
+		decode(frameOf(mNodes[leafOf(record.index)].bounds), sphere, center, radius);
+
+		intersection.t = record.t;
+		intersection.p = ray.pointAtParameter(record.t);
+		intersection.normal = (intersection.p - center) / radius;
+		std::uint16_t material = std::uint16_t(sphere.material & ~negativeRadius);
+		intersection.material = mMaterials[material];
+		intersection.materialIndex = material;
+	}
+
+	template<typename T>
+	bool CompactSphereBvh<T>::occluded(const Ray<T> &ray, T tMin, T tMax) const
+	{
+		if (mSpheres.empty())
+		{
+			return false;
+		}
+
+		const Vec3<T> &origin = ray.origin();
+		Vec3<T> inverseDirection(1 / ray.direction()[X], 1 / ray.direction()[Y], 1 / ray.direction()[Z]);
+
+		std::uint32_t stack[128];
+		int stackSize = 0;
+		std::uint32_t node = 0;
+
+		while (true)
+		{
+			const BvhNode<T> &current = mNodes[node];
+
+			if (current.bounds.overlaps(origin, inverseDirection, tMin, tMax))
+			{
+				if (current.count == 0)
+				{
+					stack[stackSize++] = current.offset;
+					node = node + 1;
+					continue;
+				}
+
+				Frame frame = frameOf(current.bounds);
+
+				for (std::uint32_t i = current.offset; i < current.offset + current.count; ++i)
+				{
+					Vec3<T> center;
+					T radius;
+					decode(frame, mSpheres[i], center, radius);
+
+					if (intersect(ray, center, radius, tMin, tMax) < tMax)
+					{
+						return true;
+					}
+				}
+			}
+
+			if (stackSize == 0)
+			{
+				return false;
+			}
+
+			node = stack[--stackSize];
+		}
+	}
+
+	template<typename T>
+	Aabb<T> CompactSphereBvh<T>::boundingBox() const
+	{
+		return mNodes.empty() ? Aabb<T>() : mNodes.front().bounds;
+	}
+
+	template<typename T>
+	std::size_t CompactSphereBvh<T>::nodeCount() const
+	{
+		return mNodes.size();
+	}
+
+	template<typename T>
+	std::size_t CompactSphereBvh<T>::size() const
+	{
+		return mSpheres.size();
+	}
+
+	template<typename T>
+	std::size_t CompactSphereBvh<T>::memoryBytes() const
+	{
+		return mNodes.capacity() * sizeof(BvhNode<T>) + mSpheres.capacity() * sizeof(QuantizedSphere)
+			+ (mLeafFirsts.capacity() + mLeafNodes.capacity()) * sizeof(std::uint32_t);
+	}
+}
+
+#endif
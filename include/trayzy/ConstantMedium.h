@@ -0,0 +1,116 @@
+#ifndef TRAYZY_CONSTANTMEDIUM_H
+#define TRAYZY_CONSTANTMEDIUM_H
+
+#include "Hittable.h"
+#include "Intersection.h"
+#include "Random.h"
+#include "Ray.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+
+namespace trayzy
+{
+	/**
+	 * A volume of uniform density, such as fog or smoke, enclosed by a convex boundary.
+	 *
+	 * Free-flight distances are sampled analytically from the exponential distribution,
+	 * so a query costs two boundary tests regardless of how dense the medium is.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class ConstantMedium : public Hittable<T>
+	{
+	public:
+		/**
+		 * Creates a new constant medium.
+		 *
+		 * @param boundary The convex surface that encloses the medium
+		 * @param density The extinction coefficient per unit of distance
+		 * @param phase The phase function of the particles in the medium
+		 */
+		ConstantMedium(std::shared_ptr<Hittable<T>> boundary, T density,
+			std::shared_ptr<Material<T>> phase) :
+			mBoundary(boundary),
+			mPhase(phase),
+			mDensity(density)
+		{
+			// Do nothing more
+		}
+
+		// Hittable::closestHit
+		virtual bool closestHit(const Ray<T> &ray, T tMin, T tMax, HitRecord<T> &record) const override;
+
+		// Hittable::evaluate
+		virtual void evaluate(const Ray<T> &ray, const HitRecord<T> &record, Intersection<T> &intersection) const override;
+
+		// Hittable::boundingBox
+		virtual Aabb<T> boundingBox() const override;
+
+	private:
+		std::shared_ptr<Hittable<T>> mBoundary;
+		std::shared_ptr<Material<T>> mPhase;
+		T mDensity;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	bool ConstantMedium<T>::closestHit(const Ray<T> &ray, T tMin, T tMax, HitRecord<T> &record) const
+	{
+		HitRecord<T> entry;
+		HitRecord<T> exit;
+		T infinity = std::numeric_limits<T>::max();
+
+		// Find the boundary crossings along the whole line, since the ray may start inside
+		if (!mBoundary->closestHit(ray, -infinity, infinity, entry) ||
+			!mBoundary->closestHit(ray, entry.t + T(0.0001), infinity, exit))
+		{
+			return false;
+		}
+
+		T t0 = std::max(entry.t, tMin);
+		T t1 = std::min(exit.t, tMax);
+
+		if (t0 >= t1 || mDensity <= 0)
+		{
+			return false;
+		}
+
+		// The free-flight distance is exponentially distributed with the density as its rate
+		T distance = -std::log(1 - randomUniform<T>()) / (mDensity * ray.direction().magnitude());
+		T t = t0 + distance;
+
+		if (t >= t1)
+		{
+			return false;
+		}
+
+		record.t = t;
+		record.primitive = this;
+		return true;
+	}
+
+	template<typename T>
+	void ConstantMedium<T>::evaluate(const Ray<T> &ray, const HitRecord<T> &record, Intersection<T> &intersection) const
+	{
+		intersection.t = record.t;
+		intersection.p = ray.pointAtParameter(record.t);
+
+		// Any normal will do since the phase function ignores it
+		intersection.normal = Vec3<T>(1, 0, 0);
+		intersection.material = mPhase;
+	}
+
+	template<typename T>
+	Aabb<T> ConstantMedium<T>::boundingBox() const
+	{
+		return mBoundary->boundingBox();
+	}
+}
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef TRAYZY_DEPTHINTEGRATOR_H
+#define TRAYZY_DEPTHINTEGRATOR_H
+
+#include "HitRecord.h"
+#include "Integrator.h"
+
+#include <algorithm>
+
+namespace trayzy
+{
+	/**
+	 * Shows the distance to the first hit as a gray level, from white at the camera to black
+	 * at the maximum distance and beyond. Only the closest hit is searched for; no hit
+	 * attributes are evaluated.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class DepthIntegrator : public Integrator<T>
+	{
+	public:
+		/// Creates a depth preview that fades to black at the provided distance
+		explicit DepthIntegrator(T maxDistance = T(100)) :
+			mMaxDistance(maxDistance)
+		{
+			// Do nothing more
+		}
+
+		// Integrator::radiance
+		virtual Vec3<T> radiance(const Ray<T> &ray, const Hittable<T> &world) const override;
+
+	private:
+		T mMaxDistance;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	Vec3<T> DepthIntegrator<T>::radiance(const Ray<T> &ray, const Hittable<T> &world) const
+	{
+		// Stop the search at the maximum distance, past which every hit looks the same
+		T scale = ray.direction().magnitude();
+		HitRecord<T> record;
+
+		if (!world.closestHit(ray, T(0.001f), mMaxDistance / scale, record))
+		{
+			return Vec3<T>(0, 0, 0);
+		}
+
+		T gray = std::max(T(0), 1 - record.t * scale / mMaxDistance);
+		return Vec3<T>(gray, gray, gray);
+	}
+}
+
+#endif
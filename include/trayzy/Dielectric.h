@@ -1,7 +1,10 @@
 #ifndef TRAYZY_DIELECTRIC_H
 #define TRAYZY_DIELECTRIC_H
 
+#include "FastMath.h"
 #include "Intersection.h"
+#include "Material.h"
+#include "Random.h"
 #include "Ray.h"
 #include "Vec3.h"
 
@@ -77,7 +80,7 @@ namespace trayzy
 		if (isRefracted)
 		{
 			refracted = refractionRatio * (vNormalized - nNormalized * dt)
-				- nNormalized * std::sqrt(discriminant);
+				- nNormalized * Math<T>::sqrt(discriminant);
 		}
 
 		return isRefracted;
@@ -87,9 +90,9 @@ namespace trayzy
 	template<typename T>
 	T Dielectric<T>::schlick(T cosine, T refractionIndex)
 	{
-		T r0 = (1 - refractionIndex) / (1 - refractionIndex);
+		T r0 = (1 - refractionIndex) / (1 + refractionIndex);
 		r0 *= r0;
-		return r0 + (1 - r0) * std::pow(1 - cosine, 5);
+		return r0 + (1 - r0) * Math<T>::pow5(1 - cosine);
 	}
 
 	template<typename T>
@@ -127,12 +130,7 @@ namespace trayzy
 		if (refract(inbound.direction(), outwardNormal, refractionRatio, refracted))
 		{
 			T reflectionProbability = schlick(cosine, mRefractionIndex);
-
-			std::random_device rd;
-			std::default_random_engine engine(rd());
-			std::uniform_real_distribution<T> distribution(0, 1);
-
-			isReflected = (distribution(engine) < reflectionProbability);
+			isReflected = (randomUniform<T>() < reflectionProbability);
 		}
 
 		scattered = Ray<T>(intersection.p, isReflected ? reflected : refracted);
@@ -0,0 +1,60 @@
+#ifndef TRAYZY_DIFFUSELIGHT_H
+#define TRAYZY_DIFFUSELIGHT_H
+
+#include "Intersection.h"
+#include "Material.h"
+#include "Ray.h"
+#include "Vec3.h"
+
+namespace trayzy
+{
+	/// A material that emits the same radiance in every direction and scatters nothing
+	template<typename T>
+	class DiffuseLight : public Material<T>
+	{
+	public:
+		/// Creates a new light with the provided emitted radiance
+		DiffuseLight(const Vec3<T> &emission = Vec3<T>(1, 1, 1)) :
+			mEmission(emission)
+		{
+			// Do nothing more
+		}
+
+		// Material::scatter
+		virtual bool scatter(const Ray<T> &inbound, const Intersection<T> &intersection,
+			Vec3<T> &attenuation, Ray<T> &scattered) const override;
+
+		// Material::emitted
+		virtual Vec3<T> emitted(const Intersection<T> &intersection) const override;
+
+		/// Returns the emitted radiance
+		inline const Vec3<T> &emission() const;
+
+	private:
+		Vec3<T> mEmission;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	bool DiffuseLight<T>::scatter(const Ray<T> &inbound, const Intersection<T> &intersection,
+		Vec3<T> &attenuation, Ray<T> &scattered) const
+	{
+		return false;
+	}
+
+	template<typename T>
+	Vec3<T> DiffuseLight<T>::emitted(const Intersection<T> &intersection) const
+	{
+		return mEmission;
+	}
+
+	template<typename T>
+	const Vec3<T> &DiffuseLight<T>::emission() const
+	{
+		return mEmission;
+	}
+}
+
+#endif
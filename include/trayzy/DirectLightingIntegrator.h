@@ -0,0 +1,118 @@
+#ifndef TRAYZY_DIRECTLIGHTINGINTEGRATOR_H
+#define TRAYZY_DIRECTLIGHTINGINTEGRATOR_H
+
+#include "Integrator.h"
+#include "Intersection.h"
+#include "LightSampler.h"
+#include "Material.h"
+#include "PathTracer.h"
+#include "UniformLightSampler.h"
+
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace trayzy
+{
+	/**
+	 * Computes only the light that reaches a diffuse surface straight from its source.
+	 *
+	 * At every diffuse hit one light is sampled and a single scattered ray is checked for
+	 * the sky; light that bounces off other diffuse surfaces is ignored. Discrete
+	 * reflections and refractions are followed up to a fixed depth so that glass and
+	 * mirrors still show what lies behind them.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class DirectLightingIntegrator : public Integrator<T>
+	{
+	public:
+		/**
+		 * Creates a direct lighting preview.
+		 *
+		 * @param lights The lights to sample, or null to light the scene with the sky alone
+		 * @param maxSpecularDepth The number of discrete reflections and refractions followed
+		 */
+		explicit DirectLightingIntegrator(std::shared_ptr<const LightSampler<T>> lights = nullptr,
+			int maxSpecularDepth = 8) :
+			mLights(lights ? std::move(lights) : std::make_shared<UniformLightSampler<T>>(std::vector<Light<T>>())),
+			mMaxSpecularDepth(maxSpecularDepth)
+		{
+			// Do nothing more
+		}
+
+		// Integrator::radiance
+		virtual Vec3<T> radiance(const Ray<T> &ray, const Hittable<T> &world) const override;
+
+	private:
+		/// Computes the direct light seen along a ray after the provided number of discrete bounces
+		Vec3<T> trace(const Ray<T> &ray, const Hittable<T> &world, int depth) const;
+
+	private:
+		std::shared_ptr<const LightSampler<T>> mLights;
+		int mMaxSpecularDepth;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	Vec3<T> DirectLightingIntegrator<T>::radiance(const Ray<T> &ray, const Hittable<T> &world) const
+	{
+		return trace(ray, world, 0);
+	}
+
+	template<typename T>
+	Vec3<T> DirectLightingIntegrator<T>::trace(const Ray<T> &ray, const Hittable<T> &world, int depth) const
+	{
+		Intersection<T> intersection;
+		T hitEpsilon(0.001f);
+
+		if (!world.hit(ray, hitEpsilon, std::numeric_limits<T>::max(), intersection))
+		{
+			return background(ray);
+		}
+
+		if (!intersection.material)
+		{
+			return Vec3<T>(0, 0, 0);
+		}
+
+		Vec3<T> c = intersection.material->emitted(intersection);
+		Vec3<T> direct;
+		Vec3<T> f;
+
+		// Materials with a BRDF are diffuse, and the rest only scatter into discrete directions
+		Vec3<T> n = dot(intersection.normal, ray.direction()) < 0 ? intersection.normal : -intersection.normal;
+		bool diffuse = intersection.material->brdf(ray, intersection, n, f);
+		sampleDirect(world, *mLights, ray, intersection, direct);
+		c += direct;
+
+		Ray<T> scattered;
+		Vec3<T> attenuation;
+
+		if (!intersection.material->scatter(ray, intersection, attenuation, scattered))
+		{
+			return c;
+		}
+
+		if (diffuse)
+		{
+			// Emitters along the scattered ray are left to light sampling, which leaves only the sky
+			if (!world.occluded(scattered, hitEpsilon, std::numeric_limits<T>::max()))
+			{
+				c += attenuation * background(scattered);
+			}
+		}
+		else if (depth < mMaxSpecularDepth)
+		{
+			c += attenuation * trace(scattered, world, depth + 1);
+		}
+
+		return c;
+	}
+}
+
+#endif
@@ -0,0 +1,700 @@
+#ifndef TRAYZY_DYNAMICBVH_H
+#define TRAYZY_DYNAMICBVH_H
+
+#include "Aabb.h"
+#include "BvhBuilder.h"
+#include "Hittable.h"
+#include "HitRecord.h"
+#include "Intersection.h"
+#include "Ray.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace trayzy
+{
+	/**
+	 * A bounding volume hierarchy that is edited in place, for scenes that change between
+	 * frames.
+	 *
+	 * Every item sits in a leaf of its own. Inserting walks down from the root toward the
+	 * sibling that grows the tree's surface area least, removing splices the leaf's parent
+	 * out, and both refit the bounds of the ancestors on the way back up, rotating subtrees
+	 * wherever that lowers their surface area. An edit therefore touches one path of the
+	 * tree rather than all of it, and the tree keeps most of the quality of the initial
+	 * top-down build.
+	 *
+	 * Leaves may be enlarged by a margin, so that items moving by less than the margin only
+	 * replace their pointer. Edits must not overlap with traversals.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class DynamicBvh : public Hittable<T>
+	{
+	public:
+		/// Identifies an item for as long as it stays in the hierarchy
+		using Handle = std::uint32_t;
+
+		/**
+		 * Builds a hierarchy over the provided items with the binned surface area heuristic.
+		 * The item at each index of the collection gets that index as its handle.
+		 *
+		 * @param hittables The items to organize, which the hierarchy takes ownership of
+		 * @param margin The distance each leaf extends beyond its item
+		 */
+		explicit DynamicBvh(std::vector<std::shared_ptr<Hittable<T>>> hittables = {}, T margin = 0);
+
+		/**
+		 * Adds an item.
+		 *
+		 * @param hittable The item, which the hierarchy takes ownership of
+		 * @return The handle of the item
+		 */
+		Handle insert(std::shared_ptr<Hittable<T>> hittable);
+
+		/**
+		 * Removes an item. Its handle may be given to an item inserted later.
+		 *
+		 * @param handle The handle of the item
+		 */
+		void remove(Handle handle);
+
+		/**
+		 * Puts another item in an item's place, such as a moved copy of it, and updates
+		 * the hierarchy for its bounds.
+		 *
+		 * @param handle The handle of the item to replace, which the new item keeps
+		 * @param hittable The new item, which the hierarchy takes ownership of
+		 */
+		void replace(Handle handle, std::shared_ptr<Hittable<T>> hittable);
+
+		/**
+		 * Updates the hierarchy after an item changed its bounds in place. Items still within
+		 * their leaf cost nothing; others are removed and inserted again.
+		 *
+		 * @param handle The handle of the item
+		 */
+		void update(Handle handle);
+
+		/// Returns the item with the provided handle
+		inline const std::shared_ptr<Hittable<T>> &item(Handle handle) const;
+
+		// Hittable::closestHit
+		virtual bool closestHit(const Ray<T> &ray, T tMin, T tMax, HitRecord<T> &record) const override;
+
+		// Hittable::evaluate
+		virtual void evaluate(const Ray<T> &ray, const HitRecord<T> &record, Intersection<T> &intersection) const override;
+
+		/**
+		 * @copydoc Hittable::occluded
+		 *
+		 * Traversal returns at the first item hit, without ordering the children.
+		 */
+		virtual bool occluded(const Ray<T> &ray, T tMin, T tMax) const override;
+
+		// Hittable::boundingBox
+		virtual Aabb<T> boundingBox() const override;
+
+		/// Returns the number of items in the hierarchy
+		inline std::size_t size() const;
+
+		/// Returns the number of nodes in the hierarchy
+		inline std::size_t nodeCount() const;
+
+		/// Returns the number of levels below the root
+		std::size_t depth() const;
+
+		/// Returns the bytes used by the nodes and the item pointers, excluding the items themselves
+		inline std::size_t memoryBytes() const;
+
+	private:
+		/// A node of the tree, stored by index so that edits never move other nodes
+		struct Node
+		{
+			/// The bounds of everything below this node
+			Aabb<T> bounds;
+
+			/// The parent node, or none for the root
+			std::uint32_t parent;
+
+			/// The left child, or the handle of the item for leaves
+			std::uint32_t left;
+
+			/// The right child, or none for leaves
+			std::uint32_t right;
+
+			/// Returns whether this node is a leaf
+			inline bool isLeaf() const
+			{
+				return right == none;
+			}
+		};
+
+		/// The nodes a traversal has deferred, held on the traversing call's frame so that a tree
+		/// nested as an item of another never disturbs the outer traversal, and spilling to the
+		/// heap only in trees that edits have left deeper than the fixed part
+		class TraversalStack
+		{
+		public:
+			inline bool empty() const
+			{
+				return mSize == 0;
+			}
+
+			inline void push(std::uint32_t node)
+			{
+				if (mSize < fixedSize)
+				{
+					mFixed[mSize] = node;
+				}
+				else
+				{
+					mSpill.push_back(node);
+				}
+
+				++mSize;
+			}
+
+			inline std::uint32_t pop()
+			{
+				if (--mSize < fixedSize)
+				{
+					return mFixed[mSize];
+				}
+
+				std::uint32_t node = mSpill.back();
+				mSpill.pop_back();
+				return node;
+			}
+
+		private:
+			static constexpr std::size_t fixedSize = 64;
+
+			std::uint32_t mFixed[fixedSize];
+			std::vector<std::uint32_t> mSpill;
+			std::size_t mSize = 0;
+		};
+
+		/// Returns an unused node
+		std::uint32_t allocateNode();
+
+		/// Puts a leaf into the tree next to the sibling that grows it least
+		void insertLeaf(std::uint32_t leaf);
+
+		/// Takes a leaf out of the tree without freeing it
+		void removeLeaf(std::uint32_t leaf);
+
+		/// Recomputes the bounds of a node and its ancestors, rotating subtrees on the way
+		void refit(std::uint32_t node);
+
+		/// Swaps a grandchild with its uncle at an interior node, if that lowers the area below it
+		void rotate(std::uint32_t node);
+
+		/// Returns the bounds of an item's leaf
+		inline Aabb<T> leafBounds(const Hittable<T> &hittable) const;
+
+		/// Returns the surface area of a box
+		static inline T surfaceArea(const Aabb<T> &box);
+
+		/// Returns the smallest box containing two boxes
+		static inline Aabb<T> merge(const Aabb<T> &a, const Aabb<T> &b);
+
+	private:
+		static constexpr std::uint32_t none = 0xFFFFFFFF;
+
+		std::vector<Node> mNodes;
+		std::vector<std::uint32_t> mFreeNodes;
+		std::vector<std::shared_ptr<Hittable<T>>> mItems;
+		std::vector<std::uint32_t> mItemLeaves;
+		std::vector<Handle> mFreeHandles;
+		std::uint32_t mRoot = none;
+		std::size_t mSize = 0;
+		T mMargin;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	DynamicBvh<T>::DynamicBvh(std::vector<std::shared_ptr<Hittable<T>>> hittables, T margin) :
+		mItems(std::move(hittables)),
+		mItemLeaves(mItems.size()),
+		mSize(mItems.size()),
+		mMargin(margin)
+	{
+		if (mItems.empty())
+		{
+			return;
+		}
+
+		std::vector<Aabb<T>> bounds(mItems.size());
+
+		for (std::size_t i = 0; i < mItems.size(); ++i)
+		{
+			bounds[i] = leafBounds(*mItems[i]);
+		}
+
+		// Single-item leaves from the builder become the leaves of the tree, at the same indices
+		BvhBuilder<T> builder(bounds, 1);
+		const std::vector<BvhNode<T>> &built = builder.nodes();
+		mNodes.resize(built.size());
+		mRoot = 0;
+		mNodes[0].parent = none;
+
+		for (std::uint32_t i = 0; i < built.size(); ++i)
+		{
+			Node &node = mNodes[i];
+			node.bounds = built[i].bounds;
+
+			if (built[i].count > 0)
+			{
+				Handle handle = builder.order()[built[i].offset];
+				node.left = handle;
+				node.right = none;
+				mItemLeaves[handle] = i;
+			}
+			else
+			{
+				node.left = i + 1;
+				node.right = built[i].offset;
+				mNodes[node.left].parent = i;
+				mNodes[node.right].parent = i;
+			}
+		}
+	}
+
+	template<typename T>
+	typename DynamicBvh<T>::Handle DynamicBvh<T>::insert(std::shared_ptr<Hittable<T>> hittable)
+	{
+		Handle handle;
+
+		if (mFreeHandles.empty())
+		{
+			handle = Handle(mItems.size());
+			mItems.push_back(nullptr);
+			mItemLeaves.push_back(none);
+		}
+		else
+		{
+			handle = mFreeHandles.back();
+			mFreeHandles.pop_back();
+		}
+
+		std::uint32_t leaf = allocateNode();
+		mNodes[leaf].bounds = leafBounds(*hittable);
+		mNodes[leaf].left = handle;
+		mNodes[leaf].right = none;
+		mItems[handle] = std::move(hittable);
+		mItemLeaves[handle] = leaf;
+		insertLeaf(leaf);
+		++mSize;
+		return handle;
+	}
+
+	template<typename T>
+	void DynamicBvh<T>::remove(Handle handle)
+	{
+		std::uint32_t leaf = mItemLeaves[handle];
+		removeLeaf(leaf);
+		mFreeNodes.push_back(leaf);
+		mItems[handle] = nullptr;
+		mItemLeaves[handle] = none;
+		mFreeHandles.push_back(handle);
+		--mSize;
+	}
+
+	template<typename T>
+	void DynamicBvh<T>::replace(Handle handle, std::shared_ptr<Hittable<T>> hittable)
+	{
+		mItems[handle] = std::move(hittable);
+		update(handle);
+	}
+
+	template<typename T>
+	void DynamicBvh<T>::update(Handle handle)
+	{
+		std::uint32_t leaf = mItemLeaves[handle];
+		Aabb<T> box = mItems[handle]->boundingBox();
+
+		if (mNodes[leaf].bounds.contains(box))
+		{
+			return;
+		}
+
+		removeLeaf(leaf);
+		mNodes[leaf].bounds = leafBounds(*mItems[handle]);
+		insertLeaf(leaf);
+	}
+
+	template<typename T>
+	const std::shared_ptr<Hittable<T>> &DynamicBvh<T>::item(Handle handle) const
+	{
+		return mItems[handle];
+	}
+
+	template<typename T>
+	std::uint32_t DynamicBvh<T>::allocateNode()
+	{
+		if (mFreeNodes.empty())
+		{
+			mNodes.emplace_back();
+			return std::uint32_t(mNodes.size() - 1);
+		}
+
+		std::uint32_t node = mFreeNodes.back();
+		mFreeNodes.pop_back();
+		return node;
+	}
+
+	template<typename T>
+	void DynamicBvh<T>::insertLeaf(std::uint32_t leaf)
+	{
+		if (mRoot == none)
+		{
+			mRoot = leaf;
+			mNodes[leaf].parent = none;
+			return;
+		}
+
+		// Descend while pushing the leaf further down costs less than pairing it here
+		const Aabb<T> box = mNodes[leaf].bounds;
+		std::uint32_t sibling = mRoot;
+
+		while (!mNodes[sibling].isLeaf())
+		{
+			const Node &node = mNodes[sibling];
+			T area = surfaceArea(node.bounds);
+			T combinedArea = surfaceArea(merge(node.bounds, box));
+
+			// Pairing here adds a parent over everything below; going deeper still grows this node
+			T cost = 2 * combinedArea;
+			T inheritance = 2 * (combinedArea - area);
+			T childCost[2];
+			std::uint32_t children[2] = { node.left, node.right };
+
+			for (int i = 0; i < 2; ++i)
+			{
+				const Node &child = mNodes[children[i]];
+				T merged = surfaceArea(merge(child.bounds, box));
+				childCost[i] = (child.isLeaf() ? merged : merged - surfaceArea(child.bounds)) + inheritance;
+			}
+
+			if (cost < childCost[0] && cost < childCost[1])
+			{
+				break;
+			}
+
+			sibling = childCost[0] < childCost[1] ? children[0] : children[1];
+		}
+
+		std::uint32_t oldParent = mNodes[sibling].parent;
+		std::uint32_t parent = allocateNode();
+		mNodes[parent].parent = oldParent;
+		mNodes[parent].left = sibling;
+		mNodes[parent].right = leaf;
+		mNodes[parent].bounds = merge(box, mNodes[sibling].bounds);
+		mNodes[sibling].parent = parent;
+		mNodes[leaf].parent = parent;
+
+		if (oldParent == none)
+		{
+			mRoot = parent;
+		}
+		else if (mNodes[oldParent].left == sibling)
+		{
+			mNodes[oldParent].left = parent;
+		}
+		else
+		{
+			mNodes[oldParent].right = parent;
+		}
+
+		refit(oldParent);
+	}
+
+	template<typename T>
+	void DynamicBvh<T>::removeLeaf(std::uint32_t leaf)
+	{
+		if (leaf == mRoot)
+		{
+			mRoot = none;
+			return;
+		}
+
+		// The sibling takes the place of the parent
+		std::uint32_t parent = mNodes[leaf].parent;
+		std::uint32_t grandparent = mNodes[parent].parent;
+		std::uint32_t sibling = mNodes[parent].left == leaf ? mNodes[parent].right : mNodes[parent].left;
+		mNodes[sibling].parent = grandparent;
+		mFreeNodes.push_back(parent);
+
+		if (grandparent == none)
+		{
+			mRoot = sibling;
+			return;
+		}
+
+		if (mNodes[grandparent].left == parent)
+		{
+			mNodes[grandparent].left = sibling;
+		}
+		else
+		{
+			mNodes[grandparent].right = sibling;
+		}
+
+		refit(grandparent);
+	}
+
+	template<typename T>
+	void DynamicBvh<T>::refit(std::uint32_t node)
+	{
+		for (; node != none; node = mNodes[node].parent)
+		{
+			rotate(node);
+			mNodes[node].bounds = merge(mNodes[mNodes[node].left].bounds, mNodes[mNodes[node].right].bounds);
+		}
+	}
+
+	template<typename T>
+	void DynamicBvh<T>::rotate(std::uint32_t node)
+	{
+		// Consider swapping either child with either child of the other, keeping the best
+		std::uint32_t children[2] = { mNodes[node].left, mNodes[node].right };
+		T bestGain = 0;
+		int bestChild = -1;
+		int bestGrandchild = -1;
+
+		for (int c = 0; c < 2; ++c)
+		{
+			const Node &child = mNodes[children[c]];
+			const Node &uncle = mNodes[children[1 - c]];
+
+			if (child.isLeaf())
+			{
+				continue;
+			}
+
+			T area = surfaceArea(child.bounds);
+			std::uint32_t grandchildren[2] = { child.left, child.right };
+
+			for (int g = 0; g < 2; ++g)
+			{
+				// The uncle moves down beside the grandchild that stays
+				T gain = area - surfaceArea(merge(uncle.bounds, mNodes[grandchildren[1 - g]].bounds));
+
+				if (gain > bestGain)
+				{
+					bestGain = gain;
+					bestChild = c;
+					bestGrandchild = g;
+				}
+			}
+		}
+
+		if (bestChild < 0)
+		{
+			return;
+		}
+
+		std::uint32_t child = children[bestChild];
+		std::uint32_t uncle = children[1 - bestChild];
+		std::uint32_t grandchild = bestGrandchild == 0 ? mNodes[child].left : mNodes[child].right;
+
+		// The grandchild moves up into the uncle's place and the uncle into the grandchild's
+		(bestChild == 0 ? mNodes[node].right : mNodes[node].left) = grandchild;
+		mNodes[grandchild].parent = node;
+		(bestGrandchild == 0 ? mNodes[child].left : mNodes[child].right) = uncle;
+		mNodes[uncle].parent = child;
+		mNodes[child].bounds = merge(mNodes[mNodes[child].left].bounds, mNodes[mNodes[child].right].bounds);
+	}
+
+	template<typename T>
+	bool DynamicBvh<T>::closestHit(const Ray<T> &ray, T tMin, T tMax, HitRecord<T> &record) const
+	{
+		if (mRoot == none)
+		{
+			return false;
+		}
+
+		const Vec3<T> &origin = ray.origin();
+		Vec3<T> inverseDirection(1 / ray.direction()[X], 1 / ray.direction()[Y], 1 / ray.direction()[Z]);
+
+		TraversalStack stack;
+		bool hasHit = false;
+		std::uint32_t node = mRoot;
+		T tEntry;
+
+		if (!mNodes[node].bounds.overlaps(origin, inverseDirection, tMin, tMax, tEntry))
+		{
+			return false;
+		}
+
+		while (true)
+		{
+			const Node &current = mNodes[node];
+
+			if (current.isLeaf())
+			{
+				if (mItems[current.left]->closestHit(ray, tMin, tMax, record))
+				{
+					tMax = record.t;
+					hasHit = true;
+				}
+			}
+			else
+			{
+				// Visit the child the ray enters first, and skip children it misses
+				T tLeft, tRight;
+				bool hitLeft = mNodes[current.left].bounds.overlaps(origin, inverseDirection, tMin, tMax, tLeft);
+				bool hitRight = mNodes[current.right].bounds.overlaps(origin, inverseDirection, tMin, tMax, tRight);
+
+				if (hitLeft && hitRight)
+				{
+					bool leftFirst = tLeft <= tRight;
+					stack.push(leftFirst ? current.right : current.left);
+					node = leftFirst ? current.left : current.right;
+					continue;
+				}
+				else if (hitLeft || hitRight)
+				{
+					node = hitLeft ? current.left : current.right;
+					continue;
+				}
+			}
+
+			// Skip deferred nodes that lie beyond the closest hit found since
+			do
+			{
+				if (stack.empty())
+				{
+					return hasHit;
+				}
+
+				node = stack.pop();
+			} while (!mNodes[node].bounds.overlaps(origin, inverseDirection, tMin, tMax));
+		}
+	}
+
+	template<typename T>
+	void DynamicBvh<T>::evaluate(const Ray<T> &ray, const HitRecord<T> &record, Intersection<T> &intersection) const
+	{
+		record.primitive->evaluate(ray, record, intersection);
+	}
+
+	template<typename T>
+	bool DynamicBvh<T>::occluded(const Ray<T> &ray, T tMin, T tMax) const
+	{
+		if (mRoot == none)
+		{
+			return false;
+		}
+
+		const Vec3<T> &origin = ray.origin();
+		Vec3<T> inverseDirection(1 / ray.direction()[X], 1 / ray.direction()[Y], 1 / ray.direction()[Z]);
+
+		TraversalStack stack;
+		stack.push(mRoot);
+
+		while (!stack.empty())
+		{
+			const Node &current = mNodes[stack.pop()];
+
+			if (!current.bounds.overlaps(origin, inverseDirection, tMin, tMax))
+			{
+				continue;
+			}
+
+			if (current.isLeaf())
+			{
+				if (mItems[current.left]->occluded(ray, tMin, tMax))
+				{
+					return true;
+				}
+			}
+			else
+			{
+				stack.push(current.right);
+				stack.push(current.left);
+			}
+		}
+
+		return false;
+	}
+
+	template<typename T>
+	Aabb<T> DynamicBvh<T>::boundingBox() const
+	{
+		return mRoot == none ? Aabb<T>() : mNodes[mRoot].bounds;
+	}
+
+	template<typename T>
+	std::size_t DynamicBvh<T>::size() const
+	{
+		return mSize;
+	}
+
+	template<typename T>
+	std::size_t DynamicBvh<T>::nodeCount() const
+	{
+		return mNodes.size() - mFreeNodes.size();
+	}
+
+	template<typename T>
+	std::size_t DynamicBvh<T>::depth() const
+	{
+		std::size_t result = 0;
+
+		for (Handle handle = 0; handle < mItemLeaves.size(); ++handle)
+		{
+			std::size_t levels = 0;
+
+			for (std::uint32_t node = mItemLeaves[handle]; node != none && node != mRoot; node = mNodes[node].parent)
+			{
+				++levels;
+			}
+
+			result = std::max(result, levels);
+		}
+
+		return result;
+	}
+
+	template<typename T>
+	std::size_t DynamicBvh<T>::memoryBytes() const
+	{
+		return mNodes.capacity() * sizeof(Node) + mItems.capacity() * sizeof(std::shared_ptr<Hittable<T>>)
+			+ (mItemLeaves.capacity() + mFreeNodes.capacity() + mFreeHandles.capacity()) * sizeof(std::uint32_t);
+	}
+
+	template<typename T>
+	Aabb<T> DynamicBvh<T>::leafBounds(const Hittable<T> &hittable) const
+	{
+		Aabb<T> box = hittable.boundingBox();
+		Vec3<T> margin(mMargin, mMargin, mMargin);
+		return Aabb<T>(box.lower() - margin, box.upper() + margin);
+	}
+
+	/* static */
+	template<typename T>
+	T DynamicBvh<T>::surfaceArea(const Aabb<T> &box)
+	{
+		Vec3<T> extent = box.extent();
+		return 2 * (extent[X] * extent[Y] + extent[Y] * extent[Z] + extent[Z] * extent[X]);
+	}
+
+	/* static */
+	template<typename T>
+	Aabb<T> DynamicBvh<T>::merge(const Aabb<T> &a, const Aabb<T> &b)
+	{
+		Aabb<T> box = a;
+		return box.expand(b);
+	}
+}
+
+#endif
@@ -0,0 +1,196 @@
+#ifndef TRAYZY_ENVIRONMENTLIGHT_H
+#define TRAYZY_ENVIRONMENTLIGHT_H
+
+#include "AliasTable.h"
+#include "Image.h"
+#include "Vec3.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace trayzy
+{
+	/**
+	 * Light arriving from infinitely far away, looked up in an equirectangular image of
+	 * linear radiance.
+	 *
+	 * Columns span the azimuth around the +Y axis, starting from +X and turning toward +Z,
+	 * so that -X lies in the middle column, and rows span the polar angle from straight down
+	 * at row 0 to straight up at the top row. Each texel holds constant radiance over its
+	 * patch of directions.
+	 *
+	 * Directions are sampled in proportion to the texels' luminance times the solid angle
+	 * their patch subtends, through an alias table, so a small bright sun is found by most
+	 * samples at a constant cost per sample regardless of the image size. Within a texel,
+	 * directions are uniform in azimuth and in the cosine of the polar angle, which is
+	 * uniform over the patch's solid angle, so the density is constant over every texel.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class EnvironmentLight
+	{
+	public:
+		/**
+		 * Creates an environment light.
+		 *
+		 * @param image The radiance of every direction, in linear color
+		 * @param scale The factor every texel's radiance is multiplied by
+		 */
+		explicit EnvironmentLight(Image<T> image, T scale = T(1));
+
+		/// Returns the image of radiance, before scaling
+		inline const Image<T> &image() const;
+
+		/// Returns the radiance arriving from a direction, which need not be of unit length
+		Vec3<T> radiance(const Vec3<T> &direction) const;
+
+		/**
+		 * Samples a direction in proportion to the luminance arriving from it.
+		 *
+		 * @param u1 A uniform random number in [0, 1) that picks a bin of the alias table
+		 * @param u2 A uniform random number in [0, 1) that decides between the bin's texel and its alias
+		 * @param u3 A uniform random number in [0, 1) for the azimuth within the texel
+		 * @param u4 A uniform random number in [0, 1) for the polar angle within the texel
+		 * @param[out] direction The unit direction toward the light
+		 * @param[out] pdf The probability density of the direction over solid angle, which is
+		 *         zero if no direction could be sampled
+		 * @return The radiance arriving from the direction
+		 */
+		Vec3<T> sample(T u1, T u2, T u3, T u4, Vec3<T> &direction, T &pdf) const;
+
+		/// Returns the probability density over solid angle with which sample() picks a direction
+		T pdf(const Vec3<T> &direction) const;
+
+	private:
+		/// Returns the column and row of the texel a direction falls in
+		void texel(const Vec3<T> &direction, int &col, int &row) const;
+
+		/// Returns the relative luminance of a linear color
+		static inline T luminance(const Vec3<T> &c);
+
+	private:
+		Image<T> mImage;
+		T mScale;
+
+		/// The cosine of the polar angle at the bottom edge of every row and the top edge of the last
+		std::vector<T> mCosines;
+
+		/// The solid angle of a texel in every row
+		std::vector<T> mSolidAngles;
+
+		AliasTable<T> mTable;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	EnvironmentLight<T>::EnvironmentLight(Image<T> image, T scale) :
+		mImage(std::move(image)),
+		mScale(scale)
+	{
+		int width = mImage.width();
+		int height = mImage.height();
+		std::vector<T> weights(std::size_t(width) * height);
+
+		for (int row = 0; row <= height; ++row)
+		{
+			mCosines.push_back(std::cos(T(M_PI) * row / height));
+		}
+
+		// Rows near the poles cover less of the sphere
+		for (int row = 0; row < height; ++row)
+		{
+			mSolidAngles.push_back(2 * T(M_PI) / width * (mCosines[row] - mCosines[row + 1]));
+
+			for (int col = 0; col < width; ++col)
+			{
+				weights[std::size_t(row) * width + col] = luminance(mImage.at(col, row)) * mSolidAngles[row];
+			}
+		}
+
+		mTable = AliasTable<T>(weights);
+	}
+
+	template<typename T>
+	const Image<T> &EnvironmentLight<T>::image() const
+	{
+		return mImage;
+	}
+
+	/* static */
+	template<typename T>
+	T EnvironmentLight<T>::luminance(const Vec3<T> &c)
+	{
+		return std::max(T(0), T(0.2126) * c[R] + T(0.7152) * c[G] + T(0.0722) * c[B]);
+	}
+
+	template<typename T>
+	void EnvironmentLight<T>::texel(const Vec3<T> &direction, int &col, int &row) const
+	{
+		Vec3<T> d = unitVector(direction);
+		T u = (std::atan2(-d[Z], -d[X]) + T(M_PI)) / (2 * T(M_PI));
+		T v = std::acos(std::min(T(1), std::max(T(-1), -d[Y]))) / T(M_PI);
+
+		col = std::min(std::max(int(u * mImage.width()), 0), mImage.width() - 1);
+		row = std::min(std::max(int(v * mImage.height()), 0), mImage.height() - 1);
+	}
+
+	template<typename T>
+	Vec3<T> EnvironmentLight<T>::radiance(const Vec3<T> &direction) const
+	{
+		if (mTable.size() == 0)
+		{
+			return Vec3<T>(0, 0, 0);
+		}
+
+		int col, row;
+		texel(direction, col, row);
+		return mScale * mImage.at(col, row);
+	}
+
+	template<typename T>
+	Vec3<T> EnvironmentLight<T>::sample(T u1, T u2, T u3, T u4, Vec3<T> &direction, T &pdf) const
+	{
+		pdf = 0;
+
+		if (mTable.total() <= 0)
+		{
+			return Vec3<T>(0, 0, 0);
+		}
+
+		T probability = 0;
+		std::size_t i = mTable.sample(u1, u2, probability);
+		int width = mImage.width();
+		int col = int(i % std::size_t(width));
+		int row = int(i / std::size_t(width));
+
+		// Place the direction uniformly over the texel's patch, the inverse of texel()
+		T phi = 2 * T(M_PI) * (col + u3) / width - T(M_PI);
+		T cosTheta = mCosines[row] + u4 * (mCosines[row + 1] - mCosines[row]);
+		T sinTheta = std::sqrt(std::max(T(0), 1 - cosTheta * cosTheta));
+
+		direction = Vec3<T>(-sinTheta * std::cos(phi), -cosTheta, -sinTheta * std::sin(phi));
+		pdf = probability / mSolidAngles[row];
+		return mScale * mImage.at(col, row);
+	}
+
+	template<typename T>
+	T EnvironmentLight<T>::pdf(const Vec3<T> &direction) const
+	{
+		if (mTable.total() <= 0)
+		{
+			return 0;
+		}
+
+		int col, row;
+		texel(direction, col, row);
+		return mTable.probability(std::size_t(row) * mImage.width() + col) / mSolidAngles[row];
+	}
+}
+
+#endif
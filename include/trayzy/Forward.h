@@ -16,16 +16,60 @@ namespace trayzy
 // Forward declarations
 namespace trayzy
 {
+	template<typename T> class Aabb;
+	template<typename T> class AlbedoIntegrator;
+	template<typename T> class AliasTable;
+	template<typename T> class AmbientOcclusionIntegrator;
+	template<typename T> class BvhBuilder;
+	template<typename T> struct BvhNode;
 	template<typename T> class Camera;
+	template<typename T> class CompactSphereBvh;
+	template<typename T> class ConstantMedium;
+	template<typename T> class DepthIntegrator;
 	template<typename T> class Dielectric;
+	template<typename T> class DiffuseLight;
+	template<typename T> class DirectLightingIntegrator;
+	template<typename T> class DynamicBvh;
+	template<typename T> class EnvironmentLight;
+	template<typename T> struct ExactMath;
+	template<typename T> struct FastMath;
+	template<typename T> class GridMedium;
+	template<typename T> struct HitRecord;
 	template<typename T> class Hittable;
 	template<typename T> class HittableList;
+	template<typename T> class HybridRenderer;
+	template<typename T> class Integrator;
 	template<typename T> struct Intersection;
+	template<typename T> class Isotropic;
 	template<typename T> class Lambertian;
+	template<typename T> struct Light;
+	template<typename T> class LightBvh;
+	template<typename T> class LightSampler;
 	template<typename T> class Material;
 	template<typename T> class Metal;
+	template<typename T> class NoiseTexture;
+	template<typename T> class NormalIntegrator;
+	template<typename T> class OutOfCoreScene;
+	template<typename T> class PathIntegrator;
+	template<typename T> class Perlin;
+	template<typename T> class PhotonMap;
+	template<typename T> class PhotonMapIntegrator;
+	template<typename T> class ProgressiveRenderer;
+	template<typename T> struct ProgressiveResult;
+	template<typename T> class RadianceCache;
+	template<typename T> class RadianceCacheIntegrator;
 	template<typename T> class Ray;
+	template<typename T> struct RayBatch;
+	template<typename T> struct RenderCallbacks;
+	template<typename T> class Renderer;
+	template<typename T> class RenderJob;
 	template<typename T> class Sphere;
+	template<typename T> class SphereRasterizer;
+	template<typename T> class StaticScene;
+	template<typename T> struct TemporalFrame;
+	template<typename T> class TemporalRenderer;
+	template<typename T> class Texture;
+	template<typename T> class UniformLightSampler;
 	template<typename T> class Vec3;
 
 	using HittableListf = HittableList<float>;
@@ -0,0 +1,351 @@
+#ifndef TRAYZY_GRIDMEDIUM_H
+#define TRAYZY_GRIDMEDIUM_H
+
+#include "Aabb.h"
+#include "Hittable.h"
+#include "Intersection.h"
+#include "Random.h"
+#include "Ray.h"
+#include "RenderStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace trayzy
+{
+	/**
+	 * A volume of varying density, such as a smoke plume, sampled from a voxel grid.
+	 *
+	 * Collisions are found with delta tracking: tentative collisions are drawn against
+	 * a coarse grid of majorants (upper bounds of the density in each block of voxels)
+	 * and accepted with probability density / majorant. Walking the majorant grid keeps
+	 * the bounds tight and skips empty blocks outright, so the cost of a query stays
+	 * nearly flat as the medium gets denser instead of growing with its optical depth.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class GridMedium : public Hittable<T>
+	{
+	public:
+		/**
+		 * Creates a new grid medium.
+		 *
+		 * @param bounds The world-space box covered by the grid
+		 * @param resolution The number of voxels along each axis
+		 * @param densities The voxel densities, with the x index varying fastest
+		 * @param phase The phase function of the particles in the medium
+		 * @param majorantBlockSize The number of voxels along each side of a majorant cell;
+		 *        larger blocks skip empty space faster but loosen the bounds in dense regions
+		 */
+		GridMedium(const Aabb<T> &bounds, const Vec3<int> &resolution, std::vector<T> densities,
+			std::shared_ptr<Material<T>> phase, int majorantBlockSize = 2);
+
+		/**
+		 * Returns the trilinearly interpolated density at a location.
+		 *
+		 * @param p The world-space location, which must lie within the grid bounds
+		 * @return The extinction coefficient per unit of distance
+		 */
+		T density(const Vec3<T> &p) const;
+
+		/**
+		 * Estimates the fraction of light transmitted along a ray segment using ratio tracking.
+		 *
+		 * @param ray The ray to follow
+		 * @param tMin The minimum parametric coordinate value
+		 * @param tMax The maximum parametric coordinate value
+		 * @return An unbiased estimate of the transmittance
+		 */
+		T transmittance(const Ray<T> &ray, T tMin, T tMax) const;
+
+		/// Returns the world-space box covered by the grid
+		inline const Aabb<T> &bounds() const;
+
+		// Hittable::closestHit
+		virtual bool closestHit(const Ray<T> &ray, T tMin, T tMax, HitRecord<T> &record) const override;
+
+		// Hittable::evaluate
+		virtual void evaluate(const Ray<T> &ray, const HitRecord<T> &record, Intersection<T> &intersection) const override;
+
+		// Hittable::boundingBox
+		virtual Aabb<T> boundingBox() const override;
+
+	private:
+		/// Returns the density stored at a voxel, clamping indices to the grid
+		inline T voxel(int i, int j, int k) const;
+
+		/// Returns the majorant of the cell at the provided majorant grid indices
+		inline T majorant(const Vec3<int> &cell) const;
+
+		/**
+		 * Walks the majorant cells crossed by a ray segment, drawing tentative collisions in each.
+		 *
+		 * @param ray The ray to follow
+		 * @param tMin The minimum parametric coordinate value
+		 * @param tMax The maximum parametric coordinate value
+		 * @param visit Called with each tentative collision's parametric coordinate and majorant;
+		 *        returns false to stop the walk
+		 * @return Whether the walk was stopped by the visitor
+		 */
+		template<typename Visitor>
+		bool track(const Ray<T> &ray, T tMin, T tMax, Visitor visit) const;
+
+	private:
+		Aabb<T> mBounds;
+		Vec3<T> mVoxelSize;
+		Vec3<T> mCellSize;
+		Vec3<int> mResolution;
+		Vec3<int> mMajorantResolution;
+		std::vector<T> mDensities;
+		std::vector<T> mMajorants;
+		std::shared_ptr<Material<T>> mPhase;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	GridMedium<T>::GridMedium(const Aabb<T> &bounds, const Vec3<int> &resolution, std::vector<T> densities,
+		std::shared_ptr<Material<T>> phase, int majorantBlockSize) :
+		mBounds(bounds),
+		mResolution(resolution),
+		mDensities(std::move(densities)),
+		mPhase(phase)
+	{
+		if (std::size_t(resolution[X]) * resolution[Y] * resolution[Z] != mDensities.size())
+		{
+			throw std::invalid_argument("GridMedium: density count does not match the resolution");
+		}
+
+		for (int axis = X; axis <= Z; ++axis)
+		{
+			mMajorantResolution[axis] = (resolution[axis] + majorantBlockSize - 1) / majorantBlockSize;
+			mVoxelSize[axis] = bounds.extent()[axis] / resolution[axis];
+			mCellSize[axis] = mVoxelSize[axis] * majorantBlockSize;
+		}
+
+		mMajorants.assign(std::size_t(mMajorantResolution[X]) * mMajorantResolution[Y] * mMajorantResolution[Z], T());
+
+		// Trilinear lookups within a block read one voxel beyond it on each side
+		for (int ck = 0; ck < mMajorantResolution[Z]; ++ck)
+		{
+			for (int cj = 0; cj < mMajorantResolution[Y]; ++cj)
+			{
+				for (int ci = 0; ci < mMajorantResolution[X]; ++ci)
+				{
+					T &bound = mMajorants[(std::size_t(ck) * mMajorantResolution[Y] + cj) * mMajorantResolution[X] + ci];
+
+					for (int k = ck * majorantBlockSize - 1; k <= (ck + 1) * majorantBlockSize; ++k)
+					{
+						for (int j = cj * majorantBlockSize - 1; j <= (cj + 1) * majorantBlockSize; ++j)
+						{
+							for (int i = ci * majorantBlockSize - 1; i <= (ci + 1) * majorantBlockSize; ++i)
+							{
+								bound = std::max(bound, voxel(i, j, k));
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	template<typename T>
+	T GridMedium<T>::voxel(int i, int j, int k) const
+	{
+		i = std::min(std::max(i, 0), mResolution[X] - 1);
+		j = std::min(std::max(j, 0), mResolution[Y] - 1);
+		k = std::min(std::max(k, 0), mResolution[Z] - 1);
+		return mDensities[(std::size_t(k) * mResolution[Y] + j) * mResolution[X] + i];
+	}
+
+	template<typename T>
+	T GridMedium<T>::majorant(const Vec3<int> &cell) const
+	{
+		return mMajorants[(std::size_t(cell[Z]) * mMajorantResolution[Y] + cell[Y]) * mMajorantResolution[X] + cell[X]];
+	}
+
+	template<typename T>
+	const Aabb<T> &GridMedium<T>::bounds() const
+	{
+		return mBounds;
+	}
+
+	template<typename T>
+	T GridMedium<T>::density(const Vec3<T> &p) const
+	{
+		// Voxel values are located at voxel centers
+		Vec3<T> g = (p - mBounds.lower()) / mVoxelSize - T(0.5);
+		Vec3<T> base(std::floor(g[X]), std::floor(g[Y]), std::floor(g[Z]));
+		Vec3<T> f = g - base;
+
+		int i = int(base[X]);
+		int j = int(base[Y]);
+		int k = int(base[Z]);
+
+		T d00 = voxel(i, j, k) + f[X] * (voxel(i + 1, j, k) - voxel(i, j, k));
+		T d10 = voxel(i, j + 1, k) + f[X] * (voxel(i + 1, j + 1, k) - voxel(i, j + 1, k));
+		T d01 = voxel(i, j, k + 1) + f[X] * (voxel(i + 1, j, k + 1) - voxel(i, j, k + 1));
+		T d11 = voxel(i, j + 1, k + 1) + f[X] * (voxel(i + 1, j + 1, k + 1) - voxel(i, j + 1, k + 1));
+
+		T d0 = d00 + f[Y] * (d10 - d00);
+		T d1 = d01 + f[Y] * (d11 - d01);
+		return d0 + f[Z] * (d1 - d0);
+	}
+
+	template<typename T>
+	template<typename Visitor>
+	bool GridMedium<T>::track(const Ray<T> &ray, T tMin, T tMax, Visitor visit) const
+	{
+		T t0 = tMin;
+		T t1 = tMax;
+
+		if (!mBounds.clip(ray, t0, t1))
+		{
+			return false;
+		}
+
+		// Set up a 3D digital differential analyzer over the majorant grid
+		T speed = ray.direction().magnitude();
+		Vec3<T> entry = ray.pointAtParameter(t0);
+		Vec3<int> cell;
+		Vec3<int> step;
+		Vec3<T> tNext;
+		Vec3<T> tDelta;
+
+		for (int axis = X; axis <= Z; ++axis)
+		{
+			T d = ray.direction()[axis];
+			cell[axis] = int((entry[axis] - mBounds.lower()[axis]) / mCellSize[axis]);
+			cell[axis] = std::min(std::max(cell[axis], 0), mMajorantResolution[axis] - 1);
+
+			if (d > 0)
+			{
+				step[axis] = 1;
+				tNext[axis] = (mBounds.lower()[axis] + (cell[axis] + 1) * mCellSize[axis] - ray.origin()[axis]) / d;
+				tDelta[axis] = mCellSize[axis] / d;
+			}
+			else if (d < 0)
+			{
+				step[axis] = -1;
+				tNext[axis] = (mBounds.lower()[axis] + cell[axis] * mCellSize[axis] - ray.origin()[axis]) / d;
+				tDelta[axis] = -mCellSize[axis] / d;
+			}
+			else
+			{
+				step[axis] = 0;
+				tNext[axis] = std::numeric_limits<T>::max();
+				tDelta[axis] = std::numeric_limits<T>::max();
+			}
+		}
+
+		T t = t0;
+
+		while (true)
+		{
+			int axis = tNext[X] < tNext[Y] ? (tNext[X] < tNext[Z] ? X : Z) : (tNext[Y] < tNext[Z] ? Y : Z);
+			T tExit = std::min(tNext[axis], t1);
+			T bound = majorant(cell);
+
+			// Exponential distances are memoryless, so sampling restarts at each cell boundary
+			if (bound > 0)
+			{
+				while (true)
+				{
+					t -= std::log(1 - randomUniform<T>()) / (bound * speed);
+
+					if (t >= tExit)
+					{
+						break;
+					}
+
+					if (!visit(t, bound))
+					{
+						return true;
+					}
+				}
+			}
+
+			if (tExit >= t1)
+			{
+				return false;
+			}
+
+			t = tExit;
+			cell[axis] += step[axis];
+
+			if (cell[axis] < 0 || cell[axis] >= mMajorantResolution[axis])
+			{
+				return false;
+			}
+
+			tNext[axis] += tDelta[axis];
+		}
+	}
+
+	template<typename T>
+	T GridMedium<T>::transmittance(const Ray<T> &ray, T tMin, T tMax) const
+	{
+		T transmitted = 1;
+
+		track(ray, tMin, tMax, [&](T t, T bound)
+		{
+			transmitted *= 1 - density(ray.pointAtParameter(t)) / bound;
+			return transmitted > 0;
+		});
+
+		return transmitted;
+	}
+
+	template<typename T>
+	bool GridMedium<T>::closestHit(const Ray<T> &ray, T tMin, T tMax, HitRecord<T> &record) const
+	{
+		countIntersectionTests();
+		T tHit = T();
+
+		bool hasHit = track(ray, tMin, tMax, [&](T t, T bound)
+		{
+			// Accept the tentative collision as a real one with probability density / majorant
+			if (randomUniform<T>() * bound < density(ray.pointAtParameter(t)))
+			{
+				tHit = t;
+				return false;
+			}
+
+			return true;
+		});
+
+		if (hasHit)
+		{
+			record.t = tHit;
+			record.primitive = this;
+		}
+
+		return hasHit;
+	}
+
+	template<typename T>
+	void GridMedium<T>::evaluate(const Ray<T> &ray, const HitRecord<T> &record, Intersection<T> &intersection) const
+	{
+		intersection.t = record.t;
+		intersection.p = ray.pointAtParameter(record.t);
+
+		// Any normal will do since the phase function ignores it
+		intersection.normal = Vec3<T>(1, 0, 0);
+		intersection.material = mPhase;
+	}
+
+	template<typename T>
+	Aabb<T> GridMedium<T>::boundingBox() const
+	{
+		return mBounds;
+	}
+}
+
+#endif
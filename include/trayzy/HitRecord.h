@@ -0,0 +1,32 @@
+#ifndef TRAYZY_HITRECORD_H
+#define TRAYZY_HITRECORD_H
+
+#include "Forward.h"
+
+#include <cstdint>
+
+namespace trayzy
+{
+	/**
+	 * The minimal record kept while searching for the closest ray hit.
+	 *
+	 * Only the parametric coordinate and the identity of the primitive are kept;
+	 * the full Intersection is evaluated once the search has settled on a hit.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	struct HitRecord
+	{
+		/// The parametric coordinate of the hit
+		T t;
+
+		/// The primitive that was hit, which evaluates the hit's attributes
+		const Hittable<T> *primitive = nullptr;
+
+		/// An index the primitive may use to identify a sub-element, such as an item in a packed array
+		std::uint32_t index = 0;
+	};
+}
+
+#endif
@@ -1,19 +1,29 @@
 #ifndef TRAYZY_HITTABLE_H
 #define TRAYZY_HITTABLE_H
 
+#include "Aabb.h"
 #include "Forward.h"
+#include "HitRecord.h"
+#include "Intersection.h"
 
 namespace trayzy
 {
 	/**
 	 * An item that may be hit by a ray trace.
 	 * 
+	 * Intersection happens in two phases: closestHit() searches for the nearest hit
+	 * while recording only its parametric coordinate and primitive, then evaluate()
+	 * computes the location, normal and material of that single final hit. Work for
+	 * candidate hits that a closer one later replaces is never done.
+	 * 
 	 * @tparam T The coordinate data type
 	 */
 	template<typename T>
 	class Hittable
 	{
 	public:
+		virtual ~Hittable() = default;
+
 		/**
 		 * Determines if a ray hits this item within the provided parametric coordinate range.
 		 * 
@@ -23,8 +33,69 @@ namespace trayzy
 		 * @param[out] instersection The details about the ray hit
 		 * @return Whether the ray hit this item within the allowed parametric coordinate range
 		 */
-		virtual bool hit(const Ray<T> &ray, T tMin, T tMax, Intersection<T> &intersection) const = 0;
+		virtual bool hit(const Ray<T> &ray, T tMin, T tMax, Intersection<T> &intersection) const;
+
+		/**
+		 * Finds the closest hit within the provided parametric coordinate range
+		 * without evaluating its attributes.
+		 * 
+		 * @param ray The ray to test against this hittable item
+		 * @param tMin The minimum parametric coordinate value
+		 * @param tMax The maximum parametric coordinate value
+		 * @param[out] record The parametric coordinate and primitive of the hit
+		 * @return Whether the ray hit this item within the allowed parametric coordinate range
+		 */
+		virtual bool closestHit(const Ray<T> &ray, T tMin, T tMax, HitRecord<T> &record) const = 0;
+
+		/**
+		 * Evaluates the attributes of a hit found by closestHit().
+		 * 
+		 * @param ray The ray that produced the hit
+		 * @param record The hit record filled by closestHit()
+		 * @param[out] intersection The details about the ray hit
+		 */
+		virtual void evaluate(const Ray<T> &ray, const HitRecord<T> &record, Intersection<T> &intersection) const = 0;
+
+		/**
+		 * Determines whether anything blocks a ray within the provided parametric coordinate range.
+		 * 
+		 * Unlike closestHit(), the search may stop at the first hit it finds, in any order,
+		 * which makes this the cheaper query for shadow and visibility rays.
+		 * 
+		 * @param ray The ray to test against this hittable item
+		 * @param tMin The minimum parametric coordinate value
+		 * @param tMax The maximum parametric coordinate value
+		 * @return Whether the ray hit this item within the allowed parametric coordinate range
+		 */
+		virtual bool occluded(const Ray<T> &ray, T tMin, T tMax) const;
+
+		/// Returns a box that encloses every point this item may be hit at
+		virtual Aabb<T> boundingBox() const = 0;
 	};
 }
 
-#endif
\ No newline at end of file
+namespace trayzy
+{
+	template<typename T>
+	bool Hittable<T>::hit(const Ray<T> &ray, T tMin, T tMax, Intersection<T> &intersection) const
+	{
+		HitRecord<T> record;
+
+		if (!closestHit(ray, tMin, tMax, record))
+		{
+			return false;
+		}
+
+		record.primitive->evaluate(ray, record, intersection);
+		return true;
+	}
+
+	template<typename T>
+	bool Hittable<T>::occluded(const Ray<T> &ray, T tMin, T tMax) const
+	{
+		HitRecord<T> record;
+		return closestHit(ray, tMin, tMax, record);
+	}
+}
+
+#endif
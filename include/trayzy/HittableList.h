@@ -4,7 +4,9 @@
 #include "Hittable.h"
 #include "Intersection.h"
 
+#include <algorithm>
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace trayzy
@@ -51,11 +53,31 @@ namespace trayzy
 		void insert(std::shared_ptr<Hittable<T>> hittable);
 
 		/**
-		 * @copydoc Hittable::hit
+		 * Removes a pointer to a hittable item from this list, moving the last item into its place.
+		 *
+		 * @param hittable The pointer to the hittable item
+		 * @return Whether the item was in the list
+		 */
+		bool remove(const std::shared_ptr<Hittable<T>> &hittable);
+
+		/// Returns the pointers to the hittable items in this list
+		inline const std::vector<std::shared_ptr<Hittable<T>>> &hittables() const;
+
+		/**
+		 * @copydoc Hittable::closestHit
 		 * 
-		 * The intersection will set to the hit against the closest item in the list.
+		 * The record will be set to the hit against the closest item in the list.
 		 */
-		virtual bool hit(const Ray<T> &ray, T tMin, T tMax, Intersection<T> &intersection) const override;
+		virtual bool closestHit(const Ray<T> &ray, T tMin, T tMax, HitRecord<T> &record) const override;
+
+		// Hittable::evaluate
+		virtual void evaluate(const Ray<T> &ray, const HitRecord<T> &record, Intersection<T> &intersection) const override;
+
+		// Hittable::occluded
+		virtual bool occluded(const Ray<T> &ray, T tMin, T tMax) const override;
+
+		// Hittable::boundingBox
+		virtual Aabb<T> boundingBox() const override;
 
 	private:
 		std::vector<std::shared_ptr<Hittable<T>>> mHittables;
@@ -71,24 +93,77 @@ namespace trayzy
 	}
 
 	template<typename T>
-	bool HittableList<T>::hit(const Ray<T> &ray, T tMin, T tMax, Intersection<T> &intersection) const
+	bool HittableList<T>::remove(const std::shared_ptr<Hittable<T>> &hittable)
+	{
+		auto found = std::find(mHittables.begin(), mHittables.end(), hittable);
+
+		if (found == mHittables.end())
+		{
+			return false;
+		}
+
+		*found = std::move(mHittables.back());
+		mHittables.pop_back();
+		return true;
+	}
+
+	template<typename T>
+	const std::vector<std::shared_ptr<Hittable<T>>> &HittableList<T>::hittables() const
+	{
+		return mHittables;
+	}
+
+	template<typename T>
+	bool HittableList<T>::closestHit(const Ray<T> &ray, T tMin, T tMax, HitRecord<T> &record) const
 	{
-		Intersection<T> intermediateIntersection;
 		bool hitAnything = false;
 		T tClosest = tMax;
 
-		for (auto hittable : mHittables)
+		for (const auto &hittable : mHittables)
 		{
-			if (hittable->hit(ray, tMin, tClosest, intermediateIntersection))
+			// Each hit narrows the range, so the record only ever holds a closer hit
+			if (hittable->closestHit(ray, tMin, tClosest, record))
 			{
-				intersection = intermediateIntersection;
-				tClosest = intersection.t;
+				tClosest = record.t;
 				hitAnything = true;
 			}
 		}
 
 		return hitAnything;
 	}
+
+	template<typename T>
+	void HittableList<T>::evaluate(const Ray<T> &ray, const HitRecord<T> &record, Intersection<T> &intersection) const
+	{
+		record.primitive->evaluate(ray, record, intersection);
+	}
+
+	template<typename T>
+	bool HittableList<T>::occluded(const Ray<T> &ray, T tMin, T tMax) const
+	{
+		for (const auto &hittable : mHittables)
+		{
+			if (hittable->occluded(ray, tMin, tMax))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	template<typename T>
+	Aabb<T> HittableList<T>::boundingBox() const
+	{
+		Aabb<T> box;
+
+		for (const auto &hittable : mHittables)
+		{
+			box.expand(hittable->boundingBox());
+		}
+
+		return box;
+	}
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,169 @@
+#ifndef TRAYZY_HYBRIDRENDERER_H
+#define TRAYZY_HYBRIDRENDERER_H
+
+#include "Camera.h"
+#include "Hittable.h"
+#include "HitRecord.h"
+#include "Image.h"
+#include "Integrator.h"
+#include "Intersection.h"
+#include "Random.h"
+#include "RayBatch.h"
+#include "Renderer.h"
+#include "RenderSettings.h"
+#include "SphereRasterizer.h"
+#include "ThreadPool.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace trayzy
+{
+	/**
+	 * Renders images whose primary visibility is rasterized and whose paths are traced from
+	 * the first bounce on.
+	 *
+	 * The camera rays of every tile are generated as Renderer generates them, their closest
+	 * hits are rasterized into the tile's G-buffer, and the integrator continues each path
+	 * from its hit. Since the rasterizer finds the hits that tracing the same rays would and
+	 * every tile draws the same random numbers, the image is identical to the one Renderer
+	 * makes with the same settings, integrator and scene.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class HybridRenderer
+	{
+	public:
+		/**
+		 * Creates a renderer.
+		 *
+		 * @param settings The parameters of every render
+		 * @param integrator The integrator that computes the color of each camera ray, or
+		 *        null for the path tracer without direct light sampling
+		 */
+		explicit HybridRenderer(const RenderSettings &settings = RenderSettings(),
+			std::shared_ptr<const Integrator<T>> integrator = nullptr) :
+			mRenderer(settings, std::move(integrator))
+		{
+			// Do nothing more
+		}
+
+		/// Returns the settings of this renderer
+		inline const RenderSettings &settings() const;
+
+		/**
+		 * Renders a scene on all worker threads.
+		 *
+		 * @param world The scene to trace the paths against
+		 * @param rasterizer The spheres of the same scene, which find the camera rays' hits
+		 * @param camera The pinhole camera to view the scene through
+		 * @return The rendered image in linear color
+		 */
+		Image<T> render(const Hittable<T> &world, const SphereRasterizer<T> &rasterizer, const Camera<T> &camera) const;
+
+		/**
+		 * Renders a scene on a thread pool and waits for it.
+		 *
+		 * The calling thread blocks, so it must not be a worker of the pool.
+		 *
+		 * @param pool The pool whose workers rasterize and render the tiles
+		 * @param world The scene to trace the paths against
+		 * @param rasterizer The spheres of the same scene, which find the camera rays' hits
+		 * @param camera The pinhole camera to view the scene through
+		 * @return The rendered image in linear color
+		 */
+		Image<T> render(ThreadPool &pool, const Hittable<T> &world, const SphereRasterizer<T> &rasterizer,
+			const Camera<T> &camera) const;
+
+	private:
+		/// Rasterizes and renders a single tile into an image
+		void renderTile(const Hittable<T> &world, const SphereRasterizer<T> &rasterizer,
+			const typename SphereRasterizer<T>::Bins &bins, const Camera<T> &camera, const Tile &tile,
+			Image<T> &image) const;
+
+	private:
+		Renderer<T> mRenderer;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	const RenderSettings &HybridRenderer<T>::settings() const
+	{
+		return mRenderer.settings();
+	}
+
+	template<typename T>
+	void HybridRenderer<T>::renderTile(const Hittable<T> &world, const SphereRasterizer<T> &rasterizer,
+		const typename SphereRasterizer<T>::Bins &bins, const Camera<T> &camera, const Tile &tile,
+		Image<T> &image) const
+	{
+		const RenderSettings &settings = mRenderer.settings();
+		const Integrator<T> &integrator = mRenderer.integrator();
+
+		RayBatch<T> rays;
+		std::vector<HitRecord<T>> gBuffer;
+		seedRandomEngine(Renderer<T>::tileSeed(settings.seed, tile.index));
+		camera.getRays(tile.x0, tile.y0, tile.width, tile.height, settings.width, settings.height, settings.samples, rays);
+		rasterizer.rasterize(bins, tile, settings.samples, rays, gBuffer);
+
+		std::size_t i = 0;
+
+		for (int row = tile.y0; row < tile.y0 + tile.height; ++row)
+		{
+			for (int col = tile.x0; col < tile.x0 + tile.width; ++col)
+			{
+				Vec3<T> c;
+
+				for (int s = 0; s < settings.samples; ++s, ++i)
+				{
+					Ray<T> ray = rays.ray(i);
+					const HitRecord<T> &hit = gBuffer[i];
+
+					if (hit.primitive)
+					{
+						Intersection<T> intersection;
+						hit.primitive->evaluate(ray, hit, intersection);
+						c += integrator.radianceFromHit(ray, &intersection, world);
+					}
+					else
+					{
+						c += integrator.radianceFromHit(ray, nullptr, world);
+					}
+				}
+
+				image.at(col, row) = c / T(settings.samples);
+			}
+		}
+	}
+
+	template<typename T>
+	Image<T> HybridRenderer<T>::render(const Hittable<T> &world, const SphereRasterizer<T> &rasterizer,
+		const Camera<T> &camera) const
+	{
+		ThreadPool pool(mRenderer.threadCount());
+		return render(pool, world, rasterizer, camera);
+	}
+
+	template<typename T>
+	Image<T> HybridRenderer<T>::render(ThreadPool &pool, const Hittable<T> &world, const SphereRasterizer<T> &rasterizer,
+		const Camera<T> &camera) const
+	{
+		const RenderSettings &settings = mRenderer.settings();
+		Image<T> image(settings.width, settings.height);
+		std::vector<Tile> tiles = mRenderer.tiles();
+		typename SphereRasterizer<T>::Bins bins = rasterizer.bin(pool, camera, settings);
+
+		parallelFor(pool, tiles.size(), [&](std::size_t i)
+		{
+			renderTile(world, rasterizer, bins, camera, tiles[i], image);
+		});
+
+		return image;
+	}
+}
+
+#endif
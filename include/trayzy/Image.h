@@ -0,0 +1,330 @@
+#ifndef TRAYZY_IMAGE_H
+#define TRAYZY_IMAGE_H
+
+#include "Forward.h"
+#include "Vec3.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace trayzy
+{
+	/**
+	 * A rectangular grid of linear RGB colors, with row 0 at the bottom.
+	 *
+	 * @tparam T The color component data type
+	 */
+	template<typename T>
+	class Image
+	{
+	public:
+		/**
+		 * Creates a black image.
+		 *
+		 * @param width The number of columns
+		 * @param height The number of rows
+		 */
+		Image(int width = 0, int height = 0) :
+			mPixels(std::size_t(width) * height),
+			mWidth(width),
+			mHeight(height)
+		{
+			// Do nothing more
+		}
+
+		inline int width() const;
+		inline int height() const;
+
+		/// Returns the color of the pixel at the provided column and row
+		inline Vec3<T> &at(int col, int row);
+
+		/// Returns the color of the pixel at the provided column and row
+		inline const Vec3<T> &at(int col, int row) const;
+
+		/// Returns all pixels, row by row from the bottom
+		inline const std::vector<Vec3<T>> &pixels() const;
+
+		/**
+		 * Writes this image as a portable pixmap with gamma 2 encoding.
+		 *
+		 * Rows are written from the top, as the format requires.
+		 *
+		 * @param os The output stream
+		 * @param binary Whether to write the binary (P6) rather than the plain text (P3) format
+		 * @param maxValue The largest component value
+		 */
+		void writePpm(std::ostream &os, bool binary = false, int maxValue = 255) const;
+
+		/**
+		 * Reads a portable pixmap written by writePpm(), undoing its gamma 2 encoding.
+		 *
+		 * Components decode to the middle of their quantization interval, so writing the
+		 * image again reproduces the original file.
+		 *
+		 * @param is The input stream
+		 * @return The decoded image
+		 */
+		static Image<T> readPpm(std::istream &is);
+
+		/**
+		 * Writes this image as a little-endian portable float map, keeping linear color
+		 * and the full range of high dynamic range images.
+		 *
+		 * @param os The output stream, which must be opened in binary mode
+		 */
+		void writePfm(std::ostream &os) const;
+
+		/**
+		 * Reads a color or grayscale portable float map of linear color, such as an
+		 * environment map converted from a high dynamic range photograph.
+		 *
+		 * @param is The input stream, which must be opened in binary mode
+		 * @return The decoded image
+		 */
+		static Image<T> readPfm(std::istream &is);
+
+	private:
+		std::vector<Vec3<T>> mPixels;
+		int mWidth;
+		int mHeight;
+	};
+
+	/**
+	 * Computes the root-mean-square difference between two images after the same gamma 2
+	 * encoding and quantization to [0, 255] that writePpm() applies.
+	 *
+	 * @return The root-mean-square difference, or infinity if the sizes differ
+	 */
+	template<typename T>
+	T rmse(const Image<T> &a, const Image<T> &b);
+}
+
+namespace trayzy
+{
+	template<typename T>
+	int Image<T>::width() const
+	{
+		return mWidth;
+	}
+
+	template<typename T>
+	int Image<T>::height() const
+	{
+		return mHeight;
+	}
+
+	template<typename T>
+	Vec3<T> &Image<T>::at(int col, int row)
+	{
+		return mPixels[std::size_t(row) * mWidth + col];
+	}
+
+	template<typename T>
+	const Vec3<T> &Image<T>::at(int col, int row) const
+	{
+		return mPixels[std::size_t(row) * mWidth + col];
+	}
+
+	template<typename T>
+	const std::vector<Vec3<T>> &Image<T>::pixels() const
+	{
+		return mPixels;
+	}
+
+	template<typename T>
+	void Image<T>::writePpm(std::ostream &os, bool binary, int maxValue) const
+	{
+		os << (binary ? "P6" : "P3") << std::endl << mWidth << " " << mHeight << std::endl << maxValue << std::endl;
+
+		for (int row = mHeight - 1; row >= 0; --row)
+		{
+			for (int col = 0; col < mWidth; ++col)
+			{
+				const Vec3<T> &c = at(col, row);
+
+				// Use gamma 2, i.e., raise color to the power 1/gamma which is square root
+				Vec3<int> iColor(
+					std::min(int(std::sqrt(c[R]) * maxValue), maxValue),
+					std::min(int(std::sqrt(c[G]) * maxValue), maxValue),
+					std::min(int(std::sqrt(c[B]) * maxValue), maxValue)
+				);
+
+				if (binary)
+				{
+					os.put(char(iColor[R])).put(char(iColor[G])).put(char(iColor[B]));
+				}
+				else
+				{
+					os << iColor << std::endl;
+				}
+			}
+		}
+	}
+
+	/* static */
+	template<typename T>
+	Image<T> Image<T>::readPpm(std::istream &is)
+	{
+		std::string magic;
+		int width = 0;
+		int height = 0;
+		int maxValue = 0;
+		is >> magic >> width >> height >> maxValue;
+
+		if (!is || (magic != "P3" && magic != "P6") || maxValue <= 0 || maxValue > 255)
+		{
+			throw std::runtime_error("Image: unsupported portable pixmap");
+		}
+
+		// Skip the single whitespace character that ends the header
+		is.get();
+		Image<T> image(width, height);
+
+		for (int row = height - 1; row >= 0; --row)
+		{
+			for (int col = 0; col < width; ++col)
+			{
+				Vec3<int> iColor;
+
+				if (magic == "P6")
+				{
+					for (int &component : iColor)
+					{
+						component = static_cast<unsigned char>(is.get());
+					}
+				}
+				else
+				{
+					is >> iColor;
+				}
+
+				for (int c = R; c <= B; ++c)
+				{
+					T value = (iColor[c] + T(0.5)) / maxValue;
+					image.at(col, row)[c] = value * value;
+				}
+			}
+		}
+
+		if (!is)
+		{
+			throw std::runtime_error("Image: truncated portable pixmap");
+		}
+
+		return image;
+	}
+
+	template<typename T>
+	void Image<T>::writePfm(std::ostream &os) const
+	{
+		// A negative scale marks little-endian data
+		os << "PF\n" << mWidth << " " << mHeight << "\n-1.0\n";
+
+		// Rows run from the bottom, as they do in memory
+		for (const Vec3<T> &c : mPixels)
+		{
+			for (int i = R; i <= B; ++i)
+			{
+				float value = float(c[i]);
+				std::uint32_t bits;
+				std::memcpy(&bits, &value, sizeof(bits));
+
+				for (int shift = 0; shift < 32; shift += 8)
+				{
+					os.put(char((bits >> shift) & 0xFF));
+				}
+			}
+		}
+	}
+
+	/* static */
+	template<typename T>
+	Image<T> Image<T>::readPfm(std::istream &is)
+	{
+		std::string magic;
+		int width = 0;
+		int height = 0;
+		double scale = 0;
+		is >> magic >> width >> height >> scale;
+
+		if (!is || (magic != "PF" && magic != "Pf") || width <= 0 || height <= 0 || scale == 0)
+		{
+			throw std::runtime_error("Image: unsupported portable float map");
+		}
+
+		// Skip the single whitespace character that ends the header
+		is.get();
+		int nChannels = magic == "PF" ? 3 : 1;
+		bool littleEndian = scale < 0;
+		Image<T> image(width, height);
+
+		for (Vec3<T> &c : image.mPixels)
+		{
+			for (int i = 0; i < nChannels; ++i)
+			{
+				unsigned char bytes[4];
+				is.read(reinterpret_cast<char *>(bytes), sizeof(bytes));
+
+				std::uint32_t bits = 0;
+
+				for (int k = 0; k < 4; ++k)
+				{
+					bits |= std::uint32_t(bytes[littleEndian ? k : 3 - k]) << (8 * k);
+				}
+
+				float value;
+				std::memcpy(&value, &bits, sizeof(value));
+				c[i] = T(value);
+			}
+
+			if (nChannels == 1)
+			{
+				c[G] = c[B] = c[R];
+			}
+		}
+
+		if (!is)
+		{
+			throw std::runtime_error("Image: truncated portable float map");
+		}
+
+		return image;
+	}
+
+	template<typename T>
+	T rmse(const Image<T> &a, const Image<T> &b)
+	{
+		if (a.width() != b.width() || a.height() != b.height())
+		{
+			return std::numeric_limits<T>::infinity();
+		}
+
+		auto encode = [](T value)
+		{
+			return std::min(int(std::sqrt(value) * 255), 255);
+		};
+
+		double sum = 0;
+
+		for (std::size_t i = 0; i < a.pixels().size(); ++i)
+		{
+			for (int c = R; c <= B; ++c)
+			{
+				double difference = encode(a.pixels()[i][c]) - encode(b.pixels()[i][c]);
+				sum += difference * difference;
+			}
+		}
+
+		return T(std::sqrt(sum / std::max<std::size_t>(1, 3 * a.pixels().size())));
+	}
+}
+
+#endif
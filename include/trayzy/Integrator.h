@@ -0,0 +1,63 @@
+#ifndef TRAYZY_INTEGRATOR_H
+#define TRAYZY_INTEGRATOR_H
+
+#include "Forward.h"
+#include "Hittable.h"
+#include "Intersection.h"
+#include "Ray.h"
+#include "Vec3.h"
+
+namespace trayzy
+{
+	/**
+	 * Estimates the light arriving along camera rays.
+	 *
+	 * Integrators are immutable once constructed and are shared by every worker thread,
+	 * so the same renderer and scene can produce a full render or a cheap preview.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class Integrator
+	{
+	public:
+		virtual ~Integrator() = default;
+
+		/**
+		 * Estimates the color seen along a camera ray.
+		 *
+		 * @param ray The camera ray
+		 * @param world The scene to trace against
+		 * @return The color seen along the ray
+		 */
+		virtual Vec3<T> radiance(const Ray<T> &ray, const Hittable<T> &world) const = 0;
+
+		/**
+		 * Estimates the color seen along a camera ray whose closest hit was found without
+		 * tracing it, such as by rasterizing primary visibility.
+		 *
+		 * The default ignores the hit and traces the ray again, so only integrators that
+		 * override this save the cost of the primary ray.
+		 *
+		 * @param ray The camera ray
+		 * @param intersection The properties at the ray's closest hit, or null if the ray
+		 *        escapes the scene
+		 * @param world The scene to trace against
+		 * @return The color seen along the ray
+		 */
+		virtual Vec3<T> radianceFromHit(const Ray<T> &ray, const Intersection<T> *intersection,
+			const Hittable<T> &world) const;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	Vec3<T> Integrator<T>::radianceFromHit(const Ray<T> &ray, const Intersection<T> *intersection,
+		const Hittable<T> &world) const
+	{
+		return radiance(ray, world);
+	}
+}
+
+#endif
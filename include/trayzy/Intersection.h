@@ -4,6 +4,7 @@
 #include "Forward.h"
 #include "Vec3.h"
 
+#include <cstdint>
 #include <memory>
 
 namespace trayzy
@@ -27,6 +28,9 @@ namespace trayzy
 
 		/// A pointer to the material at the hit point
 		std::shared_ptr<Material<T>> material;
+
+		/// The index of the material at the hit point, for scenes that store materials by value
+		std::uint32_t materialIndex = 0;
 	};
 }
 
@@ -0,0 +1,58 @@
+#ifndef TRAYZY_ISOTROPIC_H
+#define TRAYZY_ISOTROPIC_H
+
+#include "Intersection.h"
+#include "Material.h"
+#include "Ray.h"
+#include "Vec3.h"
+
+namespace trayzy
+{
+	/**
+	 * A phase function that scatters light uniformly in all directions,
+	 * used for the particles of participating media such as fog and smoke.
+	 *
+	 * @tparam T The data type to use for coordinates and computation factors
+	 */
+	template<typename T>
+	class Isotropic : public Material<T>
+	{
+	public:
+		/// Creates a new isotropic phase function
+		Isotropic(const Vec3<T> &albedo = Vec3<T>(1, 1, 1)) :
+			mAlbedo(albedo)
+		{
+			// Do nothing more
+		}
+
+		// Material::scatter
+		virtual bool scatter(const Ray<T> &inbound, const Intersection<T> &intersection,
+			Vec3<T> &attenuation, Ray<T> &scattered) const override;
+
+		// Material::albedo
+		virtual Vec3<T> albedo(const Intersection<T> &intersection) const override;
+
+	private:
+		Vec3<T> mAlbedo;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	bool Isotropic<T>::scatter(const Ray<T> &inbound, const Intersection<T> &intersection,
+		Vec3<T> &attenuation, Ray<T> &scattered) const
+	{
+		scattered = Ray<T>(intersection.p, Material<T>::randomInUnitSphere());
+		attenuation = mAlbedo;
+		return true;
+	}
+
+	template<typename T>
+	Vec3<T> Isotropic<T>::albedo(const Intersection<T> &intersection) const
+	{
+		return mAlbedo;
+	}
+}
+
+#endif
@@ -4,8 +4,14 @@
 #include "Intersection.h"
 #include "Material.h"
 #include "Ray.h"
+#include "Texture.h"
 #include "Vec3.h"
 
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <utility>
+
 namespace trayzy
 {
 	/// A Lambertian material
@@ -20,12 +26,31 @@ namespace trayzy
 			// Do nothing more
 		}
 
+		/// Creates a new Lambertian material whose albedo varies over space
+		explicit Lambertian(std::shared_ptr<const Texture<T>> texture) :
+			mTexture(std::move(texture))
+		{
+			// Do nothing more
+		}
+
 		// Material::scatter
 		virtual bool scatter(const Ray<T> &inbound, const Intersection<T> &intersection,
 			Vec3<T> &attenuation, Ray<T> &scattered) const override;
 
+		// Material::albedo
+		virtual Vec3<T> albedo(const Intersection<T> &intersection) const override;
+
+		// Material::brdf
+		virtual bool brdf(const Ray<T> &inbound, const Intersection<T> &intersection, const Vec3<T> &direction,
+			Vec3<T> &value) const override;
+
+		// Material::scatterPdf
+		virtual T scatterPdf(const Ray<T> &inbound, const Intersection<T> &intersection,
+			const Vec3<T> &direction) const override;
+
 	private:
 		Vec3<T> mAlbedo;
+		std::shared_ptr<const Texture<T>> mTexture;
 	};
 }
 
@@ -35,11 +60,33 @@ namespace trayzy
 	bool Lambertian<T>::scatter(const Ray<T> &inbound, const Intersection<T> &intersection,
 		Vec3<T> &attenuation, Ray<T> &scattered) const
 	{
-		Vec3<T> target = intersection.p + intersection.normal + Material<T>::randomInUnitSphere();
-		scattered = Ray<T>(intersection.p, target - intersection.p);
-		attenuation = mAlbedo;
+		// Scattering with the cosine-weighted density makes the attenuation exactly the albedo
+		scattered = Ray<T>(intersection.p, randomCosineDirection(intersection.normal));
+		attenuation = Lambertian<T>::albedo(intersection);
 		return true;
 	}
+
+	template<typename T>
+	bool Lambertian<T>::brdf(const Ray<T> &inbound, const Intersection<T> &intersection, const Vec3<T> &direction,
+		Vec3<T> &value) const
+	{
+		value = Lambertian<T>::albedo(intersection) / T(M_PI);
+		return true;
+	}
+
+	template<typename T>
+	T Lambertian<T>::scatterPdf(const Ray<T> &inbound, const Intersection<T> &intersection,
+		const Vec3<T> &direction) const
+	{
+		// scatter() picks directions around the normal in proportion to their cosine
+		return std::max(T(0), dot(intersection.normal, direction)) / T(M_PI);
+	}
+
+	template<typename T>
+	Vec3<T> Lambertian<T>::albedo(const Intersection<T> &intersection) const
+	{
+		return mTexture ? mTexture->value(intersection.p) : mAlbedo;
+	}
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,209 @@
+#ifndef TRAYZY_LIGHTBVH_H
+#define TRAYZY_LIGHTBVH_H
+
+#include "Aabb.h"
+#include "LightSampler.h"
+#include "Vec3.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace trayzy
+{
+	/**
+	 * A bounding volume hierarchy over lights that chooses lights in proportion to an
+	 * estimate of their contribution to a shading point.
+	 *
+	 * Every node stores a bounding sphere and the total power of its lights. Sampling walks
+	 * from the root to a single light, choosing each child in proportion to its power
+	 * divided by its squared distance and scaled by a bound on the cosine between the
+	 * surface normal and the directions toward the child, so a sample costs one
+	 * importance evaluation per level of the balanced tree. Since spherical lights emit
+	 * in every direction, only the orientation of the receiving surface is bounded.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class LightBvh : public LightSampler<T>
+	{
+	public:
+		/// Builds a hierarchy over the provided lights
+		explicit LightBvh(std::vector<Light<T>> lights);
+
+		// LightSampler::sample
+		virtual const Light<T> *sample(const Vec3<T> &p, const Vec3<T> &n, T u, T &probability) const override;
+
+		/// Returns the number of nodes in the hierarchy
+		inline std::size_t nodeCount() const;
+
+	private:
+		/// A node of the flattened tree
+		struct Node
+		{
+			/// The center of a sphere bounding every light below this node
+			Vec3<T> center;
+
+			/// The radius of a sphere bounding every light below this node
+			T radius;
+
+			/// The total power of the lights below this node
+			T power;
+
+			/// The light index for leaves, or the right child index for interior nodes
+			std::uint32_t offset;
+
+			/// Whether the node holds a single light
+			bool leaf;
+		};
+
+		/// Builds the subtree over the lights in [first, last) into the provided node
+		void build(std::uint32_t node, std::uint32_t first, std::uint32_t last);
+
+		/// Estimates the contribution of the lights below a node to a shading point
+		static inline T importance(const Node &node, const Vec3<T> &p, const Vec3<T> &n);
+
+	private:
+		std::vector<Node> mNodes;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	LightBvh<T>::LightBvh(std::vector<Light<T>> lights) :
+		LightSampler<T>(std::move(lights))
+	{
+		if (!this->mLights.empty())
+		{
+			mNodes.reserve(2 * this->mLights.size() - 1);
+			mNodes.emplace_back();
+			build(0, 0, std::uint32_t(this->mLights.size()));
+		}
+	}
+
+	template<typename T>
+	void LightBvh<T>::build(std::uint32_t node, std::uint32_t first, std::uint32_t last)
+	{
+		std::vector<Light<T>> &lights = this->mLights;
+
+		if (last - first == 1)
+		{
+			mNodes[node] = { lights[first].center, lights[first].radius, lights[first].power(), first, true };
+			return;
+		}
+
+		Aabb<T> bounds;
+		Aabb<T> centroidBounds;
+
+		for (std::uint32_t i = first; i < last; ++i)
+		{
+			Vec3<T> r(lights[i].radius, lights[i].radius, lights[i].radius);
+			bounds.expand(Aabb<T>(lights[i].center - r, lights[i].center + r));
+			centroidBounds.expand(lights[i].center);
+		}
+
+		// Median splits keep the tree balanced, which bounds the cost of a sample
+		Vec3<T> extent = centroidBounds.extent();
+		int axis = extent[X] > extent[Y] ? (extent[X] > extent[Z] ? X : Z) : (extent[Y] > extent[Z] ? Y : Z);
+		std::uint32_t middle = first + (last - first) / 2;
+
+		std::nth_element(lights.begin() + first, lights.begin() + middle, lights.begin() + last,
+			[axis](const Light<T> &a, const Light<T> &b) { return a.center[axis] < b.center[axis]; });
+
+		std::uint32_t left = std::uint32_t(mNodes.size());
+		mNodes.emplace_back();
+		build(left, first, middle);
+
+		std::uint32_t right = std::uint32_t(mNodes.size());
+		mNodes.emplace_back();
+		build(right, middle, last);
+
+		mNodes[node] = { bounds.center(), T(0.5) * bounds.extent().magnitude(),
+			mNodes[left].power + mNodes[right].power, right, false };
+	}
+
+	/* static */
+	template<typename T>
+	T LightBvh<T>::importance(const Node &node, const Vec3<T> &p, const Vec3<T> &n)
+	{
+		Vec3<T> d = node.center - p;
+		T distanceSquared = d.magnitudeSquared();
+		T radiusSquared = node.radius * node.radius;
+		T cosineBound = 1;
+
+		if (distanceSquared > radiusSquared && n.magnitudeSquared() > 0)
+		{
+			// Bound the angle to the normal by the angle to the center less the bounding cone's half-angle
+			T distance = std::sqrt(distanceSquared);
+			T cosTheta = dot(n, d) / distance;
+			T sinThetaBound = node.radius / distance;
+			T cosThetaBound = std::sqrt(1 - sinThetaBound * sinThetaBound);
+
+			if (cosTheta < cosThetaBound)
+			{
+				T sinTheta = std::sqrt(std::max(T(0), 1 - cosTheta * cosTheta));
+				cosineBound = std::max(T(0), cosTheta * cosThetaBound + sinTheta * sinThetaBound);
+			}
+		}
+
+		return node.power * cosineBound / std::max(distanceSquared, radiusSquared);
+	}
+
+	template<typename T>
+	const Light<T> *LightBvh<T>::sample(const Vec3<T> &p, const Vec3<T> &n, T u, T &probability) const
+	{
+		if (mNodes.empty())
+		{
+			return nullptr;
+		}
+
+		std::uint32_t node = 0;
+		probability = 1;
+
+		while (!mNodes[node].leaf)
+		{
+			std::uint32_t left = node + 1;
+			std::uint32_t right = mNodes[node].offset;
+			T leftImportance = importance(mNodes[left], p, n);
+			T rightImportance = importance(mNodes[right], p, n);
+
+			if (!(leftImportance + rightImportance > 0))
+			{
+				return nullptr;
+			}
+
+			// Reuse the random number by rescaling the part of it below the chosen child
+			T leftProbability = leftImportance / (leftImportance + rightImportance);
+
+			if (u < leftProbability)
+			{
+				u = u / leftProbability;
+				probability *= leftProbability;
+				node = left;
+			}
+			else
+			{
+				u = (u - leftProbability) / (1 - leftProbability);
+				probability *= 1 - leftProbability;
+				node = right;
+			}
+
+			u = std::min(u, T(1) - std::numeric_limits<T>::epsilon());
+		}
+
+		return &this->mLights[mNodes[node].offset];
+	}
+
+	template<typename T>
+	std::size_t LightBvh<T>::nodeCount() const
+	{
+		return mNodes.size();
+	}
+}
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef TRAYZY_LIGHTSAMPLER_H
+#define TRAYZY_LIGHTSAMPLER_H
+
+#include "DiffuseLight.h"
+#include "Hittable.h"
+#include "Sphere.h"
+#include "Vec3.h"
+
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace trayzy
+{
+	/**
+	 * A spherical light that emits the same radiance from every point and in every direction.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	struct Light
+	{
+		/// The center of the sphere
+		Vec3<T> center;
+
+		/// The radius of the sphere
+		T radius;
+
+		/// The emitted radiance
+		Vec3<T> emission;
+
+		/// Returns a value proportional to the total power emitted
+		inline T power() const;
+	};
+
+	/**
+	 * Chooses one light among many to sample directly from a shading point.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class LightSampler
+	{
+	public:
+		/// Creates a sampler over the provided lights
+		explicit LightSampler(std::vector<Light<T>> lights) :
+			mLights(std::move(lights))
+		{
+			// Do nothing more
+		}
+
+		virtual ~LightSampler() = default;
+
+		/**
+		 * Chooses a light to sample from a shading point.
+		 *
+		 * @param p The shading point
+		 * @param n The unit surface normal at the shading point, facing the viewer, or zero
+		 *        if light arrives from every direction
+		 * @param u A uniform random number in [0, 1)
+		 * @param[out] probability The probability of choosing the returned light
+		 * @return The chosen light, or null if no light can reach the point
+		 */
+		virtual const Light<T> *sample(const Vec3<T> &p, const Vec3<T> &n, T u, T &probability) const = 0;
+
+		/// Returns the lights, in the order the sampler keeps them
+		inline const std::vector<Light<T>> &lights() const;
+
+		/// Returns the number of lights
+		inline std::size_t size() const;
+
+	protected:
+		std::vector<Light<T>> mLights;
+	};
+
+	/**
+	 * Finds the spheres made of a diffuse light material among scene items.
+	 *
+	 * @param hittables The scene items
+	 * @return A light for every emissive sphere
+	 */
+	template<typename T>
+	std::vector<Light<T>> findLights(const std::vector<std::shared_ptr<Hittable<T>>> &hittables);
+}
+
+namespace trayzy
+{
+	template<typename T>
+	T Light<T>::power() const
+	{
+		return (emission[R] + emission[G] + emission[B]) * radius * radius;
+	}
+
+	template<typename T>
+	const std::vector<Light<T>> &LightSampler<T>::lights() const
+	{
+		return mLights;
+	}
+
+	template<typename T>
+	std::size_t LightSampler<T>::size() const
+	{
+		return mLights.size();
+	}
+
+	template<typename T>
+	std::vector<Light<T>> findLights(const std::vector<std::shared_ptr<Hittable<T>>> &hittables)
+	{
+		std::vector<Light<T>> lights;
+
+		for (const auto &hittable : hittables)
+		{
+			auto sphere = dynamic_cast<const Sphere<T> *>(hittable.get());
+			auto light = sphere ? dynamic_cast<const DiffuseLight<T> *>(sphere->material().get()) : nullptr;
+
+			if (light)
+			{
+				lights.push_back({ sphere->center(), std::abs(sphere->radius()), light->emission() });
+			}
+		}
+
+		return lights;
+	}
+}
+
+#endif
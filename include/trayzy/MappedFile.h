@@ -0,0 +1,235 @@
+#ifndef TRAYZY_MAPPEDFILE_H
+#define TRAYZY_MAPPEDFILE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace trayzy
+{
+	/**
+	 * A whole file mapped read-only into memory.
+	 *
+	 * The operating system pages the file in as its bytes are first read, and can drop
+	 * clean pages again at any time since they are backed by the file. Releasing a range
+	 * asks it to do so right away, so the resident memory of the process follows what
+	 * the caller still uses rather than everything it has ever read.
+	 */
+	class MappedFile
+	{
+	public:
+		/**
+		 * Maps a file.
+		 *
+		 * @param path The path of the file
+		 * @throws std::runtime_error If the file cannot be opened or mapped
+		 */
+		explicit MappedFile(const std::string &path);
+
+		MappedFile(const MappedFile &) = delete;
+		MappedFile &operator=(const MappedFile &) = delete;
+
+		~MappedFile();
+
+		/// Returns the first byte of the file
+		inline const unsigned char *data() const;
+
+		/// Returns the size of the file in bytes
+		inline std::size_t size() const;
+
+		/// Asks the operating system to start reading a range of bytes in ahead of use
+		void prefetch(std::size_t offset, std::size_t length) const;
+
+		/// Drops the whole pages within a range of bytes from the resident memory of the process
+		void release(std::size_t offset, std::size_t length) const;
+
+		/// Returns the size of a virtual memory page in bytes
+		static inline std::size_t pageSize();
+
+	private:
+		/// Unmaps the file and closes it, as far as it was opened
+		void unmap();
+
+	private:
+		const unsigned char *mData = nullptr;
+		std::size_t mSize = 0;
+
+#if defined(_WIN32)
+		HANDLE mFile = INVALID_HANDLE_VALUE;
+		HANDLE mMapping = nullptr;
+#else
+		int mDescriptor = -1;
+#endif
+	};
+}
+
+namespace trayzy
+{
+#if defined(_WIN32)
+	inline MappedFile::MappedFile(const std::string &path)
+	{
+		mFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL, nullptr);
+		LARGE_INTEGER size;
+
+		if (mFile == INVALID_HANDLE_VALUE || !GetFileSizeEx(mFile, &size))
+		{
+			unmap();
+			throw std::runtime_error("MappedFile: cannot open " + path);
+		}
+
+		mSize = std::size_t(size.QuadPart);
+
+		if (mSize > 0)
+		{
+			mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			mData = mMapping ? static_cast<const unsigned char *>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+
+			if (!mData)
+			{
+				unmap();
+				throw std::runtime_error("MappedFile: cannot map " + path);
+			}
+		}
+	}
+
+	inline void MappedFile::unmap()
+	{
+		if (mData)
+		{
+			UnmapViewOfFile(mData);
+		}
+
+		if (mMapping)
+		{
+			CloseHandle(mMapping);
+		}
+
+		if (mFile != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(mFile);
+		}
+	}
+#else
+	inline MappedFile::MappedFile(const std::string &path)
+	{
+		mDescriptor = open(path.c_str(), O_RDONLY);
+		struct stat status;
+
+		if (mDescriptor < 0 || fstat(mDescriptor, &status) != 0)
+		{
+			unmap();
+			throw std::runtime_error("MappedFile: cannot open " + path);
+		}
+
+		mSize = std::size_t(status.st_size);
+
+		if (mSize > 0)
+		{
+			void *data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, mDescriptor, 0);
+
+			if (data == MAP_FAILED)
+			{
+				unmap();
+				throw std::runtime_error("MappedFile: cannot map " + path);
+			}
+
+			mData = static_cast<const unsigned char *>(data);
+		}
+	}
+
+	inline void MappedFile::unmap()
+	{
+		if (mData)
+		{
+			munmap(const_cast<unsigned char *>(mData), mSize);
+		}
+
+		if (mDescriptor >= 0)
+		{
+			close(mDescriptor);
+		}
+	}
+#endif
+
+	inline MappedFile::~MappedFile()
+	{
+		unmap();
+	}
+
+	const unsigned char *MappedFile::data() const
+	{
+		return mData;
+	}
+
+	std::size_t MappedFile::size() const
+	{
+		return mSize;
+	}
+
+	inline void MappedFile::prefetch(std::size_t offset, std::size_t length) const
+	{
+#if defined(_WIN32)
+		// Windows pages the range in on first use; prefetching needs a newer API than the mapping
+		(void)offset;
+		(void)length;
+#else
+		std::size_t page = pageSize();
+		std::size_t first = offset / page * page;
+		std::size_t last = std::min(mSize, offset + length);
+
+		if (mData && first < last)
+		{
+			madvise(const_cast<unsigned char *>(mData) + first, last - first, MADV_WILLNEED);
+		}
+#endif
+	}
+
+	inline void MappedFile::release(std::size_t offset, std::size_t length) const
+	{
+		// Round inward so that pages shared with neighboring ranges stay resident
+		std::size_t page = pageSize();
+		std::size_t first = (offset + page - 1) / page * page;
+		std::size_t last = std::min(mSize, offset + length) / page * page;
+
+		if (!mData || first >= last)
+		{
+			return;
+		}
+
+#if defined(_WIN32)
+		// Unlocking pages that are not locked removes them from the working set
+		VirtualUnlock(const_cast<unsigned char *>(mData) + first, last - first);
+#else
+		madvise(const_cast<unsigned char *>(mData) + first, last - first, MADV_DONTNEED);
+#endif
+	}
+
+	/* static */
+	std::size_t MappedFile::pageSize()
+	{
+#if defined(_WIN32)
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return std::size_t(info.dwPageSize);
+#else
+		return std::size_t(sysconf(_SC_PAGESIZE));
+#endif
+	}
+}
+
+#endif
@@ -2,10 +2,9 @@
 #define TRAYZY_MATERIAL_H
 
 #include "Forward.h"
+#include "Random.h"
 #include "Vec3.h"
 
-#include <random>
-
 namespace trayzy
 {
 	/**
@@ -27,6 +26,53 @@ namespace trayzy
 		virtual bool scatter(const Ray<T> &inbound, const Intersection<T> &intersection,
 			Vec3<T> &attenuation, Ray<T> &scattered) const = 0;
 
+		/**
+		 * Returns the radiance emitted at an intersection, which is black unless overridden.
+		 *
+		 * @param intersection The properties at the intersection location
+		 * @return The emitted radiance
+		 */
+		virtual Vec3<T> emitted(const Intersection<T> &intersection) const;
+
+		/**
+		 * Returns the fraction of light reflected at an intersection, which is white unless
+		 * overridden, for previews and feature buffers.
+		 *
+		 * @param intersection The properties at the intersection location
+		 * @return The albedo
+		 */
+		virtual Vec3<T> albedo(const Intersection<T> &intersection) const;
+
+		/**
+		 * Evaluates the reflectance for light arriving from a direction, so that lights can be
+		 * sampled directly.
+		 *
+		 * Materials that only scatter into discrete directions leave this unimplemented; the
+		 * integrator then relies on scatter() alone to find light.
+		 *
+		 * @param inbound The inbound ray
+		 * @param intersection The properties at the intersection location
+		 * @param direction The unit direction toward the light
+		 * @param[out] value The bidirectional reflectance distribution function
+		 * @return Whether the material can be evaluated for arbitrary directions
+		 */
+		virtual bool brdf(const Ray<T> &inbound, const Intersection<T> &intersection, const Vec3<T> &direction,
+			Vec3<T> &value) const;
+
+		/**
+		 * Returns the probability density over solid angle with which scatter() picks a
+		 * direction, so that light sampling and scattering can be weighted against each other.
+		 *
+		 * Materials that implement brdf() must implement this as well.
+		 *
+		 * @param inbound The inbound ray
+		 * @param intersection The properties at the intersection location
+		 * @param direction The unit scattered direction
+		 * @return The probability density, which is zero unless overridden
+		 */
+		virtual T scatterPdf(const Ray<T> &inbound, const Intersection<T> &intersection,
+			const Vec3<T> &direction) const;
+
 	protected:
 		/// Returns a random vector within the unit sphere
 		static Vec3<T> randomInUnitSphere();
@@ -39,20 +85,42 @@ namespace trayzy
 
 namespace trayzy
 {
+	template<typename T>
+	Vec3<T> Material<T>::emitted(const Intersection<T> &intersection) const
+	{
+		return Vec3<T>(0, 0, 0);
+	}
+
+	template<typename T>
+	Vec3<T> Material<T>::albedo(const Intersection<T> &intersection) const
+	{
+		return Vec3<T>(1, 1, 1);
+	}
+
+	template<typename T>
+	bool Material<T>::brdf(const Ray<T> &inbound, const Intersection<T> &intersection, const Vec3<T> &direction,
+		Vec3<T> &value) const
+	{
+		return false;
+	}
+
+	template<typename T>
+	T Material<T>::scatterPdf(const Ray<T> &inbound, const Intersection<T> &intersection,
+		const Vec3<T> &direction) const
+	{
+		return 0;
+	}
+
 	/* static */
 	template<typename T>
 	Vec3<T> Material<T>::randomInUnitSphere()
 	{
-		std::random_device rd;
-		std::default_random_engine engine(rd());
-		std::uniform_real_distribution<T> distribution(0, 1);
-
 		Vec3<T> ijk(1, 1, 1);
 		Vec3<T> p;
 
 		do
 		{
-			p = T(2) * Vec3<T>(distribution(engine), distribution(engine), distribution(engine)) - ijk;
+			p = T(2) * Vec3<T>(randomUniform<T>(), randomUniform<T>(), randomUniform<T>()) - ijk;
 		} while (p.magnitudeSquared() >= 1);
 
 		return p;
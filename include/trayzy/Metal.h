@@ -1,7 +1,14 @@
 #ifndef TRAYZY_METAL_H
 #define TRAYZY_METAL_H
 
+#include "Intersection.h"
 #include "Material.h"
+#include "Ray.h"
+#include "Texture.h"
+#include "Vec3.h"
+
+#include <memory>
+#include <utility>
 
 namespace trayzy
 {
@@ -21,13 +28,24 @@ namespace trayzy
 			}
 		}
 
+		/// Creates a new metallic material whose albedo varies over space
+		explicit Metal(std::shared_ptr<const Texture<T>> texture, T fuzz = 1) :
+			Metal(Vec3<T>(), fuzz)
+		{
+			mTexture = std::move(texture);
+		}
+
 		// Material::scatter
 		virtual bool scatter(const Ray<T> &inbound, const Intersection<T> &intersection,
 			Vec3<T> &attenuation, Ray<T> &scattered) const override;
 
+		// Material::albedo
+		virtual Vec3<T> albedo(const Intersection<T> &intersection) const override;
+
 	private:
 		Vec3<T> mAlbedo;
 		T mFuzz;
+		std::shared_ptr<const Texture<T>> mTexture;
 	};
 }
 
@@ -37,11 +55,17 @@ namespace trayzy
 	bool Metal<T>::scatter(const Ray<T> &inbound, const Intersection<T> &intersection,
 		Vec3<T> &attenuation, Ray<T> &scattered) const
 	{
-		Vec3<T> reflected = reflect(unitVector(inbound.direction()), intersection.normal);
+		Vec3<T> reflected = Material<T>::reflect(unitVector(inbound.direction()), intersection.normal);
 		scattered = Ray<T>(intersection.p, reflected + mFuzz * Material<T>::randomInUnitSphere());
-		attenuation = mAlbedo;
+		attenuation = Metal<T>::albedo(intersection);
 		return dot(scattered.direction(), intersection.normal) > 0;
 	}
+
+	template<typename T>
+	Vec3<T> Metal<T>::albedo(const Intersection<T> &intersection) const
+	{
+		return mTexture ? mTexture->value(intersection.p) : mAlbedo;
+	}
 }
 
 #endif
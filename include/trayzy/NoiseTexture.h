@@ -0,0 +1,133 @@
+#ifndef TRAYZY_NOISETEXTURE_H
+#define TRAYZY_NOISETEXTURE_H
+
+#include "Perlin.h"
+#include "Texture.h"
+#include "Vec3.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace trayzy
+{
+	/**
+	 * A marble-like solid texture: sine stripes along z, displaced by turbulence, as in
+	 * "Ray Tracing: The Next Week".
+	 *
+	 * The turbulence is the magnitude of fractal Brownian motion over Perlin noise. A single
+	 * point evaluates its octaves together in the noise's lanes; values() instead puts
+	 * eight points in the lanes for each octave. Both sum the octaves in the same order, so
+	 * they agree exactly.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class NoiseTexture : public Texture<T>
+	{
+	public:
+		/**
+		 * Creates a marble texture.
+		 *
+		 * @param scale The frequency of the stripes
+		 * @param color The color of the bright veins
+		 * @param octaves The number of octaves of turbulence
+		 * @param seed The seed of the noise tables
+		 */
+		explicit NoiseTexture(T scale = 1, const Vec3<T> &color = Vec3<T>(1, 1, 1), int octaves = 7,
+			std::uint32_t seed = 1) :
+			mNoise(seed),
+			mScale(scale),
+			mColor(color),
+			mOctaves(octaves)
+		{
+			// Do nothing more
+		}
+
+		// Texture::value
+		virtual Vec3<T> value(const Vec3<T> &p) const override;
+
+		// Texture::values
+		virtual void values(const Vec3<T> *points, std::size_t n, Vec3<T> *colors) const override;
+
+		/// Returns the noise function behind the texture
+		inline const Perlin<T> &noise() const;
+
+	private:
+		/// Returns the color for a point's z coordinate and turbulence
+		inline Vec3<T> marble(T z, T turbulence) const;
+
+	private:
+		Perlin<T> mNoise;
+		T mScale;
+		Vec3<T> mColor;
+		int mOctaves;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	Vec3<T> NoiseTexture<T>::marble(T z, T turbulence) const
+	{
+		return mColor * (T(0.5) * (1 + std::sin(mScale * z + 10 * turbulence)));
+	}
+
+	template<typename T>
+	Vec3<T> NoiseTexture<T>::value(const Vec3<T> &p) const
+	{
+		return marble(p[Z], std::abs(mNoise.fbm(p, mOctaves)));
+	}
+
+	template<typename T>
+	void NoiseTexture<T>::values(const Vec3<T> *points, std::size_t n, Vec3<T> *colors) const
+	{
+		const int lanes = Perlin<T>::lanes;
+
+		// Every group of points runs through all octaves before the next, so it stays in registers
+		for (std::size_t first = 0; first < n; first += lanes)
+		{
+			T x[lanes], y[lanes], z[lanes], octave[lanes], sums[lanes];
+
+			for (int l = 0; l < lanes; ++l)
+			{
+				// Pad the last partial group with its first point
+				const Vec3<T> &p = points[first + l < n ? first + l : first];
+				x[l] = p[X];
+				y[l] = p[Y];
+				z[l] = p[Z];
+				sums[l] = 0;
+			}
+
+			T weight = 1;
+
+			for (int i = 0; i < mOctaves; ++i)
+			{
+				mNoise.noise8(x, y, z, octave);
+
+				for (int l = 0; l < lanes; ++l)
+				{
+					sums[l] += weight * octave[l];
+					x[l] *= 2;
+					y[l] *= 2;
+					z[l] *= 2;
+				}
+
+				weight *= T(0.5);
+			}
+
+			for (std::size_t l = 0; l < lanes && first + l < n; ++l)
+			{
+				colors[first + l] = marble(points[first + l][Z], std::abs(sums[l]));
+			}
+		}
+	}
+
+	template<typename T>
+	const Perlin<T> &NoiseTexture<T>::noise() const
+	{
+		return mNoise;
+	}
+}
+
+#endif
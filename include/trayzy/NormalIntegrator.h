@@ -0,0 +1,42 @@
+#ifndef TRAYZY_NORMALINTEGRATOR_H
+#define TRAYZY_NORMALINTEGRATOR_H
+
+#include "Integrator.h"
+#include "Intersection.h"
+
+#include <limits>
+
+namespace trayzy
+{
+	/**
+	 * Shows the unit normal at the first hit, mapping each component from [-1, 1] to [0, 1].
+	 * Rays that escape the scene are black.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class NormalIntegrator : public Integrator<T>
+	{
+	public:
+		// Integrator::radiance
+		virtual Vec3<T> radiance(const Ray<T> &ray, const Hittable<T> &world) const override;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	Vec3<T> NormalIntegrator<T>::radiance(const Ray<T> &ray, const Hittable<T> &world) const
+	{
+		Intersection<T> intersection;
+
+		if (!world.hit(ray, T(0.001f), std::numeric_limits<T>::max(), intersection))
+		{
+			return Vec3<T>(0, 0, 0);
+		}
+
+		return T(0.5) * (unitVector(intersection.normal) + Vec3<T>(1, 1, 1));
+	}
+}
+
+#endif
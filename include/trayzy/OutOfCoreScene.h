@@ -0,0 +1,812 @@
+#ifndef TRAYZY_OUTOFCORESCENE_H
+#define TRAYZY_OUTOFCORESCENE_H
+
+#include "Aabb.h"
+#include "BvhBuilder.h"
+#include "Hittable.h"
+#include "HitRecord.h"
+#include "Intersection.h"
+#include "MappedFile.h"
+#include "Material.h"
+#include "Ray.h"
+#include "RenderStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace trayzy
+{
+	/// Counters of the chunk residency of an out-of-core scene
+	struct OutOfCoreStats
+	{
+		/// The number of times traversal entered a chunk
+		std::uint64_t accesses = 0;
+
+		/// The number of times a chunk that was not resident had to be paged in
+		std::uint64_t loads = 0;
+
+		/// The number of times a chunk was released to stay within the budget
+		std::uint64_t evictions = 0;
+
+		/// The bytes of the chunks currently resident
+		std::size_t residentBytes = 0;
+
+		/// The most bytes of chunks that were resident at once
+		std::size_t peakResidentBytes = 0;
+	};
+
+	/**
+	 * A sphere scene that stays in a memory-mapped file and pages geometry in as rays need it.
+	 *
+	 * The file groups spatially close spheres into chunks of a few thousand, each with its own
+	 * bounding volume hierarchy, and starts every chunk on its own pages. Only the chunk
+	 * table and a small hierarchy over the chunks' bounds are kept in memory. Traversal reads
+	 * a chunk straight from the mapping, and a least recently used list releases the pages
+	 * of the chunks used longest ago once the resident chunks exceed the budget, so scenes
+	 * larger than memory render in a bounded working set. A chunk that another thread is
+	 * still reading when it is released simply faults back in, so the budget bounds what
+	 * stays resident between accesses rather than what is briefly touched.
+	 *
+	 * Tracing rays one at a time visits chunks in the order each ray needs them, which pages
+	 * the same chunks in over and over once the budget is tight. closestHits instead reorders
+	 * a batch so that every chunk is paged in once for all the rays that reach it.
+	 *
+	 * Materials are not stored in the file; spheres hold indices into a table supplied when
+	 * the file is opened. The file uses the byte order of the machine that wrote it.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class OutOfCoreScene : public Hittable<T>
+	{
+	public:
+		/// A sphere to store in a scene file
+		struct Primitive
+		{
+			/// The center of the sphere
+			Vec3<T> center;
+
+			/// The radius of the sphere, which is negative for inward normals
+			T radius;
+
+			/// The index of the sphere's material in the material table
+			std::uint32_t material;
+		};
+
+		/**
+		 * Opens a scene file.
+		 *
+		 * @param path The path of a file written by write
+		 * @param materials The material table the spheres' indices refer to
+		 * @param budgetBytes The bytes of chunks to keep resident, though at least one chunk always is
+		 * @throws std::runtime_error If the file cannot be mapped or is not a valid scene file
+		 */
+		OutOfCoreScene(const std::string &path, std::vector<std::shared_ptr<Material<T>>> materials,
+			std::size_t budgetBytes);
+
+		/**
+		 * Writes spheres to a scene file, clustering them into chunks.
+		 *
+		 * @param path The path of the file to write
+		 * @param spheres The spheres to store
+		 * @param chunkSize The largest number of spheres in a chunk, at most 65535
+		 * @throws std::runtime_error If the file cannot be written
+		 */
+		static void write(const std::string &path, const std::vector<Primitive> &spheres, int chunkSize = 4096);
+
+		// Hittable::closestHit
+		virtual bool closestHit(const Ray<T> &ray, T tMin, T tMax, HitRecord<T> &record) const override;
+
+		// Hittable::evaluate
+		virtual void evaluate(const Ray<T> &ray, const HitRecord<T> &record, Intersection<T> &intersection) const override;
+
+		// Hittable::occluded
+		virtual bool occluded(const Ray<T> &ray, T tMin, T tMax) const override;
+
+		// Hittable::boundingBox
+		virtual Aabb<T> boundingBox() const override;
+
+		/**
+		 * Finds the closest hits of a batch of rays, visiting each chunk once.
+		 *
+		 * The chunks every ray may reach are found from the resident hierarchy first, and the
+		 * chunks are then visited in file order, each testing all of its rays at once. A ray
+		 * skips a chunk that lies beyond its closest hit so far. Chunks are not visited front
+		 * to back along each ray, so rays may test more spheres than when traced one at a time.
+		 *
+		 * @param rays The rays to trace
+		 * @param tMin The smallest parametric coordinate of a hit
+		 * @param tMax The largest parametric coordinate of a hit
+		 * @param[out] records The closest hit of every ray, whose primitive is null for misses
+		 */
+		void closestHits(const std::vector<Ray<T>> &rays, T tMin, T tMax, std::vector<HitRecord<T>> &records) const;
+
+		/// Returns the number of chunks in the file
+		inline std::size_t chunkCount() const;
+
+		/// Returns the number of spheres in the file
+		inline std::size_t size() const;
+
+		/// Returns the size of the file in bytes
+		inline std::size_t fileBytes() const;
+
+		/// Returns the residency counters since the scene was opened or the counters were reset
+		OutOfCoreStats stats() const;
+
+		/// Resets the access, load and eviction counters and the peak to the current residency
+		void resetStats();
+
+	private:
+		/// The first bytes of a scene file
+		struct FileHeader
+		{
+			char magic[8];
+			std::uint32_t version;
+			std::uint32_t nChunks;
+			std::uint64_t nSpheres;
+		};
+
+		/// An entry of the chunk table that follows the header
+		struct FileChunk
+		{
+			float lower[3];
+			float upper[3];
+			std::uint64_t offset;
+			std::uint64_t bytes;
+			std::uint32_t first;
+			std::uint32_t nSpheres;
+			std::uint32_t nNodes;
+			std::uint32_t unused;
+		};
+
+		/// A node of a chunk's hierarchy, laid out like BvhNode
+		struct FileNode
+		{
+			float lower[3];
+			float upper[3];
+			std::uint32_t offset;
+			std::uint16_t count;
+			std::uint8_t axis;
+			std::uint8_t unused;
+		};
+
+		/// A sphere of a chunk, stored after the chunk's nodes
+		struct FileSphere
+		{
+			float center[3];
+			float radius;
+			std::uint32_t material;
+		};
+
+		/// The alignment of chunks in the file, a multiple of common page sizes
+		static constexpr std::size_t chunkAlignment = 16384;
+
+		/// Returns the bounds stored as floats
+		static inline Aabb<T> boundsOf(const float lower[3], const float upper[3]);
+
+		/// Returns the smallest root within the range of a ray and a sphere, or tMax if there is none
+		static inline T intersect(const Ray<T> &ray, const FileSphere &sphere, T tMin, T tMax);
+
+		/// Marks a chunk as used, paging it in and releasing others as needed, and returns its data
+		const unsigned char *acquire(std::uint32_t chunk) const;
+
+		/// Finds the closest hit within one chunk, narrowing tMax
+		bool closestHitInChunk(std::uint32_t chunk, const Ray<T> &ray, const Vec3<T> &inverseDirection, T tMin,
+			T &tMax, HitRecord<T> &record) const;
+
+		/// Returns whether any sphere of one chunk blocks a ray
+		bool occludedInChunk(std::uint32_t chunk, const Ray<T> &ray, const Vec3<T> &inverseDirection, T tMin,
+			T tMax) const;
+
+		/// Calls a function with every chunk whose bounds a ray overlaps, nearer side first, until it returns true
+		template<typename Function>
+		bool forEachChunk(const Ray<T> &ray, const Vec3<T> &inverseDirection, T tMin, const T &tMax,
+			Function function) const;
+
+	private:
+		MappedFile mFile;
+		std::vector<std::shared_ptr<Material<T>>> mMaterials;
+		std::vector<FileChunk> mChunks;
+		std::vector<BvhNode<T>> mNodes;
+		std::vector<std::uint32_t> mOrder;
+		std::size_t mBudgetBytes;
+		std::size_t mSpheres = 0;
+
+		// The residency list, most recently used first, guarded by the mutex
+		mutable std::mutex mMutex;
+		mutable std::list<std::uint32_t> mRecent;
+		mutable std::vector<std::list<std::uint32_t>::iterator> mRecentPositions;
+		mutable std::vector<bool> mResident;
+		mutable OutOfCoreStats mStats;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	OutOfCoreScene<T>::OutOfCoreScene(const std::string &path, std::vector<std::shared_ptr<Material<T>>> materials,
+		std::size_t budgetBytes) :
+		mFile(path),
+		mMaterials(std::move(materials)),
+		mBudgetBytes(budgetBytes)
+	{
+		FileHeader header;
+
+		if (mFile.size() < sizeof(header))
+		{
+			throw std::runtime_error("OutOfCoreScene: truncated scene file " + path);
+		}
+
+		std::memcpy(&header, mFile.data(), sizeof(header));
+
+		if (std::memcmp(header.magic, "TRAYZYOC", 8) != 0 || header.version != 1)
+		{
+			throw std::runtime_error("OutOfCoreScene: unsupported scene file " + path);
+		}
+
+		if (header.nChunks > (mFile.size() - sizeof(header)) / sizeof(FileChunk))
+		{
+			throw std::runtime_error("OutOfCoreScene: truncated scene file " + path);
+		}
+
+		mChunks.resize(header.nChunks);
+		std::memcpy(mChunks.data(), mFile.data() + sizeof(header), mChunks.size() * sizeof(FileChunk));
+
+		std::vector<Aabb<T>> bounds;
+
+		for (const FileChunk &chunk : mChunks)
+		{
+			std::uint64_t needed = std::uint64_t(chunk.nNodes) * sizeof(FileNode) + std::uint64_t(chunk.nSpheres) * sizeof(FileSphere);
+
+			if (chunk.offset % chunkAlignment != 0 || chunk.bytes < needed || chunk.offset > mFile.size()
+				|| chunk.bytes > mFile.size() - chunk.offset || chunk.first != mSpheres || chunk.nNodes == 0)
+			{
+				throw std::runtime_error("OutOfCoreScene: corrupt chunk table in " + path);
+			}
+
+			mSpheres += chunk.nSpheres;
+			bounds.push_back(boundsOf(chunk.lower, chunk.upper));
+		}
+
+		if (mSpheres != header.nSpheres)
+		{
+			throw std::runtime_error("OutOfCoreScene: corrupt chunk table in " + path);
+		}
+
+		// The hierarchy over the chunks is small enough to always stay in memory
+		BvhBuilder<T> builder(bounds, 1);
+		mNodes = std::move(builder.nodes());
+		mOrder = builder.order();
+
+		mRecentPositions.resize(mChunks.size());
+		mResident.resize(mChunks.size(), false);
+	}
+
+	/* static */
+	template<typename T>
+	void OutOfCoreScene<T>::write(const std::string &path, const std::vector<Primitive> &spheres, int chunkSize)
+	{
+		auto boundsOfSphere = [&spheres](std::uint32_t i)
+		{
+			T r = std::abs(spheres[i].radius);
+			return Aabb<T>(spheres[i].center - Vec3<T>(r, r, r), spheres[i].center + Vec3<T>(r, r, r));
+		};
+
+		std::vector<Aabb<T>> bounds(spheres.size());
+
+		for (std::uint32_t i = 0; i < spheres.size(); ++i)
+		{
+			bounds[i] = boundsOfSphere(i);
+		}
+
+		// The leaves of a hierarchy with chunk-sized leaves are spatially compact clusters
+		BvhBuilder<T> clusters(bounds, chunkSize);
+		std::vector<Aabb<T>>().swap(bounds);
+
+		std::vector<FileChunk> chunks;
+
+		for (const BvhNode<T> &leaf : clusters.nodes())
+		{
+			if (leaf.count > 0 || clusters.nodes().size() == 1)
+			{
+				FileChunk chunk = {};
+				chunk.first = leaf.offset;
+				chunk.nSpheres = leaf.count;
+				chunks.push_back(chunk);
+			}
+		}
+
+		// Leaves come in depth-first order, which is also the order of their spheres
+		std::sort(chunks.begin(), chunks.end(), [](const FileChunk &a, const FileChunk &b) { return a.first < b.first; });
+
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		FileHeader header = {};
+		std::memcpy(header.magic, "TRAYZYOC", 8);
+		header.version = 1;
+		header.nChunks = std::uint32_t(chunks.size());
+		header.nSpheres = spheres.size();
+
+		// The chunk table is written again once every chunk's layout is known
+		out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		out.write(reinterpret_cast<const char *>(chunks.data()), std::streamsize(chunks.size() * sizeof(FileChunk)));
+		std::uint64_t offset = sizeof(header) + chunks.size() * sizeof(FileChunk);
+
+		for (FileChunk &chunk : chunks)
+		{
+			std::vector<Aabb<T>> localBounds(chunk.nSpheres);
+			Aabb<T> chunkBounds;
+
+			for (std::uint32_t i = 0; i < chunk.nSpheres; ++i)
+			{
+				localBounds[i] = boundsOfSphere(clusters.order()[chunk.first + i]);
+				chunkBounds.expand(localBounds[i]);
+			}
+
+			BvhBuilder<T> local(localBounds, 4);
+			chunk.nNodes = std::uint32_t(local.nodes().size());
+			chunk.offset = (offset + chunkAlignment - 1) / chunkAlignment * chunkAlignment;
+			chunk.bytes = std::uint64_t(chunk.nNodes) * sizeof(FileNode) + std::uint64_t(chunk.nSpheres) * sizeof(FileSphere);
+
+			for (int axis = X; axis <= Z; ++axis)
+			{
+				chunk.lower[axis] = float(chunkBounds.lower()[axis]);
+				chunk.upper[axis] = float(chunkBounds.upper()[axis]);
+			}
+
+			std::vector<char> data(std::size_t(chunk.offset - offset), 0);
+			data.reserve(data.size() + std::size_t(chunk.bytes));
+
+			for (const BvhNode<T> &node : local.nodes())
+			{
+				FileNode stored = {};
+
+				for (int axis = X; axis <= Z; ++axis)
+				{
+					stored.lower[axis] = float(node.bounds.lower()[axis]);
+					stored.upper[axis] = float(node.bounds.upper()[axis]);
+				}
+
+				stored.offset = node.offset;
+				stored.count = node.count;
+				stored.axis = node.axis;
+				const char *bytes = reinterpret_cast<const char *>(&stored);
+				data.insert(data.end(), bytes, bytes + sizeof(stored));
+			}
+
+			for (std::uint32_t i = 0; i < chunk.nSpheres; ++i)
+			{
+				const Primitive &sphere = spheres[clusters.order()[chunk.first + local.order()[i]]];
+				FileSphere stored = {};
+
+				for (int axis = X; axis <= Z; ++axis)
+				{
+					stored.center[axis] = float(sphere.center[axis]);
+				}
+
+				stored.radius = float(sphere.radius);
+				stored.material = sphere.material;
+				const char *bytes = reinterpret_cast<const char *>(&stored);
+				data.insert(data.end(), bytes, bytes + sizeof(stored));
+			}
+
+			out.write(data.data(), std::streamsize(data.size()));
+			offset = chunk.offset + chunk.bytes;
+		}
+
+		out.seekp(sizeof(header));
+		out.write(reinterpret_cast<const char *>(chunks.data()), std::streamsize(chunks.size() * sizeof(FileChunk)));
+
+		if (!out)
+		{
+			throw std::runtime_error("OutOfCoreScene: cannot write " + path);
+		}
+	}
+
+	/* static */
+	template<typename T>
+	Aabb<T> OutOfCoreScene<T>::boundsOf(const float lower[3], const float upper[3])
+	{
+		return Aabb<T>(Vec3<T>(T(lower[X]), T(lower[Y]), T(lower[Z])), Vec3<T>(T(upper[X]), T(upper[Y]), T(upper[Z])));
+	}
+
+	/* static */
+	template<typename T>
+	T OutOfCoreScene<T>::intersect(const Ray<T> &ray, const FileSphere &sphere, T tMin, T tMax)
+	{
+		countIntersectionTests();
+		Vec3<T> oc = ray.origin() - Vec3<T>(T(sphere.center[X]), T(sphere.center[Y]), T(sphere.center[Z]));
+		T radius = T(sphere.radius);
+
+		T a = ray.direction().magnitudeSquared();
+		T b = 2 * dot(oc, ray.direction());
+		T c = oc.magnitudeSquared() - radius * radius;
+
+		T discriminant = b * b - 4 * a * c;
+
+		if (discriminant <= 0)
+		{
+			return tMax;
+		}
+
+		T sqrtDiscriminant = std::sqrt(discriminant);
+
+		for (T sign : {T(-1), T(1)})
+		{
+			T root = (-b + sign * sqrtDiscriminant) / (2 * a);
+
+			if (root < tMax && root > tMin)
+			{
+				return root;
+			}
+		}
+
+		return tMax;
+	}
+
+	template<typename T>
+	const unsigned char *OutOfCoreScene<T>::acquire(std::uint32_t chunk) const
+	{
+		const FileChunk &entry = mChunks[chunk];
+		std::lock_guard<std::mutex> lock(mMutex);
+		++mStats.accesses;
+
+		if (mResident[chunk])
+		{
+			mRecent.splice(mRecent.begin(), mRecent, mRecentPositions[chunk]);
+			return mFile.data() + entry.offset;
+		}
+
+		++mStats.loads;
+		mFile.prefetch(std::size_t(entry.offset), std::size_t(entry.bytes));
+		mRecent.push_front(chunk);
+		mRecentPositions[chunk] = mRecent.begin();
+		mResident[chunk] = true;
+		mStats.residentBytes += std::size_t(entry.bytes);
+
+		// Release the least recently used chunks, but never the one just acquired
+		while (mStats.residentBytes > mBudgetBytes && mRecent.size() > 1)
+		{
+			std::uint32_t evicted = mRecent.back();
+			const FileChunk &evictedEntry = mChunks[evicted];
+			mRecent.pop_back();
+			mResident[evicted] = false;
+			mStats.residentBytes -= std::size_t(evictedEntry.bytes);
+			++mStats.evictions;
+			mFile.release(std::size_t(evictedEntry.offset), std::size_t(evictedEntry.bytes));
+		}
+
+		mStats.peakResidentBytes = std::max(mStats.peakResidentBytes, mStats.residentBytes);
+		return mFile.data() + entry.offset;
+	}
+
+	template<typename T>
+	template<typename Function>
+	bool OutOfCoreScene<T>::forEachChunk(const Ray<T> &ray, const Vec3<T> &inverseDirection, T tMin, const T &tMax,
+		Function function) const
+	{
+		std::uint32_t stack[64];
+		int stackSize = 0;
+		std::uint32_t node = 0;
+
+		while (true)
+		{
+			const BvhNode<T> &current = mNodes[node];
+
+			// The function may narrow tMax, which prunes the chunks still on the stack
+			if (current.bounds.overlaps(ray.origin(), inverseDirection, tMin, tMax))
+			{
+				if (current.count > 0)
+				{
+					if (function(mOrder[current.offset]))
+					{
+						return true;
+					}
+				}
+				else
+				{
+					if (ray.direction()[current.axis] < 0)
+					{
+						stack[stackSize++] = node + 1;
+						node = current.offset;
+					}
+					else
+					{
+						stack[stackSize++] = current.offset;
+						node = node + 1;
+					}
+
+					continue;
+				}
+			}
+
+			if (stackSize == 0)
+			{
+				return false;
+			}
+
+			node = stack[--stackSize];
+		}
+	}
+
+	template<typename T>
+	bool OutOfCoreScene<T>::closestHitInChunk(std::uint32_t chunk, const Ray<T> &ray, const Vec3<T> &inverseDirection,
+		T tMin, T &tMax, HitRecord<T> &record) const
+	{
+		const FileChunk &entry = mChunks[chunk];
+		const unsigned char *data = acquire(chunk);
+		const FileNode *nodes = reinterpret_cast<const FileNode *>(data);
+		const FileSphere *spheres = reinterpret_cast<const FileSphere *>(data + entry.nNodes * sizeof(FileNode));
+
+		std::uint32_t stack[128];
+		int stackSize = 0;
+		std::uint32_t node = 0;
+		bool hasHit = false;
+
+		while (true)
+		{
+			const FileNode &current = nodes[node];
+
+			if (boundsOf(current.lower, current.upper).overlaps(ray.origin(), inverseDirection, tMin, tMax))
+			{
+				if (current.count > 0)
+				{
+					for (std::uint32_t i = current.offset; i < current.offset + current.count; ++i)
+					{
+						T t = intersect(ray, spheres[i], tMin, tMax);
+
+						if (t < tMax)
+						{
+							tMax = t;
+							record.t = t;
+							record.primitive = this;
+							record.index = entry.first + i;
+							hasHit = true;
+						}
+					}
+				}
+				else
+				{
+					if (ray.direction()[current.axis] < 0)
+					{
+						stack[stackSize++] = node + 1;
+						node = current.offset;
+					}
+					else
+					{
+						stack[stackSize++] = current.offset;
+						node = node + 1;
+					}
+
+					continue;
+				}
+			}
+
+			if (stackSize == 0)
+			{
+				return hasHit;
+			}
+
+			node = stack[--stackSize];
+		}
+	}
+
+	template<typename T>
+	bool OutOfCoreScene<T>::occludedInChunk(std::uint32_t chunk, const Ray<T> &ray, const Vec3<T> &inverseDirection,
+		T tMin, T tMax) const
+	{
+		const FileChunk &entry = mChunks[chunk];
+		const unsigned char *data = acquire(chunk);
+		const FileNode *nodes = reinterpret_cast<const FileNode *>(data);
+		const FileSphere *spheres = reinterpret_cast<const FileSphere *>(data + entry.nNodes * sizeof(FileNode));
+
+		std::uint32_t stack[128];
+		int stackSize = 0;
+		std::uint32_t node = 0;
+
+		while (true)
+		{
+			const FileNode &current = nodes[node];
+
+			if (boundsOf(current.lower, current.upper).overlaps(ray.origin(), inverseDirection, tMin, tMax))
+			{
+				if (current.count == 0)
+				{
+					stack[stackSize++] = current.offset;
+					node = node + 1;
+					continue;
+				}
+
+				for (std::uint32_t i = current.offset; i < current.offset + current.count; ++i)
+				{
+					if (intersect(ray, spheres[i], tMin, tMax) < tMax)
+					{
+						return true;
+					}
+				}
+			}
+
+			if (stackSize == 0)
+			{
+				return false;
+			}
+
+			node = stack[--stackSize];
+		}
+	}
+
+	template<typename T>
+	bool OutOfCoreScene<T>::closestHit(const Ray<T> &ray, T tMin, T tMax, HitRecord<T> &record) const
+	{
+		if (mSpheres == 0)
+		{
+			return false;
+		}
+
+		Vec3<T> inverseDirection(1 / ray.direction()[X], 1 / ray.direction()[Y], 1 / ray.direction()[Z]);
+		bool hasHit = false;
+
+		forEachChunk(ray, inverseDirection, tMin, tMax, [&](std::uint32_t chunk)
+		{
+			hasHit |= closestHitInChunk(chunk, ray, inverseDirection, tMin, tMax, record);
+			return false;
+		});
+
+		return hasHit;
+	}
+
+	template<typename T>
+	bool OutOfCoreScene<T>::occluded(const Ray<T> &ray, T tMin, T tMax) const
+	{
+		if (mSpheres == 0)
+		{
+			return false;
+		}
+
+		Vec3<T> inverseDirection(1 / ray.direction()[X], 1 / ray.direction()[Y], 1 / ray.direction()[Z]);
+
+		return forEachChunk(ray, inverseDirection, tMin, tMax, [&](std::uint32_t chunk)
+		{
+			return occludedInChunk(chunk, ray, inverseDirection, tMin, tMax);
+		});
+	}
+
+	template<typename T>
+	void OutOfCoreScene<T>::evaluate(const Ray<T> &ray, const HitRecord<T> &record, Intersection<T> &intersection) const
+	{
+		auto next = std::upper_bound(mChunks.begin(), mChunks.end(), record.index,
+			[](std::uint32_t index, const FileChunk &chunk) { return index < chunk.first; });
+		std::uint32_t chunk = std::uint32_t(next - mChunks.begin()) - 1;
+		const FileChunk &entry = mChunks[chunk];
+
+		FileSphere sphere;
+		std::memcpy(&sphere, acquire(chunk) + entry.nNodes * sizeof(FileNode)
+			+ (record.index - entry.first) * sizeof(FileSphere), sizeof(sphere));
+
+		if (sphere.material >= mMaterials.size())
+		{
+			throw std::runtime_error("OutOfCoreScene: material index out of range");
+		}
+
+		Vec3<T> center(T(sphere.center[X]), T(sphere.center[Y]), T(sphere.center[Z]));
+		intersection.t = record.t;
+		intersection.p = ray.pointAtParameter(record.t);
+		intersection.normal = (intersection.p - center) / T(sphere.radius);
+		intersection.material = mMaterials[sphere.material];
+		intersection.materialIndex = sphere.material;
+	}
+
+	template<typename T>
+	void OutOfCoreScene<T>::closestHits(const std::vector<Ray<T>> &rays, T tMin, T tMax,
+		std::vector<HitRecord<T>> &records) const
+	{
+		records.assign(rays.size(), HitRecord<T>());
+		std::vector<T> closest(rays.size(), tMax);
+		std::vector<Vec3<T>> inverseDirections(rays.size());
+
+		if (mSpheres == 0)
+		{
+			return;
+		}
+
+		// Bucket the rays by every chunk they may reach, using only the resident hierarchy
+		std::vector<std::uint32_t> bucketSizes(mChunks.size() + 1, 0);
+		std::vector<std::pair<std::uint32_t, std::uint32_t>> visits;
+
+		for (std::uint32_t i = 0; i < rays.size(); ++i)
+		{
+			const Vec3<T> &direction = rays[i].direction();
+			inverseDirections[i] = Vec3<T>(1 / direction[X], 1 / direction[Y], 1 / direction[Z]);
+
+			forEachChunk(rays[i], inverseDirections[i], tMin, tMax, [&](std::uint32_t chunk)
+			{
+				visits.emplace_back(chunk, i);
+				++bucketSizes[chunk + 1];
+				return false;
+			});
+		}
+
+		for (std::size_t chunk = 1; chunk < bucketSizes.size(); ++chunk)
+		{
+			bucketSizes[chunk] += bucketSizes[chunk - 1];
+		}
+
+		std::vector<std::uint32_t> bucketed(visits.size());
+
+		for (const std::pair<std::uint32_t, std::uint32_t> &visit : visits)
+		{
+			bucketed[bucketSizes[visit.first]++] = visit.second;
+		}
+
+		std::vector<std::pair<std::uint32_t, std::uint32_t>>().swap(visits);
+
+		// After the scatter every bucket's end is where the next one begins
+		for (std::uint32_t chunk = 0, first = 0; chunk < mChunks.size(); first = bucketSizes[chunk++])
+		{
+			Aabb<T> bounds = boundsOf(mChunks[chunk].lower, mChunks[chunk].upper);
+
+			for (std::uint32_t j = first; j < bucketSizes[chunk]; ++j)
+			{
+				std::uint32_t i = bucketed[j];
+
+				if (bounds.overlaps(rays[i].origin(), inverseDirections[i], tMin, closest[i]))
+				{
+					closestHitInChunk(chunk, rays[i], inverseDirections[i], tMin, closest[i], records[i]);
+				}
+			}
+		}
+	}
+
+	template<typename T>
+	Aabb<T> OutOfCoreScene<T>::boundingBox() const
+	{
+		return mNodes.empty() || mChunks.empty() ? Aabb<T>() : mNodes.front().bounds;
+	}
+
+	template<typename T>
+	std::size_t OutOfCoreScene<T>::chunkCount() const
+	{
+		return mChunks.size();
+	}
+
+	template<typename T>
+	std::size_t OutOfCoreScene<T>::size() const
+	{
+		return mSpheres;
+	}
+
+	template<typename T>
+	std::size_t OutOfCoreScene<T>::fileBytes() const
+	{
+		return mFile.size();
+	}
+
+	template<typename T>
+	OutOfCoreStats OutOfCoreScene<T>::stats() const
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		return mStats;
+	}
+
+	template<typename T>
+	void OutOfCoreScene<T>::resetStats()
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStats.accesses = 0;
+		mStats.loads = 0;
+		mStats.evictions = 0;
+		mStats.peakResidentBytes = mStats.residentBytes;
+	}
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef TRAYZY_PATHINTEGRATOR_H
+#define TRAYZY_PATHINTEGRATOR_H
+
+#include "EnvironmentLight.h"
+#include "Integrator.h"
+#include "LightSampler.h"
+#include "PathTracer.h"
+
+#include <memory>
+#include <utility>
+
+namespace trayzy
+{
+	/**
+	 * The full recursive path tracer, optionally sampling lights directly at diffuse hits.
+	 *
+	 * Rays that escape the scene see the sky gradient, or an environment light, which is
+	 * then sampled directly at diffuse hits too and weighted against scattering by multiple
+	 * importance sampling.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class PathIntegrator : public Integrator<T>
+	{
+	public:
+		/**
+		 * Creates a path tracer.
+		 *
+		 * @param lights The lights to sample directly at diffuse hits, or null to find light
+		 *        by scattering alone
+		 * @param environment The light arriving from infinitely far away, or null for the sky gradient
+		 */
+		explicit PathIntegrator(std::shared_ptr<const LightSampler<T>> lights = nullptr,
+			std::shared_ptr<const EnvironmentLight<T>> environment = nullptr) :
+			mLights(std::move(lights)),
+			mEnvironment(std::move(environment))
+		{
+			// Do nothing more
+		}
+
+		// Integrator::radiance
+		virtual Vec3<T> radiance(const Ray<T> &ray, const Hittable<T> &world) const override;
+
+		// Integrator::radianceFromHit
+		virtual Vec3<T> radianceFromHit(const Ray<T> &ray, const Intersection<T> *intersection,
+			const Hittable<T> &world) const override;
+
+	private:
+		std::shared_ptr<const LightSampler<T>> mLights;
+		std::shared_ptr<const EnvironmentLight<T>> mEnvironment;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	Vec3<T> PathIntegrator<T>::radiance(const Ray<T> &ray, const Hittable<T> &world) const
+	{
+		if (mEnvironment)
+		{
+			return color(ray, world, *mEnvironment, mLights.get(), 0);
+		}
+
+		return mLights ? color(ray, world, *mLights, 0) : color(ray, world, 0);
+	}
+
+	template<typename T>
+	Vec3<T> PathIntegrator<T>::radianceFromHit(const Ray<T> &ray, const Intersection<T> *intersection,
+		const Hittable<T> &world) const
+	{
+		if (mEnvironment)
+		{
+			return intersection ? shade(ray, world, *mEnvironment, mLights.get(), *intersection, 0)
+				: mEnvironment->radiance(ray.direction());
+		}
+
+		if (!intersection)
+		{
+			return background(ray);
+		}
+
+		return mLights ? shade(ray, world, *mLights, *intersection, 0) : shade(ray, world, *intersection, 0);
+	}
+}
+
+#endif
@@ -0,0 +1,471 @@
+#ifndef TRAYZY_PATHTRACER_H
+#define TRAYZY_PATHTRACER_H
+
+#include "EnvironmentLight.h"
+#include "Forward.h"
+#include "Hittable.h"
+#include "Intersection.h"
+#include "LightSampler.h"
+#include "Material.h"
+#include "Random.h"
+#include "Ray.h"
+#include "Vec3.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace trayzy
+{
+	/**
+	 * Scatters a ray at a hit in a scene whose materials are resolved through virtual calls.
+	 *
+	 * @param world The scene that produced the intersection
+	 * @param inbound The inbound ray
+	 * @param intersection The properties at the intersection location
+	 * @param[out] attenuation The attenuation of the scattered ray
+	 * @param[out] scattered The scattered ray
+	 * @return Whether the inbound ray was scattered
+	 */
+	template<typename T>
+	inline bool scatter(const Hittable<T> &world, const Ray<T> &inbound, const Intersection<T> &intersection,
+		Vec3<T> &attenuation, Ray<T> &scattered);
+
+	/**
+	 * Returns the radiance emitted at a hit in a scene whose materials are resolved through virtual calls.
+	 *
+	 * @param world The scene that produced the intersection
+	 * @param intersection The properties at the intersection location
+	 * @return The emitted radiance
+	 */
+	template<typename T>
+	inline Vec3<T> emitted(const Hittable<T> &world, const Intersection<T> &intersection);
+
+	/// Returns the color of the sky seen along a ray that escapes the scene
+	template<typename T>
+	inline Vec3<T> background(const Ray<T> &ray);
+
+	/**
+	 * Computes the color seen along a ray by recursively tracing its scattered paths.
+	 *
+	 * The scene type only needs a hit() member and matching scatter() and emitted() overloads,
+	 * so the same integrator serves both open, virtual scenes and closed, statically
+	 * dispatched ones.
+	 *
+	 * @tparam World The scene type
+	 * @param ray The ray to trace
+	 * @param world The scene to trace against
+	 * @param depth The number of bounces that led to this ray
+	 * @return The color seen along the ray
+	 */
+	template<typename T, typename World>
+	Vec3<T> color(const Ray<T> &ray, const World &world, int depth);
+
+	/**
+	 * Computes the color seen along a ray whose closest hit is already known, such as one
+	 * found by rasterizing, and traces its scattered paths from there.
+	 *
+	 * @tparam World The scene type
+	 * @param ray The ray that was traced
+	 * @param world The scene to trace the scattered paths against
+	 * @param intersection The properties at the closest hit along the ray
+	 * @param depth The number of bounces that led to the ray
+	 * @return The color seen along the ray
+	 */
+	template<typename T, typename World>
+	Vec3<T> shade(const Ray<T> &ray, const World &world, const Intersection<T> &intersection, int depth);
+
+	/**
+	 * Estimates the light arriving directly from one light chosen by a sampler.
+	 *
+	 * A point is sampled uniformly within the cone that the chosen light subtends, and a
+	 * shadow ray checks that nothing lies between the light and the hit.
+	 *
+	 * @param world The scene that produced the intersection
+	 * @param lights The lights of the scene
+	 * @param inbound The inbound ray
+	 * @param intersection The properties at the intersection location
+	 * @param[out] radiance The reflected radiance due to the sampled light
+	 * @return Whether a direction toward a light was sampled at a material that can be sampled
+	 *         directly; if not, because no light was chosen, the hit lies inside the chosen
+	 *         light or the material only scatters into discrete directions, emission must be
+	 *         found by scattering instead
+	 */
+	template<typename T>
+	bool sampleDirect(const Hittable<T> &world, const LightSampler<T> &lights, const Ray<T> &inbound,
+		const Intersection<T> &intersection, Vec3<T> &radiance);
+
+	/**
+	 * Computes the color seen along a ray, sampling lights directly at every diffuse hit.
+	 *
+	 * Emission reached by a ray scattered off a diffuse surface was already counted by
+	 * sampling the lights there, so only emission seen directly or through discrete
+	 * reflections and refractions is added.
+	 *
+	 * @param ray The ray to trace
+	 * @param world The scene to trace against
+	 * @param lights The emissive spheres of the scene
+	 * @param depth The number of bounces that led to this ray
+	 * @param countEmission Whether emission found along the ray contributes
+	 * @return The color seen along the ray
+	 */
+	template<typename T>
+	Vec3<T> color(const Ray<T> &ray, const Hittable<T> &world, const LightSampler<T> &lights, int depth,
+		bool countEmission = true);
+
+	/**
+	 * Computes the color seen along a ray whose closest hit is already known, sampling
+	 * lights directly at every diffuse hit.
+	 *
+	 * @param ray The ray that was traced
+	 * @param world The scene to trace the scattered paths against
+	 * @param lights The emissive spheres of the scene
+	 * @param intersection The properties at the closest hit along the ray
+	 * @param depth The number of bounces that led to the ray
+	 * @param countEmission Whether emission at the hit contributes
+	 * @return The color seen along the ray
+	 */
+	template<typename T>
+	Vec3<T> shade(const Ray<T> &ray, const Hittable<T> &world, const LightSampler<T> &lights,
+		const Intersection<T> &intersection, int depth, bool countEmission = true);
+
+	/// Returns the weight of a sample under the power heuristic of multiple importance sampling
+	template<typename T>
+	inline T powerHeuristic(T pdf, T otherPdf);
+
+	/**
+	 * Estimates the light arriving directly from an environment, weighted against finding
+	 * the same light by scattering.
+	 *
+	 * A direction is sampled from the environment's luminance, and a shadow ray checks that
+	 * nothing in the scene blocks it. The power heuristic weighs the sample by how likely
+	 * the material was to scatter toward the same direction, so that sharp peaks such as a
+	 * sun are found by light sampling while broad skies seen off glossy lobes still get the
+	 * scattered rays' share.
+	 *
+	 * @param world The scene that produced the intersection
+	 * @param environment The light arriving from infinitely far away
+	 * @param inbound The inbound ray
+	 * @param intersection The properties at the intersection location
+	 * @param[out] radiance The reflected radiance due to the sampled direction
+	 * @return Whether the material at the hit can be sampled directly, which is false for
+	 *         materials that only scatter into discrete directions
+	 */
+	template<typename T>
+	bool sampleEnvironment(const Hittable<T> &world, const EnvironmentLight<T> &environment, const Ray<T> &inbound,
+		const Intersection<T> &intersection, Vec3<T> &radiance);
+
+	/**
+	 * Computes the color seen along a ray in a scene lit by an environment, combining samples
+	 * of the environment at every diffuse hit with the scattered rays that escape to it by
+	 * multiple importance sampling.
+	 *
+	 * @param ray The ray to trace
+	 * @param world The scene to trace against
+	 * @param environment The light arriving from infinitely far away
+	 * @param lights The emissive spheres of the scene to sample directly as well, or null
+	 * @param depth The number of bounces that led to this ray
+	 * @param scatterPdf The probability density with which the ray was scattered, or zero for
+	 *        camera rays and discrete reflections and refractions, whose view of the
+	 *        environment counts fully
+	 * @param countEmission Whether emission of spheres found along the ray contributes
+	 * @return The color seen along the ray
+	 */
+	template<typename T>
+	Vec3<T> color(const Ray<T> &ray, const Hittable<T> &world, const EnvironmentLight<T> &environment,
+		const LightSampler<T> *lights, int depth, T scatterPdf = 0, bool countEmission = true);
+
+	/**
+	 * Computes the color seen along a ray whose closest hit is already known, in a scene lit
+	 * by an environment.
+	 *
+	 * @param ray The ray that was traced
+	 * @param world The scene to trace the scattered paths against
+	 * @param environment The light arriving from infinitely far away
+	 * @param lights The emissive spheres of the scene to sample directly as well, or null
+	 * @param intersection The properties at the closest hit along the ray
+	 * @param depth The number of bounces that led to the ray
+	 * @param countEmission Whether emission at the hit contributes
+	 * @return The color seen along the ray
+	 */
+	template<typename T>
+	Vec3<T> shade(const Ray<T> &ray, const Hittable<T> &world, const EnvironmentLight<T> &environment,
+		const LightSampler<T> *lights, const Intersection<T> &intersection, int depth, bool countEmission = true);
+}
+
+namespace trayzy
+{
+	template<typename T>
+	bool scatter(const Hittable<T> &world, const Ray<T> &inbound, const Intersection<T> &intersection,
+		Vec3<T> &attenuation, Ray<T> &scattered)
+	{
+		return intersection.material && intersection.material->scatter(inbound, intersection, attenuation, scattered);
+	}
+
+	template<typename T>
+	Vec3<T> emitted(const Hittable<T> &world, const Intersection<T> &intersection)
+	{
+		return intersection.material ? intersection.material->emitted(intersection) : Vec3<T>(0, 0, 0);
+	}
+
+	template<typename T>
+	Vec3<T> background(const Ray<T> &ray)
+	{
+		// Perform a linear blend (a.k.a. linear interpolation or "lerp")
+		// from pure white to "Maya blue"
+		Vec3<T> unitDirection = unitVector(ray.direction());
+		T t = T(0.5) * (unitDirection[Y] + 1);
+
+		Vec3<T> white(1, 1, 1);
+		Vec3<T> mayaBlue(T(0.5), T(0.7), 1);
+		return (1 - t) * white + t * mayaBlue;
+	}
+
+	template<typename T, typename World>
+	Vec3<T> color(const Ray<T> &ray, const World &world, int depth)
+	{
+		Intersection<T> intersection;
+		T hitEpsilon(0.001f);
+
+		if (world.hit(ray, hitEpsilon, std::numeric_limits<T>::max(), intersection))
+		{
+			return shade(ray, world, intersection, depth);
+		}
+
+		return background(ray);
+	}
+
+	template<typename T, typename World>
+	Vec3<T> shade(const Ray<T> &ray, const World &world, const Intersection<T> &intersection, int depth)
+	{
+		int maxDepth = 50;
+
+		Ray<T> scattered;
+		Vec3<T> attenuation;
+		Vec3<T> c = emitted(world, intersection);
+
+		if (depth < maxDepth && scatter(world, ray, intersection, attenuation, scattered))
+		{
+			c += attenuation * color(scattered, world, ++depth);
+		}
+
+		return c;
+	}
+
+	template<typename T>
+	bool sampleDirect(const Hittable<T> &world, const LightSampler<T> &lights, const Ray<T> &inbound,
+		const Intersection<T> &intersection, Vec3<T> &radiance)
+	{
+		Vec3<T> n = dot(intersection.normal, inbound.direction()) < 0 ? intersection.normal : -intersection.normal;
+		radiance = Vec3<T>(0, 0, 0);
+
+		T probability = 0;
+		const Light<T> *light = lights.sample(intersection.p, n, randomUniform<T>(), probability);
+		Vec3<T> direction = n;
+		Vec3<T> toCenter;
+		T distanceSquared = 0;
+		T solidAngle = 0;
+
+		if (light)
+		{
+			toCenter = light->center - intersection.p;
+			distanceSquared = toCenter.magnitudeSquared();
+		}
+
+		if (light && distanceSquared > light->radius * light->radius)
+		{
+			// Sample the cone of directions toward the sphere, keeping 1 - cos(theta) accurate for small lights
+			T sinSquaredMax = light->radius * light->radius / distanceSquared;
+			T oneMinusCosMax = sinSquaredMax / (1 + std::sqrt(1 - sinSquaredMax));
+			T oneMinusCos = randomUniform<T>() * oneMinusCosMax;
+			T cosTheta = 1 - oneMinusCos;
+			T sinTheta = std::sqrt(std::max(T(0), oneMinusCos * (2 - oneMinusCos)));
+			T phi = 2 * T(M_PI) * randomUniform<T>();
+
+			Vec3<T> w = toCenter / std::sqrt(distanceSquared);
+			Vec3<T> a = std::abs(w[X]) > T(0.9) ? Vec3<T>(0, 1, 0) : Vec3<T>(1, 0, 0);
+			Vec3<T> u = unitVector(cross(a, w));
+			Vec3<T> v = cross(w, u);
+
+			direction = sinTheta * std::cos(phi) * u + sinTheta * std::sin(phi) * v + cosTheta * w;
+			solidAngle = 2 * T(M_PI) * oneMinusCosMax;
+		}
+
+		Vec3<T> f;
+
+		if (solidAngle == 0 || !intersection.material
+			|| !intersection.material->brdf(inbound, intersection, direction, f))
+		{
+			return false;
+		}
+
+		T cosSurface = dot(n, direction);
+
+		if (cosSurface > 0)
+		{
+			// Stop the shadow ray just short of the light's near side
+			T b = dot(direction, toCenter);
+			T tLight = b - std::sqrt(std::max(T(0), b * b - distanceSquared + light->radius * light->radius));
+
+			if (!world.occluded(Ray<T>(intersection.p, direction), T(0.001f), tLight * T(0.999f)))
+			{
+				radiance = f * light->emission * (cosSurface * solidAngle / probability);
+			}
+		}
+
+		return true;
+	}
+
+	template<typename T>
+	Vec3<T> color(const Ray<T> &ray, const Hittable<T> &world, const LightSampler<T> &lights, int depth,
+		bool countEmission)
+	{
+		Intersection<T> intersection;
+		T hitEpsilon(0.001f);
+
+		if (!world.hit(ray, hitEpsilon, std::numeric_limits<T>::max(), intersection))
+		{
+			return background(ray);
+		}
+
+		return shade(ray, world, lights, intersection, depth, countEmission);
+	}
+
+	template<typename T>
+	Vec3<T> shade(const Ray<T> &ray, const Hittable<T> &world, const LightSampler<T> &lights,
+		const Intersection<T> &intersection, int depth, bool countEmission)
+	{
+		int maxDepth = 50;
+		Vec3<T> c(0, 0, 0);
+
+		if (!intersection.material)
+		{
+			return c;
+		}
+
+		if (countEmission)
+		{
+			c += intersection.material->emitted(intersection);
+		}
+
+		if (depth < maxDepth)
+		{
+			Vec3<T> direct;
+			bool sampled = sampleDirect(world, lights, ray, intersection, direct);
+			c += direct;
+
+			Ray<T> scattered;
+			Vec3<T> attenuation;
+
+			if (intersection.material->scatter(ray, intersection, attenuation, scattered))
+			{
+				c += attenuation * color(scattered, world, lights, depth + 1, !sampled);
+			}
+		}
+
+		return c;
+	}
+
+	template<typename T>
+	T powerHeuristic(T pdf, T otherPdf)
+	{
+		T a = pdf * pdf;
+		T b = otherPdf * otherPdf;
+		return a + b > 0 ? a / (a + b) : 0;
+	}
+
+	template<typename T>
+	bool sampleEnvironment(const Hittable<T> &world, const EnvironmentLight<T> &environment, const Ray<T> &inbound,
+		const Intersection<T> &intersection, Vec3<T> &radiance)
+	{
+		Vec3<T> n = dot(intersection.normal, inbound.direction()) < 0 ? intersection.normal : -intersection.normal;
+		radiance = Vec3<T>(0, 0, 0);
+
+		T u1 = randomUniform<T>(), u2 = randomUniform<T>(), u3 = randomUniform<T>(), u4 = randomUniform<T>();
+		Vec3<T> direction = n;
+		T pdf = 0;
+		Vec3<T> arriving = environment.sample(u1, u2, u3, u4, direction, pdf);
+		Vec3<T> f;
+
+		if (!intersection.material || !intersection.material->brdf(inbound, intersection, direction, f))
+		{
+			return false;
+		}
+
+		T cosSurface = dot(n, direction);
+
+		if (pdf > 0 && cosSurface > 0
+			&& !world.occluded(Ray<T>(intersection.p, direction), T(0.001f), std::numeric_limits<T>::max()))
+		{
+			T weight = powerHeuristic(pdf, intersection.material->scatterPdf(inbound, intersection, direction));
+			radiance = f * arriving * (cosSurface * weight / pdf);
+		}
+
+		return true;
+	}
+
+	template<typename T>
+	Vec3<T> color(const Ray<T> &ray, const Hittable<T> &world, const EnvironmentLight<T> &environment,
+		const LightSampler<T> *lights, int depth, T scatterPdf, bool countEmission)
+	{
+		Intersection<T> intersection;
+		T hitEpsilon(0.001f);
+
+		if (!world.hit(ray, hitEpsilon, std::numeric_limits<T>::max(), intersection))
+		{
+			// Sampling the environment at the previous hit may have found the same light
+			Vec3<T> arriving = environment.radiance(ray.direction());
+			return scatterPdf > 0 ? arriving * powerHeuristic(scatterPdf, environment.pdf(ray.direction())) : arriving;
+		}
+
+		return shade(ray, world, environment, lights, intersection, depth, countEmission);
+	}
+
+	template<typename T>
+	Vec3<T> shade(const Ray<T> &ray, const Hittable<T> &world, const EnvironmentLight<T> &environment,
+		const LightSampler<T> *lights, const Intersection<T> &intersection, int depth, bool countEmission)
+	{
+		int maxDepth = 50;
+		Vec3<T> c(0, 0, 0);
+
+		if (!intersection.material)
+		{
+			return c;
+		}
+
+		if (countEmission)
+		{
+			c += intersection.material->emitted(intersection);
+		}
+
+		if (depth < maxDepth)
+		{
+			bool sampledLights = false;
+
+			if (lights)
+			{
+				Vec3<T> direct;
+				sampledLights = sampleDirect(world, *lights, ray, intersection, direct);
+				c += direct;
+			}
+
+			Vec3<T> environmental;
+			bool sampled = sampleEnvironment(world, environment, ray, intersection, environmental);
+			c += environmental;
+
+			Ray<T> scattered;
+			Vec3<T> attenuation;
+
+			if (intersection.material->scatter(ray, intersection, attenuation, scattered))
+			{
+				T scatterPdf = sampled
+					? intersection.material->scatterPdf(ray, intersection, unitVector(scattered.direction())) : 0;
+				c += attenuation * color(scattered, world, environment, lights, depth + 1, scatterPdf, !sampledLights);
+			}
+		}
+
+		return c;
+	}
+}
+
+#endif
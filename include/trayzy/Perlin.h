@@ -0,0 +1,330 @@
+#ifndef TRAYZY_PERLIN_H
+#define TRAYZY_PERLIN_H
+
+#include "Vec3.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+namespace trayzy
+{
+	/**
+	 * Gradient noise over three dimensions, as in "Ray Tracing: The Next Week".
+	 *
+	 * Each lattice point hashes to one of 256 random unit gradients through three
+	 * precomputed permutation tables, and the gradients' contributions are blended with
+	 * Hermite smoothing, giving values in about [-1, 1].
+	 *
+	 * Besides one point at a time, noise is evaluated for eight points at once with every
+	 * step written as a loop over the eight lanes, which compilers vectorize. The lanes
+	 * perform the scalar path's operations in the same order, so both give identical
+	 * results. Fractal sums put their octaves in the lanes, so even a single shading point
+	 * evaluates its octaves together.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class Perlin
+	{
+	public:
+		/// The number of points evaluated together
+		static constexpr int lanes = 8;
+
+		/**
+		 * Creates the tables of a noise function.
+		 *
+		 * @param seed The seed the gradients and permutations are drawn from
+		 */
+		explicit Perlin(std::uint32_t seed = 1);
+
+		/**
+		 * Returns the noise at a point.
+		 *
+		 * @param p The point
+		 * @return The noise, in about [-1, 1]
+		 */
+		T noise(const Vec3<T> &p) const;
+
+		/**
+		 * Returns the noise at eight points.
+		 *
+		 * @param x The x coordinate of every point
+		 * @param y The y coordinate of every point
+		 * @param z The z coordinate of every point
+		 * @param[out] values The noise at every point
+		 */
+		void noise8(const T *x, const T *y, const T *z, T *values) const;
+
+		/**
+		 * Returns the noise at any number of points, eight at a time.
+		 *
+		 * @param x The x coordinate of every point
+		 * @param y The y coordinate of every point
+		 * @param z The z coordinate of every point
+		 * @param n The number of points
+		 * @param[out] values The noise at every point
+		 */
+		void noise(const T *x, const T *y, const T *z, std::size_t n, T *values) const;
+
+		/**
+		 * Returns fractal Brownian motion at a point: the sum of octaves of noise, each at
+		 * twice the frequency and half the amplitude of the one before. Up to eight octaves
+		 * are evaluated together.
+		 *
+		 * @param p The point
+		 * @param octaves The number of octaves
+		 * @return The sum of the octaves
+		 */
+		T fbm(const Vec3<T> &p, int octaves = 7) const;
+
+		/**
+		 * Returns the same sum as fbm() one octave at a time, as a reference.
+		 *
+		 * @param p The point
+		 * @param octaves The number of octaves
+		 * @return The sum of the octaves
+		 */
+		T scalarFbm(const Vec3<T> &p, int octaves = 7) const;
+
+	private:
+		/// Returns the lattice cell a coordinate falls in, without a call to std::floor
+		static inline int lattice(T coordinate);
+
+	private:
+		static constexpr int tableSize = 256;
+
+		std::array<T, tableSize> mGradientX;
+		std::array<T, tableSize> mGradientY;
+		std::array<T, tableSize> mGradientZ;
+		std::array<int, tableSize> mPermutationX;
+		std::array<int, tableSize> mPermutationY;
+		std::array<int, tableSize> mPermutationZ;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	Perlin<T>::Perlin(std::uint32_t seed)
+	{
+		std::mt19937 engine(seed);
+
+		// Map the engine's 32-bit output to [-1, 1) without relying on a distribution's implementation
+		auto uniform = [&engine]()
+		{
+			return 2 * T(engine() >> 8) / T(1 << 24) - 1;
+		};
+
+		for (int i = 0; i < tableSize; ++i)
+		{
+			// Normalize a point within the unit ball, so the directions are uniform
+			T x, y, z, length;
+
+			do
+			{
+				x = uniform();
+				y = uniform();
+				z = uniform();
+				length = std::sqrt(x * x + y * y + z * z);
+			} while (length > 1 || length < T(1e-3));
+
+			mGradientX[i] = x / length;
+			mGradientY[i] = y / length;
+			mGradientZ[i] = z / length;
+		}
+
+		for (std::array<int, tableSize> *permutation : { &mPermutationX, &mPermutationY, &mPermutationZ })
+		{
+			for (int i = 0; i < tableSize; ++i)
+			{
+				(*permutation)[i] = i;
+			}
+
+			for (int i = tableSize - 1; i > 0; --i)
+			{
+				std::swap((*permutation)[i], (*permutation)[engine() % std::uint32_t(i + 1)]);
+			}
+		}
+	}
+
+	/* static */
+	template<typename T>
+	int Perlin<T>::lattice(T coordinate)
+	{
+		// Truncation rounds toward zero, so step down for negative fractions
+		int cell = int(coordinate);
+		return cell - int(coordinate < T(cell));
+	}
+
+	template<typename T>
+	T Perlin<T>::noise(const Vec3<T> &p) const
+	{
+		int i = lattice(p[X]);
+		int j = lattice(p[Y]);
+		int k = lattice(p[Z]);
+
+		T u = p[X] - T(i);
+		T v = p[Y] - T(j);
+		T w = p[Z] - T(k);
+		T uu = u * u * (3 - 2 * u);
+		T vv = v * v * (3 - 2 * v);
+		T ww = w * w * (3 - 2 * w);
+
+		T accum = 0;
+
+		for (int di = 0; di < 2; ++di)
+		{
+			for (int dj = 0; dj < 2; ++dj)
+			{
+				for (int dk = 0; dk < 2; ++dk)
+				{
+					int g = mPermutationX[(i + di) & (tableSize - 1)] ^ mPermutationY[(j + dj) & (tableSize - 1)]
+						^ mPermutationZ[(k + dk) & (tableSize - 1)];
+					T d = mGradientX[g] * (u - di) + mGradientY[g] * (v - dj) + mGradientZ[g] * (w - dk);
+					T weight = (di ? uu : 1 - uu) * (dj ? vv : 1 - vv) * (dk ? ww : 1 - ww);
+					accum += weight * d;
+				}
+			}
+		}
+
+		return accum;
+	}
+
+	template<typename T>
+	void Perlin<T>::noise8(const T *x, const T *y, const T *z, T *values) const
+	{
+		// The table lookups are gathers that stay scalar without wide gather instructions, so
+		// they are done up front and every arithmetic loop runs branch-free over the lanes
+		int i[lanes], j[lanes], k[lanes];
+		T u[lanes], v[lanes], w[lanes];
+		T uu[lanes], vv[lanes], ww[lanes];
+		T gx[8][lanes], gy[8][lanes], gz[8][lanes];
+
+		for (int l = 0; l < lanes; ++l)
+		{
+			i[l] = lattice(x[l]);
+			j[l] = lattice(y[l]);
+			k[l] = lattice(z[l]);
+			u[l] = x[l] - T(i[l]);
+			v[l] = y[l] - T(j[l]);
+			w[l] = z[l] - T(k[l]);
+			uu[l] = u[l] * u[l] * (3 - 2 * u[l]);
+			vv[l] = v[l] * v[l] * (3 - 2 * v[l]);
+			ww[l] = w[l] * w[l] * (3 - 2 * w[l]);
+			values[l] = 0;
+		}
+
+		for (int l = 0; l < lanes; ++l)
+		{
+			int px[2] = { mPermutationX[i[l] & (tableSize - 1)], mPermutationX[(i[l] + 1) & (tableSize - 1)] };
+			int py[2] = { mPermutationY[j[l] & (tableSize - 1)], mPermutationY[(j[l] + 1) & (tableSize - 1)] };
+			int pz[2] = { mPermutationZ[k[l] & (tableSize - 1)], mPermutationZ[(k[l] + 1) & (tableSize - 1)] };
+
+			for (int corner = 0; corner < 8; ++corner)
+			{
+				int g = px[corner >> 2] ^ py[(corner >> 1) & 1] ^ pz[corner & 1];
+				gx[corner][l] = mGradientX[g];
+				gy[corner][l] = mGradientY[g];
+				gz[corner][l] = mGradientZ[g];
+			}
+		}
+
+		for (int corner = 0; corner < 8; ++corner)
+		{
+			int di = corner >> 2;
+			int dj = (corner >> 1) & 1;
+			int dk = corner & 1;
+
+			for (int l = 0; l < lanes; ++l)
+			{
+				T d = gx[corner][l] * (u[l] - di) + gy[corner][l] * (v[l] - dj) + gz[corner][l] * (w[l] - dk);
+				T weight = (di ? uu[l] : 1 - uu[l]) * (dj ? vv[l] : 1 - vv[l]) * (dk ? ww[l] : 1 - ww[l]);
+				values[l] += weight * d;
+			}
+		}
+	}
+
+	template<typename T>
+	void Perlin<T>::noise(const T *x, const T *y, const T *z, std::size_t n, T *values) const
+	{
+		std::size_t first = 0;
+
+		for (; first + lanes <= n; first += lanes)
+		{
+			noise8(x + first, y + first, z + first, values + first);
+		}
+
+		if (first < n)
+		{
+			// Pad the last partial group with its first point
+			T px[lanes], py[lanes], pz[lanes], pv[lanes];
+
+			for (int l = 0; l < lanes; ++l)
+			{
+				std::size_t source = first + l < n ? first + l : first;
+				px[l] = x[source];
+				py[l] = y[source];
+				pz[l] = z[source];
+			}
+
+			noise8(px, py, pz, pv);
+			std::copy(pv, pv + (n - first), values + first);
+		}
+	}
+
+	template<typename T>
+	T Perlin<T>::fbm(const Vec3<T> &p, int octaves) const
+	{
+		T x[lanes], y[lanes], z[lanes], values[lanes];
+		T accum = 0;
+		T scale = 1;
+		T weight = 1;
+
+		for (int first = 0; first < octaves; first += lanes)
+		{
+			// Scaling by powers of two is exact, so the lanes see the reference's points
+			for (int l = 0; l < lanes; ++l)
+			{
+				T octaveScale = scale * T(1 << l);
+				x[l] = p[X] * octaveScale;
+				y[l] = p[Y] * octaveScale;
+				z[l] = p[Z] * octaveScale;
+			}
+
+			noise8(x, y, z, values);
+
+			for (int l = 0; l < std::min(lanes, octaves - first); ++l)
+			{
+				accum += weight * values[l];
+				weight *= T(0.5);
+			}
+
+			scale *= T(1 << lanes);
+		}
+
+		return accum;
+	}
+
+	template<typename T>
+	T Perlin<T>::scalarFbm(const Vec3<T> &p, int octaves) const
+	{
+		Vec3<T> q = p;
+		T accum = 0;
+		T weight = 1;
+
+		for (int octave = 0; octave < octaves; ++octave)
+		{
+			accum += weight * noise(q);
+			weight *= T(0.5);
+			q *= T(2);
+		}
+
+		return accum;
+	}
+}
+
+#endif
@@ -0,0 +1,378 @@
+#ifndef TRAYZY_PHOTONMAP_H
+#define TRAYZY_PHOTONMAP_H
+
+#include "Hittable.h"
+#include "Intersection.h"
+#include "LightSampler.h"
+#include "Material.h"
+#include "Random.h"
+#include "Ray.h"
+#include "ThreadPool.h"
+#include "Vec3.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace trayzy
+{
+	/**
+	 * Caustic photons: light that reached a diffuse surface only through discrete
+	 * reflections and refractions, as behind glass or off mirrors.
+	 *
+	 * Photons leave the lights in proportion to their power and follow the materials'
+	 * scattering through dielectrics and metals. A photon is stored where it first lands on
+	 * a diffuse surface after at least one such bounce; photons that land on a diffuse
+	 * surface straight from a light are dropped, since sampling the lights already covers
+	 * that light.
+	 *
+	 * The photons are stored sorted into a hashed uniform grid whose cells are twice the
+	 * gather radius, so every lookup reads the contiguous photons of at most eight cells.
+	 * Tracing and sorting both run on all worker threads. Every block of photons has its own
+	 * seed and the sort is stable, so the map does not depend on the number of threads.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class PhotonMap
+	{
+	public:
+		/// Light arriving at a diffuse surface
+		struct Photon
+		{
+			/// The point the photon landed on
+			Vec3<T> p;
+
+			/// The flux the photon carries
+			Vec3<T> power;
+
+			/// The unit direction the photon arrived from the light along
+			Vec3<T> direction;
+		};
+
+		/**
+		 * Traces caustic photons through a scene.
+		 *
+		 * @param world The scene to trace through
+		 * @param lights The emissive spheres of the scene
+		 * @param nEmitted The number of photons that leave the lights, most of which are dropped
+		 * @param radius The radius within which photons contribute to a point
+		 * @param threads The number of worker threads, or zero to use every hardware thread
+		 * @param seed The seed the random sequence of every block of photons is derived from
+		 */
+		PhotonMap(const Hittable<T> &world, const std::vector<Light<T>> &lights, std::size_t nEmitted, T radius,
+			int threads = 0, std::uint32_t seed = 0);
+
+		/**
+		 * Estimates the caustic irradiance at a point on a diffuse surface: the flux of the
+		 * photons within the gather radius that arrived at the same side, per unit area.
+		 *
+		 * @param p The point
+		 * @param normal The unit normal on the side that is lit
+		 * @return The irradiance
+		 */
+		Vec3<T> irradiance(const Vec3<T> &p, const Vec3<T> &normal) const;
+
+		/// Returns the stored photons, sorted by grid cell
+		inline const std::vector<Photon> &photons() const;
+
+		/// Returns the number of stored photons
+		inline std::size_t size() const;
+
+		/// Returns the number of photons that left the lights
+		inline std::size_t emittedCount() const;
+
+		/// Returns the radius within which photons contribute to a point
+		inline T radius() const;
+
+		/// Returns the memory used by the photons and the grid in bytes
+		inline std::size_t memoryBytes() const;
+
+	private:
+		/// Returns the hash bucket of a grid cell
+		inline std::size_t bucket(std::int64_t x, std::int64_t y, std::int64_t z) const;
+
+		/// Returns the grid cell that a coordinate falls in
+		inline std::int64_t cell(T coordinate) const;
+
+	private:
+		/// The number of photons emitted with one seed
+		static constexpr std::size_t blockSize = 4096;
+
+		/// The number of discrete bounces a photon follows before it is dropped
+		static constexpr int maxDepth = 16;
+
+		std::vector<Photon> mPhotons;
+		std::vector<std::uint32_t> mBucketStarts;
+		std::size_t mBucketMask = 0;
+		std::size_t mEmittedCount;
+		T mRadius;
+		T mInverseCellSize;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	PhotonMap<T>::PhotonMap(const Hittable<T> &world, const std::vector<Light<T>> &lights, std::size_t nEmitted,
+		T radius, int threads, std::uint32_t seed) :
+		mEmittedCount(nEmitted),
+		mRadius(radius),
+		mInverseCellSize(1 / (2 * radius))
+	{
+		ThreadPool pool(threads);
+
+		// Lights are chosen in proportion to the flux pi * area * emission they send out
+		std::vector<T> cumulative;
+		T totalPower = 0;
+
+		for (const Light<T> &light : lights)
+		{
+			totalPower += light.power();
+			cumulative.push_back(totalPower);
+		}
+
+		std::size_t nBlocks = totalPower > 0 ? (nEmitted + blockSize - 1) / blockSize : 0;
+		std::vector<std::vector<Photon>> blocks(nBlocks);
+
+		parallelFor(pool, nBlocks, [&](std::size_t block)
+		{
+			// Mix the bits so neighboring blocks get unrelated sequences
+			std::uint64_t z = (std::uint64_t(seed) << 32 | std::uint32_t(block)) + 0x9E3779B97F4A7C15ull;
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			seedRandomEngine(unsigned(z ^ (z >> 31)));
+
+			std::size_t count = std::min(blockSize, nEmitted - block * blockSize);
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				T u = randomUniform<T>() * totalPower;
+				std::size_t chosen = std::min(std::size_t(std::upper_bound(cumulative.begin(), cumulative.end(), u)
+					- cumulative.begin()), lights.size() - 1);
+				const Light<T> &light = lights[chosen];
+				T probability = light.power() / totalPower;
+
+				// Leave a uniform point on the sphere in a cosine-weighted direction
+				T zn = 1 - 2 * randomUniform<T>();
+				T rn = std::sqrt(std::max(T(0), 1 - zn * zn));
+				T phi = 2 * T(M_PI) * randomUniform<T>();
+				Vec3<T> n(rn * std::cos(phi), rn * std::sin(phi), zn);
+
+				T zd = 1 - 2 * randomUniform<T>();
+				T rd = std::sqrt(std::max(T(0), 1 - zd * zd));
+				T phd = 2 * T(M_PI) * randomUniform<T>();
+				Vec3<T> direction = n + Vec3<T>(rd * std::cos(phd), rd * std::sin(phd), zd);
+
+				if (direction.magnitudeSquared() < T(1e-12))
+				{
+					direction = n;
+				}
+
+				T area = 4 * T(M_PI) * light.radius * light.radius;
+				Vec3<T> power = light.emission * (T(M_PI) * area / (probability * T(nEmitted)));
+				Ray<T> ray(light.center + light.radius * n, unitVector(direction));
+				bool discrete = false;
+
+				for (int depth = 0; depth < maxDepth; ++depth)
+				{
+					Intersection<T> intersection;
+
+					if (!world.hit(ray, T(0.001f), std::numeric_limits<T>::max(), intersection) || !intersection.material)
+					{
+						break;
+					}
+
+					Vec3<T> facing = dot(intersection.normal, ray.direction()) < 0 ? intersection.normal : -intersection.normal;
+					Vec3<T> f;
+
+					if (intersection.material->brdf(ray, intersection, facing, f))
+					{
+						if (discrete)
+						{
+							blocks[block].push_back({ intersection.p, power, unitVector(ray.direction()) });
+						}
+
+						break;
+					}
+
+					Vec3<T> attenuation;
+					Ray<T> scattered;
+
+					if (!intersection.material->scatter(ray, intersection, attenuation, scattered))
+					{
+						break;
+					}
+
+					power = power * attenuation;
+					ray = scattered;
+					discrete = true;
+				}
+			}
+		});
+
+		std::vector<Photon> traced;
+
+		for (std::vector<Photon> &block : blocks)
+		{
+			traced.insert(traced.end(), block.begin(), block.end());
+		}
+
+		// Count the photons of every bucket, then place them with a stable counting sort
+		std::size_t nBuckets = 1;
+
+		while (nBuckets < traced.size())
+		{
+			nBuckets *= 2;
+		}
+
+		mBucketMask = nBuckets - 1;
+		std::size_t nChunks = (traced.size() + blockSize - 1) / blockSize;
+		std::vector<std::uint32_t> buckets(traced.size());
+		std::vector<std::atomic<std::uint32_t>> counts(nBuckets);
+
+		parallelFor(pool, nChunks, [&](std::size_t chunk)
+		{
+			for (std::size_t i = chunk * blockSize; i < std::min(traced.size(), (chunk + 1) * blockSize); ++i)
+			{
+				const Vec3<T> &p = traced[i].p;
+				buckets[i] = std::uint32_t(bucket(cell(p[X]), cell(p[Y]), cell(p[Z])));
+				counts[buckets[i]].fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+
+		mBucketStarts.assign(nBuckets + 1, 0);
+
+		for (std::size_t b = 0; b < nBuckets; ++b)
+		{
+			mBucketStarts[b + 1] = mBucketStarts[b] + counts[b].load(std::memory_order_relaxed);
+			counts[b].store(mBucketStarts[b], std::memory_order_relaxed);
+		}
+
+		std::vector<std::uint32_t> order(traced.size());
+
+		parallelFor(pool, nChunks, [&](std::size_t chunk)
+		{
+			for (std::size_t i = chunk * blockSize; i < std::min(traced.size(), (chunk + 1) * blockSize); ++i)
+			{
+				order[counts[buckets[i]].fetch_add(1, std::memory_order_relaxed)] = std::uint32_t(i);
+			}
+		});
+
+		// Workers place photons within a bucket in any order, so restore the traced order
+		std::size_t nBucketChunks = (nBuckets + blockSize - 1) / blockSize;
+		mPhotons.resize(traced.size());
+
+		parallelFor(pool, nBucketChunks, [&](std::size_t chunk)
+		{
+			for (std::size_t b = chunk * blockSize; b < std::min(nBuckets, (chunk + 1) * blockSize); ++b)
+			{
+				std::sort(order.begin() + mBucketStarts[b], order.begin() + mBucketStarts[b + 1]);
+
+				for (std::uint32_t k = mBucketStarts[b]; k < mBucketStarts[b + 1]; ++k)
+				{
+					mPhotons[k] = traced[order[k]];
+				}
+			}
+		});
+	}
+
+	template<typename T>
+	std::size_t PhotonMap<T>::bucket(std::int64_t x, std::int64_t y, std::int64_t z) const
+	{
+		std::uint64_t h = std::uint64_t(x) * 73856093u ^ std::uint64_t(y) * 19349663u ^ std::uint64_t(z) * 83492791u;
+		return std::size_t(h) & mBucketMask;
+	}
+
+	template<typename T>
+	std::int64_t PhotonMap<T>::cell(T coordinate) const
+	{
+		return std::int64_t(std::floor(coordinate * mInverseCellSize));
+	}
+
+	template<typename T>
+	Vec3<T> PhotonMap<T>::irradiance(const Vec3<T> &p, const Vec3<T> &normal) const
+	{
+		Vec3<T> sum(0, 0, 0);
+
+		if (mPhotons.empty())
+		{
+			return sum;
+		}
+
+		// Cells are twice the radius wide, so the gather sphere spans at most two along each axis
+		std::int64_t x0 = cell(p[X] - mRadius);
+		std::int64_t y0 = cell(p[Y] - mRadius);
+		std::int64_t z0 = cell(p[Z] - mRadius);
+		std::size_t visited[8];
+		int nVisited = 0;
+		T radiusSquared = mRadius * mRadius;
+
+		for (std::int64_t x = x0; x <= x0 + 1; ++x)
+		{
+			for (std::int64_t y = y0; y <= y0 + 1; ++y)
+			{
+				for (std::int64_t z = z0; z <= z0 + 1; ++z)
+				{
+					// Cells that share a bucket must only be counted once
+					std::size_t b = bucket(x, y, z);
+
+					if (std::find(visited, visited + nVisited, b) != visited + nVisited)
+					{
+						continue;
+					}
+
+					visited[nVisited++] = b;
+
+					for (std::uint32_t k = mBucketStarts[b]; k < mBucketStarts[b + 1]; ++k)
+					{
+						const Photon &photon = mPhotons[k];
+
+						if ((photon.p - p).magnitudeSquared() <= radiusSquared && dot(photon.direction, normal) < 0)
+						{
+							sum += photon.power;
+						}
+					}
+				}
+			}
+		}
+
+		return sum / (T(M_PI) * radiusSquared);
+	}
+
+	template<typename T>
+	const std::vector<typename PhotonMap<T>::Photon> &PhotonMap<T>::photons() const
+	{
+		return mPhotons;
+	}
+
+	template<typename T>
+	std::size_t PhotonMap<T>::size() const
+	{
+		return mPhotons.size();
+	}
+
+	template<typename T>
+	std::size_t PhotonMap<T>::emittedCount() const
+	{
+		return mEmittedCount;
+	}
+
+	template<typename T>
+	T PhotonMap<T>::radius() const
+	{
+		return mRadius;
+	}
+
+	template<typename T>
+	std::size_t PhotonMap<T>::memoryBytes() const
+	{
+		return mPhotons.capacity() * sizeof(Photon) + mBucketStarts.capacity() * sizeof(std::uint32_t);
+	}
+}
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef TRAYZY_PHOTONMAPINTEGRATOR_H
+#define TRAYZY_PHOTONMAPINTEGRATOR_H
+
+#include "Integrator.h"
+#include "Intersection.h"
+#include "LightSampler.h"
+#include "Material.h"
+#include "PathTracer.h"
+#include "PhotonMap.h"
+
+#include <limits>
+#include <memory>
+#include <utility>
+
+namespace trayzy
+{
+	/**
+	 * The path tracer with lights sampled directly and caustics read from a photon map.
+	 *
+	 * At every diffuse hit, light arriving straight from a light is sampled as in the path
+	 * tracer, and light focused onto the hit through glass or mirrors comes from the photons
+	 * around it. Paths still scatter on to find light that bounced off other diffuse
+	 * surfaces, but once a path has left a diffuse surface it no longer counts the emission
+	 * it finds, since one of the two estimates above already covered it.
+	 *
+	 * The light sampler must hold every emissive sphere in the scene, or the light of the
+	 * missing ones only reaches the camera directly and through discrete bounces.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class PhotonMapIntegrator : public Integrator<T>
+	{
+	public:
+		/**
+		 * Creates a path tracer with photon-mapped caustics.
+		 *
+		 * @param photons The caustic photons of the scene
+		 * @param lights The lights to sample directly at diffuse hits
+		 */
+		PhotonMapIntegrator(std::shared_ptr<const PhotonMap<T>> photons, std::shared_ptr<const LightSampler<T>> lights) :
+			mPhotons(std::move(photons)),
+			mLights(std::move(lights))
+		{
+			// Do nothing more
+		}
+
+		// Integrator::radiance
+		virtual Vec3<T> radiance(const Ray<T> &ray, const Hittable<T> &world) const override;
+
+	private:
+		/**
+		 * Computes the color seen along a ray.
+		 *
+		 * @param ray The ray to trace
+		 * @param world The scene to trace against
+		 * @param depth The number of bounces that led to this ray
+		 * @param countEmission Whether emission found along the ray contributes
+		 * @return The color seen along the ray
+		 */
+		Vec3<T> trace(const Ray<T> &ray, const Hittable<T> &world, int depth, bool countEmission) const;
+
+	private:
+		std::shared_ptr<const PhotonMap<T>> mPhotons;
+		std::shared_ptr<const LightSampler<T>> mLights;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	Vec3<T> PhotonMapIntegrator<T>::radiance(const Ray<T> &ray, const Hittable<T> &world) const
+	{
+		return trace(ray, world, 0, true);
+	}
+
+	template<typename T>
+	Vec3<T> PhotonMapIntegrator<T>::trace(const Ray<T> &ray, const Hittable<T> &world, int depth,
+		bool countEmission) const
+	{
+		Intersection<T> intersection;
+
+		int maxDepth = 50;
+		T hitEpsilon(0.001f);
+
+		if (!world.hit(ray, hitEpsilon, std::numeric_limits<T>::max(), intersection))
+		{
+			return background(ray);
+		}
+
+		if (!intersection.material)
+		{
+			return Vec3<T>(0, 0, 0);
+		}
+
+		Vec3<T> c = countEmission ? intersection.material->emitted(intersection) : Vec3<T>(0, 0, 0);
+
+		if (depth >= maxDepth)
+		{
+			return c;
+		}
+
+		// A diffuse BRDF is the same in every direction, so any direction evaluates it
+		Vec3<T> n = dot(intersection.normal, ray.direction()) < 0 ? intersection.normal : -intersection.normal;
+		Vec3<T> f;
+		bool diffuse = intersection.material->brdf(ray, intersection, n, f);
+		Vec3<T> direct;
+		bool sampled = sampleDirect(world, *mLights, ray, intersection, direct);
+
+		if (diffuse)
+		{
+			c += direct + f * mPhotons->irradiance(intersection.p, n);
+		}
+
+		Ray<T> scattered;
+		Vec3<T> attenuation;
+
+		if (intersection.material->scatter(ray, intersection, attenuation, scattered))
+		{
+			c += attenuation * trace(scattered, world, depth + 1, countEmission && !sampled);
+		}
+
+		return c;
+	}
+}
+
+#endif
@@ -0,0 +1,268 @@
+#ifndef TRAYZY_PROGRESSIVERENDERER_H
+#define TRAYZY_PROGRESSIVERENDERER_H
+
+#include "Camera.h"
+#include "Hittable.h"
+#include "Image.h"
+#include "Integrator.h"
+#include "Random.h"
+#include "RayBatch.h"
+#include "Renderer.h"
+#include "RenderSettings.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace trayzy
+{
+	/**
+	 * The outcome of a time-budgeted render.
+	 *
+	 * @tparam T The color component data type
+	 */
+	template<typename T>
+	struct ProgressiveResult
+	{
+		/// The best image available when the budget ran out, in linear color
+		Image<T> image;
+
+		/// The seconds until the first complete low-resolution image was available
+		double firstImageSeconds = 0;
+
+		/// The seconds the whole render took
+		double elapsedSeconds = 0;
+
+		/// The mean number of full-resolution samples per pixel
+		double samplesPerPixel = 0;
+
+		/// The number of passes started over the frame, including preview passes
+		int passes = 0;
+	};
+
+	/**
+	 * Renders the best image it can within a wall-clock budget.
+	 *
+	 * The frame is first rendered at one sample per block of 8, 4 and then 2 pixels on a
+	 * side, so a coarse image is available almost at once. Full-resolution passes then
+	 * add 1, 1, 2, 4, ... samples per pixel until the budget expires or the sample count of
+	 * the settings is reached. Workers check the deadline between rows, and each pixel
+	 * averages only the samples of rows that finished, so an interrupted pass still
+	 * improves the image; pixels without any full-resolution sample keep their preview
+	 * color. The first preview pass always completes, however small the budget.
+	 *
+	 * Every pass reseeds each tile from the render seed, the pass and the tile index, so
+	 * the passes that complete are identical from run to run.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class ProgressiveRenderer
+	{
+	public:
+		/**
+		 * Creates a renderer.
+		 *
+		 * @param settings The parameters of every render, whose sample count is a cap
+		 * @param integrator The integrator that computes the color of each camera ray, or
+		 *        null for the path tracer without direct light sampling
+		 */
+		explicit ProgressiveRenderer(const RenderSettings &settings = RenderSettings(),
+			std::shared_ptr<const Integrator<T>> integrator = nullptr) :
+			mRenderer(settings, std::move(integrator))
+		{
+			// Do nothing more
+		}
+
+		/// Returns the settings of this renderer
+		inline const RenderSettings &settings() const;
+
+		/**
+		 * Renders a scene on all worker threads until a budget expires.
+		 *
+		 * @param world The scene to render
+		 * @param camera The camera to view the scene through
+		 * @param budget The wall-clock time allowed, measured from the call
+		 * @return The image and statistics of the render
+		 */
+		ProgressiveResult<T> render(const Hittable<T> &world, const Camera<T> &camera,
+			std::chrono::steady_clock::duration budget) const;
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		/// Renders a tile at one sample per block of pixels, returning false if the deadline passed
+		bool previewTile(const Hittable<T> &world, const Camera<T> &camera, const Tile &tile, int blockSize,
+			Clock::time_point deadline, Image<T> &preview) const;
+
+		/// Adds samples to the pixels of a tile, returning false if the deadline passed
+		bool refineTile(const Hittable<T> &world, const Camera<T> &camera, const Tile &tile, int nSamples,
+			Clock::time_point deadline, std::vector<Vec3<T>> &sums, std::vector<int> &counts) const;
+
+	private:
+		Renderer<T> mRenderer;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	const RenderSettings &ProgressiveRenderer<T>::settings() const
+	{
+		return mRenderer.settings();
+	}
+
+	template<typename T>
+	bool ProgressiveRenderer<T>::previewTile(const Hittable<T> &world, const Camera<T> &camera, const Tile &tile,
+		int blockSize, Clock::time_point deadline, Image<T> &preview) const
+	{
+		const RenderSettings &settings = mRenderer.settings();
+
+		for (int y0 = tile.y0; y0 < tile.y0 + tile.height; y0 += blockSize)
+		{
+			if (Clock::now() >= deadline)
+			{
+				return false;
+			}
+
+			int y1 = std::min(y0 + blockSize, tile.y0 + tile.height);
+
+			for (int x0 = tile.x0; x0 < tile.x0 + tile.width; x0 += blockSize)
+			{
+				int x1 = std::min(x0 + blockSize, tile.x0 + tile.width);
+
+				// Draw into named values since argument evaluation order is unspecified
+				T u = (x0 + (x1 - x0) * randomUniform<T>()) / settings.width;
+				T v = (y0 + (y1 - y0) * randomUniform<T>()) / settings.height;
+				Vec3<T> c = mRenderer.integrator().radiance(camera.getRay(u, v), world);
+
+				for (int row = y0; row < y1; ++row)
+				{
+					for (int col = x0; col < x1; ++col)
+					{
+						preview.at(col, row) = c;
+					}
+				}
+			}
+		}
+
+		return true;
+	}
+
+	template<typename T>
+	bool ProgressiveRenderer<T>::refineTile(const Hittable<T> &world, const Camera<T> &camera, const Tile &tile,
+		int nSamples, Clock::time_point deadline, std::vector<Vec3<T>> &sums, std::vector<int> &counts) const
+	{
+		const RenderSettings &settings = mRenderer.settings();
+		RayBatch<T> rays;
+		camera.getRays(tile.x0, tile.y0, tile.width, tile.height, settings.width, settings.height, nSamples, rays);
+
+		std::size_t i = 0;
+
+		for (int row = tile.y0; row < tile.y0 + tile.height; ++row)
+		{
+			if (Clock::now() >= deadline)
+			{
+				return false;
+			}
+
+			for (int col = tile.x0; col < tile.x0 + tile.width; ++col)
+			{
+				std::size_t pixel = std::size_t(row) * settings.width + col;
+
+				for (int s = 0; s < nSamples; ++s, ++i)
+				{
+					sums[pixel] += mRenderer.integrator().radiance(rays.ray(i), world);
+				}
+
+				counts[pixel] += nSamples;
+			}
+		}
+
+		return true;
+	}
+
+	template<typename T>
+	ProgressiveResult<T> ProgressiveRenderer<T>::render(const Hittable<T> &world, const Camera<T> &camera,
+		std::chrono::steady_clock::duration budget) const
+	{
+		const RenderSettings &settings = mRenderer.settings();
+		Clock::time_point start = Clock::now();
+		Clock::time_point deadline = start + budget;
+
+		ThreadPool pool(mRenderer.threadCount());
+		std::vector<Tile> tiles = mRenderer.tiles();
+		std::size_t nPixels = std::size_t(settings.width) * settings.height;
+
+		ProgressiveResult<T> result;
+		Image<T> preview(settings.width, settings.height);
+		std::vector<Vec3<T>> sums(nPixels);
+		std::vector<int> counts(nPixels, 0);
+
+		auto seedTile = [&](int pass, const Tile &tile)
+		{
+			seedRandomEngine(Renderer<T>::tileSeed(Renderer<T>::tileSeed(settings.seed, pass), tile.index));
+		};
+
+		// Preview passes at decreasing block sizes; the first ignores the deadline
+		for (int blockSize : { 8, 4, 2 })
+		{
+			if (result.passes > 0 && Clock::now() >= deadline)
+			{
+				break;
+			}
+
+			int pass = result.passes++;
+			Clock::time_point passDeadline = pass == 0 ? Clock::time_point::max() : deadline;
+
+			parallelFor(pool, tiles.size(), [&](std::size_t i)
+			{
+				seedTile(pass, tiles[i]);
+				previewTile(world, camera, tiles[i], blockSize, passDeadline, preview);
+			});
+
+			if (pass == 0)
+			{
+				result.firstImageSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+			}
+		}
+
+		// Full-resolution passes, doubling the samples of each pass after the second
+		for (int total = 0, nSamples = 1; total < settings.samples && Clock::now() < deadline; total += nSamples,
+			nSamples = std::min(std::max(1, total), settings.samples - total))
+		{
+			int pass = result.passes++;
+
+			parallelFor(pool, tiles.size(), [&](std::size_t i)
+			{
+				seedTile(pass, tiles[i]);
+				refineTile(world, camera, tiles[i], nSamples, deadline, sums, counts);
+			});
+		}
+
+		result.image = Image<T>(settings.width, settings.height);
+		std::size_t nSamples = 0;
+
+		for (int row = 0; row < settings.height; ++row)
+		{
+			for (int col = 0; col < settings.width; ++col)
+			{
+				std::size_t pixel = std::size_t(row) * settings.width + col;
+				result.image.at(col, row) = counts[pixel] > 0 ? sums[pixel] / T(counts[pixel]) : preview.at(col, row);
+				nSamples += counts[pixel];
+			}
+		}
+
+		result.samplesPerPixel = nPixels > 0 ? double(nSamples) / nPixels : 0;
+		result.elapsedSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+		return result;
+	}
+}
+
+#endif
@@ -0,0 +1,227 @@
+#ifndef TRAYZY_RADIANCECACHE_H
+#define TRAYZY_RADIANCECACHE_H
+
+#include "Vec3.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+namespace trayzy
+{
+	/**
+	 * A concurrent cache of the light reflected by diffuse surfaces, keyed on position and
+	 * normal.
+	 *
+	 * Space is divided into cubic cells, and each cell keeps one running mean per quantized
+	 * normal direction, so the two sides of a thin wall or the faces around an edge never
+	 * share an entry. Entries are spread over independently locked shards, so worker threads
+	 * fill and read the cache at the same time with little contention. An entry is only
+	 * returned once it holds enough samples to be trusted.
+	 *
+	 * Which samples land in an entry depends on the order in which threads reach it, so
+	 * renders using a cache are not bit-identical between runs.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class RadianceCache
+	{
+	public:
+		/**
+		 * Creates an empty cache.
+		 *
+		 * @param cellSize The edge length of a cell; smaller cells are more accurate but take
+		 *        longer to fill, and cells much smaller than the default rarely fill within a
+		 *        single render, costing more than they save
+		 * @param normalBins The number of bins each normal component is quantized to, from 1 to 8
+		 * @param minSamples The number of samples an entry needs before it is returned
+		 */
+		explicit RadianceCache(T cellSize = T(0.2), int normalBins = 4, int minSamples = 16) :
+			mInverseCellSize(1 / cellSize),
+			mNormalBins(std::min(std::max(normalBins, 1), 8)),
+			mMinSamples(std::max(minSamples, 1))
+		{
+			// Do nothing more
+		}
+
+		RadianceCache(const RadianceCache &) = delete;
+		RadianceCache &operator=(const RadianceCache &) = delete;
+
+		/**
+		 * Looks up the reflected radiance at a point.
+		 *
+		 * @param p The point
+		 * @param normal The unit normal on the side the light leaves from
+		 * @param[out] radiance The mean of the entry's samples, if it holds enough of them
+		 * @return Whether the entry holds enough samples
+		 */
+		bool lookup(const Vec3<T> &p, const Vec3<T> &normal, Vec3<T> &radiance) const;
+
+		/**
+		 * Adds a sample of the reflected radiance at a point.
+		 *
+		 * @param p The point
+		 * @param normal The unit normal on the side the light leaves from
+		 * @param radiance The sampled radiance
+		 */
+		void insert(const Vec3<T> &p, const Vec3<T> &normal, const Vec3<T> &radiance);
+
+		/// Removes every entry
+		void clear();
+
+		/// Returns the number of entries
+		std::size_t size() const;
+
+		/// Returns the number of entries that hold enough samples to be returned
+		std::size_t readyCount() const;
+
+		/// Returns the number of samples an entry needs before it is returned
+		inline int minSamples() const;
+
+	private:
+		/// The running sum of one cell and normal bin
+		struct Entry
+		{
+			Vec3<T> sum;
+			std::uint32_t count = 0;
+		};
+
+		/// A part of the cache with its own lock
+		struct Shard
+		{
+			mutable std::mutex mutex;
+			std::unordered_map<std::uint64_t, Entry> entries;
+		};
+
+		/// Returns the key of the cell and normal bin a point falls in
+		inline std::uint64_t key(const Vec3<T> &p, const Vec3<T> &normal) const;
+
+		/// Returns the shard that holds a key
+		inline Shard &shard(std::uint64_t key) const;
+
+	private:
+		static constexpr int shardCount = 64;
+
+		T mInverseCellSize;
+		int mNormalBins;
+		int mMinSamples;
+		mutable std::array<Shard, shardCount> mShards;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	std::uint64_t RadianceCache<T>::key(const Vec3<T> &p, const Vec3<T> &normal) const
+	{
+		// 18 bits per cell coordinate wrap around far beyond any scene, and 3 bits per normal component
+		std::uint64_t result = 0;
+
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			std::int64_t cell = std::int64_t(std::floor(p[axis] * mInverseCellSize));
+			result = result << 18 | (std::uint64_t(cell) & 0x3FFFF);
+		}
+
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			int bin = std::min(int((normal[axis] + 1) * T(0.5) * mNormalBins), mNormalBins - 1);
+			result = result << 3 | std::uint64_t(std::max(bin, 0));
+		}
+
+		return result;
+	}
+
+	template<typename T>
+	typename RadianceCache<T>::Shard &RadianceCache<T>::shard(std::uint64_t key) const
+	{
+		// Mix the bits so neighboring cells go to different shards
+		key ^= key >> 33;
+		key *= 0xFF51AFD7ED558CCDull;
+		key ^= key >> 33;
+		return mShards[key % shardCount];
+	}
+
+	template<typename T>
+	bool RadianceCache<T>::lookup(const Vec3<T> &p, const Vec3<T> &normal, Vec3<T> &radiance) const
+	{
+		std::uint64_t k = key(p, normal);
+		Shard &s = shard(k);
+		std::lock_guard<std::mutex> lock(s.mutex);
+		auto found = s.entries.find(k);
+
+		if (found == s.entries.end() || found->second.count < std::uint32_t(mMinSamples))
+		{
+			return false;
+		}
+
+		radiance = found->second.sum / T(found->second.count);
+		return true;
+	}
+
+	template<typename T>
+	void RadianceCache<T>::insert(const Vec3<T> &p, const Vec3<T> &normal, const Vec3<T> &radiance)
+	{
+		std::uint64_t k = key(p, normal);
+		Shard &s = shard(k);
+		std::lock_guard<std::mutex> lock(s.mutex);
+		Entry &entry = s.entries[k];
+		entry.sum += radiance;
+		++entry.count;
+	}
+
+	template<typename T>
+	void RadianceCache<T>::clear()
+	{
+		for (Shard &s : mShards)
+		{
+			std::lock_guard<std::mutex> lock(s.mutex);
+			s.entries.clear();
+		}
+	}
+
+	template<typename T>
+	std::size_t RadianceCache<T>::size() const
+	{
+		std::size_t result = 0;
+
+		for (const Shard &s : mShards)
+		{
+			std::lock_guard<std::mutex> lock(s.mutex);
+			result += s.entries.size();
+		}
+
+		return result;
+	}
+
+	template<typename T>
+	std::size_t RadianceCache<T>::readyCount() const
+	{
+		std::size_t result = 0;
+
+		for (const Shard &s : mShards)
+		{
+			std::lock_guard<std::mutex> lock(s.mutex);
+
+			for (const auto &entry : s.entries)
+			{
+				result += entry.second.count >= std::uint32_t(mMinSamples);
+			}
+		}
+
+		return result;
+	}
+
+	template<typename T>
+	int RadianceCache<T>::minSamples() const
+	{
+		return mMinSamples;
+	}
+}
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef TRAYZY_RADIANCECACHEINTEGRATOR_H
+#define TRAYZY_RADIANCECACHEINTEGRATOR_H
+
+#include "Integrator.h"
+#include "Intersection.h"
+#include "LightSampler.h"
+#include "Material.h"
+#include "PathTracer.h"
+#include "RadianceCache.h"
+
+#include <limits>
+#include <memory>
+#include <utility>
+
+namespace trayzy
+{
+	/**
+	 * The path tracer, ending paths at their second diffuse hit with light cached nearby.
+	 *
+	 * The first diffuse hit of every path is shaded by tracing as usual, which blurs the
+	 * cache's blockiness away. From the second diffuse hit on, the light a Lambertian
+	 * surface reflects does not depend on the direction it is seen from, so it is read from
+	 * the cache when the surrounding entry is ready. Otherwise the path continues as usual
+	 * and its result is added to the entry, so the cache fills as the render runs.
+	 *
+	 * Unlike other integrators this one changes as it renders, through a cache that is safe
+	 * to use from every worker thread. Passing the same cache to later renders of the same
+	 * scene reuses what was learned; clear it whenever the scene changes.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class RadianceCacheIntegrator : public Integrator<T>
+	{
+	public:
+		/**
+		 * Creates a cached path tracer.
+		 *
+		 * @param cache The cache to read and fill, or null for a new one with its default accuracy
+		 * @param lights The lights to sample directly at diffuse hits, or null to find light
+		 *        by scattering alone
+		 */
+		explicit RadianceCacheIntegrator(std::shared_ptr<RadianceCache<T>> cache = nullptr,
+			std::shared_ptr<const LightSampler<T>> lights = nullptr) :
+			mCache(cache ? std::move(cache) : std::make_shared<RadianceCache<T>>()),
+			mLights(std::move(lights))
+		{
+			// Do nothing more
+		}
+
+		// Integrator::radiance
+		virtual Vec3<T> radiance(const Ray<T> &ray, const Hittable<T> &world) const override;
+
+		/// Returns the cache this integrator reads and fills
+		inline RadianceCache<T> &cache() const;
+
+	private:
+		/**
+		 * Computes the color seen along a ray.
+		 *
+		 * @param ray The ray to trace
+		 * @param world The scene to trace against
+		 * @param depth The number of bounces that led to this ray
+		 * @param diffuseDepth The number of diffuse bounces that led to this ray
+		 * @param countEmission Whether emission found along the ray contributes
+		 * @return The color seen along the ray
+		 */
+		Vec3<T> trace(const Ray<T> &ray, const Hittable<T> &world, int depth, int diffuseDepth,
+			bool countEmission) const;
+
+	private:
+		std::shared_ptr<RadianceCache<T>> mCache;
+		std::shared_ptr<const LightSampler<T>> mLights;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	Vec3<T> RadianceCacheIntegrator<T>::radiance(const Ray<T> &ray, const Hittable<T> &world) const
+	{
+		return trace(ray, world, 0, 0, true);
+	}
+
+	template<typename T>
+	RadianceCache<T> &RadianceCacheIntegrator<T>::cache() const
+	{
+		return *mCache;
+	}
+
+	template<typename T>
+	Vec3<T> RadianceCacheIntegrator<T>::trace(const Ray<T> &ray, const Hittable<T> &world, int depth,
+		int diffuseDepth, bool countEmission) const
+	{
+		Intersection<T> intersection;
+
+		int maxDepth = 50;
+		T hitEpsilon(0.001f);
+
+		if (!world.hit(ray, hitEpsilon, std::numeric_limits<T>::max(), intersection))
+		{
+			return background(ray);
+		}
+
+		if (!intersection.material)
+		{
+			return Vec3<T>(0, 0, 0);
+		}
+
+		Vec3<T> c = countEmission ? intersection.material->emitted(intersection) : Vec3<T>(0, 0, 0);
+
+		if (depth >= maxDepth)
+		{
+			return c;
+		}
+
+		// Only materials with a BRDF reflect the same light in every direction
+		Vec3<T> n = dot(intersection.normal, ray.direction()) < 0 ? intersection.normal : -intersection.normal;
+		Vec3<T> f;
+		bool diffuse = intersection.material->brdf(ray, intersection, n, f);
+		bool cached = diffuse && diffuseDepth > 0;
+		Vec3<T> reflected;
+
+		if (cached && mCache->lookup(intersection.p, n, reflected))
+		{
+			return c + reflected;
+		}
+
+		bool sampled = false;
+
+		if (mLights)
+		{
+			sampled = sampleDirect(world, *mLights, ray, intersection, reflected);
+		}
+
+		Ray<T> scattered;
+		Vec3<T> attenuation;
+
+		if (intersection.material->scatter(ray, intersection, attenuation, scattered))
+		{
+			reflected += attenuation * trace(scattered, world, depth + 1, diffuseDepth + int(diffuse), !sampled);
+		}
+
+		if (cached)
+		{
+			mCache->insert(intersection.p, n, reflected);
+		}
+
+		return c + reflected;
+	}
+}
+
+#endif
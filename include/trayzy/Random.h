@@ -0,0 +1,97 @@
+#ifndef TRAYZY_RANDOM_H
+#define TRAYZY_RANDOM_H
+
+#include "Vec3.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace trayzy
+{
+	/**
+	 * Returns the random engine owned by the calling thread.
+	 *
+	 * Each thread lazily seeds its own engine from a random device, so sampling
+	 * never contends on shared state and never pays for a random device per draw.
+	 */
+	inline std::default_random_engine &randomEngine();
+
+	/**
+	 * Reseeds the random engine owned by the calling thread.
+	 *
+	 * @param seed The new seed
+	 */
+	inline void seedRandomEngine(unsigned int seed);
+
+	/**
+	 * Returns a uniformly distributed random value in [0, 1) from the calling thread's engine.
+	 *
+	 * @tparam T The floating point data type
+	 */
+	template<typename T>
+	inline T randomUniform();
+
+	/**
+	 * Returns a uniformly distributed random vector on the unit sphere.
+	 *
+	 * @tparam T The floating point data type
+	 */
+	template<typename T>
+	inline Vec3<T> randomUnitVector();
+
+	/**
+	 * Returns a random direction about a normal whose density is proportional to the cosine
+	 * of its angle to the normal. The direction is not normalized.
+	 *
+	 * @param normal The unit normal of the surface
+	 * @tparam T The floating point data type
+	 */
+	template<typename T>
+	inline Vec3<T> randomCosineDirection(const Vec3<T> &normal);
+}
+
+// Inline implementation
+namespace trayzy
+{
+	std::default_random_engine &randomEngine()
+	{
+		thread_local std::default_random_engine engine(std::random_device{}());
+		return engine;
+	}
+
+	void seedRandomEngine(unsigned int seed)
+	{
+		randomEngine().seed(seed);
+	}
+
+	template<typename T>
+	T randomUniform()
+	{
+		std::uniform_real_distribution<T> distribution(0, 1);
+		T value = distribution(randomEngine());
+
+		// Some standard library implementations may round up to the upper bound
+		return value < 1 ? value : std::nextafter(T(1), T(0));
+	}
+
+	template<typename T>
+	Vec3<T> randomUnitVector()
+	{
+		T z = 2 * randomUniform<T>() - 1;
+		T phi = 2 * T(M_PI) * randomUniform<T>();
+		T r = std::sqrt(std::max(T(0), 1 - z * z));
+		return Vec3<T>(r * std::cos(phi), r * std::sin(phi), z);
+	}
+
+	template<typename T>
+	Vec3<T> randomCosineDirection(const Vec3<T> &normal)
+	{
+		// Offsetting the normal by a random unit vector yields cosine-weighted directions,
+		// except when the two nearly cancel out
+		Vec3<T> direction = normal + randomUnitVector<T>();
+		return direction.magnitudeSquared() < T(1e-12) ? normal : direction;
+	}
+}
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef TRAYZY_RAYBATCH_H
+#define TRAYZY_RAYBATCH_H
+
+#include "Forward.h"
+#include "Ray.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace trayzy
+{
+	/**
+	 * A batch of rays stored as a structure of arrays, one array per coordinate,
+	 * so that generating or transforming many rays at once maps onto SIMD lanes.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	struct RayBatch
+	{
+		/// Resizes every coordinate array to hold the provided number of rays
+		inline void resize(std::size_t n);
+
+		/// Returns the number of rays in the batch
+		inline std::size_t size() const;
+
+		/// Returns a copy of the ray at the provided index
+		inline Ray<T> ray(std::size_t i) const;
+
+		/// The origin coordinates
+		std::vector<T> originX;
+		std::vector<T> originY;
+		std::vector<T> originZ;
+
+		/// The direction coordinates
+		std::vector<T> directionX;
+		std::vector<T> directionY;
+		std::vector<T> directionZ;
+	};
+}
+
+// Inline implementation
+namespace trayzy
+{
+	template<typename T>
+	void RayBatch<T>::resize(std::size_t n)
+	{
+		for (std::vector<T> *coordinates : { &originX, &originY, &originZ, &directionX, &directionY, &directionZ })
+		{
+			coordinates->resize(n);
+		}
+	}
+
+	template<typename T>
+	std::size_t RayBatch<T>::size() const
+	{
+		return originX.size();
+	}
+
+	template<typename T>
+	Ray<T> RayBatch<T>::ray(std::size_t i) const
+	{
+		return Ray<T>(Vec3<T>(originX[i], originY[i], originZ[i]), Vec3<T>(directionX[i], directionY[i], directionZ[i]));
+	}
+}
+
+#endif
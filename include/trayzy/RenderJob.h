@@ -0,0 +1,237 @@
+#ifndef TRAYZY_RENDERJOB_H
+#define TRAYZY_RENDERJOB_H
+
+#include "Camera.h"
+#include "Forward.h"
+#include "Image.h"
+#include "RenderSettings.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace trayzy
+{
+	/// Thrown when the result of a render job that was cancelled before completing is requested
+	class RenderCancelled : public std::runtime_error
+	{
+	public:
+		RenderCancelled() :
+			std::runtime_error("trayzy: render cancelled")
+		{
+			// Do nothing more
+		}
+	};
+
+	/**
+	 * Functions notified as an asynchronous render advances.
+	 *
+	 * Callbacks run on worker threads, one at a time, so they need no locking of their own
+	 * but should return quickly to keep the workers busy.
+	 *
+	 * @tparam T The color component data type
+	 */
+	template<typename T>
+	struct RenderCallbacks
+	{
+		/// Called when a tile is finished, with a copy of its pixels whose first pixel is the
+		/// tile's top-left corner
+		std::function<void(const Tile &tile, const Image<T> &pixels)> onTile;
+
+		/// Called when a tile is finished, with the number of finished tiles and the total
+		std::function<void(int completed, int total)> onProgress;
+	};
+
+	/**
+	 * A handle to a render running on a thread pool.
+	 *
+	 * Handles are cheap to copy and all copies refer to the same job. Dropping every handle
+	 * does not stop the job; call cancel() to abandon it.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class RenderJob
+	{
+	public:
+		/// Creates a handle that refers to no job
+		RenderJob() = default;
+
+		/// Returns whether this handle refers to a job
+		inline bool valid() const;
+
+		/**
+		 * Asks the job to stop. Workers stop between rows of pixels, and the job's result
+		 * becomes a RenderCancelled exception unless every tile had already finished. Does
+		 * nothing on a handle that refers to no job.
+		 */
+		inline void cancel();
+
+		/// Returns whether cancellation was requested
+		inline bool isCancelled() const;
+
+		/// Returns whether the job's result is available
+		inline bool isDone() const;
+
+		/// Returns the fraction of tiles finished, in [0, 1], or 0 on a handle that refers to no job
+		inline double progress() const;
+
+		/**
+		 * Blocks until the job's result is available.
+		 *
+		 * @throws std::logic_error If this handle refers to no job
+		 */
+		inline void wait() const;
+
+		/**
+		 * Blocks until the job's result is available or a timeout expires.
+		 *
+		 * @return Whether the result is available
+		 * @throws std::logic_error If this handle refers to no job
+		 */
+		template<typename Rep, typename Period>
+		bool waitFor(const std::chrono::duration<Rep, Period> &timeout) const;
+
+		/**
+		 * Blocks until the job completes and returns its image.
+		 *
+		 * @throws RenderCancelled If the job was cancelled before completing
+		 * @throws std::logic_error If this handle refers to no job
+		 */
+		inline Image<T> get() const;
+
+		/// Returns the future that holds the job's image, which is not valid on a handle that
+		/// refers to no job
+		inline std::shared_future<Image<T>> future() const;
+
+	private:
+		friend class Renderer<T>;
+
+		/// The state shared between the handles and the workers of a job
+		struct State
+		{
+			State(const Camera<T> &camera, std::vector<Tile> tiles, RenderCallbacks<T> callbacks, int width, int height) :
+				image(width, height),
+				camera(camera),
+				tiles(std::move(tiles)),
+				callbacks(std::move(callbacks)),
+				result(promise.get_future().share())
+			{
+				// Do nothing more
+			}
+
+			Image<T> image;
+			Camera<T> camera;
+			std::vector<Tile> tiles;
+			RenderCallbacks<T> callbacks;
+
+			std::atomic<bool> cancelled{ false };
+			std::atomic<std::size_t> nextTile{ 0 };
+			std::atomic<int> completedTiles{ 0 };
+			std::atomic<int> activeWorkers{ 0 };
+
+			std::mutex mutex;
+			std::exception_ptr error;
+			std::promise<Image<T>> promise;
+			std::shared_future<Image<T>> result;
+		};
+
+		explicit RenderJob(std::shared_ptr<State> state) :
+			mState(std::move(state))
+		{
+			// Do nothing more
+		}
+
+		/// Returns the future of the job, throwing if this handle refers to no job
+		inline const std::shared_future<Image<T>> &result() const;
+
+	private:
+		std::shared_ptr<State> mState;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	bool RenderJob<T>::valid() const
+	{
+		return bool(mState);
+	}
+
+	template<typename T>
+	void RenderJob<T>::cancel()
+	{
+		if (mState)
+		{
+			mState->cancelled = true;
+		}
+	}
+
+	template<typename T>
+	bool RenderJob<T>::isCancelled() const
+	{
+		return mState && mState->cancelled;
+	}
+
+	template<typename T>
+	bool RenderJob<T>::isDone() const
+	{
+		return mState && mState->result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	}
+
+	template<typename T>
+	double RenderJob<T>::progress() const
+	{
+		if (!mState)
+		{
+			return 0.0;
+		}
+
+		return mState->tiles.empty() ? 1.0 : double(mState->completedTiles) / mState->tiles.size();
+	}
+
+	template<typename T>
+	void RenderJob<T>::wait() const
+	{
+		result().wait();
+	}
+
+	template<typename T>
+	template<typename Rep, typename Period>
+	bool RenderJob<T>::waitFor(const std::chrono::duration<Rep, Period> &timeout) const
+	{
+		return result().wait_for(timeout) == std::future_status::ready;
+	}
+
+	template<typename T>
+	Image<T> RenderJob<T>::get() const
+	{
+		return result().get();
+	}
+
+	template<typename T>
+	std::shared_future<Image<T>> RenderJob<T>::future() const
+	{
+		return mState ? mState->result : std::shared_future<Image<T>>();
+	}
+
+	template<typename T>
+	const std::shared_future<Image<T>> &RenderJob<T>::result() const
+	{
+		if (!mState)
+		{
+			throw std::logic_error("RenderJob: the handle refers to no job");
+		}
+
+		return mState->result;
+	}
+}
+
+#endif
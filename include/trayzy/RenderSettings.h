@@ -0,0 +1,50 @@
+#ifndef TRAYZY_RENDERSETTINGS_H
+#define TRAYZY_RENDERSETTINGS_H
+
+#include <cstdint>
+
+namespace trayzy
+{
+	/// The parameters of a render
+	struct RenderSettings
+	{
+		/// The number of columns in the image
+		int width = 200;
+
+		/// The number of rows in the image
+		int height = 100;
+
+		/// The number of samples per pixel
+		int samples = 100;
+
+		/// The number of pixels along each side of a tile
+		int tileSize = 16;
+
+		/// The number of worker threads, or zero to use every hardware thread
+		int threads = 0;
+
+		/// The seed the random sequence of every tile is derived from
+		std::uint32_t seed = 0;
+	};
+
+	/// A rectangular block of pixels rendered as a unit
+	struct Tile
+	{
+		/// The position of the tile in the renderer's tile order
+		int index;
+
+		/// The column of the tile's lower-left pixel
+		int x0;
+
+		/// The row of the tile's lower-left pixel
+		int y0;
+
+		/// The number of columns in the tile
+		int width;
+
+		/// The number of rows in the tile
+		int height;
+	};
+}
+
+#endif
@@ -0,0 +1,320 @@
+#ifndef TRAYZY_RENDERSTATS_H
+#define TRAYZY_RENDERSTATS_H
+
+#include "RenderSettings.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace trayzy
+{
+	/// Counters of the work done by one thread while tracing rays
+	struct RayCounters
+	{
+		/// The number of rays traced against the scene, including shadow rays
+		std::uint64_t rays = 0;
+
+		/// The number of ray-primitive intersection tests
+		std::uint64_t tests = 0;
+	};
+
+	/// Returns the counters of the calling thread
+	inline RayCounters &rayCounters();
+
+	/**
+	 * Counts ray-primitive intersection tests on the calling thread.
+	 *
+	 * Primitives call this from their innermost loops, so it only counts when the library
+	 * is built with TRAYZY_RENDER_STATS defined and compiles to nothing otherwise.
+	 *
+	 * @param nTests The number of tests to add
+	 */
+	inline void countIntersectionTests(std::uint64_t nTests = 1);
+
+	/// The cost of rendering one pixel, summed over its samples
+	struct PixelCost
+	{
+		/// The wall-clock seconds spent on the pixel
+		double seconds = 0;
+
+		/// The number of rays traced for the pixel
+		std::uint64_t rays = 0;
+
+		/// The number of intersection tests done for the pixel
+		std::uint64_t tests = 0;
+	};
+
+	/// The cost of rendering one tile
+	struct TileCost
+	{
+		/// The tile the cost belongs to
+		Tile tile = {};
+
+		/// The seconds from the start of the render until a worker started the tile
+		double startSeconds = 0;
+
+		/// The wall-clock seconds spent on the tile
+		double seconds = 0;
+
+		/// The number of rays traced for the tile
+		std::uint64_t rays = 0;
+
+		/// The number of intersection tests done for the tile
+		std::uint64_t tests = 0;
+	};
+
+	/**
+	 * The per-pixel and per-tile cost of a render, for finding the expensive parts of a frame.
+	 *
+	 * The renderer fills one of these when it is passed one. Every pixel and every tile is
+	 * written by the single worker that renders its tile, so no locking is needed. Ray counts
+	 * are always recorded; intersection tests only when built with TRAYZY_RENDER_STATS.
+	 */
+	class RenderStats
+	{
+	public:
+		/// The quantities a heatmap can show
+		enum class Metric
+		{
+			Time,
+			Rays,
+			Tests
+		};
+
+		/// Returns whether intersection tests are counted in this build
+		static constexpr bool countsTests();
+
+		/**
+		 * Clears the statistics for a new render and starts its clock.
+		 *
+		 * @param width The number of columns in the image
+		 * @param height The number of rows in the image
+		 * @param tiles The tiles of the render, in the renderer's order
+		 */
+		void reset(int width, int height, const std::vector<Tile> &tiles);
+
+		/// Returns the number of columns in the image
+		inline int width() const;
+
+		/// Returns the number of rows in the image
+		inline int height() const;
+
+		/// Returns the cost of a pixel
+		inline PixelCost &at(int x, int y);
+
+		/// Returns the cost of a pixel
+		inline const PixelCost &at(int x, int y) const;
+
+		/// Returns the cost of the tile with the provided index
+		inline TileCost &tile(int index);
+
+		/// Returns the costs of every tile, in the renderer's order
+		inline const std::vector<TileCost> &tiles() const;
+
+		/// Returns the seconds since the last reset
+		inline double elapsedSeconds() const;
+
+		/// Returns the sum of a metric over the whole image
+		double total(Metric metric) const;
+
+		/**
+		 * Writes a metric as a false-color binary portable pixmap, with the top row first.
+		 *
+		 * The color scale runs from black through purple, red and yellow to white, and is
+		 * normalized to the 99th percentile so that a few extreme pixels do not wash out the
+		 * rest of the image; anything above it is white.
+		 *
+		 * @param os The stream to write to
+		 * @param metric The metric to show
+		 */
+		void writeHeatmap(std::ostream &os, Metric metric) const;
+
+		/**
+		 * Writes the cost of every tile as comma-separated values with a header row.
+		 *
+		 * @param os The stream to write to
+		 */
+		void writeTileCsv(std::ostream &os) const;
+
+	private:
+		/// Returns a metric of a pixel
+		inline double value(const PixelCost &pixel, Metric metric) const;
+
+	private:
+		int mWidth = 0;
+		int mHeight = 0;
+		std::vector<PixelCost> mPixels;
+		std::vector<TileCost> mTiles;
+		std::chrono::steady_clock::time_point mStart;
+	};
+}
+
+namespace trayzy
+{
+	RayCounters &rayCounters()
+	{
+		thread_local RayCounters counters;
+		return counters;
+	}
+
+	void countIntersectionTests(std::uint64_t nTests)
+	{
+#if defined(TRAYZY_RENDER_STATS)
+		rayCounters().tests += nTests;
+#else
+		(void)nTests;
+#endif
+	}
+
+	/* static */
+	constexpr bool RenderStats::countsTests()
+	{
+#if defined(TRAYZY_RENDER_STATS)
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	inline void RenderStats::reset(int width, int height, const std::vector<Tile> &tiles)
+	{
+		mWidth = width;
+		mHeight = height;
+		mPixels.assign(std::size_t(std::max(0, width)) * std::max(0, height), PixelCost());
+		mTiles.assign(tiles.size(), TileCost());
+
+		for (std::size_t i = 0; i < tiles.size(); ++i)
+		{
+			mTiles[i].tile = tiles[i];
+		}
+
+		mStart = std::chrono::steady_clock::now();
+	}
+
+	int RenderStats::width() const
+	{
+		return mWidth;
+	}
+
+	int RenderStats::height() const
+	{
+		return mHeight;
+	}
+
+	PixelCost &RenderStats::at(int x, int y)
+	{
+		return mPixels[std::size_t(y) * mWidth + x];
+	}
+
+	const PixelCost &RenderStats::at(int x, int y) const
+	{
+		return mPixels[std::size_t(y) * mWidth + x];
+	}
+
+	TileCost &RenderStats::tile(int index)
+	{
+		return mTiles[index];
+	}
+
+	const std::vector<TileCost> &RenderStats::tiles() const
+	{
+		return mTiles;
+	}
+
+	double RenderStats::elapsedSeconds() const
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count();
+	}
+
+	double RenderStats::value(const PixelCost &pixel, Metric metric) const
+	{
+		switch (metric)
+		{
+		case Metric::Time:
+			return pixel.seconds;
+		case Metric::Rays:
+			return double(pixel.rays);
+		default:
+			return double(pixel.tests);
+		}
+	}
+
+	inline double RenderStats::total(Metric metric) const
+	{
+		double sum = 0;
+
+		for (const PixelCost &pixel : mPixels)
+		{
+			sum += value(pixel, metric);
+		}
+
+		return sum;
+	}
+
+	inline void RenderStats::writeHeatmap(std::ostream &os, Metric metric) const
+	{
+		std::vector<double> values(mPixels.size());
+
+		for (std::size_t i = 0; i < mPixels.size(); ++i)
+		{
+			values[i] = value(mPixels[i], metric);
+		}
+
+		double scale = 0;
+
+		if (!values.empty())
+		{
+			std::vector<double> sorted(values);
+			auto percentile = sorted.begin() + std::ptrdiff_t((sorted.size() - 1) * 99 / 100);
+			std::nth_element(sorted.begin(), percentile, sorted.end());
+			scale = *percentile > 0 ? 1 / *percentile : 0;
+		}
+
+		// Evenly spaced stops of the color scale
+		static const float stops[][3] = {
+			{ 0.0f, 0.0f, 0.0f },
+			{ 0.34f, 0.06f, 0.43f },
+			{ 0.87f, 0.32f, 0.23f },
+			{ 0.99f, 0.81f, 0.15f },
+			{ 1.0f, 1.0f, 1.0f }
+		};
+		const int nIntervals = 4;
+
+		os << "P6\n" << mWidth << " " << mHeight << "\n255\n";
+
+		for (int row = mHeight - 1; row >= 0; --row)
+		{
+			for (int col = 0; col < mWidth; ++col)
+			{
+				double x = std::min(1.0, values[std::size_t(row) * mWidth + col] * scale) * nIntervals;
+				int stop = std::min(int(x), nIntervals - 1);
+				float f = float(x - stop);
+
+				for (int c = 0; c < 3; ++c)
+				{
+					float component = stops[stop][c] + f * (stops[stop + 1][c] - stops[stop][c]);
+					os.put(char(int(255.99f * component)));
+				}
+			}
+		}
+	}
+
+	inline void RenderStats::writeTileCsv(std::ostream &os) const
+	{
+		os << "index,x0,y0,width,height,start_seconds,seconds,rays,tests\n";
+
+		for (const TileCost &cost : mTiles)
+		{
+			os << cost.tile.index << "," << cost.tile.x0 << "," << cost.tile.y0 << "," << cost.tile.width << ","
+				<< cost.tile.height << "," << cost.startSeconds << "," << cost.seconds << "," << cost.rays << ","
+				<< cost.tests << "\n";
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,444 @@
+#ifndef TRAYZY_RENDERER_H
+#define TRAYZY_RENDERER_H
+
+#include "Camera.h"
+#include "Hittable.h"
+#include "Image.h"
+#include "Integrator.h"
+#include "PathIntegrator.h"
+#include "Random.h"
+#include "RayBatch.h"
+#include "RenderJob.h"
+#include "RenderSettings.h"
+#include "RenderStats.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace trayzy
+{
+	/**
+	 * Renders images by splitting them into tiles that worker threads claim one at a time.
+	 *
+	 * Each tile reseeds the worker's random engine from the render seed and the tile index,
+	 * so an image is identical no matter how many threads render it or in which order.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class Renderer
+	{
+	public:
+		/**
+		 * Creates a renderer.
+		 *
+		 * @param settings The parameters of every render
+		 * @param integrator The integrator that computes the color of each camera ray, or
+		 *        null for the path tracer without direct light sampling
+		 */
+		explicit Renderer(const RenderSettings &settings = RenderSettings(),
+			std::shared_ptr<const Integrator<T>> integrator = nullptr) :
+			mSettings(settings),
+			mIntegrator(integrator ? std::move(integrator) : std::make_shared<PathIntegrator<T>>())
+		{
+			// Do nothing more
+		}
+
+		/// Returns the settings of this renderer
+		inline const RenderSettings &settings() const;
+
+		/// Returns the integrator that computes the color of each camera ray
+		inline const Integrator<T> &integrator() const;
+
+		/// Returns the number of worker threads a render uses
+		int threadCount() const;
+
+		/// Returns the tiles covering the image, in the order they are handed out
+		std::vector<Tile> tiles() const;
+
+		/**
+		 * Renders a scene on all worker threads.
+		 *
+		 * @param world The scene to render
+		 * @param camera The camera to view the scene through
+		 * @param stats The statistics to fill with the cost of every pixel and tile, or null
+		 * @return The rendered image in linear color
+		 */
+		Image<T> render(const Hittable<T> &world, const Camera<T> &camera, RenderStats *stats = nullptr) const;
+
+		/**
+		 * Renders several views of one scene on all worker threads.
+		 *
+		 * @param world The scene to render
+		 * @param cameras The cameras to view the scene through
+		 * @return The rendered image of every camera in linear color, in the cameras' order
+		 */
+		std::vector<Image<T>> renderViews(const Hittable<T> &world, const std::vector<Camera<T>> &cameras) const;
+
+		/**
+		 * Renders several views of one scene on a thread pool and waits for them.
+		 *
+		 * Stereo pairs, cubemaps and turntables share the scene, its acceleration structure
+		 * and the integrator's light sampler, so they are built once for every view. The
+		 * tiles of all views are handed out from one queue, interleaved so that the views'
+		 * tiles at the same position run together, and workers only go idle when the last
+		 * tile of the last view is claimed rather than at the end of every view. Each view
+		 * is identical to rendering its camera alone.
+		 *
+		 * The calling thread blocks, so it must not be a worker of the pool.
+		 *
+		 * @param pool The pool whose workers render the tiles
+		 * @param world The scene to render
+		 * @param cameras The cameras to view the scene through
+		 * @return The rendered image of every camera in linear color, in the cameras' order
+		 */
+		std::vector<Image<T>> renderViews(ThreadPool &pool, const Hittable<T> &world,
+			const std::vector<Camera<T>> &cameras) const;
+
+		/**
+		 * Starts rendering a scene on a thread pool and returns without waiting.
+		 *
+		 * The job posts one task per worker of the pool, each claiming tiles until none are
+		 * left, so other work posted to the same pool interleaves with the render. The job
+		 * copies the camera but only references the world, which must outlive the job.
+		 *
+		 * @param pool The pool whose workers render the tiles
+		 * @param world The scene to render
+		 * @param camera The camera to view the scene through
+		 * @param callbacks The functions notified as tiles finish
+		 * @param stats The statistics to fill with the cost of every pixel and tile, or null; they
+		 *        are reset before the job starts and must outlive it
+		 * @return A handle to follow, wait for or cancel the render
+		 */
+		RenderJob<T> renderAsync(ThreadPool &pool, const Hittable<T> &world, const Camera<T> &camera,
+			RenderCallbacks<T> callbacks = RenderCallbacks<T>(), RenderStats *stats = nullptr) const;
+
+		/**
+		 * Renders a single tile into an image.
+		 *
+		 * @param world The scene to render
+		 * @param camera The camera to view the scene through
+		 * @param tile The tile to render
+		 * @param[out] image The image to write the tile's pixels to
+		 * @param cancelled A flag checked before each row of pixels, or null to never stop early
+		 * @param stats The statistics to record the cost of the tile and its pixels in, which
+		 *        were reset for this render, or null
+		 * @return Whether the whole tile was rendered
+		 */
+		bool renderTile(const Hittable<T> &world, const Camera<T> &camera, const Tile &tile, Image<T> &image,
+			const std::atomic<bool> *cancelled = nullptr, RenderStats *stats = nullptr) const;
+
+		/// Returns the random seed of a tile in a render with the provided seed
+		static inline std::uint32_t tileSeed(std::uint32_t seed, int tileIndex);
+
+	private:
+		/// Forwards to the scene while counting the rays traced against it on the calling thread
+		class CountingWorld : public Hittable<T>
+		{
+		public:
+			explicit CountingWorld(const Hittable<T> &world) :
+				mWorld(world)
+			{
+				// Do nothing more
+			}
+
+			// Hittable::closestHit
+			virtual bool closestHit(const Ray<T> &ray, T tMin, T tMax, HitRecord<T> &record) const override
+			{
+				++rayCounters().rays;
+				return mWorld.closestHit(ray, tMin, tMax, record);
+			}
+
+			// Hittable::evaluate
+			virtual void evaluate(const Ray<T> &ray, const HitRecord<T> &record,
+				Intersection<T> &intersection) const override
+			{
+				mWorld.evaluate(ray, record, intersection);
+			}
+
+			// Hittable::occluded
+			virtual bool occluded(const Ray<T> &ray, T tMin, T tMax) const override
+			{
+				++rayCounters().rays;
+				return mWorld.occluded(ray, tMin, tMax);
+			}
+
+			// Hittable::boundingBox
+			virtual Aabb<T> boundingBox() const override
+			{
+				return mWorld.boundingBox();
+			}
+
+		private:
+			const Hittable<T> &mWorld;
+		};
+
+	private:
+		RenderSettings mSettings;
+		std::shared_ptr<const Integrator<T>> mIntegrator;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	const RenderSettings &Renderer<T>::settings() const
+	{
+		return mSettings;
+	}
+
+	template<typename T>
+	const Integrator<T> &Renderer<T>::integrator() const
+	{
+		return *mIntegrator;
+	}
+
+	template<typename T>
+	int Renderer<T>::threadCount() const
+	{
+		return mSettings.threads > 0 ? mSettings.threads : std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	template<typename T>
+	std::vector<Tile> Renderer<T>::tiles() const
+	{
+		std::vector<Tile> result;
+		int size = std::max(1, mSettings.tileSize);
+
+		// Start from the top rows, which are written out first
+		for (int y1 = mSettings.height; y1 > 0; y1 -= size)
+		{
+			int y0 = std::max(0, y1 - size);
+
+			for (int x0 = 0; x0 < mSettings.width; x0 += size)
+			{
+				result.push_back({ int(result.size()), x0, y0, std::min(size, mSettings.width - x0), y1 - y0 });
+			}
+		}
+
+		return result;
+	}
+
+	/* static */
+	template<typename T>
+	std::uint32_t Renderer<T>::tileSeed(std::uint32_t seed, int tileIndex)
+	{
+		// Mix the bits so neighboring tiles get unrelated sequences
+		std::uint64_t z = (std::uint64_t(seed) << 32 | std::uint32_t(tileIndex)) + 0x9E3779B97F4A7C15ull;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return std::uint32_t(z ^ (z >> 31));
+	}
+
+	template<typename T>
+	bool Renderer<T>::renderTile(const Hittable<T> &world, const Camera<T> &camera, const Tile &tile, Image<T> &image,
+		const std::atomic<bool> *cancelled, RenderStats *stats) const
+	{
+		using Clock = std::chrono::steady_clock;
+
+		RayBatch<T> rays;
+		seedRandomEngine(tileSeed(mSettings.seed, tile.index));
+		camera.getRays(tile.x0, tile.y0, tile.width, tile.height, mSettings.width, mSettings.height, mSettings.samples, rays);
+
+		// Only pay for counting rays when someone asked for the statistics
+		CountingWorld countingWorld(world);
+		const Hittable<T> &traced = stats ? static_cast<const Hittable<T> &>(countingWorld) : world;
+		RayCounters &counters = rayCounters();
+		Clock::time_point tileStart = Clock::now();
+
+		if (stats)
+		{
+			stats->tile(tile.index).startSeconds = stats->elapsedSeconds();
+		}
+
+		std::size_t i = 0;
+
+		for (int row = tile.y0; row < tile.y0 + tile.height; ++row)
+		{
+			if (cancelled && cancelled->load(std::memory_order_relaxed))
+			{
+				return false;
+			}
+
+			for (int col = tile.x0; col < tile.x0 + tile.width; ++col)
+			{
+				RayCounters before = counters;
+				Clock::time_point pixelStart = stats ? Clock::now() : Clock::time_point();
+				Vec3<T> c;
+
+				for (int s = 0; s < mSettings.samples; ++s, ++i)
+				{
+					c += mIntegrator->radiance(rays.ray(i), traced);
+				}
+
+				image.at(col, row) = c / T(mSettings.samples);
+
+				if (stats)
+				{
+					PixelCost &cost = stats->at(col, row);
+					cost.seconds = std::chrono::duration<double>(Clock::now() - pixelStart).count();
+					cost.rays = counters.rays - before.rays;
+					cost.tests = counters.tests - before.tests;
+				}
+			}
+		}
+
+		if (stats)
+		{
+			TileCost &cost = stats->tile(tile.index);
+			cost.seconds = std::chrono::duration<double>(Clock::now() - tileStart).count();
+			cost.rays = 0;
+			cost.tests = 0;
+
+			for (int row = tile.y0; row < tile.y0 + tile.height; ++row)
+			{
+				for (int col = tile.x0; col < tile.x0 + tile.width; ++col)
+				{
+					cost.rays += stats->at(col, row).rays;
+					cost.tests += stats->at(col, row).tests;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	template<typename T>
+	Image<T> Renderer<T>::render(const Hittable<T> &world, const Camera<T> &camera, RenderStats *stats) const
+	{
+		ThreadPool pool(threadCount());
+		return renderAsync(pool, world, camera, RenderCallbacks<T>(), stats).get();
+	}
+
+	template<typename T>
+	std::vector<Image<T>> Renderer<T>::renderViews(const Hittable<T> &world, const std::vector<Camera<T>> &cameras) const
+	{
+		ThreadPool pool(threadCount());
+		return renderViews(pool, world, cameras);
+	}
+
+	template<typename T>
+	std::vector<Image<T>> Renderer<T>::renderViews(ThreadPool &pool, const Hittable<T> &world,
+		const std::vector<Camera<T>> &cameras) const
+	{
+		std::vector<Image<T>> images(cameras.size(), Image<T>(mSettings.width, mSettings.height));
+		std::vector<Tile> viewTiles = tiles();
+		std::size_t nViews = cameras.size();
+		std::atomic<bool> failed(false);
+
+		// Consecutive work goes to the same tile of every view, and tiles in flight stop at
+		// their next row once any tile throws
+		parallelFor(pool, viewTiles.size() * nViews, [&](std::size_t i)
+		{
+			std::size_t view = i % nViews;
+			renderTile(world, cameras[view], viewTiles[i / nViews], images[view], &failed);
+		}, &failed);
+
+		return images;
+	}
+
+	template<typename T>
+	RenderJob<T> Renderer<T>::renderAsync(ThreadPool &pool, const Hittable<T> &world, const Camera<T> &camera,
+		RenderCallbacks<T> callbacks, RenderStats *stats) const
+	{
+		using State = typename RenderJob<T>::State;
+
+		auto state = std::make_shared<State>(camera, tiles(), std::move(callbacks), mSettings.width, mSettings.height);
+
+		if (stats)
+		{
+			stats->reset(mSettings.width, mSettings.height, state->tiles);
+		}
+
+		int nTasks = std::max(1, std::min(pool.size(), int(state->tiles.size())));
+		state->activeWorkers = nTasks;
+
+		auto work = [state, renderer = *this, &world, stats]()
+		{
+			try
+			{
+				for (std::size_t i = state->nextTile++; i < state->tiles.size() && !state->cancelled; i = state->nextTile++)
+				{
+					const Tile &tile = state->tiles[i];
+
+					if (!renderer.renderTile(world, state->camera, tile, state->image, &state->cancelled, stats))
+					{
+						break;
+					}
+
+					// Other workers are still writing the rest of the image, so hand out a copy of the tile
+					Image<T> pixels;
+
+					if (state->callbacks.onTile)
+					{
+						pixels = Image<T>(tile.width, tile.height);
+
+						for (int row = 0; row < tile.height; ++row)
+						{
+							for (int col = 0; col < tile.width; ++col)
+							{
+								pixels.at(col, row) = state->image.at(tile.x0 + col, tile.y0 + row);
+							}
+						}
+					}
+
+					// Count under the lock so that progress is reported in order
+					std::lock_guard<std::mutex> lock(state->mutex);
+					int completed = ++state->completedTiles;
+
+					if (state->callbacks.onTile)
+					{
+						state->callbacks.onTile(tile, pixels);
+					}
+
+					if (state->callbacks.onProgress)
+					{
+						state->callbacks.onProgress(completed, int(state->tiles.size()));
+					}
+				}
+			}
+			catch (...)
+			{
+				// Keep the first failure and stop the other workers
+				std::lock_guard<std::mutex> lock(state->mutex);
+				state->error = state->error ? state->error : std::current_exception();
+				state->cancelled = true;
+			}
+
+			// The last worker out publishes the result
+			if (--state->activeWorkers == 0)
+			{
+				if (state->error)
+				{
+					state->promise.set_exception(state->error);
+				}
+				else if (state->completedTiles < int(state->tiles.size()))
+				{
+					state->promise.set_exception(std::make_exception_ptr(RenderCancelled()));
+				}
+				else
+				{
+					state->promise.set_value(std::move(state->image));
+				}
+			}
+		};
+
+		for (int i = 0; i < nTasks; ++i)
+		{
+			pool.post(work);
+		}
+
+		return RenderJob<T>(state);
+	}
+}
+
+#endif
@@ -0,0 +1,258 @@
+#ifndef TRAYZY_SCENEARENA_H
+#define TRAYZY_SCENEARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+namespace trayzy
+{
+	/**
+	 * A pool allocator for scene primitives and materials.
+	 *
+	 * Objects are constructed into large blocks with one pool per type, so objects of the
+	 * same type sit next to each other in memory and building a scene costs one heap
+	 * allocation per block instead of one per object. The arena owns every object and
+	 * hands out raw pointers, valid until it is cleared or destroyed, so it must outlive
+	 * every scene built from it; interfaces that take shared pointers are given them
+	 * through unowned(), which makes the borrowed lifetime visible where the scene is
+	 * built. Destroying the arena releases whole blocks at once and only visits objects
+	 * whose types have non-trivial destructors.
+	 *
+	 * An arena is not thread-safe; build each scene from a single thread.
+	 */
+	class SceneArena
+	{
+	public:
+		/// The memory used by the objects of one type
+		struct Footprint
+		{
+			/// The name of the type
+			std::string type;
+
+			/// The number of objects constructed
+			std::size_t count;
+
+			/// The size of one object in bytes
+			std::size_t objectBytes;
+
+			/// The bytes occupied by constructed objects
+			std::size_t usedBytes;
+
+			/// The bytes reserved by the type's blocks
+			std::size_t reservedBytes;
+		};
+
+		/**
+		 * Creates an empty arena.
+		 *
+		 * @param blockBytes The minimum size of each block of memory
+		 */
+		explicit SceneArena(std::size_t blockBytes = std::size_t(1) << 20) :
+			mBlockBytes(blockBytes)
+		{
+			// Do nothing more
+		}
+
+		SceneArena(const SceneArena &) = delete;
+		SceneArena &operator=(const SceneArena &) = delete;
+
+		/**
+		 * Constructs an object in the pool of its type.
+		 *
+		 * @tparam U The type of object to construct
+		 * @param args The arguments forwarded to the object's constructor
+		 * @return The object, valid until the arena is cleared or destroyed
+		 */
+		template<typename U, typename... Args>
+		U *make(Args &&...args);
+
+		/// Returns the memory used by each type of object, in order of type name
+		std::vector<Footprint> footprint() const;
+
+		/// Destroys every object and releases every block, invalidating all pointers
+		void clear();
+
+		~SceneArena()
+		{
+			clear();
+		}
+
+	private:
+		/// The storage of all objects of one type
+		struct Pool
+		{
+			std::string type;
+			std::size_t objectBytes = 0;
+			std::size_t objectsPerBlock = 0;
+			std::size_t count = 0;
+			void (*destroy)(void *) = nullptr;
+			std::vector<void *> blocks;
+		};
+
+		/// Returns the pool for a type, creating it on first use
+		template<typename U>
+		Pool &pool();
+
+		/// Returns a readable name for a type
+		static std::string typeName(const std::type_info &info);
+
+	private:
+		std::size_t mBlockBytes;
+		std::map<std::type_index, Pool> mPools;
+	};
+
+	/**
+	 * Wraps an object owned elsewhere, such as by a SceneArena, for interfaces that take
+	 * shared pointers.
+	 *
+	 * The pointer shares no ownership and carries no control block, so copying it never
+	 * touches a reference count and use_count() is 0; it dangles once the owner destroys
+	 * the object.
+	 *
+	 * @param object The object to wrap
+	 * @return A shared pointer that does not own the object
+	 */
+	template<typename U>
+	inline std::shared_ptr<U> unowned(U *object);
+}
+
+namespace trayzy
+{
+	template<typename U>
+	SceneArena::Pool &SceneArena::pool()
+	{
+		Pool &result = mPools[std::type_index(typeid(U))];
+
+		if (result.objectBytes == 0)
+		{
+			// Rounding the size up to the alignment keeps consecutive objects aligned
+			result.type = typeName(typeid(U));
+			result.objectBytes = (sizeof(U) + alignof(U) - 1) / alignof(U) * alignof(U);
+			result.objectsPerBlock = std::max<std::size_t>(1, mBlockBytes / result.objectBytes);
+
+			if (!std::is_trivially_destructible<U>::value)
+			{
+				result.destroy = [](void *object) { static_cast<U *>(object)->~U(); };
+			}
+		}
+
+		return result;
+	}
+
+	template<typename U, typename... Args>
+	U *SceneArena::make(Args &&...args)
+	{
+		static_assert(alignof(U) <= alignof(std::max_align_t), "SceneArena: over-aligned types are not supported");
+
+		Pool &typePool = pool<U>();
+		std::size_t slot = typePool.count % typePool.objectsPerBlock;
+
+		if (slot != 0)
+		{
+			void *address = static_cast<char *>(typePool.blocks.back()) + slot * typePool.objectBytes;
+			U *object = new (address) U(std::forward<Args>(args)...);
+			++typePool.count;
+			return object;
+		}
+
+		// Keep a new block only once an object is constructed in it, so a throwing
+		// constructor leaves the pools as they were
+		std::unique_ptr<void, void (*)(void *)> block(std::malloc(typePool.objectsPerBlock * typePool.objectBytes),
+			std::free);
+
+		if (!block)
+		{
+			throw std::bad_alloc();
+		}
+
+		typePool.blocks.reserve(typePool.blocks.size() + 1);
+		U *object = new (block.get()) U(std::forward<Args>(args)...);
+		typePool.blocks.push_back(block.release());
+		++typePool.count;
+		return object;
+	}
+
+	template<typename U>
+	std::shared_ptr<U> unowned(U *object)
+	{
+		// Aliasing an empty pointer yields a pointer without a control block
+		return std::shared_ptr<U>(std::shared_ptr<void>(), object);
+	}
+
+	inline std::vector<SceneArena::Footprint> SceneArena::footprint() const
+	{
+		std::vector<Footprint> result;
+
+		for (const auto &entry : mPools)
+		{
+			const Pool &typePool = entry.second;
+			result.push_back({ typePool.type, typePool.count, typePool.objectBytes,
+				typePool.count * typePool.objectBytes,
+				typePool.blocks.size() * typePool.objectsPerBlock * typePool.objectBytes });
+		}
+
+		std::sort(result.begin(), result.end(), [](const Footprint &a, const Footprint &b)
+		{
+			return a.type < b.type;
+		});
+
+		return result;
+	}
+
+	inline void SceneArena::clear()
+	{
+		for (auto &entry : mPools)
+		{
+			Pool &typePool = entry.second;
+
+			if (typePool.destroy)
+			{
+				for (std::size_t i = 0; i < typePool.count; ++i)
+				{
+					typePool.destroy(static_cast<char *>(typePool.blocks[i / typePool.objectsPerBlock])
+						+ (i % typePool.objectsPerBlock) * typePool.objectBytes);
+				}
+			}
+
+			for (void *block : typePool.blocks)
+			{
+				std::free(block);
+			}
+		}
+
+		mPools.clear();
+	}
+
+	/* static */
+	inline std::string SceneArena::typeName(const std::type_info &info)
+	{
+#if defined(__GNUG__)
+		int status = 0;
+		char *demangled = abi::__cxa_demangle(info.name(), nullptr, nullptr, &status);
+
+		if (status == 0 && demangled)
+		{
+			std::string name(demangled);
+			std::free(demangled);
+			return name;
+		}
+#endif
+		return info.name();
+	}
+}
+
+#endif
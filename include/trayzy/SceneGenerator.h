@@ -0,0 +1,186 @@
+#ifndef TRAYZY_SCENEGENERATOR_H
+#define TRAYZY_SCENEGENERATOR_H
+
+#include "Dielectric.h"
+#include "DiffuseLight.h"
+#include "Hittable.h"
+#include "Lambertian.h"
+#include "Metal.h"
+#include "SceneArena.h"
+#include "Sphere.h"
+#include "Vec3.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace trayzy
+{
+	/**
+	 * Generates a deterministic field of small random spheres on a large ground sphere,
+	 * with three large feature spheres at its center, as on the cover of
+	 * "Ray Tracing in One Weekend".
+	 *
+	 * The small spheres are jittered within the cells of a square grid one unit apart, so
+	 * the field grows outward while its density stays constant. Materials are 80% Lambertian,
+	 * 15% Metal and 5% Dielectric. The output depends only on the count and the seed, not on
+	 * the platform's standard library.
+	 *
+	 * @param arena The arena that allocates the spheres and their materials
+	 * @param count The number of small spheres
+	 * @param seed The seed of the random sequence
+	 * @return The ground, the feature spheres and the small spheres
+	 */
+	template<typename T>
+	std::vector<std::shared_ptr<Hittable<T>>> generateSphereField(SceneArena &arena, std::size_t count,
+		std::uint32_t seed = 1);
+
+	/**
+	 * Generates a deterministic night scene lit only by many small emissive spheres, for
+	 * measuring direct light sampling.
+	 *
+	 * The lights are scattered over a fixed 20 by 20 area above a ground sphere, among large
+	 * diffuse spheres that cast shadows, and a black dome blocks the sky. Their brightness
+	 * follows a heavy-tailed distribution normalized so that the total emitted power does
+	 * not depend on the count; more lights make the scene denser, not brighter.
+	 *
+	 * @param arena The arena that allocates the spheres and their materials
+	 * @param count The number of lights
+	 * @param seed The seed of the random sequence
+	 * @return The dome, the ground, the diffuse spheres and the lights
+	 */
+	template<typename T>
+	std::vector<std::shared_ptr<Hittable<T>>> generateLightField(SceneArena &arena, std::size_t count,
+		std::uint32_t seed = 1);
+}
+
+namespace trayzy
+{
+	template<typename T>
+	std::vector<std::shared_ptr<Hittable<T>>> generateSphereField(SceneArena &arena, std::size_t count,
+		std::uint32_t seed)
+	{
+		std::mt19937 engine(seed);
+
+		// Map the engine's 32-bit output to [0, 1) without relying on a distribution's implementation
+		auto uniform = [&engine]()
+		{
+			return T(engine() >> 8) / T(1 << 24);
+		};
+
+		std::vector<std::shared_ptr<Hittable<T>>> hittables;
+		hittables.reserve(count + 4);
+
+		int side = std::max(1, int(std::ceil(std::sqrt(double(count)))));
+		T groundRadius = std::max(T(1000), T(50) * side);
+
+		hittables.push_back(unowned(arena.make<Sphere<T>>(Vec3<T>(0, -groundRadius, 0), groundRadius,
+			unowned(arena.make<Lambertian<T>>(Vec3<T>(T(0.5), T(0.5), T(0.5)))))));
+
+		std::size_t generated = 0;
+
+		for (int a = -side / 2; generated < count; ++a)
+		{
+			for (int b = -side / 2; b < side - side / 2 && generated < count; ++b, ++generated)
+			{
+				// Draw into named values since argument evaluation order is unspecified
+				T choice = uniform();
+				T x = a + T(0.9) * uniform();
+				T z = b + T(0.9) * uniform();
+				Vec3<T> center(x, T(0.2), z);
+				std::shared_ptr<Material<T>> material;
+
+				if (choice < T(0.8))
+				{
+					T r = uniform() * uniform();
+					T g = uniform() * uniform();
+					T blue = uniform() * uniform();
+					material = unowned(arena.make<Lambertian<T>>(Vec3<T>(r, g, blue)));
+				}
+				else if (choice < T(0.95))
+				{
+					T r = T(0.5) * (1 + uniform());
+					T g = T(0.5) * (1 + uniform());
+					T blue = T(0.5) * (1 + uniform());
+					material = unowned(arena.make<Metal<T>>(Vec3<T>(r, g, blue), T(0.5) * uniform()));
+				}
+				else
+				{
+					material = unowned(arena.make<Dielectric<T>>(T(1.5)));
+				}
+
+				hittables.push_back(unowned(arena.make<Sphere<T>>(center, T(0.2), material)));
+			}
+		}
+
+		hittables.push_back(unowned(arena.make<Sphere<T>>(Vec3<T>(0, 1, 0), T(1),
+			unowned(arena.make<Dielectric<T>>(T(1.5))))));
+		hittables.push_back(unowned(arena.make<Sphere<T>>(Vec3<T>(-4, 1, 0), T(1),
+			unowned(arena.make<Lambertian<T>>(Vec3<T>(T(0.4), T(0.2), T(0.1)))))));
+		hittables.push_back(unowned(arena.make<Sphere<T>>(Vec3<T>(4, 1, 0), T(1),
+			unowned(arena.make<Metal<T>>(Vec3<T>(T(0.7), T(0.6), T(0.5)), T(0))))));
+
+		return hittables;
+	}
+
+	template<typename T>
+	std::vector<std::shared_ptr<Hittable<T>>> generateLightField(SceneArena &arena, std::size_t count,
+		std::uint32_t seed)
+	{
+		std::mt19937 engine(seed);
+
+		auto uniform = [&engine]()
+		{
+			return T(engine() >> 8) / T(1 << 24);
+		};
+
+		std::vector<std::shared_ptr<Hittable<T>>> hittables;
+		hittables.reserve(count + 34);
+
+		auto black = unowned(arena.make<Lambertian<T>>(Vec3<T>(0, 0, 0)));
+		auto gray = unowned(arena.make<Lambertian<T>>(Vec3<T>(T(0.5), T(0.5), T(0.5))));
+		hittables.push_back(unowned(arena.make<Sphere<T>>(Vec3<T>(0, 0, 0), T(100), black)));
+		hittables.push_back(unowned(arena.make<Sphere<T>>(Vec3<T>(0, -1000, 0), T(1000), gray)));
+
+		for (int i = 0; i < 32; ++i)
+		{
+			T x = 20 * uniform() - 10;
+			T z = 20 * uniform() - 10;
+			T radius = T(0.5) + T(0.7) * uniform();
+			hittables.push_back(unowned(arena.make<Sphere<T>>(Vec3<T>(x, radius, z), radius, gray)));
+		}
+
+		// Draw every brightness first so the total can be normalized
+		std::vector<T> strengths(count);
+		T totalStrength = 0;
+
+		for (T &strength : strengths)
+		{
+			T u = uniform();
+			strength = 1 / (1 - T(0.99) * u);
+			totalStrength += strength;
+		}
+
+		T radius(0.05f);
+
+		for (T strength : strengths)
+		{
+			T x = 20 * uniform() - 10;
+			T y = T(0.1) + T(2.9) * uniform();
+			T z = 20 * uniform() - 10;
+			T warmth = uniform();
+			Vec3<T> hue(1, T(0.6) + T(0.3) * warmth, T(0.2) + T(0.8) * warmth);
+			T scale = T(25) * strength / totalStrength;
+			hittables.push_back(unowned(arena.make<Sphere<T>>(Vec3<T>(x, y, z), radius,
+				unowned(arena.make<DiffuseLight<T>>(scale / (radius * radius) * hue)))));
+		}
+
+		return hittables;
+	}
+}
+
+#endif
@@ -1,10 +1,14 @@
 #ifndef TRAYZY_SPHERE_H
 #define TRAYZY_SPHERE_H
 
+#include "Aabb.h"
+#include "FastMath.h"
 #include "Hittable.h"
 #include "Intersection.h"
 #include "Ray.h"
+#include "RenderStats.h"
 
+#include <cmath>
 #include <memory>
 
 namespace trayzy
@@ -25,8 +29,26 @@ namespace trayzy
 			// Do nothing more
 		}
 
-		// Hittable::hit
-		virtual bool hit(const Ray<T> &ray, T tMin, T tMax, Intersection<T> &intersection) const override;
+		// Hittable::closestHit
+		virtual bool closestHit(const Ray<T> &ray, T tMin, T tMax, HitRecord<T> &record) const override;
+
+		// Hittable::evaluate
+		virtual void evaluate(const Ray<T> &ray, const HitRecord<T> &record, Intersection<T> &intersection) const override;
+
+		// Hittable::occluded
+		virtual bool occluded(const Ray<T> &ray, T tMin, T tMax) const override;
+
+		// Hittable::boundingBox
+		virtual Aabb<T> boundingBox() const override;
+
+		/// Returns the center of this sphere
+		inline const Vec3<T> &center() const;
+
+		/// Returns the radius of this sphere, which is negative for inward normals
+		inline T radius() const;
+
+		/// Returns the material of this sphere
+		inline const std::shared_ptr<Material<T>> &material() const;
 
 	private:
 		Vec3<T> mCenter;
@@ -38,8 +60,9 @@ namespace trayzy
 namespace trayzy
 {
 	template<typename T>
-	bool Sphere<T>::hit(const Ray<T> &ray, T tMin, T tMax, Intersection<T> &intersection) const
+	bool Sphere<T>::closestHit(const Ray<T> &ray, T tMin, T tMax, HitRecord<T> &record) const
 	{
+		countIntersectionTests();
 		Vec3<T> oc = ray.origin() - mCenter;
 
 		// Note that the magnitude squared of a vector is equal to the dot product with itself
@@ -52,7 +75,7 @@ namespace trayzy
 
 		if (discriminant > 0)
 		{
-			T sqrtDiscriminant =  std::sqrt(discriminant);
+			T sqrtDiscriminant = Math<T>::sqrt(discriminant);
 
 			for (T sign : {T(-1), T(1)})
 			{
@@ -60,10 +83,8 @@ namespace trayzy
 
 				if (root < tMax && root > tMin)
 				{
-					intersection.t = root;
-					intersection.p = ray.pointAtParameter(intersection.t);
-					intersection.normal = (intersection.p - mCenter) / mRadius;
-					intersection.material = mMaterial;
+					record.t = root;
+					record.primitive = this;
 					hasHit = true;
 					break;
 				}
@@ -72,6 +93,66 @@ namespace trayzy
 
 		return hasHit;
 	}
+
+	template<typename T>
+	void Sphere<T>::evaluate(const Ray<T> &ray, const HitRecord<T> &record, Intersection<T> &intersection) const
+	{
+		intersection.t = record.t;
+		intersection.p = ray.pointAtParameter(record.t);
+		intersection.normal = (intersection.p - mCenter) / mRadius;
+		intersection.material = mMaterial;
+	}
+
+	template<typename T>
+	bool Sphere<T>::occluded(const Ray<T> &ray, T tMin, T tMax) const
+	{
+		countIntersectionTests();
+		Vec3<T> oc = ray.origin() - mCenter;
+
+		T a = ray.direction().magnitudeSquared();
+		T b = 2 * dot(oc, ray.direction());
+		T c = oc.magnitudeSquared() - mRadius * mRadius;
+
+		T discriminant = b * b - 4 * a * c;
+
+		if (discriminant <= 0)
+		{
+			return false;
+		}
+
+		// Either root in range blocks the ray, so there is no need to tell which comes first
+		T sqrtDiscriminant = Math<T>::sqrt(discriminant);
+		T near = (-b - sqrtDiscriminant) / (2 * a);
+		T far = (-b + sqrtDiscriminant) / (2 * a);
+
+		return (near < tMax && near > tMin) || (far < tMax && far > tMin);
+	}
+
+	template<typename T>
+	Aabb<T> Sphere<T>::boundingBox() const
+	{
+		// The radius may be negative for spheres with inward normals
+		T r = std::abs(mRadius);
+		return Aabb<T>(mCenter - Vec3<T>(r, r, r), mCenter + Vec3<T>(r, r, r));
+	}
+
+	template<typename T>
+	const Vec3<T> &Sphere<T>::center() const
+	{
+		return mCenter;
+	}
+
+	template<typename T>
+	T Sphere<T>::radius() const
+	{
+		return mRadius;
+	}
+
+	template<typename T>
+	const std::shared_ptr<Material<T>> &Sphere<T>::material() const
+	{
+		return mMaterial;
+	}
 }
 
 #endif
@@ -0,0 +1,369 @@
+#ifndef TRAYZY_SPHERERASTERIZER_H
+#define TRAYZY_SPHERERASTERIZER_H
+
+#include "Camera.h"
+#include "Hittable.h"
+#include "HitRecord.h"
+#include "RayBatch.h"
+#include "RenderSettings.h"
+#include "Sphere.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace trayzy
+{
+	/**
+	 * Finds the closest hit of camera rays by rasterizing the screen bounds of spheres
+	 * rather than tracing the rays through an acceleration structure.
+	 *
+	 * Each sphere's bounding box is projected onto the canvas, and the pixels it covers are
+	 * binned into the tiles of the render. A tile's G-buffer then keeps, for every sample,
+	 * the depth and identity of the closest sphere among those binned there, testing each
+	 * sample's ray against the sphere exactly as tracing would, so the hits are the same as
+	 * those found by testing the same rays against every sphere. Only pinhole cameras project
+	 * spheres onto bounded pixels, since thin-lens rays start anywhere on the lens.
+	 *
+	 * Like a conservative rasterizer, a sphere is first tested against the cone of rays
+	 * through each pixel of its bounds, and only the samples of the pixels it may cover are
+	 * tested exactly. Tiles draw their spheres nearest first and keep the farthest hit of each
+	 * pixel's samples, so that, as an early depth test would skip occluded fragments, pixels
+	 * whose samples all hit something nearer than the sphere are skipped too.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class SphereRasterizer
+	{
+	public:
+		/// The pixels that a sphere may cover, from the first column and row up to but excluding the last
+		struct Bounds
+		{
+			int x0 = 0;
+			int y0 = 0;
+			int x1 = 0;
+			int y1 = 0;
+		};
+
+		/// The spheres that may cover each tile of a frame
+		struct Bins
+		{
+			/// The pixels that each sphere may cover
+			std::vector<Bounds> bounds;
+
+			/// A lower bound on the distance from the camera to each sphere's surface
+			std::vector<T> distances;
+
+			/// The indices of the spheres that may cover each tile, by tile index, nearest first
+			std::vector<std::vector<std::uint32_t>> tiles;
+
+			/// The camera the spheres were projected through
+			Camera<T> camera;
+
+			/// The number of columns in the image
+			int nCols = 0;
+
+			/// The number of rows in the image
+			int nRows = 0;
+
+			/// An upper bound on the angle between the ray through a pixel's center and any ray through the pixel
+			T pixelAngle = 0;
+		};
+
+		/**
+		 * Creates a rasterizer for a scene made only of spheres.
+		 *
+		 * @param hittables The spheres of the scene
+		 * @throws std::invalid_argument If an item is not a sphere
+		 */
+		explicit SphereRasterizer(const std::vector<std::shared_ptr<Hittable<T>>> &hittables);
+
+		/// Returns the number of spheres this rasterizer draws
+		inline std::size_t size() const;
+
+		/**
+		 * Projects every sphere and bins it into the tiles its bounds overlap.
+		 *
+		 * The spheres are projected and each tile's spheres are sorted on the workers of the
+		 * pool, and the spheres are binned on the calling thread, which must not be a worker
+		 * of the pool.
+		 *
+		 * @param pool The pool whose workers project the spheres
+		 * @param camera The camera to view the spheres through
+		 * @param settings The render settings whose image size and tile size lay out the tiles
+		 *        as Renderer::tiles() does
+		 * @return The spheres that may cover each tile
+		 * @throws std::invalid_argument If the camera has a lens
+		 */
+		Bins bin(ThreadPool &pool, const Camera<T> &camera, const RenderSettings &settings) const;
+
+		/**
+		 * Fills the G-buffer of a tile with the closest hit of each of its camera rays.
+		 *
+		 * @param bins The spheres that may cover each tile, binned for the camera of the rays
+		 * @param tile The tile
+		 * @param nSamples The number of samples per pixel
+		 * @param rays The camera rays of the tile, ordered as Camera::getRays() orders them
+		 * @param[out] gBuffer The closest hit of each ray, with a null primitive where the ray
+		 *        misses every sphere
+		 */
+		void rasterize(const Bins &bins, const Tile &tile, int nSamples, const RayBatch<T> &rays,
+			std::vector<HitRecord<T>> &gBuffer) const;
+
+	private:
+		/// Returns the pixels a sphere may cover, which are empty if it lies behind the camera
+		Bounds project(const Camera<T> &camera, const Sphere<T> &sphere, int nCols, int nRows) const;
+
+	private:
+		std::vector<std::shared_ptr<Sphere<T>>> mSpheres;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	SphereRasterizer<T>::SphereRasterizer(const std::vector<std::shared_ptr<Hittable<T>>> &hittables)
+	{
+		mSpheres.reserve(hittables.size());
+
+		for (const std::shared_ptr<Hittable<T>> &hittable : hittables)
+		{
+			std::shared_ptr<Sphere<T>> sphere = std::dynamic_pointer_cast<Sphere<T>>(hittable);
+
+			if (!sphere)
+			{
+				throw std::invalid_argument("SphereRasterizer: only spheres can be rasterized");
+			}
+
+			mSpheres.push_back(std::move(sphere));
+		}
+	}
+
+	template<typename T>
+	std::size_t SphereRasterizer<T>::size() const
+	{
+		return mSpheres.size();
+	}
+
+	template<typename T>
+	typename SphereRasterizer<T>::Bounds SphereRasterizer<T>::project(const Camera<T> &camera, const Sphere<T> &sphere,
+		int nCols, int nRows) const
+	{
+		T radius = std::abs(sphere.radius());
+		T uMin = std::numeric_limits<T>::max(), uMax = std::numeric_limits<T>::lowest();
+		T vMin = uMin, vMax = uMax;
+		int nBehind = 0;
+
+		for (int corner = 0; corner < 8; ++corner)
+		{
+			Vec3<T> point = sphere.center() + Vec3<T>(corner & 1 ? radius : -radius, corner & 2 ? radius : -radius,
+				corner & 4 ? radius : -radius);
+			T u, v;
+
+			if (!camera.project(point, u, v))
+			{
+				++nBehind;
+				continue;
+			}
+
+			uMin = std::min(uMin, u);
+			uMax = std::max(uMax, u);
+			vMin = std::min(vMin, v);
+			vMax = std::max(vMax, v);
+		}
+
+		if (nBehind == 8)
+		{
+			return Bounds();
+		}
+
+		// A box that straddles the camera projects to the whole canvas
+		if (nBehind > 0)
+		{
+			return { 0, 0, nCols, nRows };
+		}
+
+		// Widen by half a pixel so that rounding in the rays cannot step past the bounds,
+		// and clamp before converting since corners close to the camera project far away
+		T margin(0.5f);
+		auto column = [&](T u) { return int(std::floor(std::min(std::max(u * nCols, T(-1)), T(nCols + 1)))); };
+		auto row = [&](T v) { return int(std::floor(std::min(std::max(v * nRows, T(-1)), T(nRows + 1)))); };
+
+		Bounds bounds;
+		bounds.x0 = std::max(0, column(uMin - margin / nCols));
+		bounds.y0 = std::max(0, row(vMin - margin / nRows));
+		bounds.x1 = std::min(nCols, column(uMax + margin / nCols) + 1);
+		bounds.y1 = std::min(nRows, row(vMax + margin / nRows) + 1);
+		return bounds;
+	}
+
+	template<typename T>
+	typename SphereRasterizer<T>::Bins SphereRasterizer<T>::bin(ThreadPool &pool, const Camera<T> &camera,
+		const RenderSettings &settings) const
+	{
+		if (camera.lensRadius() > 0)
+		{
+			throw std::invalid_argument("SphereRasterizer: only pinhole cameras can be rasterized");
+		}
+
+		int nCols = settings.width;
+		int nRows = settings.height;
+		int size = std::max(1, settings.tileSize);
+		int nTileCols = (nCols + size - 1) / size;
+		int nTileRows = (nRows + size - 1) / size;
+
+		// Rays through a pixel lean away from its center by at most half its diagonal on the canvas
+		Vec3<T> forward = unitVector(cross(camera.horizontal(), camera.vertical()));
+		T focalDistance = std::abs(dot(camera.lowerLeft() - camera.origin(), forward));
+		Vec3<T> pixelDiagonal = camera.horizontal() / T(nCols) + camera.vertical() / T(nRows);
+
+		Bins bins;
+		bins.camera = camera;
+		bins.nCols = nCols;
+		bins.nRows = nRows;
+		bins.pixelAngle = T(0.5f) * pixelDiagonal.magnitude() / focalDistance;
+		bins.bounds.resize(mSpheres.size());
+		bins.distances.resize(mSpheres.size());
+		bins.tiles.resize(std::size_t(nTileCols) * nTileRows);
+
+		std::size_t chunk = 4096;
+
+		parallelFor(pool, (mSpheres.size() + chunk - 1) / chunk, [&](std::size_t c)
+		{
+			for (std::size_t i = c * chunk; i < std::min(mSpheres.size(), (c + 1) * chunk); ++i)
+			{
+				const Sphere<T> &sphere = *mSpheres[i];
+				bins.bounds[i] = project(camera, sphere, nCols, nRows);
+
+				// Leave room for rounding, which is largest for huge spheres seen from close by
+				T distance = (sphere.center() - camera.origin()).magnitude();
+				bins.distances[i] = distance - std::abs(sphere.radius()) - T(1e-4f) * distance;
+			}
+		});
+
+		// Tiles are numbered row by row from the top of the image, as Renderer::tiles() hands them out
+		for (std::size_t i = 0; i < mSpheres.size(); ++i)
+		{
+			const Bounds &bounds = bins.bounds[i];
+
+			if (bounds.x0 >= bounds.x1 || bounds.y0 >= bounds.y1)
+			{
+				continue;
+			}
+
+			for (int tileRow = (nRows - bounds.y1) / size; tileRow <= (nRows - 1 - bounds.y0) / size; ++tileRow)
+			{
+				for (int tileCol = bounds.x0 / size; tileCol <= (bounds.x1 - 1) / size; ++tileCol)
+				{
+					bins.tiles[std::size_t(tileRow) * nTileCols + tileCol].push_back(std::uint32_t(i));
+				}
+			}
+		}
+
+		parallelFor(pool, bins.tiles.size(), [&](std::size_t i)
+		{
+			std::sort(bins.tiles[i].begin(), bins.tiles[i].end(), [&](std::uint32_t a, std::uint32_t b)
+			{
+				return bins.distances[a] < bins.distances[b];
+			});
+		});
+
+		return bins;
+	}
+
+	template<typename T>
+	void SphereRasterizer<T>::rasterize(const Bins &bins, const Tile &tile, int nSamples, const RayBatch<T> &rays,
+		std::vector<HitRecord<T>> &gBuffer) const
+	{
+		std::size_t nPixels = std::size_t(tile.width) * tile.height;
+		HitRecord<T> miss;
+		miss.t = std::numeric_limits<T>::max();
+		gBuffer.assign(nPixels * nSamples, miss);
+
+		// The distance to the farthest hit among each pixel's samples, infinite while one misses
+		std::vector<T> farthest(nPixels, std::numeric_limits<T>::infinity());
+		std::vector<T> lengths(gBuffer.size());
+
+		for (std::size_t i = 0; i < gBuffer.size(); ++i)
+		{
+			lengths[i] = rays.ray(i).direction().magnitude();
+		}
+
+		// The direction of the ray through each pixel's center
+		const Camera<T> &camera = bins.camera;
+		std::vector<Vec3<T>> centers(nPixels);
+
+		for (int row = tile.y0; row < tile.y0 + tile.height; ++row)
+		{
+			for (int col = tile.x0; col < tile.x0 + tile.width; ++col)
+			{
+				T u = (col + T(0.5f)) / bins.nCols;
+				T v = (row + T(0.5f)) / bins.nRows;
+				centers[std::size_t(row - tile.y0) * tile.width + (col - tile.x0)] = unitVector(camera.lowerLeft()
+					+ u * camera.horizontal() + v * camera.vertical() - camera.origin());
+			}
+		}
+
+		T hitEpsilon(0.001f);
+
+		for (std::uint32_t index : bins.tiles[tile.index])
+		{
+			const Sphere<T> &sphere = *mSpheres[index];
+			const Bounds &bounds = bins.bounds[index];
+			T distance = bins.distances[index];
+
+			// A ray through the pixel passes within the radius of the center only if the ray
+			// through its center passes within the radius plus the arc the pixel spans there
+			Vec3<T> toCenter = sphere.center() - camera.origin();
+			T reach = (std::abs(sphere.radius()) + toCenter.magnitude() * bins.pixelAngle) * T(1.001f);
+			T reachSquared = reach * reach;
+			int x0 = std::max(bounds.x0, tile.x0), x1 = std::min(bounds.x1, tile.x0 + tile.width);
+			int y0 = std::max(bounds.y0, tile.y0), y1 = std::min(bounds.y1, tile.y0 + tile.height);
+
+			for (int row = y0; row < y1; ++row)
+			{
+				for (int col = x0; col < x1; ++col)
+				{
+					std::size_t pixel = std::size_t(row - tile.y0) * tile.width + (col - tile.x0);
+
+					// Every sample already hit something nearer than any point of the sphere
+					if (distance > farthest[pixel] || cross(toCenter, centers[pixel]).magnitudeSquared() > reachSquared)
+					{
+						continue;
+					}
+
+					std::size_t first = pixel * nSamples;
+					bool updated = false;
+
+					// Keep the closest hit so far, as the depth test of a rasterizer would
+					for (std::size_t i = first; i < first + nSamples; ++i)
+					{
+						updated |= sphere.closestHit(rays.ray(i), hitEpsilon, gBuffer[i].t, gBuffer[i]);
+					}
+
+					if (updated)
+					{
+						T f = 0;
+
+						for (std::size_t i = first; i < first + nSamples; ++i)
+						{
+							f = gBuffer[i].primitive ? std::max(f, gBuffer[i].t * lengths[i])
+								: std::numeric_limits<T>::infinity();
+						}
+
+						farthest[pixel] = f;
+					}
+				}
+			}
+		}
+	}
+}
+
+#endif
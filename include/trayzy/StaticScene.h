@@ -0,0 +1,209 @@
+#ifndef TRAYZY_STATICSCENE_H
+#define TRAYZY_STATICSCENE_H
+
+#include "Dielectric.h"
+#include "Forward.h"
+#include "Intersection.h"
+#include "Lambertian.h"
+#include "Metal.h"
+#include "Ray.h"
+#include "RenderStats.h"
+#include "Vec3.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <variant>
+#include <vector>
+
+namespace trayzy
+{
+	/**
+	 * A scene restricted to a closed set of primitive and material types.
+	 *
+	 * Spheres are stored as parallel coordinate arrays and materials by value in a
+	 * variant, so intersection is a tight loop over contiguous data and scattering is a
+	 * switch over the material kind with non-virtual, inlinable calls. Scenes that need
+	 * other types keep using the open Hittable and Material hierarchies.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class StaticScene
+	{
+	public:
+		/// The closed set of supported materials
+		using MaterialVariant = std::variant<Lambertian<T>, Metal<T>, Dielectric<T>>;
+
+		/**
+		 * Adds a material to the scene.
+		 *
+		 * @param material The material to copy into the scene
+		 * @return The index used to assign the material to spheres
+		 */
+		std::uint32_t addMaterial(const MaterialVariant &material);
+
+		/**
+		 * Adds a sphere to the scene.
+		 *
+		 * @param center The sphere's center
+		 * @param radius The sphere's radius, negative to point its normals inward
+		 * @param material The index returned when the sphere's material was added
+		 */
+		void addSphere(const Vec3<T> &center, T radius, std::uint32_t material);
+
+		/// Returns the number of spheres in the scene
+		inline std::size_t size() const;
+
+		/**
+		 * Determines if a ray hits the scene within the provided parametric coordinate range.
+		 *
+		 * @param ray The ray to test against the scene
+		 * @param tMin The minimum parametric coordinate value
+		 * @param tMax The maximum parametric coordinate value
+		 * @param[out] intersection The details about the closest ray hit, with its material index set
+		 * @return Whether the ray hit the scene within the allowed parametric coordinate range
+		 */
+		bool hit(const Ray<T> &ray, T tMin, T tMax, Intersection<T> &intersection) const;
+
+		/**
+		 * Scatters an inbound ray with the material at a hit, dispatching on the material kind.
+		 *
+		 * @copydetails Material::scatter
+		 */
+		bool scatter(const Ray<T> &inbound, const Intersection<T> &intersection,
+			Vec3<T> &attenuation, Ray<T> &scattered) const;
+
+	private:
+		std::vector<T> mCenterX;
+		std::vector<T> mCenterY;
+		std::vector<T> mCenterZ;
+		std::vector<T> mRadius;
+		std::vector<std::uint32_t> mSphereMaterials;
+		std::vector<MaterialVariant> mMaterials;
+	};
+
+	/// Scatters a ray at a hit in a closed-set scene
+	template<typename T>
+	inline bool scatter(const StaticScene<T> &world, const Ray<T> &inbound, const Intersection<T> &intersection,
+		Vec3<T> &attenuation, Ray<T> &scattered);
+
+	/// Returns the radiance emitted at a hit in a closed-set scene, none of whose materials emit
+	template<typename T>
+	inline Vec3<T> emitted(const StaticScene<T> &world, const Intersection<T> &intersection);
+}
+
+namespace trayzy
+{
+	template<typename T>
+	std::uint32_t StaticScene<T>::addMaterial(const MaterialVariant &material)
+	{
+		mMaterials.push_back(material);
+		return std::uint32_t(mMaterials.size() - 1);
+	}
+
+	template<typename T>
+	void StaticScene<T>::addSphere(const Vec3<T> &center, T radius, std::uint32_t material)
+	{
+		mCenterX.push_back(center[X]);
+		mCenterY.push_back(center[Y]);
+		mCenterZ.push_back(center[Z]);
+		mRadius.push_back(radius);
+		mSphereMaterials.push_back(material);
+	}
+
+	template<typename T>
+	std::size_t StaticScene<T>::size() const
+	{
+		return mRadius.size();
+	}
+
+	template<typename T>
+	bool StaticScene<T>::hit(const Ray<T> &ray, T tMin, T tMax, Intersection<T> &intersection) const
+	{
+		const T ox = ray.origin()[X], oy = ray.origin()[Y], oz = ray.origin()[Z];
+		const T dx = ray.direction()[X], dy = ray.direction()[Y], dz = ray.direction()[Z];
+		const T a = dx * dx + dy * dy + dz * dz;
+
+		std::size_t closest = size();
+		T tClosest = tMax;
+		countIntersectionTests(size());
+
+		// The same quadratic as Sphere::closestHit, on contiguous arrays
+		for (std::size_t i = 0; i < size(); ++i)
+		{
+			T ocx = ox - mCenterX[i];
+			T ocy = oy - mCenterY[i];
+			T ocz = oz - mCenterZ[i];
+
+			T b = 2 * (ocx * dx + ocy * dy + ocz * dz);
+			T c = (ocx * ocx + ocy * ocy + ocz * ocz) - mRadius[i] * mRadius[i];
+			T discriminant = b * b - 4 * a * c;
+
+			if (discriminant > 0)
+			{
+				T sqrtDiscriminant = std::sqrt(discriminant);
+				T root = (-b - sqrtDiscriminant) / (2 * a);
+
+				if (!(root < tClosest && root > tMin))
+				{
+					root = (-b + sqrtDiscriminant) / (2 * a);
+				}
+
+				if (root < tClosest && root > tMin)
+				{
+					tClosest = root;
+					closest = i;
+				}
+			}
+		}
+
+		if (closest == size())
+		{
+			return false;
+		}
+
+		Vec3<T> center(mCenterX[closest], mCenterY[closest], mCenterZ[closest]);
+		intersection.t = tClosest;
+		intersection.p = ray.pointAtParameter(tClosest);
+		intersection.normal = (intersection.p - center) / mRadius[closest];
+		intersection.material = nullptr;
+		intersection.materialIndex = mSphereMaterials[closest];
+		return true;
+	}
+
+	template<typename T>
+	bool StaticScene<T>::scatter(const Ray<T> &inbound, const Intersection<T> &intersection,
+		Vec3<T> &attenuation, Ray<T> &scattered) const
+	{
+		const MaterialVariant &material = mMaterials[intersection.materialIndex];
+
+		// Qualified calls bypass the virtual tables, letting the compiler inline each material
+		switch (material.index())
+		{
+		case 0:
+			return std::get<0>(material).Lambertian<T>::scatter(inbound, intersection, attenuation, scattered);
+		case 1:
+			return std::get<1>(material).Metal<T>::scatter(inbound, intersection, attenuation, scattered);
+		case 2:
+			return std::get<2>(material).Dielectric<T>::scatter(inbound, intersection, attenuation, scattered);
+		default:
+			return false;
+		}
+	}
+
+	template<typename T>
+	bool scatter(const StaticScene<T> &world, const Ray<T> &inbound, const Intersection<T> &intersection,
+		Vec3<T> &attenuation, Ray<T> &scattered)
+	{
+		return world.scatter(inbound, intersection, attenuation, scattered);
+	}
+
+	template<typename T>
+	Vec3<T> emitted(const StaticScene<T> &world, const Intersection<T> &intersection)
+	{
+		return Vec3<T>(0, 0, 0);
+	}
+}
+
+#endif
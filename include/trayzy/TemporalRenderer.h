@@ -0,0 +1,506 @@
+#ifndef TRAYZY_TEMPORALRENDERER_H
+#define TRAYZY_TEMPORALRENDERER_H
+
+#include "Camera.h"
+#include "Hittable.h"
+#include "HitRecord.h"
+#include "Image.h"
+#include "Integrator.h"
+#include "Intersection.h"
+#include "Material.h"
+#include "Random.h"
+#include "Renderer.h"
+#include "RenderSettings.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace trayzy
+{
+	/// The parameters that decide when a pixel's history is reused
+	struct TemporalSettings
+	{
+		/// The most samples a pixel's history keeps, so that it follows view-dependent shading
+		int maxHistory = 64;
+
+		/// The samples every pixel adds each frame even when its history suffices
+		int minSamples = 1;
+
+		/// The relative difference in depth beyond which a reprojected pixel counts as disoccluded
+		double depthTolerance = 0.02;
+
+		/// The smallest cosine between the normals of a pixel and its reprojected history
+		double normalTolerance = 0.9;
+
+		/// The relative standard error of a pixel's mean above which its history counts as noisy
+		double noiseThreshold = 0.05;
+	};
+
+	/**
+	 * The outcome of rendering one frame of a sequence.
+	 *
+	 * @tparam T The color component data type
+	 */
+	template<typename T>
+	struct TemporalFrame
+	{
+		/// The frame, in linear color
+		Image<T> image;
+
+		/// The samples traced for this frame, excluding the one primary ray per pixel
+		std::size_t samples = 0;
+
+		/// The samples a render from scratch would trace beyond those traced, which is
+		/// negative when noisy pixels took more than that
+		std::int64_t samplesSaved = 0;
+
+		/// The pixels that reused the previous frame's history
+		std::size_t reusedPixels = 0;
+
+		/// The seconds the frame took
+		double elapsedSeconds = 0;
+	};
+
+	/**
+	 * Renders sequences of frames seen from a moving camera, reusing the samples of each
+	 * frame in the next.
+	 *
+	 * Every frame first traces one ray through the center of each pixel to find the primitive,
+	 * depth and normal of the surface it sees. The surface point is projected into the
+	 * previous frame's camera, and the four pixels around it donate their sums of samples,
+	 * blended bilinearly, if they saw the same surface there: the primitive must be the same
+	 * and the depth and normal must match within the settings' tolerances, which rejects the
+	 * pixels that the move disoccluded. A pixel then traces new samples up to the sample count
+	 * of the render settings, more while its history is noisy, and at least the settings'
+	 * minimum. Pixels that missed the scene reuse the history of the direction they look in.
+	 *
+	 * Only pixels that saw one surface with a BRDF give or take history: mirrors and glass show
+	 * something else from every camera position, and pixels on a silhouette mix surfaces whose
+	 * share of the pixel changes as the camera moves. Diffuse shading still varies a little
+	 * with the view and repeated resampling blurs detail, so the history is capped and every
+	 * pixel adds a minimum of new samples. Call reset() whenever the scene changes.
+	 *
+	 * Each frame reseeds every tile from the render seed, the frame and the tile index, so a
+	 * sequence is identical no matter how many threads render it.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class TemporalRenderer
+	{
+	public:
+		/**
+		 * Creates a renderer without history.
+		 *
+		 * @param settings The parameters of every frame, whose sample count is the target per pixel
+		 * @param temporalSettings The parameters that decide when history is reused
+		 * @param integrator The integrator that computes the color of each camera ray, or
+		 *        null for the path tracer without direct light sampling
+		 */
+		explicit TemporalRenderer(const RenderSettings &settings = RenderSettings(),
+			const TemporalSettings &temporalSettings = TemporalSettings(),
+			std::shared_ptr<const Integrator<T>> integrator = nullptr) :
+			mRenderer(settings, std::move(integrator)),
+			mTemporalSettings(temporalSettings)
+		{
+			// Do nothing more
+		}
+
+		/// Returns the settings of every frame
+		inline const RenderSettings &settings() const;
+
+		/// Returns the parameters that decide when history is reused
+		inline const TemporalSettings &temporalSettings() const;
+
+		/// Returns the number of frames rendered since the last reset
+		inline int frameCount() const;
+
+		/**
+		 * Renders the next frame of the sequence on all worker threads.
+		 *
+		 * @param world The scene to render, which must be the same for every frame
+		 * @param camera The camera of the frame
+		 * @return The image and statistics of the frame
+		 */
+		TemporalFrame<T> render(const Hittable<T> &world, const Camera<T> &camera);
+
+		/// Forgets the history, so the next frame is rendered from scratch
+		void reset();
+
+	private:
+		/// What a frame keeps of every pixel for the next
+		struct History
+		{
+			/// The sum of the pixel's samples
+			std::vector<Vec3<T>> sums;
+
+			/// The sum of the squared luminances of the pixel's samples
+			std::vector<T> squareSums;
+
+			/// The number of samples in the sums, fractional once blended
+			std::vector<T> counts;
+
+			/// The distance from the camera to the surface seen through the pixel's center,
+			/// or infinity if it missed the scene
+			std::vector<T> depths;
+
+			/// The normal of the surface seen through the pixel's center
+			std::vector<Vec3<T>> normals;
+
+			/// The primitive seen through the pixel's center, or null if it missed the scene
+			std::vector<const Hittable<T> *> primitives;
+
+			/// The sub-element of the primitive seen through the pixel's center
+			std::vector<std::uint32_t> indices;
+
+			/// The surface point seen through the pixel's center
+			std::vector<Vec3<T>> points;
+
+			/// Whether the pixel saw a single surface with view-independent shading, which
+			/// makes its samples fit for reuse
+			std::vector<std::uint8_t> stable;
+		};
+
+		/// The statistics of one tile of a frame
+		struct TileCount
+		{
+			std::size_t samples = 0;
+			std::size_t reusedPixels = 0;
+		};
+
+		/// Finds the surface through the center of every pixel of a tile
+		void traceTile(const Hittable<T> &world, const Camera<T> &camera, const Tile &tile);
+
+		/// Samples the pixels of a tile on top of their history, into the current history and the image
+		TileCount shadeTile(const Hittable<T> &world, const Camera<T> &camera, const Tile &tile, Image<T> &image);
+
+		/// Returns whether a pixel and the four pixels next to it all saw the same primitive
+		bool interior(int col, int row) const;
+
+		/// Blends the history of the previous frame's pixels that saw a pixel's surface, returning
+		/// false if none did
+		bool reproject(std::size_t pixel, Vec3<T> &sum, T &squareSum, T &count) const;
+
+		/// Returns the luminance of a linear color
+		static inline T luminance(const Vec3<T> &color);
+
+	private:
+		Renderer<T> mRenderer;
+		TemporalSettings mTemporalSettings;
+		History mHistory;
+		History mCurrent;
+		Camera<T> mPreviousCamera;
+		int mFrameCount = 0;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	const RenderSettings &TemporalRenderer<T>::settings() const
+	{
+		return mRenderer.settings();
+	}
+
+	template<typename T>
+	const TemporalSettings &TemporalRenderer<T>::temporalSettings() const
+	{
+		return mTemporalSettings;
+	}
+
+	template<typename T>
+	int TemporalRenderer<T>::frameCount() const
+	{
+		return mFrameCount;
+	}
+
+	template<typename T>
+	void TemporalRenderer<T>::reset()
+	{
+		mFrameCount = 0;
+	}
+
+	/* static */
+	template<typename T>
+	T TemporalRenderer<T>::luminance(const Vec3<T> &color)
+	{
+		return T(0.2126) * color[R] + T(0.7152) * color[G] + T(0.0722) * color[B];
+	}
+
+	template<typename T>
+	bool TemporalRenderer<T>::interior(int col, int row) const
+	{
+		const RenderSettings &settings = mRenderer.settings();
+		std::size_t pixel = std::size_t(row) * settings.width + col;
+		const int offsets[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+
+		for (const int *offset : offsets)
+		{
+			int x = std::min(std::max(col + offset[0], 0), settings.width - 1);
+			int y = std::min(std::max(row + offset[1], 0), settings.height - 1);
+			std::size_t neighbor = std::size_t(y) * settings.width + x;
+
+			if (mCurrent.primitives[neighbor] != mCurrent.primitives[pixel]
+				|| mCurrent.indices[neighbor] != mCurrent.indices[pixel])
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	template<typename T>
+	bool TemporalRenderer<T>::reproject(std::size_t pixel, Vec3<T> &sum, T &squareSum, T &count) const
+	{
+		const RenderSettings &settings = mRenderer.settings();
+		bool missed = mCurrent.primitives[pixel] == nullptr;
+		const Vec3<T> &point = mCurrent.points[pixel];
+		T u, v;
+
+		if (!mPreviousCamera.project(missed ? mPreviousCamera.origin() + point : point, u, v))
+		{
+			return false;
+		}
+
+		// Blend the four pixels around the point, offset so that pixel centers are whole numbers
+		T x = u * settings.width - T(0.5);
+		T y = v * settings.height - T(0.5);
+		T distance = (point - mPreviousCamera.origin()).magnitude();
+		int col0 = int(std::floor(x));
+		int row0 = int(std::floor(y));
+		T fx = x - T(col0);
+		T fy = y - T(row0);
+		T totalWeight = 0;
+
+		sum = Vec3<T>();
+		squareSum = 0;
+		count = 0;
+
+		for (int corner = 0; corner < 4; ++corner)
+		{
+			int col = col0 + (corner & 1);
+			int row = row0 + (corner >> 1);
+			T weight = ((corner & 1) ? fx : 1 - fx) * ((corner >> 1) ? fy : 1 - fy);
+
+			if (col < 0 || col >= settings.width || row < 0 || row >= settings.height || weight <= 0)
+			{
+				continue;
+			}
+
+			// Skip the pixels that saw another primitive, the same one elsewhere, or an edge
+			std::size_t source = std::size_t(row) * settings.width + col;
+			T depth = mHistory.depths[source];
+			bool valid = mHistory.stable[source] && mHistory.primitives[source] == mCurrent.primitives[pixel]
+				&& mHistory.indices[source] == mCurrent.indices[pixel] && (missed
+				|| (std::abs(distance - depth) <= T(mTemporalSettings.depthTolerance) * depth
+				&& dot(mCurrent.normals[pixel], mHistory.normals[source]) >= T(mTemporalSettings.normalTolerance)));
+
+			if (valid)
+			{
+				sum += weight * mHistory.sums[source];
+				squareSum += weight * mHistory.squareSums[source];
+				count += weight * mHistory.counts[source];
+				totalWeight += weight;
+			}
+		}
+
+		// A point that only its neighbors saw is too far from any history to trust
+		if (totalWeight < T(0.25))
+		{
+			return false;
+		}
+
+		sum /= totalWeight;
+		squareSum /= totalWeight;
+		count /= totalWeight;
+		return true;
+	}
+
+	template<typename T>
+	void TemporalRenderer<T>::traceTile(const Hittable<T> &world, const Camera<T> &camera, const Tile &tile)
+	{
+		const RenderSettings &settings = mRenderer.settings();
+
+		for (int row = tile.y0; row < tile.y0 + tile.height; ++row)
+		{
+			for (int col = tile.x0; col < tile.x0 + tile.width; ++col)
+			{
+				std::size_t pixel = std::size_t(row) * settings.width + col;
+
+				// Aim through the center of the lens, where missed pixels keep their direction
+				Vec3<T> target = camera.lowerLeft() + (col + T(0.5)) / settings.width * camera.horizontal()
+					+ (row + T(0.5)) / settings.height * camera.vertical();
+				Ray<T> ray(camera.origin(), target - camera.origin());
+				HitRecord<T> record;
+
+				if (!world.closestHit(ray, T(0.001f), std::numeric_limits<T>::max(), record))
+				{
+					mCurrent.depths[pixel] = std::numeric_limits<T>::infinity();
+					mCurrent.normals[pixel] = Vec3<T>();
+					mCurrent.primitives[pixel] = nullptr;
+					mCurrent.indices[pixel] = 0;
+					mCurrent.points[pixel] = ray.direction();
+					mCurrent.stable[pixel] = true;
+					continue;
+				}
+
+				Intersection<T> intersection;
+				world.evaluate(ray, record, intersection);
+
+				// Only materials with a BRDF reflect the same light toward every camera position
+				Vec3<T> facing = dot(intersection.normal, ray.direction()) < 0 ? intersection.normal
+					: -intersection.normal;
+				Vec3<T> f;
+
+				mCurrent.depths[pixel] = (intersection.p - camera.origin()).magnitude();
+				mCurrent.normals[pixel] = intersection.normal;
+				mCurrent.primitives[pixel] = record.primitive;
+				mCurrent.indices[pixel] = record.index;
+				mCurrent.points[pixel] = intersection.p;
+				mCurrent.stable[pixel] = intersection.material
+					&& intersection.material->brdf(ray, intersection, facing, f);
+			}
+		}
+	}
+
+	template<typename T>
+	typename TemporalRenderer<T>::TileCount TemporalRenderer<T>::shadeTile(const Hittable<T> &world,
+		const Camera<T> &camera, const Tile &tile, Image<T> &image)
+	{
+		const RenderSettings &settings = mRenderer.settings();
+		const TemporalSettings &temporal = mTemporalSettings;
+		const Integrator<T> &integrator = mRenderer.integrator();
+		int maxHistory = std::max(temporal.maxHistory, settings.samples);
+		TileCount count;
+
+		for (int row = tile.y0; row < tile.y0 + tile.height; ++row)
+		{
+			for (int col = tile.x0; col < tile.x0 + tile.width; ++col)
+			{
+				std::size_t pixel = std::size_t(row) * settings.width + col;
+				bool stable = mCurrent.stable[pixel] && interior(col, row);
+				Vec3<T> sum;
+				T squareSum = 0;
+				T n = 0;
+
+				if (mFrameCount > 0 && stable && reproject(pixel, sum, squareSum, n))
+				{
+					++count.reusedPixels;
+
+					// Keep room for the new samples within the cap, scaling the sums to the same weight
+					T kept = std::min(n, T(std::max(0, maxHistory - temporal.minSamples)));
+
+					if (kept < n)
+					{
+						T scale = kept / n;
+						sum *= scale;
+						squareSum *= scale;
+						n = kept;
+					}
+				}
+
+				int nNew = std::max(temporal.minSamples, int(std::ceil(settings.samples - n)));
+
+				if (n > 0)
+				{
+					T mean = luminance(sum) / n;
+					T variance = std::max(T(0), squareSum / n - mean * mean);
+					T error = std::sqrt(variance / n);
+
+					if (error > T(temporal.noiseThreshold) * std::max(mean, T(1e-3)))
+					{
+						nNew = std::max(nNew, std::min(settings.samples, int(maxHistory - n)));
+					}
+				}
+
+				for (int s = 0; s < nNew; ++s)
+				{
+					// Draw into named values since argument evaluation order is unspecified
+					T u = (col + randomUniform<T>()) / settings.width;
+					T v = (row + randomUniform<T>()) / settings.height;
+					Vec3<T> c = integrator.radiance(camera.getRay(u, v), world);
+					T y = luminance(c);
+					sum += c;
+					squareSum += y * y;
+				}
+
+				n += nNew;
+				count.samples += nNew;
+
+				mCurrent.sums[pixel] = sum;
+				mCurrent.squareSums[pixel] = squareSum;
+				mCurrent.counts[pixel] = n;
+				mCurrent.stable[pixel] = stable;
+				image.at(col, row) = n > 0 ? sum / n : Vec3<T>();
+			}
+		}
+
+		return count;
+	}
+
+	template<typename T>
+	TemporalFrame<T> TemporalRenderer<T>::render(const Hittable<T> &world, const Camera<T> &camera)
+	{
+		using Clock = std::chrono::steady_clock;
+
+		const RenderSettings &settings = mRenderer.settings();
+		Clock::time_point start = Clock::now();
+		std::size_t nPixels = std::size_t(settings.width) * settings.height;
+
+		mCurrent.sums.resize(nPixels);
+		mCurrent.squareSums.resize(nPixels);
+		mCurrent.counts.resize(nPixels);
+		mCurrent.depths.resize(nPixels);
+		mCurrent.normals.resize(nPixels);
+		mCurrent.primitives.resize(nPixels);
+		mCurrent.indices.resize(nPixels);
+		mCurrent.points.resize(nPixels);
+		mCurrent.stable.resize(nPixels);
+
+		ThreadPool pool(mRenderer.threadCount());
+		std::vector<Tile> tiles = mRenderer.tiles();
+		std::vector<TileCount> counts(tiles.size());
+		TemporalFrame<T> frame;
+		frame.image = Image<T>(settings.width, settings.height);
+
+		// Every surface must be known before shading, which compares each pixel with its neighbors
+		parallelFor(pool, tiles.size(), [&](std::size_t i)
+		{
+			traceTile(world, camera, tiles[i]);
+		});
+
+		parallelFor(pool, tiles.size(), [&](std::size_t i)
+		{
+			seedRandomEngine(Renderer<T>::tileSeed(Renderer<T>::tileSeed(settings.seed, mFrameCount),
+				tiles[i].index));
+			counts[i] = shadeTile(world, camera, tiles[i], frame.image);
+		});
+
+		for (const TileCount &count : counts)
+		{
+			frame.samples += count.samples;
+			frame.reusedPixels += count.reusedPixels;
+		}
+
+		frame.samplesSaved = std::int64_t(nPixels) * settings.samples - std::int64_t(frame.samples);
+		frame.elapsedSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+		// This frame's pixels are the history of the next
+		std::swap(mHistory, mCurrent);
+		mPreviousCamera = camera;
+		++mFrameCount;
+
+		return frame;
+	}
+}
+
+#endif
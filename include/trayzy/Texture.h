@@ -0,0 +1,56 @@
+#ifndef TRAYZY_TEXTURE_H
+#define TRAYZY_TEXTURE_H
+
+#include "Forward.h"
+#include "Vec3.h"
+
+#include <cstddef>
+
+namespace trayzy
+{
+	/**
+	 * A color that varies over space, such as a procedural solid texture.
+	 *
+	 * Textures are immutable once constructed and are shared by every worker thread.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class Texture
+	{
+	public:
+		virtual ~Texture() = default;
+
+		/**
+		 * Returns the color at a point.
+		 *
+		 * @param p The point in world space
+		 * @return The color
+		 */
+		virtual Vec3<T> value(const Vec3<T> &p) const = 0;
+
+		/**
+		 * Returns the colors at many points, which textures may override to share work
+		 * between points.
+		 *
+		 * @param points The points in world space
+		 * @param n The number of points
+		 * @param[out] colors The color at every point
+		 */
+		virtual void values(const Vec3<T> *points, std::size_t n, Vec3<T> *colors) const;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	void Texture<T>::values(const Vec3<T> *points, std::size_t n, Vec3<T> *colors) const
+	{
+		for (std::size_t i = 0; i < n; ++i)
+		{
+			colors[i] = value(points[i]);
+		}
+	}
+}
+
+#endif
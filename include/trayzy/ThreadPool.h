@@ -0,0 +1,200 @@
+#ifndef TRAYZY_THREADPOOL_H
+#define TRAYZY_THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace trayzy
+{
+	/**
+	 * A fixed set of worker threads that run tasks in the order they are posted.
+	 *
+	 * Destroying the pool finishes every task already posted before joining the workers.
+	 */
+	class ThreadPool
+	{
+	public:
+		/**
+		 * Starts a new pool.
+		 *
+		 * @param nThreads The number of worker threads, or zero to use every hardware thread
+		 */
+		explicit ThreadPool(int nThreads = 0);
+
+		ThreadPool(const ThreadPool &) = delete;
+		ThreadPool &operator=(const ThreadPool &) = delete;
+
+		~ThreadPool();
+
+		/// Returns the number of worker threads
+		inline int size() const;
+
+		/// Queues a task to run on a worker thread
+		void post(std::function<void()> task);
+
+	private:
+		/// Runs queued tasks until the pool stops
+		void work();
+
+	private:
+		std::vector<std::thread> mWorkers;
+		std::deque<std::function<void()>> mTasks;
+		std::mutex mMutex;
+		std::condition_variable mCondition;
+		bool mStopping = false;
+	};
+
+	/**
+	 * Calls a function for every index below a count on the workers of a pool, and waits for
+	 * them. Indices are claimed one at a time, so each should stand for a sizable block of work.
+	 *
+	 * After a call throws, the remaining indices are skipped and the first exception is
+	 * rethrown once every worker has stopped. The calling thread blocks, so it must not be a
+	 * worker of the pool.
+	 *
+	 * @param pool The pool whose workers call the function
+	 * @param count The number of indices
+	 * @param function The function to call with each index
+	 * @param failed A flag set once a call throws, which long calls can poll to stop early
+	 *        rather than run to completion, or null to keep the flag internal
+	 */
+	template<typename Function>
+	void parallelFor(ThreadPool &pool, std::size_t count, const Function &function,
+		std::atomic<bool> *failed = nullptr);
+}
+
+namespace trayzy
+{
+	inline ThreadPool::ThreadPool(int nThreads)
+	{
+		if (nThreads <= 0)
+		{
+			nThreads = int(std::max(1u, std::thread::hardware_concurrency()));
+		}
+
+		for (int i = 0; i < nThreads; ++i)
+		{
+			mWorkers.emplace_back(&ThreadPool::work, this);
+		}
+	}
+
+	inline ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mStopping = true;
+		}
+
+		mCondition.notify_all();
+
+		for (std::thread &worker : mWorkers)
+		{
+			worker.join();
+		}
+	}
+
+	int ThreadPool::size() const
+	{
+		return int(mWorkers.size());
+	}
+
+	inline void ThreadPool::post(std::function<void()> task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mTasks.push_back(std::move(task));
+		}
+
+		mCondition.notify_one();
+	}
+
+	inline void ThreadPool::work()
+	{
+		while (true)
+		{
+			std::function<void()> task;
+
+			{
+				std::unique_lock<std::mutex> lock(mMutex);
+				mCondition.wait(lock, [this]() { return mStopping || !mTasks.empty(); });
+
+				if (mTasks.empty())
+				{
+					return;
+				}
+
+				task = std::move(mTasks.front());
+				mTasks.pop_front();
+			}
+
+			task();
+		}
+	}
+
+	template<typename Function>
+	void parallelFor(ThreadPool &pool, std::size_t count, const Function &function, std::atomic<bool> *failed)
+	{
+		std::atomic<std::size_t> next(0);
+		std::atomic<bool> ownFailed(false);
+		std::atomic<bool> &stop = failed ? *failed : ownFailed;
+
+		auto work = [&]()
+		{
+			try
+			{
+				for (std::size_t i = next++; i < count && !stop; i = next++)
+				{
+					function(i);
+				}
+			}
+			catch (...)
+			{
+				// Stop the other workers; the exception reaches the caller through the task's future
+				stop = true;
+				throw;
+			}
+		};
+
+		int nTasks = int(std::max<std::size_t>(1, std::min(std::size_t(pool.size()), count)));
+		std::vector<std::future<void>> results;
+
+		for (int i = 0; i < nTasks; ++i)
+		{
+			auto task = std::make_shared<std::packaged_task<void()>>(work);
+			results.push_back(task->get_future());
+			pool.post([task]() { (*task)(); });
+		}
+
+		// Wait for every task before rethrowing, since they reference the caller's frame
+		std::exception_ptr error;
+
+		for (std::future<void> &result : results)
+		{
+			try
+			{
+				result.get();
+			}
+			catch (...)
+			{
+				error = error ? error : std::current_exception();
+			}
+		}
+
+		if (error)
+		{
+			std::rethrow_exception(error);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef TRAYZY_UNIFORMLIGHTSAMPLER_H
+#define TRAYZY_UNIFORMLIGHTSAMPLER_H
+
+#include "LightSampler.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace trayzy
+{
+	/**
+	 * Chooses every light with the same probability, regardless of its contribution.
+	 *
+	 * @tparam T The coordinate data type
+	 */
+	template<typename T>
+	class UniformLightSampler : public LightSampler<T>
+	{
+	public:
+		/// Creates a sampler over the provided lights
+		explicit UniformLightSampler(std::vector<Light<T>> lights) :
+			LightSampler<T>(std::move(lights))
+		{
+			// Do nothing more
+		}
+
+		// LightSampler::sample
+		virtual const Light<T> *sample(const Vec3<T> &p, const Vec3<T> &n, T u, T &probability) const override;
+	};
+}
+
+namespace trayzy
+{
+	template<typename T>
+	const Light<T> *UniformLightSampler<T>::sample(const Vec3<T> &p, const Vec3<T> &n, T u, T &probability) const
+	{
+		const std::vector<Light<T>> &lights = this->mLights;
+
+		if (lights.empty())
+		{
+			return nullptr;
+		}
+
+		probability = T(1) / lights.size();
+		return &lights[std::min(lights.size() - 1, std::size_t(u * lights.size()))];
+	}
+}
+
+#endif
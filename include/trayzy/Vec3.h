@@ -1,10 +1,12 @@
 #ifndef TRAYZY_VEC3_H
 #define TRAYZY_VEC3_H
 
+#include "FastMath.h"
 #include "Forward.h"
 
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <functional>
 #include <iostream>
 #include <numeric>
@@ -122,6 +124,14 @@ namespace trayzy
 	/// Computes unit vector equivalent of a vector.
 	template<typename T>
 	inline Vec3<T> unitVector(const Vec3<T> &v);
+
+	/// Computes the element-wise minimum between two vectors.
+	template<typename T>
+	inline Vec3<T> minimum(const Vec3<T> &v1, const Vec3<T> &v2);
+
+	/// Computes the element-wise maximum between two vectors.
+	template<typename T>
+	inline Vec3<T> maximum(const Vec3<T> &v1, const Vec3<T> &v2);
 }
 
 // Inline implementation
@@ -181,6 +191,12 @@ namespace trayzy
 	template<typename T>
 	Vec3<T> &Vec3<T>::operator/=(const T &t)
 	{
+		// One division and three multiplications beat three divisions, at the cost of a rounding
+		if (Math<T>::fast)
+		{
+			return *this *= T(1) / t;
+		}
+
 		std::transform(this->cbegin(), this->cend(), this->begin(), std::bind(std::divides<T>(), std::placeholders::_1, t));
 		return *this;
 	}
@@ -194,12 +210,17 @@ namespace trayzy
 	template<typename T>
 	T Vec3<T>::magnitude() const
 	{
-		return std::sqrt(magnitudeSquared());
+		return Math<T>::sqrt(magnitudeSquared());
 	}
 
 	template<typename T>
 	Vec3<T> &Vec3<T>::normalize()
 	{
+		if (Math<T>::fast)
+		{
+			return *this *= Math<T>::rsqrt(magnitudeSquared());
+		}
+
 		*this /= magnitude();
 		return *this;
 	}
@@ -289,6 +310,11 @@ namespace trayzy
 	template<typename T>
 	Vec3<T> operator/(const Vec3<T> &v, const T &t)
 	{
+		if (Math<T>::fast)
+		{
+			return v * (T(1) / t);
+		}
+
 		Vec3<T> result;
 		std::transform(v.cbegin(), v.cend(), result.begin(), std::bind(std::divides<T>(), std::placeholders::_1, t));
 		return result;
@@ -310,8 +336,8 @@ namespace trayzy
 	Vec3<T> cross(const Vec3<T> &v1, const Vec3<T> &v2)
 	{
 		return Vec3<T>(
-			v1[1] * v2[2] - v1[2] * v1[1],
-			v1[2] * v2[0] - v1[0] * v1[2],
+			v1[1] * v2[2] - v1[2] * v2[1],
+			v1[2] * v2[0] - v1[0] * v2[2],
 			v1[0] * v2[1] - v1[1] * v2[0]
 		);
 	}
@@ -319,8 +345,25 @@ namespace trayzy
 	template<typename T>
 	Vec3<T> unitVector(const Vec3<T> &v)
 	{
+		if (Math<T>::fast)
+		{
+			return v * Math<T>::rsqrt(v.magnitudeSquared());
+		}
+
 		return v / v.magnitude();
 	}
+
+	template<typename T>
+	Vec3<T> minimum(const Vec3<T> &v1, const Vec3<T> &v2)
+	{
+		return Vec3<T>(std::min(v1[0], v2[0]), std::min(v1[1], v2[1]), std::min(v1[2], v2[2]));
+	}
+
+	template<typename T>
+	Vec3<T> maximum(const Vec3<T> &v1, const Vec3<T> &v2)
+	{
+		return Vec3<T>(std::max(v1[0], v2[0]), std::max(v1[1], v2[1]), std::max(v1[2], v2[2]));
+	}
 }
 
 #endif
@@ -1,132 +1,273 @@
-#include <cfloat>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <memory>
-#include <random>
+#include <string>
 
+#include <trayzy/AlbedoIntegrator.h>
+#include <trayzy/AmbientOcclusionIntegrator.h>
 #include <trayzy/Camera.h>
+#include <trayzy/DepthIntegrator.h>
 #include <trayzy/Dielectric.h>
+#include <trayzy/DirectLightingIntegrator.h>
+#include <trayzy/EnvironmentLight.h>
 #include <trayzy/HittableList.h>
+#include <trayzy/HybridRenderer.h>
+#include <trayzy/Image.h>
 #include <trayzy/Lambertian.h>
 #include <trayzy/Metal.h>
-#include <trayzy/Ray.h>
+#include <trayzy/NormalIntegrator.h>
+#include <trayzy/PathIntegrator.h>
+#include <trayzy/RadianceCache.h>
+#include <trayzy/RadianceCacheIntegrator.h>
+#include <trayzy/Renderer.h>
+#include <trayzy/RenderStats.h>
+#include <trayzy/SceneArena.h>
 #include <trayzy/Sphere.h>
+#include <trayzy/SphereRasterizer.h>
+#include <trayzy/ThreadPool.h>
 #include <trayzy/Vec3.h>
 
+using AlbedoIntegratorf = trayzy::AlbedoIntegrator<float>;
+using AmbientOcclusionIntegratorf = trayzy::AmbientOcclusionIntegrator<float>;
 using Cameraf = trayzy::Camera<float>;
+using DepthIntegratorf = trayzy::DepthIntegrator<float>;
 using Dielectricf = trayzy::Dielectric<float>;
+using DirectLightingIntegratorf = trayzy::DirectLightingIntegrator<float>;
+using EnvironmentLightf = trayzy::EnvironmentLight<float>;
 using HittableListf = trayzy::HittableList<float>;
+using HybridRendererf = trayzy::HybridRenderer<float>;
+using Imagef = trayzy::Image<float>;
+using Integratorf = trayzy::Integrator<float>;
 using Lambertianf = trayzy::Lambertian<float>;
 using Metalf = trayzy::Metal<float>;
-using Rayf = trayzy::Ray<float>;
+using NormalIntegratorf = trayzy::NormalIntegrator<float>;
+using PathIntegratorf = trayzy::PathIntegrator<float>;
+using RadianceCachef = trayzy::RadianceCache<float>;
+using RadianceCacheIntegratorf = trayzy::RadianceCacheIntegrator<float>;
+using Rendererf = trayzy::Renderer<float>;
 using Spheref = trayzy::Sphere<float>;
+using SphereRasterizerf = trayzy::SphereRasterizer<float>;
 using Vec3f = trayzy::Vec3<float>;
-using Vec3i = trayzy::Vec3<int>;
 
-std::random_device rd;
-std::default_random_engine engine(rd());
-std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+/// Returns the integrator with the provided name, or null if there is none; the radiance
+/// cache, if any, uses cells of cacheCell edge length, cacheBins normal bins per axis and
+/// entries of at least cacheSamples samples
+std::shared_ptr<const Integratorf> makeIntegrator(const std::string &name, float cacheCell, int cacheBins,
+	int cacheSamples)
+{
+	if (name == "path")
+	{
+		return std::make_shared<PathIntegratorf>();
+	}
+	else if (name == "normals")
+	{
+		return std::make_shared<NormalIntegratorf>();
+	}
+	else if (name == "depth")
+	{
+		return std::make_shared<DepthIntegratorf>(5.0f);
+	}
+	else if (name == "albedo")
+	{
+		return std::make_shared<AlbedoIntegratorf>();
+	}
+	else if (name == "ao")
+	{
+		return std::make_shared<AmbientOcclusionIntegratorf>(4, 0.5f);
+	}
+	else if (name == "direct")
+	{
+		return std::make_shared<DirectLightingIntegratorf>();
+	}
+	else if (name == "cache")
+	{
+		return std::make_shared<RadianceCacheIntegratorf>(
+			std::make_shared<RadianceCachef>(cacheCell, cacheBins, cacheSamples));
+	}
+
+	return nullptr;
+}
 
-template<typename T>
-trayzy::Vec3<T> color(const trayzy::Ray<T> &ray, const trayzy::HittableList<T> &world, int depth)
+int main(int argc, char **argv)
 {
-	trayzy::Vec3<T> c(0, 0, 0);
-	trayzy::Vec3<T> white(1, 1, 1);
-	trayzy::Intersection<T> intersection;
-	
-	int maxDepth = 50;
-	T hitEpsilon(0.001f);
+	// TODO Read column count, row count, max value, and output file from arguments
+	trayzy::RenderSettings settings;
+	settings.width = 200;
+	settings.height = 100;
+	settings.samples = 100;
+	std::string integratorName = "path";
+	std::string statsPrefix;
+	std::string visibility = "trace";
+	std::string environmentPath;
+	float cacheCell = 0.2f;
+	int cacheBins = 4;
+	int cacheSamples = 16;
 
-	if (world.hit(ray, hitEpsilon, T(FLT_MAX), intersection))
+	for (int i = 1; i + 1 < argc; i += 2)
 	{
-		trayzy::Ray<T> scattered;
-		trayzy::Vec3<T> attenuation;
-
-		if (depth < maxDepth && intersection.material &&
-			intersection.material->scatter(ray, intersection, attenuation, scattered))
+		if (std::strcmp(argv[i], "--integrator") == 0)
+		{
+			integratorName = argv[i + 1];
+		}
+		else if (std::strcmp(argv[i], "--samples") == 0)
+		{
+			settings.samples = std::max(1, std::atoi(argv[i + 1]));
+		}
+		else if (std::strcmp(argv[i], "--stats") == 0)
+		{
+			statsPrefix = argv[i + 1];
+		}
+		else if (std::strcmp(argv[i], "--visibility") == 0)
+		{
+			visibility = argv[i + 1];
+		}
+		else if (std::strcmp(argv[i], "--environment") == 0)
+		{
+			environmentPath = argv[i + 1];
+		}
+		else if (std::strcmp(argv[i], "--cache-cell") == 0)
+		{
+			cacheCell = std::max(1e-3f, float(std::atof(argv[i + 1])));
+		}
+		else if (std::strcmp(argv[i], "--cache-bins") == 0)
+		{
+			cacheBins = std::atoi(argv[i + 1]);
+		}
+		else if (std::strcmp(argv[i], "--cache-samples") == 0)
 		{
-			c = attenuation * color(scattered, world, ++depth);
+			cacheSamples = std::atoi(argv[i + 1]);
 		}
 	}
-	else
+
+	std::shared_ptr<const Integratorf> integrator = makeIntegrator(integratorName, cacheCell, cacheBins,
+		cacheSamples);
+
+	if (!integrator)
 	{
-		// Perform a linear blend (a.k.a. linear interpolation or "lerp")
-		// from pure white to "Maya blue"
-		trayzy::Vec3<T> unitDirection = trayzy::unitVector(ray.direction());
-		T t = T(0.5) * (unitDirection[trayzy::Y] + 1);
+		std::cerr << "Unknown integrator " << integratorName
+			<< "; use path, normals, depth, albedo, ao, direct or cache" << std::endl;
+		return 1;
+	}
+
+	// Light the scene with a float map of the sky rather than the gradient
+	if (!environmentPath.empty())
+	{
+		std::ifstream environmentIn(environmentPath, std::ios::binary);
+
+		if (!environmentIn || integratorName != "path")
+		{
+			std::cerr << "Cannot light the " << integratorName << " integrator with " << environmentPath
+				<< "; use a portable float map with the path integrator" << std::endl;
+			return 1;
+		}
 
-		trayzy::Vec3<T> mayaBlue(T(0.5), T(0.7), 1);
-		c = (1 - t) * white + t * mayaBlue;
+		auto environment = std::make_shared<EnvironmentLightf>(Imagef::readPfm(environmentIn));
+		integrator = std::make_shared<PathIntegratorf>(nullptr, environment);
 	}
 
-	return c;
-}
+	if (visibility != "trace" && visibility != "raster")
+	{
+		std::cerr << "Unknown visibility " << visibility << "; use trace or raster" << std::endl;
+		return 1;
+	}
+
+	// The hybrid renderer keeps no per-pixel statistics
+	if (visibility == "raster" && !statsPrefix.empty())
+	{
+		std::cerr << "Cannot record statistics to " << statsPrefix << " with rasterized visibility"
+			<< "; use --visibility trace" << std::endl;
+		return 1;
+	}
 
-int main(int argc, char **argv)
-{
-	// TODO Read column count, row count, max value, and output file from arguments
-	int nCols = 200;
-	int nRows = 100;
-	int nSamples = 100;
 	int maxValue = 255;
 	std::ostream &out = std::cout;
 
-	out << "P3" << std::endl << nCols << " " << nRows << std::endl << maxValue << std::endl;
-
+	// The arena owns every scene object, so it must be declared before the world
+	trayzy::SceneArena arena;
 	trayzy::HittableListf world;
 
-	world.insert(std::make_shared<Spheref>(
+	world.insert(trayzy::unowned(arena.make<Spheref>(
 		Vec3f(0.0f, 0.0f, -1.0f), 0.5f,
-		std::make_shared<Lambertianf>(Vec3f(0.1f, 0.2f, 0.5f))));
+		trayzy::unowned(arena.make<Lambertianf>(Vec3f(0.1f, 0.2f, 0.5f))))));
 
-	world.insert(std::make_shared<Spheref>(
+	world.insert(trayzy::unowned(arena.make<Spheref>(
 		Vec3f(0.0f, -100.5f, -1.0f), 100.0f,
-		std::make_shared<Lambertianf>(Vec3f(0.8f, 0.8f, 0.0f))));
+		trayzy::unowned(arena.make<Lambertianf>(Vec3f(0.8f, 0.8f, 0.0f))))));
 
-	world.insert(std::make_shared<Spheref>(
+	world.insert(trayzy::unowned(arena.make<Spheref>(
 		Vec3f(1.0f, 0.0f, -1.0f), 0.5f,
-		std::make_shared<Metalf>(Vec3f(0.8f, 0.6f, 0.2f), 0.3f)));
+		trayzy::unowned(arena.make<Metalf>(Vec3f(0.8f, 0.6f, 0.2f), 0.3f)))));
 
 	// Use a negative radius to point surface normals inward,
 	// creating a hollow glass sphere
-	world.insert(std::make_shared<Spheref>(
-		Vec3f(-1.0f, 0.0f, -1.0f), 0.5f, std::make_shared<Dielectricf>(1.5f)));
+	world.insert(trayzy::unowned(arena.make<Spheref>(
+		Vec3f(-1.0f, 0.0f, -1.0f), 0.5f, trayzy::unowned(arena.make<Dielectricf>(1.5f)))));
 
-	world.insert(std::make_shared<Spheref>(
-		Vec3f(-1.0f, 0.0f, -1.0f), -0.45f, std::make_shared<Dielectricf>(1.5f)));
+	world.insert(trayzy::unowned(arena.make<Spheref>(
+		Vec3f(-1.0f, 0.0f, -1.0f), -0.45f, trayzy::unowned(arena.make<Dielectricf>(1.5f)))));
 
 	Vec3f lookFrom(-2, 2, 1);
 	Vec3f lookAt(0, 0, -1);
 	Vec3f up(0, 1, 0);
 	float verticalFovDegrees = 90;
-	float aspectRatio = float(nCols) / nRows;
+	float aspectRatio = float(settings.width) / settings.height;
 	Cameraf cam(lookFrom, lookAt, up, verticalFovDegrees, aspectRatio);
 
-	for (int j = nRows - 1; j >= 0; --j)
+	Rendererf renderer(settings, integrator);
+	trayzy::ThreadPool pool(renderer.threadCount());
+	trayzy::RenderCallbacks<float> callbacks;
+
+	callbacks.onProgress = [](int completed, int total)
 	{
-		for (int i = 0; i < nCols; ++i)
-		{
-			Vec3f fColor;
+		std::cerr << "\rRendering " << 100 * completed / total << "%" << (completed == total ? "\n" : "") << std::flush;
+	};
 
-			for (int s = 0; s < nSamples; ++s)
-			{
-				float u = (i + distribution(engine)) / nCols;
-				float v = (j + distribution(engine)) / nRows;
-				Rayf ray = cam.getRay(u, v);
-				fColor += color(ray, world, 0);
-			}
+	trayzy::RenderStats stats;
+	trayzy::RenderStats *recorded = statsPrefix.empty() ? nullptr : &stats;
+	Imagef image;
 
-			fColor /= float(nSamples);
+	// Rasterizing primary visibility starts every path at its first bounce, with the same result
+	if (visibility == "raster")
+	{
+		SphereRasterizerf rasterizer(world.hittables());
+		image = HybridRendererf(settings, integrator).render(pool, world, rasterizer, cam);
+	}
+	else
+	{
+		image = renderer.renderAsync(pool, world, cam, callbacks, recorded).get();
+	}
 
-			// Use gamma 2, i.e., raise color to the power 1/gamma which is square root
-			fColor = Vec3f(std::sqrt(fColor[trayzy::R]), std::sqrt(fColor[trayzy::G]), std::sqrt(fColor[trayzy::B]));
+	image.writePpm(out, false, maxValue);
 
-			Vec3i iColor(
-				int(fColor[trayzy::R] * maxValue),
-				int(fColor[trayzy::G] * maxValue),
-				int(fColor[trayzy::B] * maxValue)
-			);
+	// Write the cost of the frame as heatmaps and a table of tiles
+	if (recorded)
+	{
+		using Metric = trayzy::RenderStats::Metric;
+
+		std::ofstream timeOut(statsPrefix + "-time.ppm", std::ios::binary);
+		stats.writeHeatmap(timeOut, Metric::Time);
+		std::ofstream raysOut(statsPrefix + "-rays.ppm", std::ios::binary);
+		stats.writeHeatmap(raysOut, Metric::Rays);
+		std::ofstream tilesOut(statsPrefix + "-tiles.csv");
+		stats.writeTileCsv(tilesOut);
+
+		if (trayzy::RenderStats::countsTests())
+		{
+			std::ofstream testsOut(statsPrefix + "-tests.ppm", std::ios::binary);
+			stats.writeHeatmap(testsOut, Metric::Tests);
+		}
+
+		std::cerr << "Traced " << std::uint64_t(stats.total(Metric::Rays)) << " rays";
 
-			out << iColor << std::endl;
+		if (trayzy::RenderStats::countsTests())
+		{
+			std::cerr << " with " << std::uint64_t(stats.total(Metric::Tests)) << " intersection tests";
 		}
+
+		std::cerr << "; wrote statistics to " << statsPrefix << "-*" << std::endl;
 	}
 }